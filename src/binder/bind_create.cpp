@@ -129,7 +129,35 @@ auto Binder::BindIndex(duckdb_libpgquery::PGIndexStmt *stmt) -> std::unique_ptr<
     }
   }
 
-  return std::make_unique<IndexStatement>(stmt->idxname, std::move(table), std::move(cols));
+  // The parser has no INCLUDE clause, so the columns a covering index stores besides its key come as an option:
+  // `WITH (include = 'v2, v3')`.
+  std::vector<std::unique_ptr<BoundColumnRef>> include_cols;
+  if (stmt->options != nullptr) {
+    for (auto cell = stmt->options->head; cell != nullptr; cell = cell->next) {
+      auto option = reinterpret_cast<duckdb_libpgquery::PGDefElem *>(cell->data.ptr_value);
+      if (StringUtil::Lower(option->defname) != "include") {
+        throw NotImplementedException(fmt::format("index option {} is not supported", option->defname));
+      }
+      if (option->arg == nullptr || option->arg->type != duckdb_libpgquery::T_PGString) {
+        throw bustub::Exception("include takes a string of comma separated columns");
+      }
+      auto names = reinterpret_cast<duckdb_libpgquery::PGValue *>(option->arg)->val.str;
+      for (const auto &name : StringUtil::Split(names, ',')) {
+        auto column_ref = ResolveColumn(*table, std::vector{StringUtil::Strip(name, ' ')});
+        include_cols.emplace_back(
+            std::make_unique<BoundColumnRef>(dynamic_cast<const BoundColumnRef &>(*column_ref)));
+      }
+    }
+  }
+
+  // Without `USING` the parser reports the default access method, a b+ tree.
+  auto index_type = StringUtil::Lower(stmt->accessMethod);
+  if (index_type != "btree" && index_type != "art") {
+    throw NotImplementedException(fmt::format("index type {} is not supported", index_type));
+  }
+
+  return std::make_unique<IndexStatement>(stmt->idxname, std::move(table), std::move(cols), stmt->unique,
+                                          std::move(include_cols), std::move(index_type));
 }
 
 }  // namespace bustub
@@ -62,6 +62,7 @@ BufferPoolManagerInstance::~BufferPoolManagerInstance() {
  */
 
 auto BufferPoolManagerInstance::NewPgImp(page_id_t *page_id) -> Page * {
+  std::scoped_lock<std::mutex> lock(latch_);
   Page *res_page = nullptr;
 
   /** 1. 首先在 free list 中寻找位置 */
@@ -125,6 +126,7 @@ auto BufferPoolManagerInstance::NewPgImp(page_id_t *page_id) -> Page * {
 
 /** 如果说 page 需要从磁盘中获得，但是 buffer pool 已经是没有空位能够用了，并且不能够被驱逐 */
 auto BufferPoolManagerInstance::FetchPgImp(page_id_t page_id) -> Page * {
+  std::scoped_lock<std::mutex> lock(latch_);
   Page *res_page = nullptr;
   /** 1. 首先在 Pages 中判断是不是能够直接获取到，然后 pin  */
   frame_id_t frame_index;
@@ -161,6 +163,7 @@ auto BufferPoolManagerInstance::FetchPgImp(page_id_t page_id) -> Page * {
   res_page->ResetMemory(); /** 如果是驱逐了某个页 那么就需要对内容进行 Reset 操作*/
   disk_manager_->ReadPage(page_id, res_page->GetData());
   res_page->pin_count_++;
+  replacer_->SetEvictable(frame_index, false); /** 新加入 replacer 的 frame 默认可以被驱逐, 必须 pin 住 */
   return res_page;
 }
 
@@ -178,6 +181,7 @@ auto BufferPoolManagerInstance::FetchPgImp(page_id_t page_id) -> Page * {
  * @return false if the page is not in the page table or its pin count is <= 0 before this call, true otherwise
  */
 auto BufferPoolManagerInstance::UnpinPgImp(page_id_t page_id, bool is_dirty) -> bool {
+  std::scoped_lock<std::mutex> lock(latch_);
   frame_id_t frame_index;
   if (!page_table_->Find(page_id, frame_index)) {
     return false; /** 如果说没有在 page_table 中找到数据 */
@@ -209,6 +213,7 @@ auto BufferPoolManagerInstance::UnpinPgImp(page_id_t page_id, bool is_dirty) ->
  */
 
 auto BufferPoolManagerInstance::FlushPgImp(page_id_t page_id) -> bool {
+  std::scoped_lock<std::mutex> lock(latch_);
   frame_id_t frame_index;
   if (!page_table_->Find(page_id, frame_index)) { return false; }
   Page *res_page = pages_ + frame_index;
@@ -219,6 +224,7 @@ auto BufferPoolManagerInstance::FlushPgImp(page_id_t page_id) -> bool {
 
 /** Flush all of the pages, passed the num of pages, from id [0 ~ pool_size - 1] */
 void BufferPoolManagerInstance::FlushAllPgsImp() {
+  std::scoped_lock<std::mutex> lock(latch_);
   size_t pool_size = GetPoolSize();
   Page *page = nullptr;
   for (size_t i = 0; i < pool_size; i++) {
@@ -242,6 +248,7 @@ void BufferPoolManagerInstance::FlushAllPgsImp() {
  */
 
 auto BufferPoolManagerInstance::DeletePgImp(page_id_t page_id) -> bool {
+  std::scoped_lock<std::mutex> lock(latch_);
   frame_id_t frame_index;
   if (!page_table_->Find(page_id, frame_index)) {
     return true;
@@ -27,9 +27,9 @@ auto LRUKReplacer::Evict(frame_id_t *frame_id) -> bool {
       return false;
     }  // 根本没有找到
     // Run here means : find an entry to be evicted in cached list
-    int tmp_id = *frame_id;
     DecrementEvictableSize();
     *frame_id = index2->first;
+    int tmp_id = *frame_id;
     cache_list_.erase(index2);
     cache_mp_.erase(tmp_id);
     counter_.erase(tmp_id);
@@ -164,7 +164,7 @@ void LRUKReplacer::Remove(frame_id_t frame_id) {
       throw std::exception();
     }  // 如果说不存在就抛出异常
     DecrementEvictableSize();
-    history_linked_list_.erase(cache_mp_[frame_id]);
+    history_linked_list_.erase(history_map_[frame_id]);
     history_map_.erase(frame_id);
     counter_.erase(frame_id);
   } else {
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <optional>
 #include <shared_mutex>
 #include <string>
@@ -20,6 +21,7 @@
 #include "common/util/string_util.h"
 #include "concurrency/lock_manager.h"
 #include "concurrency/transaction.h"
+#include "concurrency/vacuum.h"
 #include "execution/execution_engine.h"
 #include "execution/executor_context.h"
 #include "execution/executors/mock_scan_executor.h"
@@ -33,10 +35,21 @@
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
 #include "storage/disk/disk_manager_memory.h"
+#include "storage/page/header_page.h"
 #include "type/value_factory.h"
 
 namespace bustub {
 
+/** Create a b+ tree index whose entries, the key followed by the included columns, fit into KeySize bytes. */
+template <size_t KeySize>
+static auto CreateBPlusTreeIndex(Catalog *catalog, Transaction *txn, const IndexStatement &index_stmt,
+                                 const Schema &key_schema, const std::vector<uint32_t> &key_attrs,
+                                 const std::vector<uint32_t> &include_attrs) -> IndexInfo * {
+  return catalog->CreateIndex<GenericKey<KeySize>, RID, GenericComparator<KeySize>>(
+      txn, index_stmt.index_name_, index_stmt.table_->table_, index_stmt.table_->schema_, key_schema, key_attrs,
+      KeySize, HashFunction<GenericKey<KeySize>>{}, index_stmt.is_unique_, include_attrs);
+}
+
 auto BustubInstance::MakeExecutorContext(Transaction *txn) -> std::unique_ptr<ExecutorContext> {
   return std::make_unique<ExecutorContext>(txn, catalog_, buffer_pool_manager_, txn_manager_, lock_manager_);
 }
@@ -59,6 +72,15 @@ BustubInstance::BustubInstance(const std::string &db_file_name) {
     buffer_pool_manager_ = nullptr;
   }
 
+  // The first page is the header page, the B+ tree indexes record their root page ids in it.
+  if (buffer_pool_manager_ != nullptr) {
+    page_id_t header_page_id;
+    auto *header_page = static_cast<HeaderPage *>(buffer_pool_manager_->NewPage(&header_page_id));
+    BUSTUB_ASSERT(header_page_id == HEADER_PAGE_ID, "the header page must be the first page");
+    header_page->Init();
+    buffer_pool_manager_->UnpinPage(header_page_id, true);
+  }
+
   // Transaction (txn) related.
   lock_manager_ = new LockManager();
   txn_manager_ = new TransactionManager(lock_manager_, log_manager_);
@@ -69,6 +91,10 @@ BustubInstance::BustubInstance(const std::string &db_file_name) {
   // Catalog.
   catalog_ = new Catalog(buffer_pool_manager_, lock_manager_, log_manager_);
 
+  // Garbage collection of deleted tuples and dead tuple versions.
+  vacuum_ = new Vacuum(catalog_, txn_manager_, &catalog_lock_);
+  vacuum_->StartVacuumThread();
+
   // Execution engine.
   execution_engine_ = new ExecutionEngine(buffer_pool_manager_, txn_manager_, catalog_);
 }
@@ -91,6 +117,15 @@ BustubInstance::BustubInstance() {
     buffer_pool_manager_ = nullptr;
   }
 
+  // The first page is the header page, the B+ tree indexes record their root page ids in it.
+  if (buffer_pool_manager_ != nullptr) {
+    page_id_t header_page_id;
+    auto *header_page = static_cast<HeaderPage *>(buffer_pool_manager_->NewPage(&header_page_id));
+    BUSTUB_ASSERT(header_page_id == HEADER_PAGE_ID, "the header page must be the first page");
+    header_page->Init();
+    buffer_pool_manager_->UnpinPage(header_page_id, true);
+  }
+
   // Transaction (txn) related.
   lock_manager_ = new LockManager();
   txn_manager_ = new TransactionManager(lock_manager_, log_manager_);
@@ -101,6 +136,10 @@ BustubInstance::BustubInstance() {
   // Catalog.
   catalog_ = new Catalog(buffer_pool_manager_, lock_manager_, log_manager_);
 
+  // Garbage collection of deleted tuples and dead tuple versions.
+  vacuum_ = new Vacuum(catalog_, txn_manager_, &catalog_lock_);
+  vacuum_->StartVacuumThread();
+
   // Execution engine.
   execution_engine_ = new ExecutionEngine(buffer_pool_manager_, txn_manager_, catalog_);
 }
@@ -146,6 +185,36 @@ void BustubInstance::CmdDisplayIndices(ResultWriter &writer) {
   writer.EndTable();
 }
 
+void BustubInstance::CmdDisplayLocks(ResultWriter &writer) {
+  auto entries = lock_manager_->GetLockStats()->Snapshot();
+  // The most contended first.
+  std::sort(entries.begin(), entries.end(), [](const LockStatsEntry &a, const LockStatsEntry &b) {
+    return a.wait_time_us_ != b.wait_time_us_ ? a.wait_time_us_ > b.wait_time_us_ : a.requests_ > b.requests_;
+  });
+  writer.BeginTable(false);
+  writer.BeginHeader();
+  for (const auto *header : {"table", "row", "requests", "waits", "wait_us", "wait_p50_us", "wait_p99_us", "upgrades",
+                             "deadlock_aborts"}) {
+    writer.WriteHeaderCell(header);
+  }
+  writer.EndHeader();
+  for (const auto &entry : entries) {
+    writer.BeginRow();
+    const auto *table_info = catalog_->GetTable(entry.oid_);
+    writer.WriteCell(table_info != Catalog::NULL_TABLE_INFO ? table_info->name_ : fmt::format("{}", entry.oid_));
+    writer.WriteCell(entry.is_row_ ? fmt::format("{}/{}", entry.rid_.GetPageId(), entry.rid_.GetSlotNum()) : "-");
+    writer.WriteCell(fmt::format("{}", entry.requests_));
+    writer.WriteCell(fmt::format("{}", entry.waits_));
+    writer.WriteCell(fmt::format("{}", entry.wait_time_us_));
+    writer.WriteCell(fmt::format("{}", entry.WaitPercentileUs(0.5)));
+    writer.WriteCell(fmt::format("{}", entry.WaitPercentileUs(0.99)));
+    writer.WriteCell(fmt::format("{}", entry.upgrades_));
+    writer.WriteCell(fmt::format("{}", entry.deadlock_aborts_));
+    writer.EndRow();
+  }
+  writer.EndTable();
+}
+
 void BustubInstance::WriteOneCell(const std::string &cell, ResultWriter &writer) {
   writer.BeginTable(true);
   writer.BeginRow();
@@ -161,6 +230,9 @@ void BustubInstance::CmdDisplayHelp(ResultWriter &writer) {
 \di: show all indices
 \help: show this message again
 
+SET lock_stats = true: count lock requests and waits per table and sampled row
+SHOW LOCKS: show the lock counters, the most contended first
+
 BusTub shell currently only supports a small set of Postgres queries. We'll set
 up a doc describing the current status later. It will silently ignore some parts
 of the query, so it's normal that you'll get a wrong result when executing
@@ -227,20 +299,55 @@ auto BustubInstance::ExecuteSqlTxn(const std::string &sql, ResultWriter &writer,
         std::vector<uint32_t> col_ids;
         for (const auto &col : index_stmt.cols_) {
           auto idx = index_stmt.table_->schema_.GetColIdx(col->col_name_.back());
+          if (std::find(col_ids.begin(), col_ids.end(), idx) != col_ids.end()) {
+            throw bustub::Exception(fmt::format("column {} is already in the index", col->ToString()));
+          }
           col_ids.push_back(idx);
           if (index_stmt.table_->schema_.GetColumn(idx).GetType() != TypeId::INTEGER) {
             throw NotImplementedException("only support creating index on integer column");
           }
         }
-        if (col_ids.size() != 1) {
-          throw NotImplementedException("only support creating index with exactly one column");
+        std::vector<uint32_t> include_ids;
+        for (const auto &col : index_stmt.include_cols_) {
+          auto idx = index_stmt.table_->schema_.GetColIdx(col->col_name_.back());
+          if (std::find(col_ids.begin(), col_ids.end(), idx) != col_ids.end() ||
+              std::find(include_ids.begin(), include_ids.end(), idx) != include_ids.end()) {
+            throw bustub::Exception(fmt::format("column {} is already in the index", col->ToString()));
+          }
+          include_ids.push_back(idx);
+          if (index_stmt.table_->schema_.GetColumn(idx).GetType() != TypeId::INTEGER) {
+            throw NotImplementedException("only support including integer columns");
+          }
         }
         auto key_schema = Schema::CopySchema(&index_stmt.table_->schema_, col_ids);
 
+        // The entries are as wide as the key and the included columns, rounded up to a key size the tree is built for.
+        size_t entry_size = INTEGER_SIZE * (col_ids.size() + include_ids.size());
+        if (entry_size > 64) {
+          throw NotImplementedException("too many key and included columns");
+        }
+        bool art = index_stmt.index_type_ == "art";
+        if (art && !include_ids.empty()) {
+          throw NotImplementedException("art indexes do not include columns");
+        }
         std::unique_lock<std::shared_mutex> l(catalog_lock_);
-        auto info = catalog_->CreateIndex<IntegerKeyType, IntegerValueType, IntegerComparatorType>(
-            txn, index_stmt.index_name_, index_stmt.table_->table_, index_stmt.table_->schema_, key_schema, col_ids,
-            INTEGER_SIZE, IntegerHashFunctionType{});
+        IndexInfo *info;
+        if (art) {
+          // The tree encodes the keys itself, the key types are only there to fit the catalog's interface.
+          info = catalog_->CreateIndex<IntegerKeyType, IntegerValueType, IntegerComparatorType>(
+              txn, index_stmt.index_name_, index_stmt.table_->table_, index_stmt.table_->schema_, key_schema, col_ids,
+              entry_size, HashFunction<IntegerKeyType>{}, index_stmt.is_unique_, include_ids, IndexType::ARTIndex);
+        } else if (entry_size <= INTEGER_SIZE) {
+          info = CreateBPlusTreeIndex<INTEGER_SIZE>(catalog_, txn, index_stmt, key_schema, col_ids, include_ids);
+        } else if (entry_size <= 8) {
+          info = CreateBPlusTreeIndex<8>(catalog_, txn, index_stmt, key_schema, col_ids, include_ids);
+        } else if (entry_size <= 16) {
+          info = CreateBPlusTreeIndex<16>(catalog_, txn, index_stmt, key_schema, col_ids, include_ids);
+        } else if (entry_size <= 32) {
+          info = CreateBPlusTreeIndex<32>(catalog_, txn, index_stmt, key_schema, col_ids, include_ids);
+        } else {
+          info = CreateBPlusTreeIndex<64>(catalog_, txn, index_stmt, key_schema, col_ids, include_ids);
+        }
         l.unlock();
 
         if (info == nullptr) {
@@ -251,6 +358,10 @@ auto BustubInstance::ExecuteSqlTxn(const std::string &sql, ResultWriter &writer,
       }
       case StatementType::VARIABLE_SHOW_STATEMENT: {
         const auto &show_stmt = dynamic_cast<const VariableShowStatement &>(*statement);
+        if (StringUtil::Lower(show_stmt.variable_) == "locks") {
+          CmdDisplayLocks(writer);
+          continue;
+        }
         auto content = GetSessionVariable(show_stmt.variable_);
         WriteOneCell(fmt::format("{}={}", show_stmt.variable_, content), writer);
         continue;
@@ -258,6 +369,10 @@ auto BustubInstance::ExecuteSqlTxn(const std::string &sql, ResultWriter &writer,
       case StatementType::VARIABLE_SET_STATEMENT: {
         const auto &set_stmt = dynamic_cast<const VariableSetStatement &>(*statement);
         session_variables_[set_stmt.variable_] = set_stmt.value_;
+        if (set_stmt.variable_ == "lock_stats") {
+          auto value = StringUtil::Lower(set_stmt.value_);
+          lock_manager_->GetLockStats()->Enable(value == "1" || value == "true" || value == "yes");
+        }
         continue;
       }
       case StatementType::EXPLAIN_STATEMENT: {
@@ -392,6 +507,7 @@ BustubInstance::~BustubInstance() {
     log_manager_->StopFlushThread();
   }
   delete execution_engine_;
+  delete vacuum_;
   delete catalog_;
   delete checkpoint_manager_;
   delete log_manager_;
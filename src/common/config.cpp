@@ -20,4 +20,6 @@ std::chrono::duration<int64_t> log_timeout = std::chrono::seconds(1);
 
 std::chrono::milliseconds cycle_detection_interval = std::chrono::milliseconds(50);
 
+std::chrono::milliseconds vacuum_interval = std::chrono::milliseconds(100);
+
 }  // namespace bustub
@@ -12,37 +12,742 @@
 
 #include "concurrency/lock_manager.h"
 
+#include <chrono>  // NOLINT
+#include <functional>
+#include <optional>
+#include <set>
+
 #include "common/config.h"
 #include "concurrency/transaction.h"
 #include "concurrency/transaction_manager.h"
 
 namespace bustub {
 
-auto LockManager::LockTable(Transaction *txn, LockMode lock_mode, const table_oid_t &oid) -> bool { return true; }
+/*****************************************************************************
+ * LOCK REQUEST POOL
+ *****************************************************************************/
+
+auto LockRequestPool::Acquire(txn_id_t txn_id, LockManager::LockMode lock_mode, table_oid_t oid)
+    -> LockManager::LockRequest * {
+  if (free_list_.empty()) {
+    return &requests_.emplace_back(txn_id, lock_mode, oid);
+  }
+  auto *request = free_list_.back();
+  free_list_.pop_back();
+  *request = LockManager::LockRequest(txn_id, lock_mode, oid);
+  return request;
+}
 
-auto LockManager::UnlockTable(Transaction *txn, const table_oid_t &oid) -> bool { return true; }
+auto LockRequestPool::Acquire(txn_id_t txn_id, LockManager::LockMode lock_mode, table_oid_t oid, const RID &rid)
+    -> LockManager::LockRequest * {
+  if (free_list_.empty()) {
+    return &requests_.emplace_back(txn_id, lock_mode, oid, rid);
+  }
+  auto *request = free_list_.back();
+  free_list_.pop_back();
+  *request = LockManager::LockRequest(txn_id, lock_mode, oid, rid);
+  return request;
+}
+
+/*****************************************************************************
+ * LOCK / UNLOCK
+ *****************************************************************************/
+
+auto LockManager::LockTable(Transaction *txn, LockMode lock_mode, const table_oid_t &oid) -> bool {
+  if (txn->GetState() == TransactionState::ABORTED || txn->GetState() == TransactionState::COMMITTED) {
+    return false;
+  }
+  CheckLockAllowed(txn, lock_mode);
+
+  auto guard = PinTableQueue(oid);
+  auto *queue = guard.Get();
+  std::unique_lock<std::mutex> lock(queue->latch_);
+  auto *request = GetRequestPool(txn)->Acquire(txn->GetTransactionId(), lock_mode, oid);
+  return AcquireLock(txn, queue, &lock, request);
+}
+
+auto LockManager::UnlockTable(Transaction *txn, const table_oid_t &oid) -> bool {
+  txn->LockTxn();
+  auto s_rows = txn->GetSharedRowLockSet()->find(oid);
+  auto x_rows = txn->GetExclusiveRowLockSet()->find(oid);
+  bool holds_rows = (s_rows != txn->GetSharedRowLockSet()->end() && !s_rows->second.empty()) ||
+                    (x_rows != txn->GetExclusiveRowLockSet()->end() && !x_rows->second.empty());
+  txn->UnlockTxn();
+  if (holds_rows) {
+    AbortImplicitly(txn, AbortReason::TABLE_UNLOCKED_BEFORE_UNLOCKING_ROWS);
+  }
+
+  auto guard = PinTableQueue(oid);
+  auto *queue = guard.Get();
+  std::unique_lock<std::mutex> lock(queue->latch_);
+  auto *request = FindRequest(queue, txn->GetTransactionId());
+  if (request == nullptr || !request->granted_) {
+    lock.unlock();
+    AbortImplicitly(txn, AbortReason::ATTEMPTED_UNLOCK_BUT_NO_LOCK_HELD);
+  }
+  queue->request_queue_.remove(request);
+  queue->cv_.notify_all();
+  lock.unlock();
+
+  UpdateStateOnUnlock(txn, request->lock_mode_);
+  BookTableLock(txn, request->lock_mode_, oid, false);
+  txn->LockTxn();
+  txn->GetEscalatedTableSet()->erase(oid);
+  txn->UnlockTxn();
+  GetRequestPool(txn)->Release(request);
+  return true;
+}
 
 auto LockManager::LockRow(Transaction *txn, LockMode lock_mode, const table_oid_t &oid, const RID &rid) -> bool {
+  if (txn->GetState() == TransactionState::ABORTED || txn->GetState() == TransactionState::COMMITTED) {
+    return false;
+  }
+  if (lock_mode != LockMode::SHARED && lock_mode != LockMode::EXCLUSIVE) {
+    AbortImplicitly(txn, AbortReason::ATTEMPTED_INTENTION_LOCK_ON_ROW);
+  }
+  CheckLockAllowed(txn, lock_mode);
+
+  // A row lock needs a matching lock on its table: X rows need X, IX or SIX, S rows need any table lock. This holds
+  // before escalation as well, escalating never grants more than the table lock allows.
+  bool table_locked = txn->IsTableExclusiveLocked(oid) || txn->IsTableIntentionExclusiveLocked(oid) ||
+                      txn->IsTableSharedIntentionExclusiveLocked(oid);
+  if (lock_mode == LockMode::SHARED) {
+    table_locked = table_locked || txn->IsTableSharedLocked(oid) || txn->IsTableIntentionSharedLocked(oid);
+  }
+  if (!table_locked) {
+    AbortImplicitly(txn, AbortReason::TABLE_LOCK_NOT_PRESENT);
+  }
+
+  // After escalation the table lock stands in for the row locks of the table.
+  if (txn->IsTableEscalated(oid) && TableLockCovers(txn, lock_mode, oid)) {
+    return true;
+  }
+  if (txn->GetState() == TransactionState::GROWING &&
+      (txn->IsTableEscalated(oid) ||
+       (lock_escalation_threshold_ != 0 && CountRowLocks(txn, oid) >= lock_escalation_threshold_))) {
+    return EscalateRowLocks(txn, lock_mode, oid);
+  }
+
+  auto guard = PinRowQueue(rid);
+  auto *queue = guard.Get();
+  std::unique_lock<std::mutex> lock(queue->latch_);
+  auto *request = GetRequestPool(txn)->Acquire(txn->GetTransactionId(), lock_mode, oid, rid);
+  return AcquireLock(txn, queue, &lock, request);
+}
+
+auto LockManager::UnlockRow(Transaction *txn, const table_oid_t &oid, const RID &rid) -> bool {
+  if (txn->IsTableEscalated(oid) && !txn->IsRowSharedLocked(oid, rid) && !txn->IsRowExclusiveLocked(oid, rid)) {
+    // The row lock was folded into the table lock, which is released by UnlockTable().
+    return true;
+  }
+  auto guard = PinRowQueue(rid);
+  auto *queue = guard.Get();
+  std::unique_lock<std::mutex> lock(queue->latch_);
+  auto *request = FindRequest(queue, txn->GetTransactionId());
+  if (request == nullptr || !request->granted_) {
+    lock.unlock();
+    AbortImplicitly(txn, AbortReason::ATTEMPTED_UNLOCK_BUT_NO_LOCK_HELD);
+  }
+  queue->request_queue_.remove(request);
+  queue->cv_.notify_all();
+  lock.unlock();
+
+  UpdateStateOnUnlock(txn, request->lock_mode_);
+  BookRowLock(txn, request->lock_mode_, oid, rid, false);
+  GetRequestPool(txn)->Release(request);
   return true;
 }
 
-auto LockManager::UnlockRow(Transaction *txn, const table_oid_t &oid, const RID &rid) -> bool { return true; }
+/*****************************************************************************
+ * HELPERS
+ *****************************************************************************/
+
+auto LockManager::PinTableQueue(const table_oid_t &oid) -> QueueGuard<table_oid_t> {
+  return {&table_lock_map_[std::hash<table_oid_t>()(oid) % LOCK_TABLE_PARTITION_NUM], oid};
+}
+
+auto LockManager::PinRowQueue(const RID &rid) -> QueueGuard<RID> {
+  return {&row_lock_map_[std::hash<RID>()(rid) % LOCK_TABLE_PARTITION_NUM], rid};
+}
 
-void LockManager::AddEdge(txn_id_t t1, txn_id_t t2) {}
+void LockManager::NotifyQueue(table_oid_t oid, const RID &rid) {
+  auto notify = [](LockRequestQueue *queue) {
+    std::scoped_lock<std::mutex> lock(queue->latch_);
+    queue->cv_.notify_all();
+  };
+  if (rid.GetPageId() == INVALID_PAGE_ID) {
+    notify(PinTableQueue(oid).Get());
+  } else {
+    notify(PinRowQueue(rid).Get());
+  }
+}
 
-void LockManager::RemoveEdge(txn_id_t t1, txn_id_t t2) {}
+auto LockManager::GetQueueCount() -> size_t {
+  size_t count = 0;
+  for (auto &partition : table_lock_map_) {
+    std::scoped_lock<std::mutex> lock(partition.latch_);
+    count += partition.queues_.size();
+  }
+  for (auto &partition : row_lock_map_) {
+    std::scoped_lock<std::mutex> lock(partition.latch_);
+    count += partition.queues_.size();
+  }
+  return count;
+}
 
-auto LockManager::HasCycle(txn_id_t *txn_id) -> bool { return false; }
+auto LockManager::GetRequestPool(Transaction *txn) -> LockRequestPool * {
+  if (txn->GetLockRequestPool() == nullptr) {
+    txn->SetLockRequestPool(std::make_shared<LockRequestPool>());
+  }
+  return txn->GetLockRequestPool();
+}
+
+auto LockManager::AcquireLock(Transaction *txn, LockRequestQueue *queue, std::unique_lock<std::mutex> *lock,
+                              LockRequest *request) -> bool {
+  auto *pool = GetRequestPool(txn);
+  auto *held = FindRequest(queue, txn->GetTransactionId());
+  bool upgrade = false;
+  if (held != nullptr) {
+    if (held->lock_mode_ == request->lock_mode_) {
+      pool->Release(request);
+      return true;
+    }
+    if (queue->upgrading_ != INVALID_TXN_ID) {
+      pool->Release(request);
+      lock->unlock();
+      AbortImplicitly(txn, AbortReason::UPGRADE_CONFLICT);
+    }
+    if (!CanUpgrade(held->lock_mode_, request->lock_mode_)) {
+      pool->Release(request);
+      lock->unlock();
+      AbortImplicitly(txn, AbortReason::INCOMPATIBLE_UPGRADE);
+    }
+
+    // Drop the old lock and queue the upgrade in front of every waiting request.
+    queue->request_queue_.remove(held);
+    if (request->rid_.GetPageId() == INVALID_PAGE_ID) {
+      BookTableLock(txn, held->lock_mode_, request->oid_, false);
+    } else {
+      BookRowLock(txn, held->lock_mode_, request->oid_, request->rid_, false);
+    }
+    pool->Release(held);
+
+    auto it = std::find_if(queue->request_queue_.begin(), queue->request_queue_.end(),
+                           [](const LockRequest *r) { return !r->granted_; });
+    queue->request_queue_.insert(it, request);
+    queue->upgrading_ = txn->GetTransactionId();
+    upgrade = true;
+  } else {
+    queue->request_queue_.push_back(request);
+  }
+
+  // The request goes back to the pool when it is withdrawn, so keep what the counters need.
+  bool stats = stats_.IsEnabled();
+  table_oid_t oid = request->oid_;
+  RID rid = request->rid_;
+  const RID *row = rid.GetPageId() == INVALID_PAGE_ID ? nullptr : &rid;
+  std::optional<std::chrono::steady_clock::time_point> wait_start;
+  if (stats) {
+    stats_.RecordRequest(oid, row, upgrade);
+  }
+  auto record_wait = [&]() {
+    if (wait_start.has_value()) {
+      auto wait_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() -
+                                                                           *wait_start);
+      stats_.RecordWait(oid, row, wait_us.count());
+    }
+  };
+
+  auto withdraw = [&]() {
+    if (upgrade) {
+      queue->upgrading_ = INVALID_TXN_ID;
+    }
+    queue->request_queue_.remove(request);
+    queue->cv_.notify_all();
+    pool->Release(request);
+  };
+
+  while (!Grantable(queue, request)) {
+    if (txn->IsOptimistic()) {
+      // An optimistic transaction only locks while it validates, where a conflict fails the validation instead.
+      withdraw();
+      return false;
+    }
+    if (deadlock_policy_ == DeadlockPolicy::WAIT_DIE && !CanWait(queue, request)) {
+      withdraw();
+      lock->unlock();
+      if (stats) {
+        stats_.RecordDeadlockAbort(oid, row);
+      }
+      AbortImplicitly(txn, AbortReason::DEADLOCK);
+    }
+    if (deadlock_policy_ == DeadlockPolicy::WOUND_WAIT) {
+      if (Wound(queue, lock, request)) {
+        continue;
+      }
+      // Register before the state check below, so a wounder either sees us waiting here or we see its wound.
+      SetWaitingOn(txn->GetTransactionId(), request);
+      if (txn->GetState() == TransactionState::ABORTED) {
+        SetWaitingOn(txn->GetTransactionId(), nullptr);
+        withdraw();
+        if (stats) {
+          record_wait();
+          stats_.RecordDeadlockAbort(oid, row);
+        }
+        return false;
+      }
+    }
+    if (stats && !wait_start.has_value()) {
+      wait_start = std::chrono::steady_clock::now();
+    }
+    queue->cv_.wait(*lock);
+    if (deadlock_policy_ == DeadlockPolicy::WOUND_WAIT) {
+      SetWaitingOn(txn->GetTransactionId(), nullptr);
+    }
+    if (txn->GetState() == TransactionState::ABORTED) {
+      // Aborted while waiting: chosen as a deadlock victim or wounded.
+      withdraw();
+      if (stats) {
+        record_wait();
+        stats_.RecordDeadlockAbort(oid, row);
+      }
+      return false;
+    }
+  }
+
+  request->granted_ = true;
+  if (upgrade) {
+    queue->upgrading_ = INVALID_TXN_ID;
+  }
+  if (request->lock_mode_ != LockMode::EXCLUSIVE) {
+    // The next waiter may be compatible with us; let it re-check.
+    queue->cv_.notify_all();
+  }
+  lock->unlock();
+  if (stats) {
+    record_wait();
+  }
+
+  if (request->rid_.GetPageId() == INVALID_PAGE_ID) {
+    BookTableLock(txn, request->lock_mode_, request->oid_, true);
+  } else {
+    BookRowLock(txn, request->lock_mode_, request->oid_, request->rid_, true);
+  }
+  return true;
+}
+
+auto LockManager::Grantable(LockRequestQueue *queue, LockRequest *request) -> bool {
+  for (auto *other : queue->request_queue_) {
+    if (other == request) {
+      return true;
+    }
+    // Granted requests form a prefix of the queue; a waiting request in front of us is served first (FIFO).
+    if (!other->granted_ || !AreCompatible(other->lock_mode_, request->lock_mode_)) {
+      return false;
+    }
+  }
+  return false;
+}
+
+auto LockManager::FindRequest(LockRequestQueue *queue, txn_id_t txn_id) -> LockRequest * {
+  for (auto *request : queue->request_queue_) {
+    if (request->txn_id_ == txn_id) {
+      return request;
+    }
+  }
+  return nullptr;
+}
+
+auto LockManager::CanWait(LockRequestQueue *queue, LockRequest *request) -> bool {
+  for (auto *other : queue->request_queue_) {
+    if (other == request) {
+      break;
+    }
+    bool blocks = !other->granted_ || !AreCompatible(other->lock_mode_, request->lock_mode_);
+    if (blocks && other->txn_id_ < request->txn_id_) {
+      return false;
+    }
+  }
+  return true;
+}
+
+auto LockManager::Wound(LockRequestQueue *queue, std::unique_lock<std::mutex> *lock, LockRequest *request) -> bool {
+  std::vector<txn_id_t> wounded;
+  for (auto *other : queue->request_queue_) {
+    if (other == request) {
+      break;
+    }
+    bool blocks = !other->granted_ || !AreCompatible(other->lock_mode_, request->lock_mode_);
+    if (!blocks || other->txn_id_ < request->txn_id_) {
+      continue;
+    }
+    auto *victim = TransactionManager::GetTransaction(other->txn_id_);
+    if (victim->GetState() == TransactionState::GROWING || victim->GetState() == TransactionState::SHRINKING) {
+      victim->SetState(TransactionState::ABORTED);
+      wounded.push_back(other->txn_id_);
+    }
+  }
+  if (wounded.empty()) {
+    return false;
+  }
+  // Victims waiting on this queue re-check their state right away.
+  queue->cv_.notify_all();
+
+  // A victim holding a lock here may itself be blocked on another queue; it has to wake up there and roll back.
+  std::vector<std::pair<table_oid_t, RID>> elsewhere;
+  {
+    std::scoped_lock<std::mutex> waiting_lock(waiting_on_latch_);
+    for (auto victim : wounded) {
+      auto it = waiting_on_.find(victim);
+      if (it != waiting_on_.end() && !(it->second.first == request->oid_ && it->second.second == request->rid_)) {
+        elsewhere.push_back(it->second);
+      }
+    }
+  }
+  if (elsewhere.empty()) {
+    return false;
+  }
+  // Never hold two queue latches at once, or wounders on different queues could deadlock on the latches.
+  lock->unlock();
+  for (const auto &[oid, rid] : elsewhere) {
+    NotifyQueue(oid, rid);
+  }
+  lock->lock();
+  return true;
+}
+
+void LockManager::SetWaitingOn(txn_id_t txn_id, const LockRequest *request) {
+  std::scoped_lock<std::mutex> waiting_lock(waiting_on_latch_);
+  if (request == nullptr) {
+    waiting_on_.erase(txn_id);
+  } else {
+    waiting_on_[txn_id] = {request->oid_, request->rid_};
+  }
+}
+
+void LockManager::BookTableLock(Transaction *txn, LockMode lock_mode, const table_oid_t &oid, bool insert) {
+  std::shared_ptr<std::unordered_set<table_oid_t>> lock_set;
+  switch (lock_mode) {
+    case LockMode::SHARED:
+      lock_set = txn->GetSharedTableLockSet();
+      break;
+    case LockMode::EXCLUSIVE:
+      lock_set = txn->GetExclusiveTableLockSet();
+      break;
+    case LockMode::INTENTION_SHARED:
+      lock_set = txn->GetIntentionSharedTableLockSet();
+      break;
+    case LockMode::INTENTION_EXCLUSIVE:
+      lock_set = txn->GetIntentionExclusiveTableLockSet();
+      break;
+    case LockMode::SHARED_INTENTION_EXCLUSIVE:
+      lock_set = txn->GetSharedIntentionExclusiveTableLockSet();
+      break;
+  }
+  txn->LockTxn();
+  if (insert) {
+    lock_set->emplace(oid);
+  } else {
+    lock_set->erase(oid);
+  }
+  txn->UnlockTxn();
+}
+
+void LockManager::BookRowLock(Transaction *txn, LockMode lock_mode, const table_oid_t &oid, const RID &rid,
+                              bool insert) {
+  auto lock_set = lock_mode == LockMode::SHARED ? txn->GetSharedRowLockSet() : txn->GetExclusiveRowLockSet();
+  txn->LockTxn();
+  if (insert) {
+    (*lock_set)[oid].emplace(rid);
+  } else {
+    (*lock_set)[oid].erase(rid);
+  }
+  txn->UnlockTxn();
+}
+
+void LockManager::UpdateStateOnUnlock(Transaction *txn, LockMode lock_mode) {
+  if (txn->GetState() != TransactionState::GROWING) {
+    return;
+  }
+  if (lock_mode == LockMode::EXCLUSIVE ||
+      (lock_mode == LockMode::SHARED && (txn->GetIsolationLevel() == IsolationLevel::REPEATABLE_READ ||
+                                         txn->GetIsolationLevel() == IsolationLevel::SNAPSHOT_ISOLATION))) {
+    txn->SetState(TransactionState::SHRINKING);
+  }
+}
+
+auto LockManager::CountRowLocks(Transaction *txn, const table_oid_t &oid) -> size_t {
+  size_t count = 0;
+  txn->LockTxn();
+  auto s_rows = txn->GetSharedRowLockSet()->find(oid);
+  if (s_rows != txn->GetSharedRowLockSet()->end()) {
+    count += s_rows->second.size();
+  }
+  auto x_rows = txn->GetExclusiveRowLockSet()->find(oid);
+  if (x_rows != txn->GetExclusiveRowLockSet()->end()) {
+    count += x_rows->second.size();
+  }
+  txn->UnlockTxn();
+  return count;
+}
+
+auto LockManager::TableLockCovers(Transaction *txn, LockMode lock_mode, const table_oid_t &oid) -> bool {
+  if (txn->IsTableExclusiveLocked(oid)) {
+    return true;
+  }
+  return lock_mode == LockMode::SHARED &&
+         (txn->IsTableSharedLocked(oid) || txn->IsTableSharedIntentionExclusiveLocked(oid));
+}
+
+auto LockManager::EscalateRowLocks(Transaction *txn, LockMode lock_mode, const table_oid_t &oid) -> bool {
+  txn->LockTxn();
+  std::vector<RID> rows;
+  auto s_rows = txn->GetSharedRowLockSet()->find(oid);
+  if (s_rows != txn->GetSharedRowLockSet()->end()) {
+    rows.insert(rows.end(), s_rows->second.begin(), s_rows->second.end());
+  }
+  bool exclusive = lock_mode == LockMode::EXCLUSIVE;
+  auto x_rows = txn->GetExclusiveRowLockSet()->find(oid);
+  if (x_rows != txn->GetExclusiveRowLockSet()->end()) {
+    exclusive = exclusive || !x_rows->second.empty();
+    rows.insert(rows.end(), x_rows->second.begin(), x_rows->second.end());
+  }
+  txn->UnlockTxn();
+
+  auto row_mode = exclusive ? LockMode::EXCLUSIVE : LockMode::SHARED;
+  if (!TableLockCovers(txn, row_mode, oid)) {
+    // IX cannot be upgraded to S; SIX gives the same read access while keeping the intention to write.
+    auto table_mode = LockMode::SHARED;
+    if (exclusive) {
+      table_mode = LockMode::EXCLUSIVE;
+    } else if (txn->IsTableIntentionExclusiveLocked(oid)) {
+      table_mode = LockMode::SHARED_INTENTION_EXCLUSIVE;
+    }
+    if (!LockTable(txn, table_mode, oid)) {
+      return false;
+    }
+  }
+
+  auto *pool = GetRequestPool(txn);
+  for (const auto &rid : rows) {
+    auto guard = PinRowQueue(rid);
+    auto *queue = guard.Get();
+    std::unique_lock<std::mutex> lock(queue->latch_);
+    auto *request = FindRequest(queue, txn->GetTransactionId());
+    queue->request_queue_.remove(request);
+    queue->cv_.notify_all();
+    lock.unlock();
+    BookRowLock(txn, request->lock_mode_, oid, rid, false);
+    pool->Release(request);
+  }
+  txn->LockTxn();
+  txn->GetEscalatedTableSet()->emplace(oid);
+  txn->UnlockTxn();
+  return true;
+}
+
+void LockManager::CheckLockAllowed(Transaction *txn, LockMode lock_mode) {
+  bool shared_mode = lock_mode == LockMode::SHARED || lock_mode == LockMode::INTENTION_SHARED ||
+                     lock_mode == LockMode::SHARED_INTENTION_EXCLUSIVE;
+  switch (txn->GetIsolationLevel()) {
+    case IsolationLevel::READ_UNCOMMITTED:
+      if (shared_mode) {
+        AbortImplicitly(txn, AbortReason::LOCK_SHARED_ON_READ_UNCOMMITTED);
+      }
+      if (txn->GetState() == TransactionState::SHRINKING) {
+        AbortImplicitly(txn, AbortReason::LOCK_ON_SHRINKING);
+      }
+      break;
+    case IsolationLevel::READ_COMMITTED:
+      if (txn->GetState() == TransactionState::SHRINKING && lock_mode != LockMode::SHARED &&
+          lock_mode != LockMode::INTENTION_SHARED) {
+        AbortImplicitly(txn, AbortReason::LOCK_ON_SHRINKING);
+      }
+      break;
+    case IsolationLevel::REPEATABLE_READ:
+    case IsolationLevel::SNAPSHOT_ISOLATION:
+      // Snapshot isolation only locks for writes, which follow the same two phases as repeatable read.
+      if (txn->GetState() == TransactionState::SHRINKING) {
+        AbortImplicitly(txn, AbortReason::LOCK_ON_SHRINKING);
+      }
+      break;
+  }
+}
+
+void LockManager::AbortImplicitly(Transaction *txn, AbortReason reason) {
+  txn->SetState(TransactionState::ABORTED);
+  throw TransactionAbortException(txn->GetTransactionId(), reason);
+}
+
+auto LockManager::AreCompatible(LockMode held, LockMode requested) -> bool {
+  switch (held) {
+    case LockMode::INTENTION_SHARED:
+      return requested != LockMode::EXCLUSIVE;
+    case LockMode::INTENTION_EXCLUSIVE:
+      return requested == LockMode::INTENTION_SHARED || requested == LockMode::INTENTION_EXCLUSIVE;
+    case LockMode::SHARED:
+      return requested == LockMode::INTENTION_SHARED || requested == LockMode::SHARED;
+    case LockMode::SHARED_INTENTION_EXCLUSIVE:
+      return requested == LockMode::INTENTION_SHARED;
+    case LockMode::EXCLUSIVE:
+      return false;
+  }
+  return false;
+}
+
+auto LockManager::CanUpgrade(LockMode held, LockMode requested) -> bool {
+  switch (held) {
+    case LockMode::INTENTION_SHARED:
+      return requested == LockMode::SHARED || requested == LockMode::EXCLUSIVE ||
+             requested == LockMode::SHARED_INTENTION_EXCLUSIVE;
+    case LockMode::SHARED:
+    case LockMode::INTENTION_EXCLUSIVE:
+      return requested == LockMode::EXCLUSIVE || requested == LockMode::SHARED_INTENTION_EXCLUSIVE;
+    case LockMode::SHARED_INTENTION_EXCLUSIVE:
+      return requested == LockMode::EXCLUSIVE;
+    case LockMode::EXCLUSIVE:
+      return false;
+  }
+  return false;
+}
+
+/*****************************************************************************
+ * DEADLOCK DETECTION
+ *****************************************************************************/
+
+void LockManager::AddEdge(txn_id_t t1, txn_id_t t2) {
+  auto &edges = waits_for_[t1];
+  if (std::find(edges.begin(), edges.end(), t2) == edges.end()) {
+    edges.push_back(t2);
+  }
+}
+
+void LockManager::RemoveEdge(txn_id_t t1, txn_id_t t2) {
+  auto it = waits_for_.find(t1);
+  if (it == waits_for_.end()) {
+    return;
+  }
+  auto &edges = it->second;
+  edges.erase(std::remove(edges.begin(), edges.end(), t2), edges.end());
+  if (edges.empty()) {
+    waits_for_.erase(it);
+  }
+}
+
+auto LockManager::HasCycle(txn_id_t *txn_id) -> bool {
+  // Explore from the lowest txn id and visit neighbours in ascending order, so the result is deterministic.
+  std::set<txn_id_t> nodes;
+  for (const auto &[from, edges] : waits_for_) {
+    nodes.insert(from);
+  }
+
+  std::unordered_set<txn_id_t> done;
+  for (auto start : nodes) {
+    if (done.count(start) != 0) {
+      continue;
+    }
+    std::vector<txn_id_t> path;
+    std::unordered_set<txn_id_t> on_path;
+    std::function<bool(txn_id_t)> dfs = [&](txn_id_t node) -> bool {
+      path.push_back(node);
+      on_path.insert(node);
+      auto it = waits_for_.find(node);
+      if (it != waits_for_.end()) {
+        std::vector<txn_id_t> next(it->second);
+        std::sort(next.begin(), next.end());
+        for (auto neighbour : next) {
+          if (on_path.count(neighbour) != 0) {
+            auto cycle_begin = std::find(path.begin(), path.end(), neighbour);
+            *txn_id = *std::max_element(cycle_begin, path.end());
+            return true;
+          }
+          if (done.count(neighbour) == 0 && dfs(neighbour)) {
+            return true;
+          }
+        }
+      }
+      path.pop_back();
+      on_path.erase(node);
+      done.insert(node);
+      return false;
+    };
+    if (dfs(start)) {
+      return true;
+    }
+  }
+  return false;
+}
 
 auto LockManager::GetEdgeList() -> std::vector<std::pair<txn_id_t, txn_id_t>> {
   std::vector<std::pair<txn_id_t, txn_id_t>> edges(0);
+  for (const auto &[from, tos] : waits_for_) {
+    for (auto to : tos) {
+      edges.emplace_back(from, to);
+    }
+  }
   return edges;
 }
 
 void LockManager::RunCycleDetection() {
   while (enable_cycle_detection_) {
     std::this_thread::sleep_for(cycle_detection_interval);
-    {  // TODO(students): detect deadlock
+    {
+      // Snapshot the waits-for edges of every queue. Partitions are visited one at a time, so lock traffic on the
+      // other partitions is never stalled by the detector.
+      std::vector<std::pair<txn_id_t, txn_id_t>> edges;
+      // The resource every waiting transaction is blocked on, so a victim can be woken up.
+      std::unordered_map<txn_id_t, std::pair<table_oid_t, RID>> waiting_on;
+      auto collect = [&](LockRequestQueue *queue) {
+        std::scoped_lock<std::mutex> queue_lock(queue->latch_);
+        for (auto *waiter : queue->request_queue_) {
+          if (waiter->granted_) {
+            continue;
+          }
+          waiting_on[waiter->txn_id_] = {waiter->oid_, waiter->rid_};
+          for (auto *holder : queue->request_queue_) {
+            if (holder->granted_ && holder->txn_id_ != waiter->txn_id_) {
+              edges.emplace_back(waiter->txn_id_, holder->txn_id_);
+            }
+          }
+        }
+      };
+      for (auto &partition : table_lock_map_) {
+        std::scoped_lock<std::mutex> partition_lock(partition.latch_);
+        for (auto &[oid, queue] : partition.queues_) {
+          collect(&queue);
+        }
+      }
+      for (auto &partition : row_lock_map_) {
+        std::scoped_lock<std::mutex> partition_lock(partition.latch_);
+        for (auto &[rid, queue] : partition.queues_) {
+          collect(&queue);
+        }
+      }
+      if (edges.empty()) {
+        continue;
+      }
+
+      std::scoped_lock<std::mutex> graph_lock(waits_for_latch_);
+      waits_for_.clear();
+      for (const auto &[from, to] : edges) {
+        AddEdge(from, to);
+      }
+      txn_id_t victim;
+      while (HasCycle(&victim)) {
+        // The victim may have been granted its lock and finished since the graph was collected.
+        if (auto *victim_txn = TransactionManager::GetTransaction(victim); victim_txn != nullptr) {
+          victim_txn->SetState(TransactionState::ABORTED);
+        }
+        waits_for_.erase(victim);
+        for (auto &[from, tos] : waits_for_) {
+          tos.erase(std::remove(tos.begin(), tos.end(), victim), tos.end());
+        }
+        auto resource = waiting_on.find(victim);
+        if (resource != waiting_on.end()) {
+          NotifyQueue(resource->second.first, resource->second.second);
+        }
+      }
+      waits_for_.clear();
     }
   }
 }
@@ -0,0 +1,165 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lock_stats.cpp
+//
+// Identification: src/concurrency/lock_stats.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "concurrency/lock_stats.h"
+
+#include <mutex>  // NOLINT
+
+namespace bustub {
+
+auto LockStatsEntry::WaitPercentileUs(double p) const -> uint64_t {
+  if (waits_ == 0) {
+    return 0;
+  }
+  auto rank = static_cast<uint64_t>(p * static_cast<double>(waits_ - 1)) + 1;
+  uint64_t seen = 0;
+  for (size_t i = 0; i < wait_histogram_.size(); i++) {
+    seen += wait_histogram_[i];
+    if (seen >= rank) {
+      return uint64_t{1} << i;
+    }
+  }
+  return uint64_t{1} << (wait_histogram_.size() - 1);
+}
+
+void LockStats::Enable(bool enable) {
+  if (enable && !enabled_.load()) {
+    // Counters are reset in place, a lock request that raced with an earlier Enable(false) may still hold them.
+    std::shared_lock<std::shared_mutex> lock(latch_);
+    for (auto &[oid, counters] : tables_) {
+      Reset(counters.get());
+    }
+    for (auto &[rid, row] : rows_) {
+      Reset(row.second.get());
+    }
+  }
+  enabled_.store(enable);
+}
+
+void LockStats::RecordRequest(table_oid_t oid, const RID *rid, bool upgrade) {
+  Counters *counters;
+  if (rid == nullptr) {
+    counters = TableCounters(oid);
+  } else {
+    bool sample = row_requests_.fetch_add(1, std::memory_order_relaxed) % LOCK_STATS_ROW_SAMPLE_RATE == 0;
+    counters = RowCounters(*rid);
+    if (counters == nullptr && sample) {
+      std::unique_lock<std::shared_mutex> lock(latch_);
+      if (rows_.size() < LOCK_STATS_ROW_CAPACITY) {
+        auto &row = rows_[*rid];
+        if (row.second == nullptr) {
+          row = {oid, std::make_unique<Counters>()};
+        }
+        counters = row.second.get();
+      }
+    }
+    // Row requests are also counted on their table, so the table totals are exact.
+    auto *table = TableCounters(oid);
+    table->requests_.fetch_add(1, std::memory_order_relaxed);
+    if (upgrade) {
+      table->upgrades_.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (counters == nullptr) {
+      return;
+    }
+  }
+  counters->requests_.fetch_add(1, std::memory_order_relaxed);
+  if (upgrade) {
+    counters->upgrades_.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+void LockStats::RecordWait(table_oid_t oid, const RID *rid, uint64_t wait_us) {
+  size_t bucket = 0;
+  while (bucket + 1 < LOCK_WAIT_HISTOGRAM_BUCKETS && (uint64_t{1} << bucket) <= wait_us) {
+    bucket++;
+  }
+  for (auto *counters : {TableCounters(oid), rid == nullptr ? nullptr : RowCounters(*rid)}) {
+    if (counters == nullptr) {
+      continue;
+    }
+    counters->waits_.fetch_add(1, std::memory_order_relaxed);
+    counters->wait_time_us_.fetch_add(wait_us, std::memory_order_relaxed);
+    counters->wait_histogram_[bucket].fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+void LockStats::RecordDeadlockAbort(table_oid_t oid, const RID *rid) {
+  for (auto *counters : {TableCounters(oid), rid == nullptr ? nullptr : RowCounters(*rid)}) {
+    if (counters != nullptr) {
+      counters->deadlock_aborts_.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+}
+
+auto LockStats::Snapshot() -> std::vector<LockStatsEntry> {
+  std::vector<LockStatsEntry> entries;
+  std::shared_lock<std::shared_mutex> lock(latch_);
+  for (const auto &[oid, counters] : tables_) {
+    entries.push_back(Copy(*counters, oid, false, RID()));
+  }
+  for (const auto &[rid, row] : rows_) {
+    entries.push_back(Copy(*row.second, row.first, true, rid));
+  }
+  return entries;
+}
+
+auto LockStats::TableCounters(table_oid_t oid) -> Counters * {
+  {
+    std::shared_lock<std::shared_mutex> lock(latch_);
+    auto it = tables_.find(oid);
+    if (it != tables_.end()) {
+      return it->second.get();
+    }
+  }
+  std::unique_lock<std::shared_mutex> lock(latch_);
+  auto &counters = tables_[oid];
+  if (counters == nullptr) {
+    counters = std::make_unique<Counters>();
+  }
+  return counters.get();
+}
+
+auto LockStats::RowCounters(const RID &rid) -> Counters * {
+  std::shared_lock<std::shared_mutex> lock(latch_);
+  auto it = rows_.find(rid);
+  return it == rows_.end() ? nullptr : it->second.second.get();
+}
+
+void LockStats::Reset(Counters *counters) {
+  counters->requests_ = 0;
+  counters->waits_ = 0;
+  counters->upgrades_ = 0;
+  counters->deadlock_aborts_ = 0;
+  counters->wait_time_us_ = 0;
+  for (auto &bucket : counters->wait_histogram_) {
+    bucket = 0;
+  }
+}
+
+auto LockStats::Copy(const Counters &counters, table_oid_t oid, bool is_row, RID rid) -> LockStatsEntry {
+  LockStatsEntry entry{oid,
+                       is_row,
+                       rid,
+                       counters.requests_.load(),
+                       counters.waits_.load(),
+                       counters.upgrades_.load(),
+                       counters.deadlock_aborts_.load(),
+                       counters.wait_time_us_.load(),
+                       {}};
+  for (size_t i = 0; i < entry.wait_histogram_.size(); i++) {
+    entry.wait_histogram_[i] = counters.wait_histogram_[i].load();
+  }
+  return entry;
+}
+
+}  // namespace bustub
@@ -12,24 +12,37 @@
 
 #include "concurrency/transaction_manager.h"
 
+#include <algorithm>
+#include <map>
 #include <mutex>  // NOLINT
 #include <shared_mutex>
+#include <thread>  // NOLINT
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
+#include <vector>
 
 #include "catalog/catalog.h"
 #include "storage/table/table_heap.h"
 namespace bustub {
 
-std::unordered_map<txn_id_t, Transaction *> TransactionManager::txn_map = {};
-std::shared_mutex TransactionManager::txn_map_mutex = {};
+std::array<TransactionManager::TxnMapPartition, TXN_MAP_PARTITION_NUM> TransactionManager::txn_map = {};
 
-auto TransactionManager::Begin(Transaction *txn, IsolationLevel isolation_level) -> Transaction * {
+auto TransactionManager::Begin(Transaction *txn, IsolationLevel isolation_level,
+                               ConcurrencyControl concurrency_control) -> Transaction * {
   // Acquire the global transaction latch in shared mode.
   global_txn_latch_.RLock();
 
   if (txn == nullptr) {
     txn = new Transaction(next_txn_id_++, isolation_level);
+    txn->SetConcurrencyControl(concurrency_control);
+  }
+
+  if (txn->GetIsolationLevel() == IsolationLevel::SNAPSHOT_ISOLATION) {
+    // The snapshot holds everything committed so far; it pins the versions it reads until the transaction ends.
+    std::scoped_lock<std::mutex> lock(ts_latch_);
+    txn->SetReadTs(last_commit_ts_.load());
+    active_read_ts_.insert(txn->GetReadTs());
   }
 
   if (enable_logging) {
@@ -38,51 +51,226 @@ auto TransactionManager::Begin(Transaction *txn, IsolationLevel isolation_level)
     txn->SetPrevLSN(lsn);
   }
 
-  std::unique_lock<std::shared_mutex> l(txn_map_mutex);
-  txn_map[txn->GetTransactionId()] = txn;
+  auto &partition = TxnMapPartitionOf(txn->GetTransactionId());
+  std::unique_lock<std::shared_mutex> l(partition.latch_);
+  partition.map_[txn->GetTransactionId()] = txn;
   return txn;
 }
 
-void TransactionManager::Commit(Transaction *txn) {
+auto TransactionManager::Commit(Transaction *txn) -> bool {
+  if (txn->IsOptimistic() && !ValidateAndInstall(txn)) {
+    Abort(txn);
+    return false;
+  }
   txn->SetState(TransactionState::COMMITTED);
 
-  // Perform all deletes before we commit.
+  if (txn->GetIsolationLevel() == IsolationLevel::SNAPSHOT_ISOLATION) {
+    std::scoped_lock<std::mutex> lock(ts_latch_);
+    active_read_ts_.erase(active_read_ts_.find(txn->GetReadTs()));
+  }
+
+  // Stamp the new versions with the open epoch, then wait for the epoch to close so that new snapshots see them.
+  // Deletes that no running snapshot can see anymore are applied right away, the others are left to the vacuum.
+  std::vector<std::pair<TableHeap *, RID>> deletes;
   auto write_set = txn->GetWriteSet();
-  while (!write_set->empty()) {
-    auto &item = write_set->back();
-    auto *table = item.table_;
-    if (item.wtype_ == WType::DELETE) {
-      // Note that this also releases the lock when holding the page latch.
-      table->ApplyDelete(item.rid_, txn);
+  if (!write_set->empty()) {
+    timestamp_t commit_ts = EnterEpoch();
+    // The epoch is still open, so the watermark is below commit_ts and the replaced versions are kept.
+    timestamp_t watermark = GetWatermark();
+    txn->SetCommitTs(commit_ts);
+    for (const auto &item : *write_set) {
+      item.table_->GetVersionStore()->Commit(item.rid_, txn->GetTransactionId(), commit_ts, watermark);
+    }
+    epoch_committers_[commit_ts % 2]--;
+    CloseEpoch(commit_ts);
+
+    std::scoped_lock<std::mutex> lock(ts_latch_);
+    watermark = WatermarkUnlocked();
+    for (const auto &item : *write_set) {
+      if (item.wtype_ == WType::DELETE) {
+        if (commit_ts <= watermark) {
+          deletes.emplace_back(item.table_, item.rid_);
+        } else {
+          deferred_deletes_.push_back({item.table_, item.rid_, commit_ts});
+        }
+      }
     }
-    write_set->pop_back();
   }
   write_set->clear();
+  txn->GetUndoBuffer()->Clear();
+
+  // Perform all deletes before we commit. Their index entries go first, so that an index never leads to a freed slot.
+  if (!deletes.empty()) {
+    for (const auto &item : *txn->GetIndexWriteSet()) {
+      if (item.wtype_ == WType::DELETE) {
+        DropIndexEntry(item, txn);
+      }
+    }
+  }
+  for (const auto &[table, rid] : deletes) {
+    // Note that this also releases the lock when holding the page latch.
+    table->ApplyDelete(rid, txn);
+  }
 
   // Release all the locks.
   ReleaseLocks(txn);
+  UnregisterTransaction(txn->GetTransactionId());
   // Release the global transaction latch.
   global_txn_latch_.RUnlock();
+  return true;
+}
+
+void TransactionManager::CloseEpoch(timestamp_t commit_ts) {
+  std::scoped_lock<std::mutex> lock(epoch_latch_);
+  if (last_commit_ts_.load() >= commit_ts) {
+    // Another committer of the group closed it.
+    return;
+  }
+  epoch_.store(commit_ts + 1);
+  while (epoch_committers_[commit_ts % 2].load() != 0) {
+    std::this_thread::yield();
+  }
+  last_commit_ts_.store(commit_ts);
+}
+
+auto TransactionManager::ValidateAndInstall(Transaction *txn) -> bool {
+  if (txn->GetState() == TransactionState::ABORTED) {
+    return false;
+  }
+  auto write_set = txn->GetOptimisticWriteSet();
+  std::vector<std::pair<TableHeap *, RID>> reserved;
+  std::unordered_set<TableHeap *> insert_locked;
+  auto release = [&]() {
+    for (const auto &[table, rid] : reserved) {
+      table->GetVersionStore()->Rollback(rid, txn->GetTransactionId());
+    }
+    for (auto *table : insert_locked) {
+      table->GetVersionStore()->UnlockInserts();
+    }
+  };
+
+  // Phase 1: lock the write set. Deleted and updated tuples are claimed, tables that get inserts have their insert
+  // version made odd, so that concurrent scans of them fail to validate. 2PL readers do not look at either, so the
+  // writes are also locked like a 2PL writer locks them: IX on the tables and X on the rows that are deleted or
+  // updated, held until the transaction ends.
+  for (const auto &item : *write_set) {
+    bool locked = LockForInstall(txn, item);
+    if (locked && item.wtype_ == WType::INSERT) {
+      if (insert_locked.count(item.table_) == 0) {
+        locked = item.table_->GetVersionStore()->LockInserts();
+        if (locked) {
+          insert_locked.insert(item.table_);
+        }
+      }
+    } else if (locked) {
+      locked = item.table_->ReserveWrite(item.rid_, txn);
+      if (locked) {
+        reserved.emplace_back(item.table_, item.rid_);
+      }
+    }
+    if (!locked) {
+      release();
+      return false;
+    }
+  }
+
+  // Phase 2: validate that nothing read changed, and that nobody inserted into the scanned tables.
+  for (const auto &item : *txn->GetOptimisticReadSet()) {
+    if (!item.table_->GetVersionStore()->ValidateVersion(item.rid_, txn, item.version_)) {
+      release();
+      return false;
+    }
+  }
+  for (const auto &item : *txn->GetOptimisticScanSet()) {
+    uint64_t expected = item.version_ + (insert_locked.count(item.table_) != 0 ? 1 : 0);
+    if (item.version_ % 2 != 0 || item.table_->GetVersionStore()->GetInsertVersion() != expected) {
+      release();
+      return false;
+    }
+  }
+
+  // Phase 3: install the writes. From here on they go through the table write set like any other write, so an
+  // install that fails leaves the installed ones to Abort() and only releases the rest.
+  for (auto item = write_set->begin(); item != write_set->end(); ++item) {
+    auto *table_info = item->catalog_->GetTable(item->table_oid_);
+    RID rid = item->rid_;
+    bool installed = false;
+    if (item->wtype_ == WType::INSERT) {
+      installed = item->table_->InsertTuple(item->tuple_, &rid, txn);
+    } else if (item->wtype_ == WType::UPDATE) {
+      installed = item->table_->UpdateTuple(item->tuple_, rid, txn);
+    } else {
+      installed = item->table_->MarkDelete(rid, txn);
+    }
+    if (!installed) {
+      for (auto rest = item; rest != write_set->end(); ++rest) {
+        if (rest->wtype_ != WType::INSERT) {
+          rest->table_->GetVersionStore()->Rollback(rest->rid_, txn->GetTransactionId());
+        }
+      }
+      for (auto *table : insert_locked) {
+        table->GetVersionStore()->UnlockInserts();
+      }
+      return false;
+    }
+    for (auto *index_info : item->catalog_->GetTableIndexes(table_info->name_)) {
+      // Deleted tuples keep their index entries until the delete is applied.
+      if (item->wtype_ == WType::INSERT) {
+        InsertIndexEntry(txn, table_info, index_info, item->tuple_, rid, item->catalog_);
+      } else if (item->wtype_ == WType::UPDATE) {
+        // Abort() puts the old entry back.
+        auto *index = index_info->index_.get();
+        index->DeleteEntry(index->EntryFromTuple(item->old_tuple_, table_info->schema_), rid, txn);
+        index->InsertEntry(index->EntryFromTuple(item->tuple_, table_info->schema_), rid, txn);
+        IndexWriteRecord record(rid, item->table_oid_, WType::UPDATE, item->tuple_, index_info->index_oid_,
+                                item->catalog_);
+        record.old_tuple_ = item->old_tuple_;
+        txn->AppendIndexWriteRecord(record);
+      } else {
+        txn->AppendIndexWriteRecord(IndexWriteRecord(rid, item->table_oid_, item->wtype_, item->tuple_,
+                                                     index_info->index_oid_, item->catalog_));
+      }
+    }
+  }
+  for (auto *table : insert_locked) {
+    table->GetVersionStore()->UnlockInserts();
+  }
+  write_set->clear();
+  return true;
+}
+
+auto TransactionManager::LockForInstall(Transaction *txn, const OptimisticWriteRecord &item) -> bool {
+  auto oid = item.table_oid_;
+  try {
+    if (!txn->IsTableIntentionExclusiveLocked(oid) &&
+        !lock_manager_->LockTable(txn, LockManager::LockMode::INTENTION_EXCLUSIVE, oid)) {
+      return false;
+    }
+    return item.wtype_ == WType::INSERT ||
+           lock_manager_->LockRow(txn, LockManager::LockMode::EXCLUSIVE, oid, item.rid_);
+  } catch (TransactionAbortException &e) {
+    return false;
+  }
 }
 
 void TransactionManager::Abort(Transaction *txn) {
   txn->SetState(TransactionState::ABORTED);
-  // Rollback before releasing the lock.
+  // Rollback before releasing the lock. The writes are undone newest first, but every page is latched only once.
   auto table_write_set = txn->GetWriteSet();
-  while (!table_write_set->empty()) {
-    auto &item = table_write_set->back();
-    auto *table = item.table_;
-    if (item.wtype_ == WType::DELETE) {
-      table->RollbackDelete(item.rid_, txn);
-    } else if (item.wtype_ == WType::INSERT) {
-      // Note that this also releases the lock when holding the page latch.
-      table->ApplyDelete(item.rid_, txn);
-    } else if (item.wtype_ == WType::UPDATE) {
-      table->UpdateTuple(item.tuple_, item.rid_, txn);
-    }
-    table_write_set->pop_back();
+  std::map<std::pair<TableHeap *, page_id_t>, std::vector<const TableWriteRecord *>> page_writes;
+  for (auto item = table_write_set->rbegin(); item != table_write_set->rend(); ++item) {
+    page_writes[{item->table_, item->rid_.GetPageId()}].push_back(&*item);
+  }
+  for (const auto &[page, records] : page_writes) {
+    page.first->RollbackPage(page.second, records, txn);
+  }
+  // Only drop the version chain entries once every page holds its old version again, so that snapshots never see an
+  // intermediate version of a tuple the transaction wrote several times.
+  for (const auto &item : *table_write_set) {
+    item.table_->GetVersionStore()->Rollback(item.rid_, txn->GetTransactionId());
   }
   table_write_set->clear();
+  txn->GetUndoBuffer()->Clear();
   // Rollback index updates
   auto index_write_set = txn->GetIndexWriteSet();
   while (!index_write_set->empty()) {
@@ -91,30 +279,93 @@ void TransactionManager::Abort(Transaction *txn) {
     // Metadata identifying the table that should be deleted from.
     TableInfo *table_info = catalog->GetTable(item.table_oid_);
     IndexInfo *index_info = catalog->GetIndex(item.index_oid_);
-    auto new_key = item.tuple_.KeyFromTuple(table_info->schema_, *(index_info->index_->GetKeySchema()),
-                                            index_info->index_->GetKeyAttrs());
+    auto new_key = index_info->index_->EntryFromTuple(item.tuple_, table_info->schema_);
     if (item.wtype_ == WType::DELETE) {
-      index_info->index_->InsertEntry(new_key, item.rid_, txn);
+      // A delete leaves the entry in place, unless an insert into a unique index replaced it.
+      std::vector<RID> result;
+      index_info->index_->ScanKey(
+          item.tuple_.KeyFromTuple(table_info->schema_, index_info->key_schema_, index_info->index_->GetKeyAttrs()),
+          &result, txn);
+      if (std::find(result.begin(), result.end(), item.rid_) == result.end()) {
+        index_info->index_->InsertEntry(new_key, item.rid_, txn);
+      }
     } else if (item.wtype_ == WType::INSERT) {
       index_info->index_->DeleteEntry(new_key, item.rid_, txn);
     } else if (item.wtype_ == WType::UPDATE) {
       // Delete the new key and insert the old key
       index_info->index_->DeleteEntry(new_key, item.rid_, txn);
-      auto old_key = item.old_tuple_.KeyFromTuple(table_info->schema_, *(index_info->index_->GetKeySchema()),
-                                                  index_info->index_->GetKeyAttrs());
+      auto old_key = index_info->index_->EntryFromTuple(item.old_tuple_, table_info->schema_);
       index_info->index_->InsertEntry(old_key, item.rid_, txn);
     }
     index_write_set->pop_back();
   }
-  table_write_set->clear();
   index_write_set->clear();
 
+  if (txn->GetIsolationLevel() == IsolationLevel::SNAPSHOT_ISOLATION) {
+    std::scoped_lock<std::mutex> lock(ts_latch_);
+    active_read_ts_.erase(active_read_ts_.find(txn->GetReadTs()));
+  }
+
   // Release all the locks.
   ReleaseLocks(txn);
+  UnregisterTransaction(txn->GetTransactionId());
   // Release the global transaction latch.
   global_txn_latch_.RUnlock();
 }
 
+auto TransactionManager::TakeDeferredDeletes() -> std::vector<std::pair<TableHeap *, RID>> {
+  std::vector<std::pair<TableHeap *, RID>> deletes;
+  std::scoped_lock<std::mutex> lock(ts_latch_);
+  timestamp_t watermark = WatermarkUnlocked();
+  auto it = std::remove_if(deferred_deletes_.begin(), deferred_deletes_.end(), [&](const DeferredDelete &item) {
+    if (item.commit_ts_ > watermark) {
+      return false;
+    }
+    deletes.emplace_back(item.table_, item.rid_);
+    return true;
+  });
+  deferred_deletes_.erase(it, deferred_deletes_.end());
+  return deletes;
+}
+
+void TransactionManager::DropIndexEntry(const IndexWriteRecord &record, Transaction *txn) {
+  TableInfo *table_info = record.catalog_->GetTable(record.table_oid_);
+  IndexInfo *index_info = record.catalog_->GetIndex(record.index_oid_);
+  auto key =
+      record.tuple_.KeyFromTuple(table_info->schema_, index_info->key_schema_, index_info->index_->GetKeyAttrs());
+  // An insert may have replaced the entry already.
+  std::vector<RID> result;
+  index_info->index_->ScanKey(key, &result, txn);
+  if (std::find(result.begin(), result.end(), record.rid_) != result.end()) {
+    index_info->index_->DeleteEntry(index_info->index_->EntryFromTuple(record.tuple_, table_info->schema_),
+                                    record.rid_, txn);
+  }
+}
+
+void TransactionManager::InsertIndexEntry(Transaction *txn, const TableInfo *table_info, IndexInfo *index_info,
+                                          const Tuple &tuple, const RID &rid, Catalog *catalog) {
+  auto *index = index_info->index_.get();
+  auto entry = index->EntryFromTuple(tuple, table_info->schema_);
+  if (index->GetMetadata()->IsUnique()) {
+    std::vector<RID> result;
+    index->ScanKey(tuple.KeyFromTuple(table_info->schema_, index_info->key_schema_, index->GetKeyAttrs()), &result,
+                   txn);
+    Tuple deleted;
+    for (const auto &old_rid : result) {
+      if (!(old_rid == rid) && table_info->table_->GetDeletedTuple(old_rid, &deleted) &&
+          table_info->table_->GetVersionStore()->CheckWrite(old_rid, txn)) {
+        // Abort() puts the entry back.
+        index->DeleteEntry(index->EntryFromTuple(deleted, table_info->schema_), old_rid, txn);
+        txn->AppendIndexWriteRecord(
+            IndexWriteRecord(old_rid, table_info->oid_, WType::DELETE, deleted, index_info->index_oid_, catalog));
+      }
+    }
+  }
+  index->InsertEntry(entry, rid, txn);
+  txn->AppendIndexWriteRecord(
+      IndexWriteRecord(rid, table_info->oid_, WType::INSERT, tuple, index_info->index_oid_, catalog));
+}
+
 void TransactionManager::BlockAllTransactions() { global_txn_latch_.WLock(); }
 
 void TransactionManager::ResumeTransactions() { global_txn_latch_.WUnlock(); }
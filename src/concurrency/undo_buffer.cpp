@@ -0,0 +1,68 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// undo_buffer.cpp
+//
+// Identification: src/concurrency/undo_buffer.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "concurrency/undo_buffer.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace bustub {
+
+auto UndoImage::Diff(UndoBuffer *buffer, const char *old_data, uint32_t old_size, const char *new_data,
+                     uint32_t new_size) -> UndoImage {
+  UndoImage image;
+  image.tuple_size_ = old_size;
+  if (old_size != new_size) {
+    image.data_ = buffer->Append(old_data, old_size);
+    image.size_ = old_size;
+    return image;
+  }
+  uint32_t begin = 0;
+  while (begin < old_size && old_data[begin] == new_data[begin]) {
+    begin++;
+  }
+  uint32_t end = old_size;
+  while (end > begin && old_data[end - 1] == new_data[end - 1]) {
+    end--;
+  }
+  image.offset_ = begin;
+  image.size_ = end - begin;
+  image.data_ = image.size_ == 0 ? nullptr : buffer->Append(old_data + begin, image.size_);
+  return image;
+}
+
+auto UndoBuffer::Append(const char *data, uint32_t size) -> const char * {
+  if (chunks_.empty() || used_ + size > chunks_.back().capacity_) {
+    size_t capacity = std::max<size_t>(UNDO_BUFFER_CHUNK_SIZE, size);
+    chunks_.push_back({std::make_unique<char[]>(capacity), capacity});
+    used_ = 0;
+  }
+  char *copy = chunks_.back().data_.get() + used_;
+  memcpy(copy, data, size);
+  used_ += size;
+  size_ += size;
+  return copy;
+}
+
+void UndoBuffer::Clear() {
+  // A first chunk sized for one large copy is not worth keeping.
+  if (!chunks_.empty() && chunks_.front().capacity_ != UNDO_BUFFER_CHUNK_SIZE) {
+    chunks_.clear();
+  }
+  if (chunks_.size() > 1) {
+    chunks_.erase(chunks_.begin() + 1, chunks_.end());
+  }
+  used_ = 0;
+  size_ = 0;
+}
+
+}  // namespace bustub
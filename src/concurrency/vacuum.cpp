@@ -0,0 +1,110 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// vacuum.cpp
+//
+// Identification: src/concurrency/vacuum.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "concurrency/vacuum.h"
+
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+
+#include "storage/table/table_heap.h"
+
+namespace bustub {
+
+void Vacuum::StartVacuumThread() {
+  if (vacuum_thread_ != nullptr) {
+    return;
+  }
+  enable_vacuum_ = true;
+  vacuum_thread_ = new std::thread([this] {
+    std::unique_lock<std::mutex> lock(thread_latch_);
+    while (!thread_cv_.wait_for(lock, vacuum_interval, [this] { return !enable_vacuum_; })) {
+      lock.unlock();
+      RunOnce();
+      lock.lock();
+    }
+  });
+}
+
+void Vacuum::StopVacuumThread() {
+  {
+    // Wake the thread up instead of letting it sleep out the interval.
+    std::scoped_lock<std::mutex> lock(thread_latch_);
+    enable_vacuum_ = false;
+  }
+  thread_cv_.notify_all();
+  if (vacuum_thread_ != nullptr) {
+    vacuum_thread_->join();
+    delete vacuum_thread_;
+    vacuum_thread_ = nullptr;
+  }
+}
+
+auto Vacuum::RunOnce() -> VacuumStats {
+  std::scoped_lock<std::mutex> pass_lock(pass_latch_);
+  std::shared_lock<std::shared_mutex> catalog_lock;
+  if (catalog_lock_ != nullptr) {
+    catalog_lock = std::shared_lock<std::shared_mutex>(*catalog_lock_);
+  }
+
+  std::unordered_map<TableHeap *, TableInfo *> tables;
+  for (const auto &name : catalog_->GetTableNames()) {
+    auto *table_info = catalog_->GetTable(name);
+    // Mock tables have no heap to vacuum.
+    if (table_info->table_ != nullptr) {
+      tables[table_info->table_.get()] = table_info;
+    }
+  }
+
+  VacuumStats stats;
+  // Drop the index entries of the deferred deletes, then free their slots. The entries go first, so that no index
+  // leads to a slot an insert may already reuse.
+  for (const auto &[table, rid] : txn_manager_->TakeDeferredDeletes()) {
+    Tuple tuple;
+    auto table_info = tables.find(table);
+    if (table_info != tables.end() && table->GetDeletedTuple(rid, &tuple)) {
+      for (auto *index_info : catalog_->GetTableIndexes(table_info->second->name_)) {
+        auto key = tuple.KeyFromTuple(table_info->second->schema_, index_info->key_schema_,
+                                      index_info->index_->GetKeyAttrs());
+        std::vector<RID> result;
+        index_info->index_->ScanKey(key, &result, nullptr);
+        if (std::find(result.begin(), result.end(), rid) != result.end()) {
+          index_info->index_->DeleteEntry(index_info->index_->EntryFromTuple(tuple, table_info->second->schema_),
+                                          rid, nullptr);
+          stats.removed_index_entries_++;
+        }
+      }
+    }
+    size_t reclaimed = table->Reclaim(rid, &tuple);
+    if (reclaimed == 0) {
+      continue;
+    }
+    stats.reclaimed_slots_++;
+    stats.reclaimed_bytes_ += reclaimed;
+  }
+
+  // Drop the versions below the watermark and trim the slot arrays.
+  timestamp_t watermark = txn_manager_->GetWatermark();
+  for (const auto &[table, table_info] : tables) {
+    stats.reclaimed_bytes_ += table->Compact(watermark);
+  }
+
+  if (stats.reclaimed_slots_ != 0 || stats.reclaimed_bytes_ != 0) {
+    LOG_DEBUG("vacuum reclaimed %zu slots, %zu index entries, %zu bytes", stats.reclaimed_slots_,
+              stats.removed_index_entries_, stats.reclaimed_bytes_);
+  }
+  std::scoped_lock<std::mutex> stats_lock(stats_latch_);
+  total_stats_ += stats;
+  return stats;
+}
+
+}  // namespace bustub
@@ -0,0 +1,803 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// adaptive_radix_tree.cpp
+//
+// Identification: src/container/art/adaptive_radix_tree.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "container/art/adaptive_radix_tree.h"
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <thread>  // NOLINT
+
+#include "common/exception.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+enum class ARTNodeType : uint8_t { LEAF, NODE4, NODE16, NODE48, NODE256 };
+
+struct ARTNode {
+  explicit ARTNode(ARTNodeType type) : type_(type) {}
+  const ARTNodeType type_;
+};
+
+/** A leaf is never changed once it is in the tree, a writer replaces it instead */
+struct ARTLeaf : public ARTNode {
+  ARTLeaf() : ARTNode(ARTNodeType::LEAF) {}
+  std::array<uint8_t, ART_MAX_KEY_SIZE> key_;
+  std::vector<RID> rids_;
+};
+
+/**
+ * The header of the inner nodes. The version counts the changes of the node in its upper bits; the lowest bit marks
+ * a node that was unlinked from the tree, the one above it a node a writer holds.
+ */
+struct ARTInnerNode : public ARTNode {
+  static constexpr uint64_t OBSOLETE = 1;
+  static constexpr uint64_t LOCKED = 2;
+
+  using ARTNode::ARTNode;
+
+  /** Note the version to read the node optimistically, waiting for a writer to finish. @return false if obsolete */
+  auto ReadLock(uint64_t *version) const -> bool {
+    *version = version_.load();
+    while ((*version & LOCKED) != 0) {
+      std::this_thread::yield();
+      *version = version_.load();
+    }
+    return (*version & OBSOLETE) == 0;
+  }
+
+  /** @return whether nothing changed the node since its version was noted */
+  auto Validate(uint64_t version) const -> bool { return version_.load() == version; }
+
+  /** Lock the node if nothing changed it since its version was noted */
+  auto Upgrade(uint64_t version) -> bool { return version_.compare_exchange_strong(version, version + LOCKED); }
+
+  /** Lock the node unless it is obsolete */
+  auto WriteLock() -> bool {
+    uint64_t version;
+    return ReadLock(&version) && Upgrade(version);
+  }
+
+  void WriteUnlock() { version_.fetch_add(LOCKED); }
+
+  /** Unlock a node that was unlinked from the tree, for good */
+  void WriteUnlockObsolete() { version_.fetch_add(LOCKED + OBSOLETE); }
+
+  std::atomic<uint64_t> version_{0};
+  uint16_t count_{0};
+  /** The key bytes all keys below the node share, starting at the node's depth */
+  uint8_t prefix_len_{0};
+  std::array<uint8_t, ART_MAX_KEY_SIZE> prefix_;
+};
+
+/** Up to 4 children, with their key bytes sorted */
+struct ARTNode4 : public ARTInnerNode {
+  static constexpr uint16_t CAPACITY = 4;
+  ARTNode4() : ARTInnerNode(ARTNodeType::NODE4) {}
+  std::array<uint8_t, CAPACITY> keys_;
+  std::array<std::atomic<ARTNode *>, CAPACITY> children_{};
+};
+
+/** Up to 16 children, with their key bytes sorted */
+struct ARTNode16 : public ARTInnerNode {
+  static constexpr uint16_t CAPACITY = 16;
+  ARTNode16() : ARTInnerNode(ARTNodeType::NODE16) {}
+  std::array<uint8_t, CAPACITY> keys_;
+  std::array<std::atomic<ARTNode *>, CAPACITY> children_{};
+};
+
+/** Up to 48 children, a key byte indexes the slot of its child */
+struct ARTNode48 : public ARTInnerNode {
+  static constexpr uint16_t CAPACITY = 48;
+  static constexpr uint8_t EMPTY = 0xFF;
+  ARTNode48() : ARTInnerNode(ARTNodeType::NODE48) { child_index_.fill(EMPTY); }
+  std::array<uint8_t, 256> child_index_;
+  std::array<std::atomic<ARTNode *>, CAPACITY> children_{};
+};
+
+/** A child for every key byte */
+struct ARTNode256 : public ARTInnerNode {
+  static constexpr uint16_t CAPACITY = 256;
+  ARTNode256() : ARTInnerNode(ARTNodeType::NODE256) {}
+  std::array<std::atomic<ARTNode *>, CAPACITY> children_{};
+};
+
+/*****************************************************************************
+ * NODE OPERATIONS
+ * The lookups may run on a node a writer is changing, their callers validate the node's version before they use
+ * what they found. The changes require the node to be locked, or not yet in the tree.
+ *****************************************************************************/
+
+static auto NewInnerNode(ARTNodeType type) -> ARTInnerNode * {
+  switch (type) {
+    case ARTNodeType::NODE4:
+      return new ARTNode4();
+    case ARTNodeType::NODE16:
+      return new ARTNode16();
+    case ARTNodeType::NODE48:
+      return new ARTNode48();
+    case ARTNodeType::NODE256:
+      return new ARTNode256();
+    default:
+      UNREACHABLE("a leaf is not an inner node");
+  }
+}
+
+static void DeleteNode(ARTNode *node) {
+  switch (node->type_) {
+    case ARTNodeType::LEAF:
+      delete static_cast<ARTLeaf *>(node);
+      break;
+    case ARTNodeType::NODE4:
+      delete static_cast<ARTNode4 *>(node);
+      break;
+    case ARTNodeType::NODE16:
+      delete static_cast<ARTNode16 *>(node);
+      break;
+    case ARTNodeType::NODE48:
+      delete static_cast<ARTNode48 *>(node);
+      break;
+    case ARTNodeType::NODE256:
+      delete static_cast<ARTNode256 *>(node);
+      break;
+  }
+}
+
+template <typename SortedNode>
+static auto FindSortedChild(const SortedNode *node, uint8_t byte) -> ARTNode * {
+  uint16_t count = std::min(node->count_, SortedNode::CAPACITY);
+  for (uint16_t i = 0; i < count; i++) {
+    if (node->keys_[i] == byte) {
+      return node->children_[i].load(std::memory_order_acquire);
+    }
+  }
+  return nullptr;
+}
+
+static auto FindChild(const ARTInnerNode *node, uint8_t byte) -> ARTNode * {
+  switch (node->type_) {
+    case ARTNodeType::NODE4:
+      return FindSortedChild(static_cast<const ARTNode4 *>(node), byte);
+    case ARTNodeType::NODE16:
+      return FindSortedChild(static_cast<const ARTNode16 *>(node), byte);
+    case ARTNodeType::NODE48: {
+      const auto *node48 = static_cast<const ARTNode48 *>(node);
+      uint8_t slot = node48->child_index_[byte];
+      return slot < ARTNode48::CAPACITY ? node48->children_[slot].load(std::memory_order_acquire) : nullptr;
+    }
+    case ARTNodeType::NODE256:
+      return static_cast<const ARTNode256 *>(node)->children_[byte].load(std::memory_order_acquire);
+    default:
+      UNREACHABLE("a leaf has no children");
+  }
+}
+
+/** Call fn(byte, child) for every child, in key order */
+static void ForEachChild(const ARTInnerNode *node, const std::function<void(uint8_t, ARTNode *)> &fn) {
+  switch (node->type_) {
+    case ARTNodeType::NODE4: {
+      const auto *node4 = static_cast<const ARTNode4 *>(node);
+      for (uint16_t i = 0; i < node4->count_; i++) {
+        fn(node4->keys_[i], node4->children_[i].load());
+      }
+      break;
+    }
+    case ARTNodeType::NODE16: {
+      const auto *node16 = static_cast<const ARTNode16 *>(node);
+      for (uint16_t i = 0; i < node16->count_; i++) {
+        fn(node16->keys_[i], node16->children_[i].load());
+      }
+      break;
+    }
+    case ARTNodeType::NODE48: {
+      const auto *node48 = static_cast<const ARTNode48 *>(node);
+      for (uint16_t byte = 0; byte < 256; byte++) {
+        if (node48->child_index_[byte] != ARTNode48::EMPTY) {
+          fn(static_cast<uint8_t>(byte), node48->children_[node48->child_index_[byte]].load());
+        }
+      }
+      break;
+    }
+    case ARTNodeType::NODE256: {
+      const auto *node256 = static_cast<const ARTNode256 *>(node);
+      for (uint16_t byte = 0; byte < 256; byte++) {
+        if (auto *child = node256->children_[byte].load(); child != nullptr) {
+          fn(static_cast<uint8_t>(byte), child);
+        }
+      }
+      break;
+    }
+    default:
+      UNREACHABLE("a leaf has no children");
+  }
+}
+
+template <typename SortedNode>
+static void AddSortedChild(SortedNode *node, uint8_t byte, ARTNode *child) {
+  uint16_t pos = 0;
+  while (pos < node->count_ && node->keys_[pos] < byte) {
+    pos++;
+  }
+  for (uint16_t i = node->count_; i > pos; i--) {
+    node->keys_[i] = node->keys_[i - 1];
+    node->children_[i].store(node->children_[i - 1].load(), std::memory_order_release);
+  }
+  node->keys_[pos] = byte;
+  node->children_[pos].store(child, std::memory_order_release);
+  node->count_++;
+}
+
+/** Add a child for a byte the node has none for, the node must not be full */
+static void AddChild(ARTInnerNode *node, uint8_t byte, ARTNode *child) {
+  switch (node->type_) {
+    case ARTNodeType::NODE4:
+      AddSortedChild(static_cast<ARTNode4 *>(node), byte, child);
+      break;
+    case ARTNodeType::NODE16:
+      AddSortedChild(static_cast<ARTNode16 *>(node), byte, child);
+      break;
+    case ARTNodeType::NODE48: {
+      auto *node48 = static_cast<ARTNode48 *>(node);
+      uint8_t slot = 0;
+      while (node48->children_[slot].load() != nullptr) {
+        slot++;
+      }
+      node48->children_[slot].store(child, std::memory_order_release);
+      node48->child_index_[byte] = slot;
+      node48->count_++;
+      break;
+    }
+    case ARTNodeType::NODE256:
+      static_cast<ARTNode256 *>(node)->children_[byte].store(child, std::memory_order_release);
+      node->count_++;
+      break;
+    default:
+      UNREACHABLE("a leaf has no children");
+  }
+}
+
+template <typename SortedNode>
+static void ChangeSortedChild(SortedNode *node, uint8_t byte, ARTNode *child) {
+  for (uint16_t i = 0; i < node->count_; i++) {
+    if (node->keys_[i] == byte) {
+      node->children_[i].store(child, std::memory_order_release);
+      return;
+    }
+  }
+  UNREACHABLE("the node has no child for the byte");
+}
+
+/** Replace the child of a byte */
+static void ChangeChild(ARTInnerNode *node, uint8_t byte, ARTNode *child) {
+  switch (node->type_) {
+    case ARTNodeType::NODE4:
+      ChangeSortedChild(static_cast<ARTNode4 *>(node), byte, child);
+      break;
+    case ARTNodeType::NODE16:
+      ChangeSortedChild(static_cast<ARTNode16 *>(node), byte, child);
+      break;
+    case ARTNodeType::NODE48: {
+      auto *node48 = static_cast<ARTNode48 *>(node);
+      node48->children_[node48->child_index_[byte]].store(child, std::memory_order_release);
+      break;
+    }
+    case ARTNodeType::NODE256:
+      static_cast<ARTNode256 *>(node)->children_[byte].store(child, std::memory_order_release);
+      break;
+    default:
+      UNREACHABLE("a leaf has no children");
+  }
+}
+
+template <typename SortedNode>
+static void RemoveSortedChild(SortedNode *node, uint8_t byte) {
+  uint16_t pos = 0;
+  while (node->keys_[pos] != byte) {
+    pos++;
+  }
+  for (uint16_t i = pos; i + 1 < node->count_; i++) {
+    node->keys_[i] = node->keys_[i + 1];
+    node->children_[i].store(node->children_[i + 1].load(), std::memory_order_release);
+  }
+  node->count_--;
+}
+
+/** Remove the child of a byte */
+static void RemoveChild(ARTInnerNode *node, uint8_t byte) {
+  switch (node->type_) {
+    case ARTNodeType::NODE4:
+      RemoveSortedChild(static_cast<ARTNode4 *>(node), byte);
+      break;
+    case ARTNodeType::NODE16:
+      RemoveSortedChild(static_cast<ARTNode16 *>(node), byte);
+      break;
+    case ARTNodeType::NODE48: {
+      auto *node48 = static_cast<ARTNode48 *>(node);
+      node48->children_[node48->child_index_[byte]].store(nullptr);
+      node48->child_index_[byte] = ARTNode48::EMPTY;
+      node48->count_--;
+      break;
+    }
+    case ARTNodeType::NODE256:
+      static_cast<ARTNode256 *>(node)->children_[byte].store(nullptr);
+      node->count_--;
+      break;
+    default:
+      UNREACHABLE("a leaf has no children");
+  }
+}
+
+static auto IsFull(const ARTInnerNode *node) -> bool {
+  switch (node->type_) {
+    case ARTNodeType::NODE4:
+      return node->count_ == ARTNode4::CAPACITY;
+    case ARTNodeType::NODE16:
+      return node->count_ == ARTNode16::CAPACITY;
+    case ARTNodeType::NODE48:
+      return node->count_ == ARTNode48::CAPACITY;
+    default:
+      return false;
+  }
+}
+
+/**
+ * @return whether the node shrinks into the next smaller size when it loses a child. The thresholds stay well below
+ * the size the smaller node grows back at, so that a node does not flip between two sizes.
+ */
+static auto IsUnderfull(const ARTInnerNode *node) -> bool {
+  switch (node->type_) {
+    case ARTNodeType::NODE16:
+      return node->count_ == 3;
+    case ARTNodeType::NODE48:
+      return node->count_ == 12;
+    case ARTNodeType::NODE256:
+      return node->count_ == 37;
+    default:
+      return false;
+  }
+}
+
+/** Copy the prefix and the children of a node, but the child of skip_byte when skip is set, into a new node */
+static auto CopyInnerNode(const ARTInnerNode *node, ARTNodeType type, bool skip = false, uint8_t skip_byte = 0)
+    -> ARTInnerNode * {
+  auto *copy = NewInnerNode(type);
+  copy->prefix_len_ = node->prefix_len_;
+  copy->prefix_ = node->prefix_;
+  ForEachChild(node, [copy, skip, skip_byte](uint8_t byte, ARTNode *child) {
+    if (!skip || byte != skip_byte) {
+      AddChild(copy, byte, child);
+    }
+  });
+  return copy;
+}
+
+/**
+ * @return the position of the first byte of the node's prefix that differs from the key at depth, or len if they
+ * all match
+ */
+static auto PrefixMismatch(const ARTInnerNode *node, const uint8_t *key, size_t depth, size_t len) -> size_t {
+  for (size_t i = 0; i < len; i++) {
+    if (node->prefix_[i] != key[depth + i]) {
+      return i;
+    }
+  }
+  return len;
+}
+
+/*****************************************************************************
+ * EPOCHS
+ *****************************************************************************/
+
+AdaptiveRadixTree::EpochGuard::EpochGuard(AdaptiveRadixTree *tree) {
+  static thread_local const size_t THREAD_HASH = std::hash<std::thread::id>{}(std::this_thread::get_id());
+  // Start in the slot of the thread, and take the next free one if another thread holds it.
+  for (size_t i = THREAD_HASH % ART_EPOCH_SLOTS;; i = (i + 1) % ART_EPOCH_SLOTS) {
+    auto &slot = tree->epoch_slots_[i].epoch_;
+    uint64_t idle = 0;
+    if (slot.load(std::memory_order_relaxed) == 0 && slot.compare_exchange_strong(idle, tree->global_epoch_.load())) {
+      slot_ = &slot;
+      return;
+    }
+  }
+}
+
+AdaptiveRadixTree::EpochGuard::~EpochGuard() { slot_->store(0); }
+
+void AdaptiveRadixTree::Retire(ARTNode *node) {
+  std::vector<ARTNode *> reclaimed;
+  {
+    std::scoped_lock latch(retired_latch_);
+    // Any operation that may still read the node started in this epoch or an earlier one.
+    retired_.emplace_back(global_epoch_.load(), node);
+    if (retired_.size() < reclaim_threshold_) {
+      return;
+    }
+    uint64_t oldest = global_epoch_.fetch_add(1) + 1;
+    for (const auto &slot : epoch_slots_) {
+      if (uint64_t epoch = slot.epoch_.load(); epoch != 0) {
+        oldest = std::min(oldest, epoch);
+      }
+    }
+    auto kept = std::partition(retired_.begin(), retired_.end(),
+                               [oldest](const auto &retired) { return retired.first >= oldest; });
+    for (auto it = kept; it != retired_.end(); ++it) {
+      reclaimed.push_back(it->second);
+    }
+    retired_.erase(kept, retired_.end());
+    // Wait for another batch before looking again, even when a long operation keeps the nodes.
+    reclaim_threshold_ = retired_.size() + ART_RECLAIM_BATCH;
+  }
+  for (auto *retired : reclaimed) {
+    DeleteNode(retired);
+  }
+}
+
+/*****************************************************************************
+ * TREE
+ *****************************************************************************/
+
+AdaptiveRadixTree::AdaptiveRadixTree(size_t key_size)
+    : key_size_(key_size), root_(NewInnerNode(ARTNodeType::NODE256)) {
+  if (key_size_ == 0 || key_size_ > ART_MAX_KEY_SIZE) {
+    delete static_cast<ARTNode256 *>(root_);
+    throw Exception(ExceptionType::OUT_OF_RANGE, "adaptive radix tree keys must be 1 to ART_MAX_KEY_SIZE bytes");
+  }
+}
+
+AdaptiveRadixTree::~AdaptiveRadixTree() {
+  FreeSubtree(root_);
+  for (const auto &[epoch, node] : retired_) {
+    DeleteNode(node);
+  }
+}
+
+void AdaptiveRadixTree::FreeSubtree(ARTNode *node) {
+  if (node->type_ != ARTNodeType::LEAF) {
+    ForEachChild(static_cast<ARTInnerNode *>(node), [](uint8_t /*byte*/, ARTNode *child) { FreeSubtree(child); });
+  }
+  DeleteNode(node);
+}
+
+auto AdaptiveRadixTree::MakeLeaf(const uint8_t *key, std::vector<RID> rids) const -> ARTLeaf * {
+  auto *leaf = new ARTLeaf();
+  std::memcpy(leaf->key_.data(), key, key_size_);
+  leaf->rids_ = std::move(rids);
+  return leaf;
+}
+
+auto AdaptiveRadixTree::GetValue(const uint8_t *key, std::vector<RID> *result) -> bool {
+  EpochGuard guard(this);
+  bool found;
+  while (!TryGetValue(key, result, &found)) {
+  }
+  return found;
+}
+
+auto AdaptiveRadixTree::Insert(const uint8_t *key, const RID &rid, bool unique) -> bool {
+  EpochGuard guard(this);
+  bool inserted;
+  while (!TryInsert(key, rid, unique, &inserted)) {
+  }
+  return inserted;
+}
+
+auto AdaptiveRadixTree::Remove(const uint8_t *key, const RID &rid) -> bool {
+  EpochGuard guard(this);
+  bool removed;
+  while (!TryRemove(key, rid, &removed)) {
+  }
+  return removed;
+}
+
+auto AdaptiveRadixTree::TryGetValue(const uint8_t *key, std::vector<RID> *result, bool *found) -> bool {
+  ARTInnerNode *node = root_;
+  uint64_t version;
+  if (!node->ReadLock(&version)) {
+    return false;
+  }
+  size_t depth = 0;
+  while (true) {
+    // A prefix that runs past the key was read while a writer changed it.
+    size_t len = node->prefix_len_;
+    if (depth + len >= key_size_) {
+      return false;
+    }
+    if (PrefixMismatch(node, key, depth, len) < len) {
+      *found = false;
+      return node->Validate(version);
+    }
+    depth += len;
+    ARTNode *child = FindChild(node, key[depth]);
+    if (!node->Validate(version)) {
+      return false;
+    }
+    if (child == nullptr) {
+      *found = false;
+      return true;
+    }
+    if (child->type_ == ARTNodeType::LEAF) {
+      // The leaf was in the tree when the node was validated, and it does not change.
+      const auto *leaf = static_cast<const ARTLeaf *>(child);
+      *found = std::memcmp(leaf->key_.data(), key, key_size_) == 0;
+      if (*found) {
+        result->insert(result->end(), leaf->rids_.begin(), leaf->rids_.end());
+      }
+      return true;
+    }
+    auto *next = static_cast<ARTInnerNode *>(child);
+    uint64_t next_version;
+    if (!next->ReadLock(&next_version) || !node->Validate(version)) {
+      return false;
+    }
+    node = next;
+    version = next_version;
+    depth++;
+  }
+}
+
+auto AdaptiveRadixTree::TryInsert(const uint8_t *key, const RID &rid, bool unique, bool *inserted) -> bool {
+  ARTInnerNode *parent = nullptr;
+  uint64_t parent_version = 0;
+  uint8_t parent_byte = 0;
+  ARTInnerNode *node = root_;
+  uint64_t version;
+  if (!node->ReadLock(&version)) {
+    return false;
+  }
+  size_t depth = 0;
+  while (true) {
+    size_t len = node->prefix_len_;
+    if (depth + len >= key_size_) {
+      return false;
+    }
+    if (size_t mismatch = PrefixMismatch(node, key, depth, len); mismatch < len) {
+      // The key leaves the prefix: a new node takes the shared part of the prefix and branches between the node
+      // and the new leaf. The root has no prefix, so the node has a parent.
+      if (!parent->Upgrade(parent_version)) {
+        return false;
+      }
+      if (!node->Upgrade(version)) {
+        parent->WriteUnlock();
+        return false;
+      }
+      auto *branch = NewInnerNode(ARTNodeType::NODE4);
+      branch->prefix_len_ = mismatch;
+      std::copy_n(node->prefix_.begin(), mismatch, branch->prefix_.begin());
+      AddChild(branch, node->prefix_[mismatch], node);
+      AddChild(branch, key[depth + mismatch], MakeLeaf(key, {rid}));
+      // The node keeps the part of the prefix below the byte the new node branches on.
+      node->prefix_len_ = len - mismatch - 1;
+      std::copy(node->prefix_.begin() + mismatch + 1, node->prefix_.begin() + len, node->prefix_.begin());
+      ChangeChild(parent, parent_byte, branch);
+      node->WriteUnlock();
+      parent->WriteUnlock();
+      *inserted = true;
+      return true;
+    }
+    depth += len;
+    uint8_t byte = key[depth];
+    ARTNode *child = FindChild(node, byte);
+    if (!node->Validate(version)) {
+      return false;
+    }
+
+    if (child == nullptr) {
+      if (!IsFull(node)) {
+        if (!node->Upgrade(version)) {
+          return false;
+        }
+        if (parent != nullptr && !parent->Validate(parent_version)) {
+          node->WriteUnlock();
+          return false;
+        }
+        AddChild(node, byte, MakeLeaf(key, {rid}));
+        node->WriteUnlock();
+        *inserted = true;
+        return true;
+      }
+      // Grow the node into the next size. The root never fills up, so the node has a parent.
+      if (!parent->Upgrade(parent_version)) {
+        return false;
+      }
+      if (!node->Upgrade(version)) {
+        parent->WriteUnlock();
+        return false;
+      }
+      auto type = node->type_ == ARTNodeType::NODE4    ? ARTNodeType::NODE16
+                  : node->type_ == ARTNodeType::NODE16 ? ARTNodeType::NODE48
+                                                       : ARTNodeType::NODE256;
+      auto *grown = CopyInnerNode(node, type);
+      AddChild(grown, byte, MakeLeaf(key, {rid}));
+      ChangeChild(parent, parent_byte, grown);
+      node->WriteUnlockObsolete();
+      parent->WriteUnlock();
+      Retire(node);
+      *inserted = true;
+      return true;
+    }
+    if (parent != nullptr && !parent->Validate(parent_version)) {
+      return false;
+    }
+
+    if (child->type_ == ARTNodeType::LEAF) {
+      if (!node->Upgrade(version)) {
+        return false;
+      }
+      auto *leaf = static_cast<ARTLeaf *>(child);
+      if (std::memcmp(leaf->key_.data(), key, key_size_) == 0) {
+        if (unique || std::find(leaf->rids_.begin(), leaf->rids_.end(), rid) != leaf->rids_.end()) {
+          node->WriteUnlock();
+          *inserted = false;
+          return true;
+        }
+        auto rids = leaf->rids_;
+        rids.push_back(rid);
+        ChangeChild(node, byte, MakeLeaf(key, std::move(rids)));
+        node->WriteUnlock();
+        Retire(leaf);
+        *inserted = true;
+        return true;
+      }
+      // Two keys share the path down to here: a new node takes the bytes they share below it and branches between
+      // them. The keys differ before their end, they are equally long.
+      size_t branch_depth = depth + 1;
+      while (leaf->key_[branch_depth] == key[branch_depth]) {
+        branch_depth++;
+      }
+      auto *branch = NewInnerNode(ARTNodeType::NODE4);
+      branch->prefix_len_ = branch_depth - depth - 1;
+      std::copy(key + depth + 1, key + branch_depth, branch->prefix_.begin());
+      AddChild(branch, leaf->key_[branch_depth], leaf);
+      AddChild(branch, key[branch_depth], MakeLeaf(key, {rid}));
+      ChangeChild(node, byte, branch);
+      node->WriteUnlock();
+      *inserted = true;
+      return true;
+    }
+
+    parent = node;
+    parent_version = version;
+    parent_byte = byte;
+    node = static_cast<ARTInnerNode *>(child);
+    if (!node->ReadLock(&version)) {
+      return false;
+    }
+    depth++;
+  }
+}
+
+auto AdaptiveRadixTree::TryRemove(const uint8_t *key, const RID &rid, bool *removed) -> bool {
+  ARTInnerNode *parent = nullptr;
+  uint64_t parent_version = 0;
+  uint8_t parent_byte = 0;
+  ARTInnerNode *node = root_;
+  uint64_t version;
+  if (!node->ReadLock(&version)) {
+    return false;
+  }
+  size_t depth = 0;
+  while (true) {
+    size_t len = node->prefix_len_;
+    if (depth + len >= key_size_) {
+      return false;
+    }
+    if (PrefixMismatch(node, key, depth, len) < len) {
+      *removed = false;
+      return node->Validate(version);
+    }
+    depth += len;
+    uint8_t byte = key[depth];
+    ARTNode *child = FindChild(node, byte);
+    if (!node->Validate(version)) {
+      return false;
+    }
+    if (child == nullptr) {
+      *removed = false;
+      return true;
+    }
+    if (parent != nullptr && !parent->Validate(parent_version)) {
+      return false;
+    }
+
+    if (child->type_ == ARTNodeType::LEAF) {
+      auto *leaf = static_cast<ARTLeaf *>(child);
+      auto pos = std::find(leaf->rids_.begin(), leaf->rids_.end(), rid);
+      if (std::memcmp(leaf->key_.data(), key, key_size_) != 0 || pos == leaf->rids_.end()) {
+        *removed = false;
+        return true;
+      }
+      *removed = true;
+
+      if (leaf->rids_.size() > 1) {
+        if (!node->Upgrade(version)) {
+          return false;
+        }
+        std::vector<RID> rids(leaf->rids_.begin(), pos);
+        rids.insert(rids.end(), pos + 1, leaf->rids_.end());
+        ChangeChild(node, byte, MakeLeaf(key, std::move(rids)));
+        node->WriteUnlock();
+        Retire(leaf);
+        return true;
+      }
+
+      bool collapse = node != root_ && node->type_ == ARTNodeType::NODE4 && node->count_ == 2;
+      if (!collapse && (node == root_ || !IsUnderfull(node))) {
+        if (!node->Upgrade(version)) {
+          return false;
+        }
+        RemoveChild(node, byte);
+        node->WriteUnlock();
+        Retire(leaf);
+        return true;
+      }
+
+      // The node is replaced in its parent, by its other child or by a smaller node.
+      if (!parent->Upgrade(parent_version)) {
+        return false;
+      }
+      if (!node->Upgrade(version)) {
+        parent->WriteUnlock();
+        return false;
+      }
+      if (collapse) {
+        uint8_t other_byte = 0;
+        ARTNode *other = nullptr;
+        ForEachChild(node, [byte, &other_byte, &other](uint8_t child_byte, ARTNode *node_child) {
+          if (child_byte != byte) {
+            other_byte = child_byte;
+            other = node_child;
+          }
+        });
+        if (other->type_ != ARTNodeType::LEAF) {
+          // The other child takes the node's prefix and the byte it hung off in front of its own.
+          auto *inner = static_cast<ARTInnerNode *>(other);
+          if (!inner->WriteLock()) {
+            node->WriteUnlock();
+            parent->WriteUnlock();
+            return false;
+          }
+          std::copy_backward(inner->prefix_.begin(), inner->prefix_.begin() + inner->prefix_len_,
+                             inner->prefix_.begin() + inner->prefix_len_ + len + 1);
+          std::copy_n(node->prefix_.begin(), len, inner->prefix_.begin());
+          inner->prefix_[len] = other_byte;
+          inner->prefix_len_ += len + 1;
+          ChangeChild(parent, parent_byte, inner);
+          inner->WriteUnlock();
+        } else {
+          ChangeChild(parent, parent_byte, other);
+        }
+      } else {
+        auto type = node->type_ == ARTNodeType::NODE256  ? ARTNodeType::NODE48
+                    : node->type_ == ARTNodeType::NODE48 ? ARTNodeType::NODE16
+                                                         : ARTNodeType::NODE4;
+        ChangeChild(parent, parent_byte, CopyInnerNode(node, type, true, byte));
+      }
+      node->WriteUnlockObsolete();
+      parent->WriteUnlock();
+      Retire(node);
+      Retire(leaf);
+      return true;
+    }
+
+    parent = node;
+    parent_version = version;
+    parent_byte = byte;
+    node = static_cast<ARTInnerNode *>(child);
+    if (!node->ReadLock(&version)) {
+      return false;
+    }
+    depth++;
+  }
+}
+
+}  // namespace bustub
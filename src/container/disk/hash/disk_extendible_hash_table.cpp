@@ -10,6 +10,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <iostream>
 #include <string>
 #include <utility>
@@ -22,11 +23,26 @@
 
 namespace bustub {
 
-template <typename KeyType, typename ValueType, typename KeyComparator>
+template <typename KeyType, typename ValueType, typename KeyComparator, typename BucketPage>
 HASH_TABLE_TYPE::DiskExtendibleHashTable(const std::string &name, BufferPoolManager *buffer_pool_manager,
                                          const KeyComparator &comparator, HashFunction<KeyType> hash_fn)
     : buffer_pool_manager_(buffer_pool_manager), comparator_(comparator), hash_fn_(std::move(hash_fn)) {
-  //  implement me!
+  // The table starts with a directory of global depth 0 that points to one empty bucket.
+  Page *dir_raw = buffer_pool_manager_->NewPage(&directory_page_id_);
+  if (dir_raw == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot allocate the directory page of the hash table");
+  }
+  auto *dir_page = AsDirectory(dir_raw);
+  dir_page->SetPageId(directory_page_id_);
+  page_id_t bucket_page_id;
+  if (buffer_pool_manager_->NewPage(&bucket_page_id) == nullptr) {
+    buffer_pool_manager_->UnpinPage(directory_page_id_, true);
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot allocate the first bucket page of the hash table");
+  }
+  dir_page->SetBucketPageId(0, bucket_page_id);
+  dir_page->SetLocalDepth(0, 0);
+  buffer_pool_manager_->UnpinPage(bucket_page_id, true);
+  buffer_pool_manager_->UnpinPage(directory_page_id_, true);
 }
 
 /*****************************************************************************
@@ -39,89 +55,233 @@ HASH_TABLE_TYPE::DiskExtendibleHashTable(const std::string &name, BufferPoolMana
  * @param key the key to hash
  * @return the downcasted 32-bit hash
  */
-template <typename KeyType, typename ValueType, typename KeyComparator>
+template <typename KeyType, typename ValueType, typename KeyComparator, typename BucketPage>
 auto HASH_TABLE_TYPE::Hash(KeyType key) -> uint32_t {
   return static_cast<uint32_t>(hash_fn_.GetHash(key));
 }
 
-template <typename KeyType, typename ValueType, typename KeyComparator>
+template <typename KeyType, typename ValueType, typename KeyComparator, typename BucketPage>
 inline auto HASH_TABLE_TYPE::KeyToDirectoryIndex(KeyType key, HashTableDirectoryPage *dir_page) -> uint32_t {
-  return 0;
+  return Hash(key) & dir_page->GetGlobalDepthMask();
 }
 
-template <typename KeyType, typename ValueType, typename KeyComparator>
+template <typename KeyType, typename ValueType, typename KeyComparator, typename BucketPage>
 inline auto HASH_TABLE_TYPE::KeyToPageId(KeyType key, HashTableDirectoryPage *dir_page) -> page_id_t {
-  return 0;
+  return dir_page->GetBucketPageId(KeyToDirectoryIndex(key, dir_page));
 }
 
-template <typename KeyType, typename ValueType, typename KeyComparator>
-auto HASH_TABLE_TYPE::FetchDirectoryPage() -> HashTableDirectoryPage * {
-  return nullptr;
+template <typename KeyType, typename ValueType, typename KeyComparator, typename BucketPage>
+auto HASH_TABLE_TYPE::FetchDirectoryPage() -> Page * {
+  return buffer_pool_manager_->FetchPage(directory_page_id_);
 }
 
-template <typename KeyType, typename ValueType, typename KeyComparator>
-auto HASH_TABLE_TYPE::FetchBucketPage(page_id_t bucket_page_id) -> HASH_TABLE_BUCKET_TYPE * {
-  return nullptr;
+template <typename KeyType, typename ValueType, typename KeyComparator, typename BucketPage>
+auto HASH_TABLE_TYPE::FetchBucketPage(page_id_t bucket_page_id) -> Page * {
+  return buffer_pool_manager_->FetchPage(bucket_page_id);
 }
 
 /*****************************************************************************
  * SEARCH
  *****************************************************************************/
-template <typename KeyType, typename ValueType, typename KeyComparator>
+template <typename KeyType, typename ValueType, typename KeyComparator, typename BucketPage>
 auto HASH_TABLE_TYPE::GetValue(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result) -> bool {
-  return false;
+  Page *dir_raw = FetchDirectoryPage();
+  dir_raw->RLatch();
+  page_id_t bucket_page_id = KeyToPageId(key, AsDirectory(dir_raw));
+  Page *bucket_raw = FetchBucketPage(bucket_page_id);
+  bucket_raw->RLatch();
+  bool found = AsBucket(bucket_raw)->GetValue(key, comparator_, result);
+  bucket_raw->RUnlatch();
+  buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+  dir_raw->RUnlatch();
+  buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+  return found;
 }
 
 /*****************************************************************************
  * INSERTION
  *****************************************************************************/
-template <typename KeyType, typename ValueType, typename KeyComparator>
+template <typename KeyType, typename ValueType, typename KeyComparator, typename BucketPage>
 auto HASH_TABLE_TYPE::Insert(Transaction *transaction, const KeyType &key, const ValueType &value) -> bool {
-  return false;
+  Page *dir_raw = FetchDirectoryPage();
+  dir_raw->RLatch();
+  page_id_t bucket_page_id = KeyToPageId(key, AsDirectory(dir_raw));
+  Page *bucket_raw = FetchBucketPage(bucket_page_id);
+  bucket_raw->WLatch();
+  auto *bucket_page = AsBucket(bucket_raw);
+  bool inserted = bucket_page->Insert(key, value, comparator_);
+  bool full = !inserted && bucket_page->IsFull();
+  bucket_raw->WUnlatch();
+  buffer_pool_manager_->UnpinPage(bucket_page_id, inserted);
+  dir_raw->RUnlatch();
+  buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+
+  if (full) {
+    return SplitInsert(transaction, key, value);
+  }
+  return inserted;
 }
 
-template <typename KeyType, typename ValueType, typename KeyComparator>
+template <typename KeyType, typename ValueType, typename KeyComparator, typename BucketPage>
 auto HASH_TABLE_TYPE::SplitInsert(Transaction *transaction, const KeyType &key, const ValueType &value) -> bool {
-  return false;
+  Page *dir_raw = FetchDirectoryPage();
+  dir_raw->WLatch();
+  auto *dir_page = AsDirectory(dir_raw);
+  bool dir_dirty = false;
+  bool inserted = false;
+  // Another split may have made room since the bucket was found full, and the pairs may all stay in one half of a
+  // split, so look the bucket up again every round.
+  while (true) {
+    uint32_t bucket_idx = KeyToDirectoryIndex(key, dir_page);
+    page_id_t bucket_page_id = dir_page->GetBucketPageId(bucket_idx);
+    Page *bucket_raw = FetchBucketPage(bucket_page_id);
+    auto *bucket_page = AsBucket(bucket_raw);
+    if (!bucket_page->IsFull()) {
+      inserted = bucket_page->Insert(key, value, comparator_);
+      buffer_pool_manager_->UnpinPage(bucket_page_id, inserted);
+      break;
+    }
+
+    std::vector<ValueType> values;
+    bucket_page->GetValue(key, comparator_, &values);
+    uint32_t local_depth = dir_page->GetLocalDepth(bucket_idx);
+    bool duplicate = std::find(values.begin(), values.end(), value) != values.end();
+    bool dir_full = local_depth == dir_page->GetGlobalDepth() && 2 * dir_page->Size() > DIRECTORY_ARRAY_SIZE;
+    page_id_t image_page_id = INVALID_PAGE_ID;
+    Page *image_raw = duplicate || dir_full ? nullptr : buffer_pool_manager_->NewPage(&image_page_id);
+    if (image_raw == nullptr) {
+      buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+      break;
+    }
+    auto *image_page = AsBucket(image_raw);
+
+    if (local_depth == dir_page->GetGlobalDepth()) {
+      dir_page->IncrGlobalDepth();
+    }
+    // Every directory entry of the bucket gets one bit deeper, the ones with that bit set point to the image.
+    uint32_t high_bit = 1U << local_depth;
+    for (uint32_t i = 0; i < dir_page->Size(); i++) {
+      if (dir_page->GetBucketPageId(i) == bucket_page_id) {
+        dir_page->IncrLocalDepth(i);
+        if ((i & high_bit) != 0) {
+          dir_page->SetBucketPageId(i, image_page_id);
+        }
+      }
+    }
+    dir_dirty = true;
+    for (uint32_t slot = 0; slot < BucketPage::ARRAY_SIZE; slot++) {
+      if (bucket_page->IsReadable(slot) && (Hash(bucket_page->KeyAt(slot)) & high_bit) != 0) {
+        image_page->Insert(bucket_page->KeyAt(slot), bucket_page->ValueAt(slot), comparator_);
+        bucket_page->RemoveAt(slot);
+      }
+    }
+    buffer_pool_manager_->UnpinPage(image_page_id, true);
+    buffer_pool_manager_->UnpinPage(bucket_page_id, true);
+  }
+  dir_raw->WUnlatch();
+  buffer_pool_manager_->UnpinPage(directory_page_id_, dir_dirty);
+  return inserted;
 }
 
 /*****************************************************************************
  * REMOVE
  *****************************************************************************/
-template <typename KeyType, typename ValueType, typename KeyComparator>
+template <typename KeyType, typename ValueType, typename KeyComparator, typename BucketPage>
 auto HASH_TABLE_TYPE::Remove(Transaction *transaction, const KeyType &key, const ValueType &value) -> bool {
-  return false;
+  Page *dir_raw = FetchDirectoryPage();
+  dir_raw->RLatch();
+  page_id_t bucket_page_id = KeyToPageId(key, AsDirectory(dir_raw));
+  Page *bucket_raw = FetchBucketPage(bucket_page_id);
+  bucket_raw->WLatch();
+  auto *bucket_page = AsBucket(bucket_raw);
+  bool removed = bucket_page->Remove(key, value, comparator_);
+  bool empty = removed && bucket_page->IsEmpty();
+  bucket_raw->WUnlatch();
+  buffer_pool_manager_->UnpinPage(bucket_page_id, removed);
+  dir_raw->RUnlatch();
+  buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+
+  if (empty) {
+    Merge(transaction, key, value);
+  }
+  return removed;
 }
 
 /*****************************************************************************
  * MERGE
  *****************************************************************************/
-template <typename KeyType, typename ValueType, typename KeyComparator>
-void HASH_TABLE_TYPE::Merge(Transaction *transaction, const KeyType &key, const ValueType &value) {}
+template <typename KeyType, typename ValueType, typename KeyComparator, typename BucketPage>
+void HASH_TABLE_TYPE::Merge(Transaction *transaction, const KeyType &key, const ValueType &value) {
+  Page *dir_raw = FetchDirectoryPage();
+  dir_raw->WLatch();
+  auto *dir_page = AsDirectory(dir_raw);
+  bool dir_dirty = false;
+
+  // Merging the bucket may leave it with an empty split image of its new depth, an image that could not merge
+  // before because the bucket was split deeper than it, so keep merging from the same directory index.
+  uint32_t bucket_idx = KeyToDirectoryIndex(key, dir_page);
+  while (dir_page->GetLocalDepth(bucket_idx) > 0) {
+    uint32_t local_depth = dir_page->GetLocalDepth(bucket_idx);
+    uint32_t image_idx = dir_page->GetSplitImageIndex(bucket_idx);
+    if (dir_page->GetLocalDepth(image_idx) != local_depth) {
+      break;
+    }
+    page_id_t bucket_page_id = dir_page->GetBucketPageId(bucket_idx);
+    page_id_t image_page_id = dir_page->GetBucketPageId(image_idx);
+    // An insert may have refilled the bucket since it was found empty.
+    Page *bucket_raw = FetchBucketPage(bucket_page_id);
+    bool bucket_empty = AsBucket(bucket_raw)->IsEmpty();
+    buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+    Page *image_raw = FetchBucketPage(image_page_id);
+    bool image_empty = AsBucket(image_raw)->IsEmpty();
+    buffer_pool_manager_->UnpinPage(image_page_id, false);
+    if (!bucket_empty && !image_empty) {
+      break;
+    }
+
+    page_id_t kept_page_id = bucket_empty ? image_page_id : bucket_page_id;
+    page_id_t dropped_page_id = bucket_empty ? bucket_page_id : image_page_id;
+    for (uint32_t i = 0; i < dir_page->Size(); i++) {
+      page_id_t page_id = dir_page->GetBucketPageId(i);
+      if (page_id == bucket_page_id || page_id == image_page_id) {
+        dir_page->SetBucketPageId(i, kept_page_id);
+        dir_page->DecrLocalDepth(i);
+      }
+    }
+    buffer_pool_manager_->DeletePage(dropped_page_id);
+    dir_dirty = true;
+  }
+  while (dir_page->CanShrink()) {
+    dir_page->DecrGlobalDepth();
+    dir_dirty = true;
+  }
+  dir_raw->WUnlatch();
+  buffer_pool_manager_->UnpinPage(directory_page_id_, dir_dirty);
+}
 
 /*****************************************************************************
  * GETGLOBALDEPTH - DO NOT TOUCH
  *****************************************************************************/
-template <typename KeyType, typename ValueType, typename KeyComparator>
+template <typename KeyType, typename ValueType, typename KeyComparator, typename BucketPage>
 auto HASH_TABLE_TYPE::GetGlobalDepth() -> uint32_t {
-  table_latch_.RLock();
-  HashTableDirectoryPage *dir_page = FetchDirectoryPage();
-  uint32_t global_depth = dir_page->GetGlobalDepth();
+  Page *dir_raw = FetchDirectoryPage();
+  dir_raw->RLatch();
+  uint32_t global_depth = AsDirectory(dir_raw)->GetGlobalDepth();
+  dir_raw->RUnlatch();
   assert(buffer_pool_manager_->UnpinPage(directory_page_id_, false, nullptr));
-  table_latch_.RUnlock();
   return global_depth;
 }
 
 /*****************************************************************************
  * VERIFY INTEGRITY - DO NOT TOUCH
  *****************************************************************************/
-template <typename KeyType, typename ValueType, typename KeyComparator>
+template <typename KeyType, typename ValueType, typename KeyComparator, typename BucketPage>
 void HASH_TABLE_TYPE::VerifyIntegrity() {
-  table_latch_.RLock();
-  HashTableDirectoryPage *dir_page = FetchDirectoryPage();
-  dir_page->VerifyIntegrity();
+  Page *dir_raw = FetchDirectoryPage();
+  dir_raw->RLatch();
+  AsDirectory(dir_raw)->VerifyIntegrity();
+  dir_raw->RUnlatch();
   assert(buffer_pool_manager_->UnpinPage(directory_page_id_, false, nullptr));
-  table_latch_.RUnlock();
 }
 
 /*****************************************************************************
@@ -135,4 +295,17 @@ template class DiskExtendibleHashTable<GenericKey<16>, RID, GenericComparator<16
 template class DiskExtendibleHashTable<GenericKey<32>, RID, GenericComparator<32>>;
 template class DiskExtendibleHashTable<GenericKey<64>, RID, GenericComparator<64>>;
 
+template class DiskExtendibleHashTable<int, int, IntComparator,
+                                       HashTableFingerprintBucketPage<int, int, IntComparator>>;
+template class DiskExtendibleHashTable<GenericKey<4>, RID, GenericComparator<4>,
+                                       HashTableFingerprintBucketPage<GenericKey<4>, RID, GenericComparator<4>>>;
+template class DiskExtendibleHashTable<GenericKey<8>, RID, GenericComparator<8>,
+                                       HashTableFingerprintBucketPage<GenericKey<8>, RID, GenericComparator<8>>>;
+template class DiskExtendibleHashTable<GenericKey<16>, RID, GenericComparator<16>,
+                                       HashTableFingerprintBucketPage<GenericKey<16>, RID, GenericComparator<16>>>;
+template class DiskExtendibleHashTable<GenericKey<32>, RID, GenericComparator<32>,
+                                       HashTableFingerprintBucketPage<GenericKey<32>, RID, GenericComparator<32>>>;
+template class DiskExtendibleHashTable<GenericKey<64>, RID, GenericComparator<64>,
+                                       HashTableFingerprintBucketPage<GenericKey<64>, RID, GenericComparator<64>>>;
+
 }  // namespace bustub
@@ -0,0 +1,205 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// concurrent_extendible_hash_table.cpp
+//
+// Identification: src/container/hash/concurrent_extendible_hash_table.cpp
+//
+// Copyright (c) 2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <functional>
+#include <list>
+#include <string>
+#include <utility>
+
+#include "container/hash/concurrent_extendible_hash_table.h"
+#include "storage/page/page.h"
+
+namespace bustub {
+
+template <typename K, typename V>
+ConcurrentExtendibleHashTable<K, V>::ConcurrentExtendibleHashTable(size_t bucket_size)
+    : global_depth_(1), bucket_size_(bucket_size), num_buckets_(2) {
+  dir_.push_back(std::make_shared<Bucket>(bucket_size_, 1));
+  dir_.push_back(std::make_shared<Bucket>(bucket_size_, 1));
+}
+
+template <typename K, typename V>
+auto ConcurrentExtendibleHashTable<K, V>::GetGlobalDepth() const -> int {
+  std::shared_lock dir_latch(dir_latch_);
+  return global_depth_;
+}
+
+template <typename K, typename V>
+auto ConcurrentExtendibleHashTable<K, V>::GetLocalDepth(int dir_index) const -> int {
+  std::shared_lock dir_latch(dir_latch_);
+  return dir_[dir_index]->GetDepth();
+}
+
+template <typename K, typename V>
+auto ConcurrentExtendibleHashTable<K, V>::GetNumBuckets() const -> int {
+  std::shared_lock dir_latch(dir_latch_);
+  return num_buckets_;
+}
+
+template <typename K, typename V>
+auto ConcurrentExtendibleHashTable<K, V>::Find(const K &key, V &value) -> bool {
+  size_t hash = std::hash<K>()(key);
+  std::shared_lock dir_latch(dir_latch_);
+  auto *bucket = dir_[IndexOf(hash)].get();
+  std::shared_lock bucket_latch(bucket->latch_);
+  auto *found = bucket->Find(key, hash);
+  if (found == nullptr) {
+    return false;
+  }
+  value = *found;
+  return true;
+}
+
+template <typename K, typename V>
+auto ConcurrentExtendibleHashTable<K, V>::Remove(const K &key) -> bool {
+  size_t hash = std::hash<K>()(key);
+  std::shared_lock dir_latch(dir_latch_);
+  auto *bucket = dir_[IndexOf(hash)].get();
+  std::unique_lock bucket_latch(bucket->latch_);
+  return bucket->Remove(key, hash);
+}
+
+template <typename K, typename V>
+void ConcurrentExtendibleHashTable<K, V>::Insert(const K &key, const V &value) {
+  size_t hash = std::hash<K>()(key);
+  {
+    std::shared_lock dir_latch(dir_latch_);
+    auto *bucket = dir_[IndexOf(hash)].get();
+    std::unique_lock bucket_latch(bucket->latch_);
+    if (bucket->Insert(key, value, hash)) {
+      return;
+    }
+  }
+  // The bucket is full: split it with the directory to ourselves. Another insert may have split it meanwhile.
+  std::unique_lock dir_latch(dir_latch_);
+  while (true) {
+    auto bucket = dir_[IndexOf(hash)];
+    if (bucket->Insert(key, value, hash)) {
+      return;
+    }
+    if (bucket->GetDepth() == global_depth_) {
+      size_t n = dir_.size();
+      dir_.resize(n * 2);
+      for (size_t i = 0; i < n; i++) {
+        dir_[i + n] = dir_[i];
+      }
+      global_depth_++;
+    }
+    // All of the keys may still end up in the same half, then the loop splits again.
+    RedistributeBucket(bucket);
+  }
+}
+
+template <typename K, typename V>
+void ConcurrentExtendibleHashTable<K, V>::RedistributeBucket(const std::shared_ptr<Bucket> &bucket) {
+  // Every directory entry of the bucket whose bit at the old local depth is set moves to the new sibling bucket.
+  size_t mask = size_t{1} << bucket->GetDepth();
+  bucket->IncrementDepth();
+  auto sibling = std::make_shared<Bucket>(bucket_size_, bucket->GetDepth());
+  num_buckets_++;
+  for (size_t i = 0; i < dir_.size(); i++) {
+    if (dir_[i] == bucket && (i & mask) != 0) {
+      dir_[i] = sibling;
+    }
+  }
+  bucket->MoveTo(sibling.get(), mask);
+}
+
+//===--------------------------------------------------------------------===//
+// Bucket
+//===--------------------------------------------------------------------===//
+template <typename K, typename V>
+ConcurrentExtendibleHashTable<K, V>::Bucket::Bucket(size_t size, int depth)
+    : size_(size), depth_(depth), slot_bits_(1) {
+  // At least twice as many slots as pairs, a power of two
+  while ((size_t{1} << slot_bits_) < 2 * size_) {
+    slot_bits_++;
+  }
+  slots_.resize(size_t{1} << slot_bits_);
+}
+
+template <typename K, typename V>
+auto ConcurrentExtendibleHashTable<K, V>::Bucket::Find(const K &key, size_t hash) -> V * {
+  size_t mask = slots_.size() - 1;
+  for (size_t i = Home(hash); slots_[i].used_; i = (i + 1) & mask) {
+    if (slots_[i].hash_ == hash && slots_[i].key_ == key) {
+      return &slots_[i].value_;
+    }
+  }
+  return nullptr;
+}
+
+template <typename K, typename V>
+auto ConcurrentExtendibleHashTable<K, V>::Bucket::Insert(const K &key, const V &value, size_t hash) -> bool {
+  size_t mask = slots_.size() - 1;
+  size_t i = Home(hash);
+  for (; slots_[i].used_; i = (i + 1) & mask) {
+    if (slots_[i].hash_ == hash && slots_[i].key_ == key) {
+      slots_[i].value_ = value;
+      return true;
+    }
+  }
+  if (IsFull()) {
+    return false;
+  }
+  slots_[i] = Slot{true, hash, key, value};
+  count_++;
+  return true;
+}
+
+template <typename K, typename V>
+auto ConcurrentExtendibleHashTable<K, V>::Bucket::Remove(const K &key, size_t hash) -> bool {
+  size_t mask = slots_.size() - 1;
+  size_t hole = Home(hash);
+  while (slots_[hole].used_ && (slots_[hole].hash_ != hash || !(slots_[hole].key_ == key))) {
+    hole = (hole + 1) & mask;
+  }
+  if (!slots_[hole].used_) {
+    return false;
+  }
+  slots_[hole] = Slot{};
+  count_--;
+  // Move back every pair behind the hole that a lookup could not reach past it anymore, the ones whose home is not
+  // between the hole and themselves.
+  for (size_t i = (hole + 1) & mask; slots_[i].used_; i = (i + 1) & mask) {
+    size_t home = Home(slots_[i].hash_);
+    bool reachable = hole <= i ? (hole < home && home <= i) : (hole < home || home <= i);
+    if (!reachable) {
+      slots_[hole] = std::move(slots_[i]);
+      slots_[i] = Slot{};
+      hole = i;
+    }
+  }
+  return true;
+}
+
+template <typename K, typename V>
+void ConcurrentExtendibleHashTable<K, V>::Bucket::MoveTo(Bucket *sibling, size_t bit) {
+  auto slots = std::move(slots_);
+  slots_.clear();
+  slots_.resize(slots.size());
+  count_ = 0;
+  for (auto &slot : slots) {
+    if (slot.used_) {
+      ((slot.hash_ & bit) != 0 ? sibling : this)->Insert(slot.key_, slot.value_, slot.hash_);
+    }
+  }
+}
+
+template class ConcurrentExtendibleHashTable<page_id_t, Page *>;
+template class ConcurrentExtendibleHashTable<Page *, std::list<Page *>::iterator>;
+template class ConcurrentExtendibleHashTable<int, int>;
+// test purpose
+template class ConcurrentExtendibleHashTable<int, std::string>;
+template class ConcurrentExtendibleHashTable<int, std::list<int>::iterator>;
+
+}  // namespace bustub
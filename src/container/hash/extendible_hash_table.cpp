@@ -10,6 +10,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <cassert>
 #include <cstdlib>
 #include <functional>
@@ -81,8 +82,24 @@ auto ExtendibleHashTable<K, V>::GetNumBucketsInternal() const -> int {
   return num_buckets_;
 }
 
+template <typename K, typename V>
+auto ExtendibleHashTable<K, V>::GetMemoryUsage() const -> size_t {
+  std::scoped_lock<std::mutex> lock(latch_);
+  // A list node holds the pair and two pointers, make_shared puts a bucket next to its reference counts. A bucket of
+  // local depth d is counted at the one directory index below 2^d that points to it.
+  size_t pairs = 0;
+  for (size_t i = 0; i < dir_.size(); i++) {
+    if (i < (size_t{1} << dir_[i]->GetDepth())) {
+      pairs += dir_[i]->GetItems().size();
+    }
+  }
+  return sizeof(*this) + dir_.capacity() * sizeof(std::shared_ptr<Bucket>) +
+         num_buckets_ * (sizeof(Bucket) + 2 * sizeof(int64_t)) + pairs * (sizeof(std::pair<K, V>) + 2 * sizeof(void *));
+}
+
 template <typename K, typename V>
 auto ExtendibleHashTable<K, V>::Find(const K &key, V &value) -> bool {
+  std::scoped_lock<std::mutex> lock(latch_);
   // 1. 通过 IndexOfKey() 获得 哈希桶的位置
   size_t index = IndexOf(key);
   std::shared_ptr<Bucket> bucket = dir_[index];
@@ -98,65 +115,92 @@ auto ExtendibleHashTable<K, V>::Find(const K &key, V &value) -> bool {
 
 template <typename K, typename V>
 auto ExtendibleHashTable<K, V>::Remove(const K &key) -> bool {
+  std::scoped_lock<std::mutex> lock(latch_);
   size_t index = IndexOf(key);
   std::shared_ptr<Bucket> bucket = dir_[index];
-  return bucket->Remove(key);
+  if (!bucket->Remove(key)) {
+    return false;
+  }
+  if (bucket->IsEmpty()) {
+    MergeBucket(index);
+  }
+  return true;
 }
 
 template <typename K, typename V>
 void ExtendibleHashTable<K, V>::Insert(const K &key, const V &value) {
-  // 1. If the key exists, the value should be updated.
-  size_t index = IndexOf(key);
-  std::shared_ptr<Bucket> bucket = dir_[index];
-  int local_depth = bucket->GetDepth();
-  int global_depth = GetGlobalDepth();
-  if (bucket->IfExistsThenUpdate(key, value)) { return; }
-  // 2. If the bucket is not full, then insert to the bucket. Return false 就代表着【满了】放不进去
-  if (bucket->Insert(key, value)) { return;}
-  // 3. Run here means the bucket is [full]
-  if (local_depth < global_depth) {  // 只能是说 桶进行分裂， 但是目录不会进行一个扩张的操作
-    bucket->IncrementDepth();
-    // 直接将对应的 index ====> bucket pointer 进行一个重新的分配
-    // local_depth 的最高位进行一个 bucket 的重新分配
-    auto pairs = bucket->GetItems();
-    pairs.push_back(std::make_pair(key, value));
-    bucket->ClearTheBucket();
-    int mask = (1 << local_depth);
-    int target = index | mask;                                               // 最高位的 bit 取 1
-    dir_[target] = std::make_shared<Bucket>(bucket_size_, local_depth + 1);  // 创建一个新的 bucket 【bucket分裂】
-    RedistributeBucket1(pairs);
-  } else {                     // local_depth == global depth
-    IncrementGlobalDepth();    // 1. increment the global depth
-    bucket->IncrementDepth();  // 2. increment the local depth
-    int n = dir_.size();
-    dir_.resize(n * 2);  // 3. double the size of dir
-    // 下面的操作同上面是一样的， 只不过是说 最高 bit 位为1的时候进行一个映射
-    for (int i = 0; i < n; i++) {
-      dir_[i + (1 << local_depth)] = dir_[i];
-    }  // 相同的映射， 只有 bucket 进行分裂的时候才创建新的 shared_ptr
-    auto pairs = bucket->GetItems();
-    pairs.push_back(std::make_pair(key, value));
-    bucket->ClearTheBucket();
-    dir_[index + (1 << local_depth)] = std::make_shared<Bucket>(bucket_size_, local_depth + 1);  // 创建一个新的 bucket
-    RedistributeBucket1(pairs);
+  std::scoped_lock<std::mutex> lock(latch_);
+  while (true) {
+    // 1. If the key exists, the value should be updated. If the bucket is not full, insert into the bucket.
+    std::shared_ptr<Bucket> bucket = dir_[IndexOf(key)];
+    if (bucket->Insert(key, value)) {
+      return;
+    }
+    // 2. Run here means the bucket is [full], double the directory if the bucket is as deep as the directory
+    if (bucket->GetDepth() == global_depth_) {
+      size_t n = dir_.size();
+      dir_.resize(n * 2);
+      for (size_t i = 0; i < n; i++) {
+        dir_[i + n] = dir_[i];
+      }  // 相同的映射， 只有 bucket 进行分裂的时候才创建新的 shared_ptr
+      IncrementGlobalDepthinternal();
+    }
+    // 3. split the bucket and retry, all of the keys may still end up in the same half
+    RedistributeBucket(bucket);
   }
 }
 
 template <typename K, typename V>
-auto ExtendibleHashTable<K, V>::RedistributeBucket1(std::list<std::pair<K, V>> &list) -> void {
-  // 获得了 list, 直接进行 hash 操作就行了
-  for (auto &it : list) {
-    Insert(it.first, it.second);
+auto ExtendibleHashTable<K, V>::RedistributeBucket(std::shared_ptr<Bucket> bucket) -> void {
+  // Every directory entry of the bucket whose bit at the old local depth is set moves to the new sibling bucket.
+  int mask = 1 << bucket->GetDepth();
+  bucket->IncrementDepth();
+  auto sibling = std::make_shared<Bucket>(bucket_size_, bucket->GetDepth());
+  num_buckets_++;
+  for (size_t i = 0; i < dir_.size(); i++) {
+    if (dir_[i] == bucket && (i & mask) != 0) {
+      dir_[i] = sibling;
+    }
+  }
+  // 重新的分配，通过 global depth 直接进行哈希映射就行了, 两个桶都不会满
+  auto pairs = bucket->GetItems();
+  bucket->ClearTheBucket();
+  for (auto &it : pairs) {
+    dir_[IndexOf(it.first)]->Insert(it.first, it.second);
   }
 }
 
 template <typename K, typename V>
-auto ExtendibleHashTable<K, V>::RedistributeBucket(std::shared_ptr<Bucket> bucket) -> void {
-  // 重新的分配，通过 global depth 直接进行哈希映射就行了
-  auto pairs = bucket->GetItems();
-  //  bucket->ClearTheBucket();
-  for (auto &it : pairs) {
-    Insert(it.first, it.second);  // 直接插入，因为肯定不满的
+auto ExtendibleHashTable<K, V>::MergeBucket(size_t dir_index) -> void {
+  // The table keeps the two buckets of depth 1 it starts with.
+  while (dir_[dir_index]->GetDepth() > 1) {
+    std::shared_ptr<Bucket> bucket = dir_[dir_index];
+    size_t image_index = dir_index ^ (size_t{1} << (bucket->GetDepth() - 1));
+    std::shared_ptr<Bucket> image = dir_[image_index];
+    if (image->GetDepth() != bucket->GetDepth() || (!bucket->IsEmpty() && !image->IsEmpty())) {
+      break;
+    }
+    // Keep the bucket that has the pairs, every directory entry of the empty one points to it from now on.
+    auto &kept = bucket->IsEmpty() ? image : bucket;
+    auto &dropped = bucket->IsEmpty() ? bucket : image;
+    for (auto &entry : dir_) {
+      if (entry == dropped) {
+        entry = kept;
+      }
+    }
+    kept->DecrementDepth();
+    num_buckets_--;
+  }
+  // Halve the directory while its upper half only repeats the lower half.
+  while (global_depth_ > 1) {
+    bool any_as_deep = std::any_of(dir_.begin(), dir_.end(),
+                                   [&](const std::shared_ptr<Bucket> &b) { return b->GetDepth() == global_depth_; });
+    if (any_as_deep) {
+      break;
+    }
+    dir_.resize(dir_.size() / 2);
+    dir_.shrink_to_fit();
+    global_depth_--;
   }
 }
 
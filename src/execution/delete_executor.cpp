@@ -12,16 +12,86 @@
 
 #include <memory>
 
+#include "concurrency/transaction_manager.h"
 #include "execution/executors/delete_executor.h"
+#include "type/value_factory.h"
 
 namespace bustub {
 
 DeleteExecutor::DeleteExecutor(ExecutorContext *exec_ctx, const DeletePlanNode *plan,
                                std::unique_ptr<AbstractExecutor> &&child_executor)
-    : AbstractExecutor(exec_ctx) {}
+    : AbstractExecutor(exec_ctx),
+      plan_(plan),
+      table_info_(exec_ctx->GetCatalog()->GetTable(plan->TableOid())),
+      child_executor_(std::move(child_executor)) {}
 
-void DeleteExecutor::Init() { throw NotImplementedException("DeleteExecutor is not implemented"); }
+void DeleteExecutor::Init() {
+  auto *txn = exec_ctx_->GetTransaction();
+  auto oid = table_info_->oid_;
+  if (txn->IsOptimistic()) {
+    // Optimistic writes are buffered until commit and take no locks.
+    child_executor_->Init();
+    done_ = false;
+    return;
+  }
+  try {
+    // Take the intention lock before the child starts reading, a shared table lock is upgraded to SIX.
+    if (!txn->IsTableIntentionExclusiveLocked(oid) && !txn->IsTableSharedIntentionExclusiveLocked(oid) &&
+        !txn->IsTableExclusiveLocked(oid)) {
+      auto mode = txn->IsTableSharedLocked(oid) ? LockManager::LockMode::SHARED_INTENTION_EXCLUSIVE
+                                                : LockManager::LockMode::INTENTION_EXCLUSIVE;
+      if (!exec_ctx_->GetLockManager()->LockTable(txn, mode, oid)) {
+        throw ExecutionException("delete: failed to lock table " + table_info_->name_);
+      }
+    }
+  } catch (TransactionAbortException &e) {
+    throw ExecutionException("delete: " + e.GetInfo());
+  }
+  child_executor_->Init();
+  indexes_ = exec_ctx_->GetCatalog()->GetTableIndexes(table_info_->name_);
+  done_ = false;
+}
 
-auto DeleteExecutor::Next([[maybe_unused]] Tuple *tuple, RID *rid) -> bool { return false; }
+auto DeleteExecutor::Next([[maybe_unused]] Tuple *tuple, RID *rid) -> bool {
+  if (done_) {
+    return false;
+  }
+  auto *txn = exec_ctx_->GetTransaction();
+  auto oid = table_info_->oid_;
+  int32_t count = 0;
+  Tuple child_tuple;
+  RID child_rid;
+  while (child_executor_->Next(&child_tuple, &child_rid)) {
+    if (txn->IsOptimistic()) {
+      txn->GetOptimisticWriteSet()->emplace_back(child_rid, WType::DELETE, child_tuple, oid, table_info_->table_.get(),
+                                                 exec_ctx_->GetCatalog());
+      count++;
+      continue;
+    }
+    try {
+      if (!txn->IsRowExclusiveLocked(oid, child_rid) &&
+          !exec_ctx_->GetLockManager()->LockRow(txn, LockManager::LockMode::EXCLUSIVE, oid, child_rid)) {
+        throw ExecutionException("delete: failed to lock row " + child_rid.ToString());
+      }
+    } catch (TransactionAbortException &e) {
+      throw ExecutionException("delete: " + e.GetInfo());
+    }
+    if (!table_info_->table_->MarkDelete(child_rid, txn)) {
+      // Another transaction deleted or rewrote the tuple after the snapshot of txn was taken.
+      throw ExecutionException("delete: write-write conflict on row " + child_rid.ToString());
+    }
+    // The index entries stay until the delete is applied: readers that do not see the delete yet must still find the
+    // row through the indexes.
+    for (auto *index_info : indexes_) {
+      txn->AppendIndexWriteRecord(
+          IndexWriteRecord(child_rid, oid, WType::DELETE, child_tuple, index_info->index_oid_, exec_ctx_->GetCatalog()));
+    }
+    count++;
+  }
+  std::vector<Value> values{ValueFactory::GetIntegerValue(count)};
+  *tuple = Tuple(values, &GetOutputSchema());
+  done_ = true;
+  return true;
+}
 
 }  // namespace bustub
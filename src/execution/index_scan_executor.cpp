@@ -11,12 +11,197 @@
 //===----------------------------------------------------------------------===//
 #include "execution/executors/index_scan_executor.h"
 
+#include <numeric>
+
+#include "concurrency/transaction_manager.h"
+#include "storage/index/b_plus_tree_index.h"
+
 namespace bustub {
 IndexScanExecutor::IndexScanExecutor(ExecutorContext *exec_ctx, const IndexScanPlanNode *plan)
-    : AbstractExecutor(exec_ctx) {}
+    : AbstractExecutor(exec_ctx),
+      plan_(plan),
+      index_info_(exec_ctx->GetCatalog()->GetIndex(plan->GetIndexOid())),
+      table_info_(exec_ctx->GetCatalog()->GetTable(index_info_->table_name_)) {}
+
+void IndexScanExecutor::Init() {
+  auto *txn = exec_ctx_->GetTransaction();
+  // Rows are read like a sequential scan reads them.
+  locking_ = txn->GetIsolationLevel() != IsolationLevel::READ_UNCOMMITTED &&
+             txn->GetIsolationLevel() != IsolationLevel::SNAPSHOT_ISOLATION && !txn->IsOptimistic();
+  auto oid = table_info_->oid_;
+  if (locking_) {
+    // An index-only scan does not lock the rows it yields, it shares the whole table instead so that no writer
+    // changes the entries until the transaction ends.
+    bool covered = txn->IsTableSharedLocked(oid) || txn->IsTableSharedIntentionExclusiveLocked(oid) ||
+                   txn->IsTableExclusiveLocked(oid);
+    auto mode = LockManager::LockMode::SHARED;
+    if (txn->IsTableIntentionExclusiveLocked(oid)) {
+      mode = LockManager::LockMode::SHARED_INTENTION_EXCLUSIVE;
+    }
+    if (!plan_->index_only_) {
+      covered = covered || txn->IsTableIntentionSharedLocked(oid) || txn->IsTableIntentionExclusiveLocked(oid);
+      mode = LockManager::LockMode::INTENTION_SHARED;
+    }
+    if (!covered) {
+      try {
+        if (!exec_ctx_->GetLockManager()->LockTable(txn, mode, oid)) {
+          throw ExecutionException("index scan: failed to lock table " + table_info_->name_);
+        }
+      } catch (TransactionAbortException &e) {
+        throw ExecutionException("index scan: " + e.GetInfo());
+      }
+    }
+  }
+  // Only a snapshot tells which version of a row a transaction sees, and the index has none. Deleted rows keep their
+  // entries until their slots are freed, so the table also has to be read while it has any.
+  read_table_ = !plan_->index_only_ || (!locking_ && txn->GetIsolationLevel() != IsolationLevel::READ_UNCOMMITTED) ||
+                table_info_->table_->HasMarkedDeletes();
+
+  rids_.clear();
+  entries_.clear();
+  cursor_ = 0;
+  auto *index = index_info_->index_.get();
+  if (index_info_->index_type_ == IndexType::ARTIndex) {
+    ProbeKey();
+    return;
+  }
+  switch (index_info_->key_size_) {
+    case 4:
+      ScanTree(dynamic_cast<BPlusTreeIndex<GenericKey<4>, RID, GenericComparator<4>> *>(index));
+      break;
+    case 8:
+      ScanTree(dynamic_cast<BPlusTreeIndex<GenericKey<8>, RID, GenericComparator<8>> *>(index));
+      break;
+    case 16:
+      ScanTree(dynamic_cast<BPlusTreeIndex<GenericKey<16>, RID, GenericComparator<16>> *>(index));
+      break;
+    case 32:
+      ScanTree(dynamic_cast<BPlusTreeIndex<GenericKey<32>, RID, GenericComparator<32>> *>(index));
+      break;
+    case 64:
+      ScanTree(dynamic_cast<BPlusTreeIndex<GenericKey<64>, RID, GenericComparator<64>> *>(index));
+      break;
+    default:
+      UNREACHABLE("index scan needs a b+ tree index");
+  }
+}
+
+template <typename KeyType, typename KeyComparator>
+void IndexScanExecutor::ScanTree(BPlusTreeIndex<KeyType, RID, KeyComparator> *tree) {
+  BUSTUB_ASSERT(tree != nullptr, "index scan needs a b+ tree index");
+  auto *key_schema = tree->GetKeySchema();
+  std::vector<Value> prefix;
+  for (const auto &value : plan_->prefix_) {
+    prefix.push_back(value->Evaluate(nullptr, *key_schema));
+  }
+  // A bound sits before or after the entries that start with its prefix, whichever keeps them in the range; the
+  // start bound of an exclusive range still meets those entries and skips them.
+  auto make_bound = [tree, &prefix](const AbstractExpressionRef &bound, bool after) {
+    std::vector<Value> values(prefix);
+    if (bound != nullptr) {
+      values.push_back(bound->Evaluate(nullptr, *tree->GetKeySchema()));
+    }
+    return tree->EntryBound(values, after);
+  };
+  // The scan starts at the bound in its direction and the iterator ends it at the other one. Without a bound the
+  // prefix still limits the range.
+  const auto &start = plan_->descending_ ? plan_->upper_bound_ : plan_->lower_bound_;
+  bool start_inclusive = plan_->descending_ ? plan_->upper_inclusive_ : plan_->lower_inclusive_;
+  const auto &stop = plan_->descending_ ? plan_->lower_bound_ : plan_->upper_bound_;
+  bool stop_inclusive = plan_->descending_ ? plan_->lower_inclusive_ : plan_->upper_inclusive_;
+  IndexIterator<KeyType, RID, KeyComparator> iter;
+  if (start == nullptr && prefix.empty()) {
+    iter = plan_->descending_ ? tree->GetReverseBeginIterator() : tree->GetBeginIterator();
+  } else {
+    start_inclusive = start_inclusive || start == nullptr;
+    KeyType start_key = make_bound(start, start_inclusive == plan_->descending_);
+    iter = plan_->descending_ ? tree->GetReverseBeginIterator(start_key) : tree->GetBeginIterator(start_key);
+    if (!start_inclusive) {
+      // The entries equal to the start bound in the columns it fixes
+      std::vector<uint32_t> bound_columns(prefix.size() + 1);
+      std::iota(bound_columns.begin(), bound_columns.end(), 0);
+      auto bound_schema = Schema::CopySchema(key_schema, bound_columns);
+      KeyComparator bound_comparator(&bound_schema);
+      while (!iter.IsEnd() && bound_comparator((*iter).first, start_key) == 0) {
+        ++iter;
+      }
+    }
+  }
+  if (stop != nullptr || !prefix.empty()) {
+    stop_inclusive = stop_inclusive || stop == nullptr;
+    iter.SetBound(make_bound(stop, stop_inclusive != plan_->descending_), stop_inclusive);
+  }
+  auto *entry_schema = tree->GetEntrySchema();
+  for (; !iter.IsEnd(); ++iter) {
+    rids_.push_back((*iter).second);
+    if (!read_table_) {
+      std::vector<Value> values;
+      values.reserve(entry_schema->GetColumnCount());
+      for (uint32_t i = 0; i < entry_schema->GetColumnCount(); i++) {
+        values.push_back((*iter).first.ToValue(entry_schema, i));
+      }
+      entries_.emplace_back(values, &GetOutputSchema());
+    }
+  }
+}
+
+void IndexScanExecutor::ProbeKey() {
+  auto *key_schema = index_info_->index_->GetKeySchema();
+  BUSTUB_ASSERT(plan_->prefix_.size() == key_schema->GetColumnCount() && !plan_->index_only_,
+                "an index that does not scan ranges is only planned for whole keys");
+  std::vector<Value> values;
+  for (const auto &value : plan_->prefix_) {
+    values.push_back(value->Evaluate(nullptr, *key_schema));
+  }
+  index_info_->index_->ScanKey(Tuple(values, key_schema), &rids_, exec_ctx_->GetTransaction());
+}
 
-void IndexScanExecutor::Init() { throw NotImplementedException("IndexScanExecutor is not implemented"); }
+auto IndexScanExecutor::Next(Tuple *tuple, RID *rid) -> bool {
+  while (cursor_ < rids_.size()) {
+    size_t pos = cursor_++;
+    RID cur_rid = rids_[pos];
+    if (!read_table_) {
+      *tuple = entries_[pos];
+    } else if (!ReadTuple(cur_rid, tuple)) {
+      continue;
+    } else if (plan_->index_only_) {
+      *tuple = index_info_->index_->EntryFromTuple(*tuple, table_info_->schema_);
+    }
+    if (plan_->filter_predicate_ != nullptr) {
+      auto value = plan_->filter_predicate_->Evaluate(tuple, GetOutputSchema());
+      if (value.IsNull() || !value.GetAs<bool>()) {
+        continue;
+      }
+    }
+    *rid = cur_rid;
+    return true;
+  }
+  return false;
+}
 
-auto IndexScanExecutor::Next(Tuple *tuple, RID *rid) -> bool { return false; }
+auto IndexScanExecutor::ReadTuple(const RID &rid, Tuple *tuple) -> bool {
+  auto *txn = exec_ctx_->GetTransaction();
+  auto oid = table_info_->oid_;
+  bool lock_row = locking_ && !txn->IsRowExclusiveLocked(oid, rid) && !txn->IsRowSharedLocked(oid, rid);
+  if (lock_row) {
+    try {
+      if (!exec_ctx_->GetLockManager()->LockRow(txn, LockManager::LockMode::SHARED, oid, rid)) {
+        throw ExecutionException("index scan: failed to lock row " + rid.ToString());
+      }
+    } catch (TransactionAbortException &e) {
+      throw ExecutionException("index scan: " + e.GetInfo());
+    }
+  }
+  // Read the tuple again, it may have changed or gone before the lock was granted.
+  bool exists = table_info_->table_->GetTuple(rid, tuple, txn);
+  if (lock_row && txn->GetIsolationLevel() == IsolationLevel::READ_COMMITTED) {
+    exec_ctx_->GetLockManager()->UnlockRow(txn, oid, rid);
+  }
+  if (!exists && txn->GetState() == TransactionState::ABORTED) {
+    // An optimistic read ran into an uncommitted write.
+    throw ExecutionException("index scan: read conflict on row " + rid.ToString());
+  }
+  return exists;
+}
 
 }  // namespace bustub
@@ -1,27 +1,93 @@
-//===----------------------------------------------------------------------===//
-//
-//                         BusTub
-//
-// insert_executor.cpp
-//
-// Identification: src/execution/insert_executor.cpp
-//
-// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
-//
-//===----------------------------------------------------------------------===//
-
-#include <memory>
-
-#include "execution/executors/insert_executor.h"
-
-namespace bustub {
-
-InsertExecutor::InsertExecutor(ExecutorContext *exec_ctx, const InsertPlanNode *plan,
-                               std::unique_ptr<AbstractExecutor> &&child_executor)
-    : AbstractExecutor(exec_ctx) {}
-
-void InsertExecutor::Init() { throw NotImplementedException("InsertExecutor is not implemented"); }
-
-auto InsertExecutor::Next([[maybe_unused]] Tuple *tuple, RID *rid) -> bool { return false; }
-
-}  // namespace bustub
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// insert_executor.cpp
+//
+// Identification: src/execution/insert_executor.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <memory>
+
+#include "concurrency/transaction_manager.h"
+#include "execution/executors/insert_executor.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+InsertExecutor::InsertExecutor(ExecutorContext *exec_ctx, const InsertPlanNode *plan,
+                               std::unique_ptr<AbstractExecutor> &&child_executor)
+    : AbstractExecutor(exec_ctx),
+      plan_(plan),
+      table_info_(exec_ctx->GetCatalog()->GetTable(plan->TableOid())),
+      child_executor_(std::move(child_executor)) {}
+
+void InsertExecutor::Init() {
+  auto *txn = exec_ctx_->GetTransaction();
+  auto oid = table_info_->oid_;
+  if (txn->IsOptimistic()) {
+    // Optimistic writes are buffered until commit and take no locks.
+    child_executor_->Init();
+    done_ = false;
+    return;
+  }
+  try {
+    // Take the intention lock before the child starts reading, a shared table lock is upgraded to SIX.
+    if (!txn->IsTableIntentionExclusiveLocked(oid) && !txn->IsTableSharedIntentionExclusiveLocked(oid) &&
+        !txn->IsTableExclusiveLocked(oid)) {
+      auto mode = txn->IsTableSharedLocked(oid) ? LockManager::LockMode::SHARED_INTENTION_EXCLUSIVE
+                                                : LockManager::LockMode::INTENTION_EXCLUSIVE;
+      if (!exec_ctx_->GetLockManager()->LockTable(txn, mode, oid)) {
+        throw ExecutionException("insert: failed to lock table " + table_info_->name_);
+      }
+    }
+  } catch (TransactionAbortException &e) {
+    throw ExecutionException("insert: " + e.GetInfo());
+  }
+  child_executor_->Init();
+  indexes_ = exec_ctx_->GetCatalog()->GetTableIndexes(table_info_->name_);
+  done_ = false;
+}
+
+auto InsertExecutor::Next([[maybe_unused]] Tuple *tuple, RID *rid) -> bool {
+  if (done_) {
+    return false;
+  }
+  auto *txn = exec_ctx_->GetTransaction();
+  auto oid = table_info_->oid_;
+  int32_t count = 0;
+  Tuple child_tuple;
+  RID child_rid;
+  while (child_executor_->Next(&child_tuple, &child_rid)) {
+    if (txn->IsOptimistic()) {
+      txn->GetOptimisticWriteSet()->emplace_back(child_rid, WType::INSERT, child_tuple, oid, table_info_->table_.get(),
+                                                 exec_ctx_->GetCatalog());
+      count++;
+      continue;
+    }
+    RID new_rid;
+    if (!table_info_->table_->InsertTuple(child_tuple, &new_rid, txn)) {
+      throw ExecutionException("insert: failed to insert into table " + table_info_->name_);
+    }
+    try {
+      if (!exec_ctx_->GetLockManager()->LockRow(txn, LockManager::LockMode::EXCLUSIVE, oid, new_rid)) {
+        throw ExecutionException("insert: failed to lock row " + new_rid.ToString());
+      }
+    } catch (TransactionAbortException &e) {
+      throw ExecutionException("insert: " + e.GetInfo());
+    }
+    for (auto *index_info : indexes_) {
+      TransactionManager::InsertIndexEntry(txn, table_info_, index_info, child_tuple, new_rid, exec_ctx_->GetCatalog());
+    }
+    count++;
+  }
+  std::vector<Value> values{ValueFactory::GetIntegerValue(count)};
+  *tuple = Tuple(values, &GetOutputSchema());
+  done_ = true;
+  return true;
+}
+
+}  // namespace bustub
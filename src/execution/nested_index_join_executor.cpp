@@ -12,19 +12,138 @@
 
 #include "execution/executors/nested_index_join_executor.h"
 
+#include "concurrency/transaction_manager.h"
+#include "type/value_factory.h"
+
 namespace bustub {
 
 NestIndexJoinExecutor::NestIndexJoinExecutor(ExecutorContext *exec_ctx, const NestedIndexJoinPlanNode *plan,
                                              std::unique_ptr<AbstractExecutor> &&child_executor)
-    : AbstractExecutor(exec_ctx) {
+    : AbstractExecutor(exec_ctx),
+      plan_(plan),
+      child_executor_(std::move(child_executor)),
+      index_info_(exec_ctx->GetCatalog()->GetIndex(plan->GetIndexOid())),
+      table_info_(exec_ctx->GetCatalog()->GetTable(plan->GetInnerTableOid())) {
   if (!(plan->GetJoinType() == JoinType::LEFT || plan->GetJoinType() == JoinType::INNER)) {
     // Note for 2022 Fall: You ONLY need to implement left join and inner join.
     throw bustub::NotImplementedException(fmt::format("join type {} not supported", plan->GetJoinType()));
   }
 }
 
-void NestIndexJoinExecutor::Init() { throw NotImplementedException("NestIndexJoinExecutor is not implemented"); }
+void NestIndexJoinExecutor::Init() {
+  auto *txn = exec_ctx_->GetTransaction();
+  // Inner rows are read like a sequential scan reads them.
+  locking_ = txn->GetIsolationLevel() != IsolationLevel::READ_UNCOMMITTED &&
+             txn->GetIsolationLevel() != IsolationLevel::SNAPSHOT_ISOLATION && !txn->IsOptimistic();
+  auto oid = table_info_->oid_;
+  if (locking_ && !txn->IsTableIntentionSharedLocked(oid) && !txn->IsTableSharedLocked(oid) &&
+      !txn->IsTableIntentionExclusiveLocked(oid) && !txn->IsTableSharedIntentionExclusiveLocked(oid) &&
+      !txn->IsTableExclusiveLocked(oid)) {
+    try {
+      if (!exec_ctx_->GetLockManager()->LockTable(txn, LockManager::LockMode::INTENTION_SHARED, oid)) {
+        throw ExecutionException("index join: failed to lock table " + table_info_->name_);
+      }
+    } catch (TransactionAbortException &e) {
+      throw ExecutionException("index join: " + e.GetInfo());
+    }
+  }
+  child_executor_->Init();
+  outer_tuples_.clear();
+  matches_.clear();
+  outer_pos_ = 0;
+  match_pos_ = 0;
+  outer_matched_ = false;
+}
+
+auto NestIndexJoinExecutor::Next(Tuple *tuple, RID *rid) -> bool {
+  while (true) {
+    if (outer_pos_ == outer_tuples_.size() && !FillBatch()) {
+      return false;
+    }
+    const Tuple &outer = outer_tuples_[outer_pos_];
+    const auto &matches = matches_[outer_pos_];
+    while (match_pos_ < matches.size()) {
+      Tuple inner;
+      if (ReadInner(matches[match_pos_++], &inner)) {
+        *tuple = Join(outer, &inner);
+        outer_matched_ = true;
+        return true;
+      }
+    }
+    bool pad = !outer_matched_ && plan_->GetJoinType() == JoinType::LEFT;
+    outer_pos_++;
+    match_pos_ = 0;
+    outer_matched_ = false;
+    if (pad) {
+      *tuple = Join(outer, nullptr);
+      return true;
+    }
+  }
+}
 
-auto NestIndexJoinExecutor::Next(Tuple *tuple, RID *rid) -> bool { return false; }
+auto NestIndexJoinExecutor::FillBatch() -> bool {
+  outer_tuples_.clear();
+  outer_pos_ = 0;
+  std::vector<Tuple> keys;
+  std::vector<bool> null_keys;
+  Tuple outer;
+  RID outer_rid;
+  while (outer_tuples_.size() < INDEX_JOIN_BATCH_SIZE && child_executor_->Next(&outer, &outer_rid)) {
+    Value key = plan_->KeyPredicate()->Evaluate(&outer, child_executor_->GetOutputSchema());
+    null_keys.push_back(key.IsNull());
+    keys.emplace_back(std::vector<Value>{key}, index_info_->index_->GetKeySchema());
+    outer_tuples_.push_back(outer);
+  }
+  if (outer_tuples_.empty()) {
+    return false;
+  }
+  index_info_->index_->ScanKeys(keys, &matches_, exec_ctx_->GetTransaction());
+  // A null key equals nothing, not even the null keys of the index.
+  for (size_t i = 0; i < null_keys.size(); i++) {
+    if (null_keys[i]) {
+      matches_[i].clear();
+    }
+  }
+  return true;
+}
+
+auto NestIndexJoinExecutor::ReadInner(const RID &rid, Tuple *tuple) -> bool {
+  auto *txn = exec_ctx_->GetTransaction();
+  auto oid = table_info_->oid_;
+  bool lock_row = locking_ && !txn->IsRowExclusiveLocked(oid, rid) && !txn->IsRowSharedLocked(oid, rid);
+  if (lock_row) {
+    try {
+      if (!exec_ctx_->GetLockManager()->LockRow(txn, LockManager::LockMode::SHARED, oid, rid)) {
+        throw ExecutionException("index join: failed to lock row " + rid.ToString());
+      }
+    } catch (TransactionAbortException &e) {
+      throw ExecutionException("index join: " + e.GetInfo());
+    }
+  }
+  bool exists = table_info_->table_->GetTuple(rid, tuple, txn);
+  if (lock_row && txn->GetIsolationLevel() == IsolationLevel::READ_COMMITTED) {
+    exec_ctx_->GetLockManager()->UnlockRow(txn, oid, rid);
+  }
+  if (!exists && txn->GetState() == TransactionState::ABORTED) {
+    // An optimistic read ran into an uncommitted write.
+    throw ExecutionException("index join: read conflict on row " + rid.ToString());
+  }
+  return exists;
+}
+
+auto NestIndexJoinExecutor::Join(const Tuple &outer, const Tuple *inner) const -> Tuple {
+  const auto &outer_schema = child_executor_->GetOutputSchema();
+  const auto &inner_schema = plan_->InnerTableSchema();
+  std::vector<Value> values;
+  values.reserve(GetOutputSchema().GetColumnCount());
+  for (uint32_t i = 0; i < outer_schema.GetColumnCount(); i++) {
+    values.push_back(outer.GetValue(&outer_schema, i));
+  }
+  for (uint32_t i = 0; i < inner_schema.GetColumnCount(); i++) {
+    values.push_back(inner == nullptr ? ValueFactory::GetNullValueByType(inner_schema.GetColumn(i).GetType())
+                                      : inner->GetValue(&inner_schema, i));
+  }
+  return Tuple(values, &GetOutputSchema());
+}
 
 }  // namespace bustub
@@ -1,23 +1,85 @@
-//===----------------------------------------------------------------------===//
-//
-//                         BusTub
-//
-// seq_scan_executor.cpp
-//
-// Identification: src/execution/seq_scan_executor.cpp
-//
-// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
-//
-//===----------------------------------------------------------------------===//
-
-#include "execution/executors/seq_scan_executor.h"
-
-namespace bustub {
-
-SeqScanExecutor::SeqScanExecutor(ExecutorContext *exec_ctx, const SeqScanPlanNode *plan) : AbstractExecutor(exec_ctx) {}
-
-void SeqScanExecutor::Init() { throw NotImplementedException("SeqScanExecutor is not implemented"); }
-
-auto SeqScanExecutor::Next(Tuple *tuple, RID *rid) -> bool { return false; }
-
-}  // namespace bustub
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// seq_scan_executor.cpp
+//
+// Identification: src/execution/seq_scan_executor.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/executors/seq_scan_executor.h"
+
+#include "concurrency/transaction_manager.h"
+
+namespace bustub {
+
+SeqScanExecutor::SeqScanExecutor(ExecutorContext *exec_ctx, const SeqScanPlanNode *plan)
+    : AbstractExecutor(exec_ctx),
+      plan_(plan),
+      table_info_(exec_ctx->GetCatalog()->GetTable(plan->GetTableOid())) {}
+
+void SeqScanExecutor::Init() {
+  auto *txn = exec_ctx_->GetTransaction();
+  // Snapshot isolation reads its snapshot without locks, read uncommitted reads whatever is there, optimistic
+  // transactions record what they read and validate it at commit.
+  locking_ = txn->GetIsolationLevel() != IsolationLevel::READ_UNCOMMITTED &&
+             txn->GetIsolationLevel() != IsolationLevel::SNAPSHOT_ISOLATION && !txn->IsOptimistic();
+  auto oid = table_info_->oid_;
+  if (locking_ && !txn->IsTableIntentionSharedLocked(oid) && !txn->IsTableSharedLocked(oid) &&
+      !txn->IsTableIntentionExclusiveLocked(oid) && !txn->IsTableSharedIntentionExclusiveLocked(oid) &&
+      !txn->IsTableExclusiveLocked(oid)) {
+    try {
+      if (!exec_ctx_->GetLockManager()->LockTable(txn, LockManager::LockMode::INTENTION_SHARED, oid)) {
+        throw ExecutionException("seq scan: failed to lock table " + table_info_->name_);
+      }
+    } catch (TransactionAbortException &e) {
+      throw ExecutionException("seq scan: " + e.GetInfo());
+    }
+  }
+  iter_ = std::make_unique<TableIterator>(table_info_->table_->Begin(txn));
+}
+
+auto SeqScanExecutor::Next(Tuple *tuple, RID *rid) -> bool {
+  auto *txn = exec_ctx_->GetTransaction();
+  auto oid = table_info_->oid_;
+  while (*iter_ != table_info_->table_->End()) {
+    RID cur_rid = (*iter_)->GetRid();
+    ++(*iter_);
+    bool lock_row = locking_ && !txn->IsRowExclusiveLocked(oid, cur_rid) && !txn->IsRowSharedLocked(oid, cur_rid);
+    if (lock_row) {
+      try {
+        if (!exec_ctx_->GetLockManager()->LockRow(txn, LockManager::LockMode::SHARED, oid, cur_rid)) {
+          throw ExecutionException("seq scan: failed to lock row " + cur_rid.ToString());
+        }
+      } catch (TransactionAbortException &e) {
+        throw ExecutionException("seq scan: " + e.GetInfo());
+      }
+    }
+    // Read the tuple again, it may have changed or gone before the lock was granted.
+    bool exists = table_info_->table_->GetTuple(cur_rid, tuple, txn);
+    if (lock_row && txn->GetIsolationLevel() == IsolationLevel::READ_COMMITTED) {
+      exec_ctx_->GetLockManager()->UnlockRow(txn, oid, cur_rid);
+    }
+    if (!exists) {
+      if (txn->GetState() == TransactionState::ABORTED) {
+        // An optimistic read ran into an uncommitted write.
+        throw ExecutionException("seq scan: read conflict on row " + cur_rid.ToString());
+      }
+      continue;
+    }
+    if (plan_->filter_predicate_ != nullptr) {
+      auto value = plan_->filter_predicate_->Evaluate(tuple, GetOutputSchema());
+      if (value.IsNull() || !value.GetAs<bool>()) {
+        continue;
+      }
+    }
+    *rid = cur_rid;
+    return true;
+  }
+  return false;
+}
+
+}  // namespace bustub
@@ -21,7 +21,9 @@ namespace bustub {
 class IndexStatement : public BoundStatement {
  public:
   explicit IndexStatement(std::string index_name, std::unique_ptr<BoundBaseTableRef> table,
-                          std::vector<std::unique_ptr<BoundColumnRef>> cols);
+                          std::vector<std::unique_ptr<BoundColumnRef>> cols, bool is_unique,
+                          std::vector<std::unique_ptr<BoundColumnRef>> include_cols = {},
+                          std::string index_type = "btree");
 
   /** Name of the index */
   std::string index_name_;
@@ -32,6 +34,15 @@ class IndexStatement : public BoundStatement {
   /** Name of the columns */
   std::vector<std::unique_ptr<BoundColumnRef>> cols_;
 
+  /** Whether it is a unique index */
+  bool is_unique_;
+
+  /** Name of the columns stored in the index besides the key, for index-only scans */
+  std::vector<std::unique_ptr<BoundColumnRef>> include_cols_;
+
+  /** The access method of `USING`, "btree" or "art" */
+  std::string index_type_;
+
   auto ToString() const -> std::string override;
 };
 
@@ -21,6 +21,7 @@
 #include "buffer/buffer_pool_manager.h"
 #include "catalog/schema.h"
 #include "container/hash/hash_function.h"
+#include "storage/index/art_index.h"
 #include "storage/index/b_plus_tree_index.h"
 #include "storage/index/extendible_hash_table_index.h"
 #include "storage/index/index.h"
@@ -35,6 +36,9 @@ using table_oid_t = uint32_t;
 using column_oid_t = uint32_t;
 using index_oid_t = uint32_t;
 
+/** The structure an index keeps its entries in */
+enum class IndexType { BPlusTreeIndex, ARTIndex };
+
 /**
  * The TableInfo class maintains metadata about a table.
  */
@@ -69,16 +73,18 @@ struct IndexInfo {
    * @param index An owning pointer to the index
    * @param index_oid The unique OID for the index
    * @param table_name The name of the table on which the index is created
-   * @param key_size The size of the index key, in bytes
+   * @param key_size The size of an index entry, in bytes
+   * @param index_type The structure the index keeps its entries in
    */
   IndexInfo(Schema key_schema, std::string name, std::unique_ptr<Index> &&index, index_oid_t index_oid,
-            std::string table_name, size_t key_size)
+            std::string table_name, size_t key_size, IndexType index_type = IndexType::BPlusTreeIndex)
       : key_schema_{std::move(key_schema)},
         name_{std::move(name)},
         index_{std::move(index)},
         index_oid_{index_oid},
         table_name_{std::move(table_name)},
-        key_size_{key_size} {}
+        key_size_{key_size},
+        index_type_{index_type} {}
   /** The schema for the index key */
   Schema key_schema_;
   /** The name of the index */
@@ -89,8 +95,10 @@ struct IndexInfo {
   index_oid_t index_oid_;
   /** The name of the table on which the index is created */
   std::string table_name_;
-  /** The size of the index key, in bytes */
+  /** The size of an index entry, the key and the included columns, in bytes */
   const size_t key_size_;
+  /** The structure the index keeps its entries in; only a b+ tree scans ranges of keys */
+  const IndexType index_type_;
 };
 
 /**
@@ -194,14 +202,19 @@ class Catalog {
    * @param schema The schema of the table
    * @param key_schema The schema of the key
    * @param key_attrs Key attributes
-   * @param keysize Size of the key
+   * @param keysize Size of an index entry, the key and the included columns
    * @param hash_function The hash function for the index
+   * @param is_unique Whether a key may map to one record only
+   * @param include_attrs The table columns stored in the index besides the key
+   * @param index_type The structure the index keeps its entries in; an ART index ignores the key types
    * @return A (non-owning) pointer to the metadata of the new table
    */
   template <class KeyType, class ValueType, class KeyComparator>
   auto CreateIndex(Transaction *txn, const std::string &index_name, const std::string &table_name, const Schema &schema,
                    const Schema &key_schema, const std::vector<uint32_t> &key_attrs, std::size_t keysize,
-                   HashFunction<KeyType> hash_function) -> IndexInfo * {
+                   HashFunction<KeyType> hash_function, bool is_unique = true,
+                   const std::vector<uint32_t> &include_attrs = {},
+                   IndexType index_type = IndexType::BPlusTreeIndex) -> IndexInfo * {
     // Reject the creation request for nonexistent table
     if (table_names_.find(table_name) == table_names_.end()) {
       return NULL_INDEX_INFO;
@@ -218,29 +231,28 @@ class Catalog {
     }
 
     // Construct index metdata
-    auto meta = std::make_unique<IndexMetadata>(index_name, table_name, &schema, key_attrs);
-
-    // Construct the index, take ownership of metadata
-    // TODO(Kyle): We should update the API for CreateIndex
-    // to allow specification of the index type itself, not
-    // just the key, value, and comparator types
-
-    // TODO(chi): support both hash index and btree index
-    auto index = std::make_unique<BPlusTreeIndex<KeyType, ValueType, KeyComparator>>(std::move(meta), bpm_);
+    auto meta = std::make_unique<IndexMetadata>(index_name, table_name, &schema, key_attrs, is_unique, include_attrs);
 
-    // Populate the index with all tuples in table heap
+    // Construct the index, take ownership of metadata, and populate it with all tuples in table heap
+    // TODO(chi): support hash index
     auto *table_meta = GetTable(table_name);
-    auto *heap = table_meta->table_.get();
-    for (auto tuple = heap->Begin(txn); tuple != heap->End(); ++tuple) {
-      index->InsertEntry(tuple->KeyFromTuple(schema, key_schema, key_attrs), tuple->GetRid(), txn);
+    std::unique_ptr<Index> index;
+    if (index_type == IndexType::ARTIndex) {
+      auto art_index = std::make_unique<ARTIndex>(std::move(meta));
+      art_index->BulkLoad(table_meta->table_.get(), schema, txn);
+      index = std::move(art_index);
+    } else {
+      auto tree_index = std::make_unique<BPlusTreeIndex<KeyType, ValueType, KeyComparator>>(std::move(meta), bpm_);
+      tree_index->BulkLoad(table_meta->table_.get(), schema, txn);
+      index = std::move(tree_index);
     }
 
     // Get the next OID for the new index
     const auto index_oid = next_index_oid_.fetch_add(1);
 
     // Construct index information; IndexInfo takes ownership of the Index itself
-    auto index_info =
-        std::make_unique<IndexInfo>(key_schema, index_name, std::move(index), index_oid, table_name, keysize);
+    auto index_info = std::make_unique<IndexInfo>(key_schema, index_name, std::move(index), index_oid, table_name,
+                                                  keysize, index_type);
     auto *tmp = index_info.get();
 
     // Update internal tracking
@@ -298,7 +310,7 @@ class Catalog {
    * @param index_oid The OID of the index for which to query
    * @return A (non-owning) pointer to the metadata for the index
    */
-  auto GetIndex(index_oid_t index_oid) -> IndexInfo * {
+  auto GetIndex(index_oid_t index_oid) const -> IndexInfo * {
     auto index = indexes_.find(index_oid);
     if (index == indexes_.end()) {
       return NULL_INDEX_INFO;
@@ -39,6 +39,7 @@ class TransactionManager;
 class LogManager;
 class CheckpointManager;
 class Catalog;
+class Vacuum;
 class ExecutionEngine;
 
 class ResultWriter {
@@ -251,6 +252,7 @@ class BustubInstance {
   LogManager *log_manager_;
   CheckpointManager *checkpoint_manager_;
   Catalog *catalog_;
+  Vacuum *vacuum_;
   ExecutionEngine *execution_engine_;
   std::shared_mutex catalog_lock_;
 
@@ -270,6 +272,7 @@ class BustubInstance {
   void CmdDisplayTables(ResultWriter &writer);
   void CmdDisplayIndices(ResultWriter &writer);
   void CmdDisplayHelp(ResultWriter &writer);
+  void CmdDisplayLocks(ResultWriter &writer);
   void WriteOneCell(const std::string &cell, ResultWriter &writer);
   std::unordered_map<std::string, std::string> session_variables_;
 };
@@ -21,6 +21,9 @@ namespace bustub {
 /** Cycle detection is performed every CYCLE_DETECTION_INTERVAL milliseconds. */
 extern std::chrono::milliseconds cycle_detection_interval;
 
+/** The vacuum reclaims deleted tuples and dead tuple versions every VACUUM_INTERVAL milliseconds. */
+extern std::chrono::milliseconds vacuum_interval;
+
 /** True if logging should be enabled, false otherwise. */
 extern std::atomic<bool> enable_logging;
 
@@ -36,12 +39,28 @@ static constexpr int BUFFER_POOL_SIZE = 10;
 static constexpr int LOG_BUFFER_SIZE = ((BUFFER_POOL_SIZE + 1) * BUSTUB_PAGE_SIZE);  // size of a log buffer in byte
 static constexpr int BUCKET_SIZE = 50;                                               // size of extendible hash bucket
 static constexpr int LRUK_REPLACER_K = 10;  // lookback window for lru-k replacer
+static constexpr int LOCK_TABLE_PARTITION_NUM = 16;  // number of independently latched lock table partitions
+static constexpr int LOCK_ESCALATION_THRESHOLD = 1024;  // row locks on one table a txn holds before escalation
+static constexpr int TXN_MAP_PARTITION_NUM = 16;  // number of independently latched transaction map partitions
+static constexpr int UNDO_BUFFER_CHUNK_SIZE = 4096;  // size of an undo buffer chunk in byte
+static constexpr int LOCK_WAIT_HISTOGRAM_BUCKETS = 24;  // power-of-two microsecond buckets of the lock wait histogram
+static constexpr int LOCK_STATS_ROW_SAMPLE_RATE = 16;   // one in this many row lock requests is counted for its row
+static constexpr int LOCK_STATS_ROW_CAPACITY = 4096;    // rows whose lock counters are kept at most
+static constexpr int BULK_LOAD_SORT_RUN_SIZE = 1 << 16;  // index entries a bulk load sorts in memory per run
+static constexpr double BULK_LOAD_FILL_FACTOR = 0.9;     // fraction of a page a bulk loaded b+ tree fills
+static constexpr double COMPACTION_FILL_FACTOR = 0.9;    // fraction of a leaf a b+ tree compaction fills
+static constexpr int COMPACTION_WINDOW = 8;              // leaves a b+ tree compaction repacks at a time
+static constexpr int INDEX_JOIN_BATCH_SIZE = 256;  // outer tuples a nested index join looks up in the index at once
+static constexpr int ART_MAX_KEY_SIZE = 64;        // size of the largest key of an adaptive radix tree in byte
+static constexpr int ART_EPOCH_SLOTS = 64;         // threads that may operate on an adaptive radix tree at once
+static constexpr int ART_RECLAIM_BATCH = 64;       // replaced nodes an adaptive radix tree frees at a time
 
 using frame_id_t = int32_t;    // frame id type
 using page_id_t = int32_t;     // page id type
 using txn_id_t = int32_t;      // transaction id type
 using lsn_t = int32_t;         // log sequence number type
 using slot_offset_t = size_t;  // slot offset type
+using timestamp_t = int64_t;   // commit / snapshot timestamp type
 using oid_t = uint16_t;
 
 static constexpr int VARCHAR_DEFAULT_LENGTH = 128;  // default length for varchar when constructing the column
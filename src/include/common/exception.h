@@ -47,6 +47,8 @@ enum class ExceptionType {
   OUT_OF_MEMORY = 9,
   /** Method not implemented. */
   NOT_IMPLEMENTED = 11,
+  /** Execution of a query failed, e.g. because its transaction was aborted. */
+  EXECUTION = 12,
 };
 
 class Exception : public std::runtime_error {
@@ -102,6 +104,8 @@ class Exception : public std::runtime_error {
         return "Out of Memory";
       case ExceptionType::NOT_IMPLEMENTED:
         return "Not implemented";
+      case ExceptionType::EXECUTION:
+        return "Execution";
       default:
         return "Unknown";
     }
@@ -117,4 +121,10 @@ class NotImplementedException : public Exception {
   explicit NotImplementedException(const std::string &msg) : Exception(ExceptionType::NOT_IMPLEMENTED, msg) {}
 };
 
+class ExecutionException : public Exception {
+ public:
+  ExecutionException() = delete;
+  explicit ExecutionException(const std::string &msg) : Exception(ExceptionType::EXECUTION, msg) {}
+};
+
 }  // namespace bustub
@@ -39,6 +39,12 @@ class ReaderWriterLatch {
    */
   void RLock() { mutex_.lock_shared(); }
 
+  /**
+   * Try to acquire a read latch without waiting.
+   * @return true if the read latch is held now
+   */
+  auto TryRLock() -> bool { return mutex_.try_lock_shared(); }
+
   /**
    * Release a read latch.
    */
@@ -13,7 +13,9 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
 #include <condition_variable>  // NOLINT
+#include <deque>
 #include <list>
 #include <memory>
 #include <mutex>  // NOLINT
@@ -24,11 +26,13 @@
 
 #include "common/config.h"
 #include "common/rid.h"
+#include "concurrency/lock_stats.h"
 #include "concurrency/transaction.h"
 
 namespace bustub {
 
 class TransactionManager;
+class LockRequestPool;
 
 /**
  * LockManager handles transactions asking for locks on records.
@@ -71,22 +75,109 @@ class LockManager {
     txn_id_t upgrading_ = INVALID_TXN_ID;
     /** coordination */
     std::mutex latch_;
+    /** Number of threads using the queue, protected by the latch of the partition */
+    size_t pins_{0};
   };
 
   /**
-   * Creates a new lock manager configured for the deadlock detection policy.
+   * One partition of the lock table. A resource always hashes to the same partition, so the partition latch only
+   * has to be held while looking up (or creating) the request queue of the resource; the wait itself happens on the
+   * queue latch. A thread pins the queue while it uses it, and the last thread to unpin a queue without requests
+   * erases it, so the table only holds the queues of the resources that are locked or waited for.
    */
-  LockManager() {
-    enable_cycle_detection_ = true;
-    cycle_detection_thread_ = new std::thread(&LockManager::RunCycleDetection, this);
+  template <typename K>
+  class LockTablePartition {
+   public:
+    /** @return the request queue of key, created if needed, pinned until Unpin() */
+    auto Pin(const K &key) -> LockRequestQueue * {
+      std::scoped_lock<std::mutex> lock(latch_);
+      auto *queue = &queues_[key];
+      queue->pins_++;
+      return queue;
+    }
+
+    /** Drop a pin taken by Pin(). The caller must not hold the queue latch. */
+    void Unpin(const K &key) {
+      std::scoped_lock<std::mutex> lock(latch_);
+      auto it = queues_.find(key);
+      // Nobody else holds a pin, so nobody can add a request to the queue meanwhile.
+      if (--it->second.pins_ == 0 && it->second.request_queue_.empty()) {
+        queues_.erase(it);
+      }
+    }
+
+    /** Request queues of the resources that hash to this partition */
+    std::unordered_map<K, LockRequestQueue> queues_;
+    /** Protects queues_ and the pin counts of the queues (not the queues themselves) */
+    std::mutex latch_;
+  };
+
+  /** Keeps a request queue pinned for the lifetime of the guard. */
+  template <typename K>
+  class QueueGuard {
+   public:
+    QueueGuard(LockTablePartition<K> *partition, const K &key)
+        : partition_(partition), key_(key), queue_(partition->Pin(key)) {}
+    ~QueueGuard() { partition_->Unpin(key_); }
+    QueueGuard(const QueueGuard &) = delete;
+    auto operator=(const QueueGuard &) -> QueueGuard & = delete;
+
+    auto Get() const -> LockRequestQueue * { return queue_; }
+
+   private:
+    LockTablePartition<K> *partition_;
+    K key_;
+    LockRequestQueue *queue_;
+  };
+
+  /**
+   * How deadlocks are dealt with. Transaction ids double as timestamps: a smaller id is an older transaction.
+   *
+   * DETECTION:  waiters block unconditionally; a background thread periodically builds the waits-for graph and
+   *             aborts the youngest transaction of every cycle.
+   * WAIT_DIE:   an older requester waits for younger blockers; a younger requester is aborted (DEADLOCK) at once.
+   * WOUND_WAIT: an older requester aborts ("wounds") younger blockers and waits for them to go away;
+   *             a younger requester waits for older blockers.
+   */
+  enum class DeadlockPolicy { DETECTION, WAIT_DIE, WOUND_WAIT };
+
+  /**
+   * Creates a new lock manager configured for the given deadlock policy.
+   * The cycle detection thread is only started for DeadlockPolicy::DETECTION.
+   */
+  explicit LockManager(DeadlockPolicy deadlock_policy = DeadlockPolicy::DETECTION)
+      : deadlock_policy_(deadlock_policy) {
+    enable_cycle_detection_ = deadlock_policy == DeadlockPolicy::DETECTION;
+    if (enable_cycle_detection_) {
+      cycle_detection_thread_ = new std::thread(&LockManager::RunCycleDetection, this);
+    }
   }
 
   ~LockManager() {
     enable_cycle_detection_ = false;
-    cycle_detection_thread_->join();
-    delete cycle_detection_thread_;
+    if (cycle_detection_thread_ != nullptr) {
+      cycle_detection_thread_->join();
+      delete cycle_detection_thread_;
+    }
   }
 
+  /** @return the deadlock policy of this lock manager */
+  auto GetDeadlockPolicy() const -> DeadlockPolicy { return deadlock_policy_; }
+
+  /**
+   * Set the lock escalation threshold. Once a transaction holds this many row locks on one table, its next
+   * LockRow() on that table takes a table lock instead (S, SIX or X, depending on the row locks held and
+   * requested) and releases all of its row locks on the table. 0 disables lock escalation.
+   * @param threshold the number of row locks per table that triggers escalation
+   */
+  void SetLockEscalationThreshold(size_t threshold) { lock_escalation_threshold_ = threshold; }
+
+  /**
+   * @return the lock counters of this lock manager: requests, waits, wait durations, upgrades and deadlock aborts per
+   * table and per sampled row. Counting is off until GetLockStats()->Enable(true).
+   */
+  auto GetLockStats() -> LockStats * { return &stats_; }
+
   /**
    * [LOCK_NOTE]
    *
@@ -212,6 +303,8 @@ class LockManager {
    * TransactionAbortException under certain circumstances.
    * See [LOCK_NOTE] in header file.
    *
+   * An optimistic transaction never waits: false is returned if the lock cannot be granted right away.
+   *
    * @param txn the transaction requesting the lock upgrade
    * @param lock_mode the lock mode for the requested lock
    * @param oid the table_oid_t of the table to be locked in lock_mode
@@ -241,6 +334,8 @@ class LockManager {
    * TransactionAbortException under certain circumstances.
    * See [LOCK_NOTE] in header file.
    *
+   * An optimistic transaction never waits: false is returned if the lock cannot be granted right away.
+   *
    * @param txn the transaction requesting the lock upgrade
    * @param lock_mode the lock mode for the requested lock
    * @param oid the table_oid_t of the table the row belongs to
@@ -280,6 +375,9 @@ class LockManager {
    */
   auto RemoveEdge(txn_id_t t1, txn_id_t t2) -> void;
 
+  /** @return the number of request queues in the lock table, i.e. of the tables and rows locked or waited for */
+  auto GetQueueCount() -> size_t;
+
   /**
    * Checks if the graph has a cycle, returning the newest transaction ID in the cycle if so.
    * @param[out] txn_id if the graph has a cycle, will contain the newest transaction ID
@@ -298,22 +396,132 @@ class LockManager {
   auto RunCycleDetection() -> void;
 
  private:
+  /** @return a guard pinning the request queue of the table, created if needed */
+  auto PinTableQueue(const table_oid_t &oid) -> QueueGuard<table_oid_t>;
+
+  /** @return a guard pinning the request queue of the row, created if needed */
+  auto PinRowQueue(const RID &rid) -> QueueGuard<RID>;
+
+  /** Wake up the waiters on the request queue of a table (rid is invalid) or of a row. */
+  void NotifyQueue(table_oid_t oid, const RID &rid);
+
+  /** @return the request pool of the transaction, creating it on the first lock request */
+  auto GetRequestPool(Transaction *txn) -> LockRequestPool *;
+
+  /**
+   * Enqueue request (or turn the transaction's granted request into an upgrade) and block until it is granted.
+   * The caller holds the queue latch through `lock`.
+   * @return false if the transaction was aborted while waiting
+   */
+  auto AcquireLock(Transaction *txn, LockRequestQueue *queue, std::unique_lock<std::mutex> *lock,
+                   LockRequest *request) -> bool;
+
+  /** @return true if request is at the head of the waiters and compatible with every granted request */
+  auto Grantable(LockRequestQueue *queue, LockRequest *request) -> bool;
+
+  /** @return the request of txn_id in the queue, or nullptr if it has none */
+  auto FindRequest(LockRequestQueue *queue, txn_id_t txn_id) -> LockRequest *;
+
+  /**
+   * Wait-die: checks whether the requester may wait for the requests that block it.
+   * @return false if an older transaction blocks the request, i.e. the requester has to die
+   */
+  auto CanWait(LockRequestQueue *queue, LockRequest *request) -> bool;
+
+  /**
+   * Wound-wait: aborts every younger transaction that blocks the request and wakes it up wherever it is waiting.
+   * Waking a transaction blocked on another queue requires dropping the latch of this queue.
+   * @return true if the queue latch was released meanwhile, so the caller has to re-check the queue
+   */
+  auto Wound(LockRequestQueue *queue, std::unique_lock<std::mutex> *lock, LockRequest *request) -> bool;
+
+  /** Wound-wait: records the request a transaction is blocked on, or clears it with nullptr. */
+  void SetWaitingOn(txn_id_t txn_id, const LockRequest *request);
+
+  /** Add / remove a granted lock in the lock sets of the transaction. */
+  void BookTableLock(Transaction *txn, LockMode lock_mode, const table_oid_t &oid, bool insert);
+  void BookRowLock(Transaction *txn, LockMode lock_mode, const table_oid_t &oid, const RID &rid, bool insert);
+
+  /** Move the transaction to SHRINKING if releasing a lock in lock_mode requires it. */
+  void UpdateStateOnUnlock(Transaction *txn, LockMode lock_mode);
+
+  /** @return the number of row locks the transaction holds on the table */
+  auto CountRowLocks(Transaction *txn, const table_oid_t &oid) -> size_t;
+
+  /** @return true if the table lock held by the transaction already grants lock_mode on every row of the table */
+  auto TableLockCovers(Transaction *txn, LockMode lock_mode, const table_oid_t &oid) -> bool;
+
+  /**
+   * Replace the row locks of the transaction on the table by a single table lock strong enough for them and for
+   * the requested row lock mode. Releasing the row locks does not move the transaction to SHRINKING.
+   * @return false if the transaction was aborted while waiting for the table lock
+   */
+  auto EscalateRowLocks(Transaction *txn, LockMode lock_mode, const table_oid_t &oid) -> bool;
+
+  /** Check the isolation level and 2PL phase rules for lock_mode, aborting the transaction on violation. */
+  void CheckLockAllowed(Transaction *txn, LockMode lock_mode);
+
+  /** Set the transaction to ABORTED and throw a TransactionAbortException. */
+  [[noreturn]] void AbortImplicitly(Transaction *txn, AbortReason reason);
+
+  static auto AreCompatible(LockMode held, LockMode requested) -> bool;
+  static auto CanUpgrade(LockMode held, LockMode requested) -> bool;
+
   /** Fall 2022 */
-  /** Structure that holds lock requests for a given table oid */
-  std::unordered_map<table_oid_t, LockRequestQueue> table_lock_map_;
-  /** Coordination */
-  std::mutex table_lock_map_latch_;
+  /** Lock table for table oids, partitioned by hash of the oid */
+  std::array<LockTablePartition<table_oid_t>, LOCK_TABLE_PARTITION_NUM> table_lock_map_;
+
+  /** Lock table for RIDs, partitioned by hash of the RID */
+  std::array<LockTablePartition<RID>, LOCK_TABLE_PARTITION_NUM> row_lock_map_;
+
+  /** Number of row locks per table and transaction that triggers lock escalation, 0 if disabled */
+  size_t lock_escalation_threshold_{LOCK_ESCALATION_THRESHOLD};
+
+  /** Deadlock handling policy, fixed at construction */
+  const DeadlockPolicy deadlock_policy_;
 
-  /** Structure that holds lock requests for a given RID */
-  std::unordered_map<RID, LockRequestQueue> row_lock_map_;
-  /** Coordination */
-  std::mutex row_lock_map_latch_;
+  /** Lock contention counters */
+  LockStats stats_;
+
+  /**
+   * Wound-wait: the resource (table oid and row rid, invalid for a table) every blocked transaction waits on, so a
+   * wounded transaction can be woken up
+   */
+  std::unordered_map<txn_id_t, std::pair<table_oid_t, RID>> waiting_on_;
+  std::mutex waiting_on_latch_;
 
   std::atomic<bool> enable_cycle_detection_;
-  std::thread *cycle_detection_thread_;
+  std::thread *cycle_detection_thread_{nullptr};
   /** Waits-for graph representation. */
   std::unordered_map<txn_id_t, std::vector<txn_id_t>> waits_for_;
   std::mutex waits_for_latch_;
 };
 
+/**
+ * LockRequestPool recycles the LockRequest objects of a single transaction. Requests are carved out of a deque,
+ * whose elements never move, and are handed back to a free list on unlock, so a transaction that takes and drops
+ * many locks does not go through the global allocator for each of them.
+ *
+ * The pool is owned by the transaction. Like the lock sets of the transaction, it is only used by the thread that is
+ * currently running the transaction, so it needs no latch of its own.
+ */
+class LockRequestPool {
+ public:
+  /** @return a table lock request for txn_id in lock_mode */
+  auto Acquire(txn_id_t txn_id, LockManager::LockMode lock_mode, table_oid_t oid) -> LockManager::LockRequest *;
+
+  /** @return a row lock request for txn_id in lock_mode */
+  auto Acquire(txn_id_t txn_id, LockManager::LockMode lock_mode, table_oid_t oid, const RID &rid)
+      -> LockManager::LockRequest *;
+
+  /** Return a request that is no longer in any request queue to the pool. */
+  void Release(LockManager::LockRequest *request) { free_list_.push_back(request); }
+
+ private:
+  /** Backing storage of every request ever handed out by this pool */
+  std::deque<LockManager::LockRequest> requests_;
+  /** Requests that can be handed out again */
+  std::vector<LockManager::LockRequest *> free_list_;
+};
+
 }  // namespace bustub
@@ -0,0 +1,114 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lock_stats.h
+//
+// Identification: src/include/concurrency/lock_stats.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "common/config.h"
+#include "common/rid.h"
+
+namespace bustub {
+
+using table_oid_t = uint32_t;
+
+/**
+ * A point-in-time copy of the lock counters of one table or one sampled row.
+ *
+ * wait_histogram_[i] counts the waits that took less than 2^i microseconds (and at least 2^(i-1)); the last bucket
+ * also counts every longer wait.
+ */
+struct LockStatsEntry {
+  table_oid_t oid_;
+  /** Whether the entry is about a row of the table rather than the table itself */
+  bool is_row_;
+  RID rid_;
+  uint64_t requests_;
+  uint64_t waits_;
+  uint64_t upgrades_;
+  uint64_t deadlock_aborts_;
+  uint64_t wait_time_us_;
+  std::array<uint64_t, LOCK_WAIT_HISTOGRAM_BUCKETS> wait_histogram_;
+
+  /** @return an upper bound of the p-th percentile of the wait durations in microseconds, 0 without waits */
+  auto WaitPercentileUs(double p) const -> uint64_t;
+};
+
+/**
+ * LockStats counts lock requests, waits, wait durations, upgrades and deadlock aborts per table, and per row for a
+ * sample of the row lock requests.
+ *
+ * Counting is off by default; while it is off, the lock manager pays one relaxed atomic load per lock request.
+ * Counters are atomics behind a map that is only latched exclusively when a table or row is seen for the first time.
+ * Rows are sampled by request: a row is tracked from the first of its lock requests that is among one in
+ * LOCK_STATS_ROW_SAMPLE_RATE row lock requests, so hot rows show up quickly while the map stays small. Tracked rows
+ * count every later request. At most LOCK_STATS_ROW_CAPACITY rows are tracked; table counters are always exact.
+ */
+class LockStats {
+ public:
+  /** Turn counting on or off. Turning it on starts again from zero. */
+  void Enable(bool enable);
+
+  /** @return whether counting is on */
+  auto IsEnabled() const -> bool { return enabled_.load(std::memory_order_relaxed); }
+
+  /**
+   * Count a lock request.
+   * @param oid the table, or the table of the row
+   * @param rid the row, nullptr for a table lock
+   * @param upgrade whether the request upgrades a lock the transaction already holds
+   */
+  void RecordRequest(table_oid_t oid, const RID *rid, bool upgrade);
+
+  /** Count a request that had to wait, for wait_us microseconds. */
+  void RecordWait(table_oid_t oid, const RID *rid, uint64_t wait_us);
+
+  /** Count a request whose transaction was aborted to prevent or break a deadlock. */
+  void RecordDeadlockAbort(table_oid_t oid, const RID *rid);
+
+  /** @return the counters of every table followed by those of every sampled row */
+  auto Snapshot() -> std::vector<LockStatsEntry>;
+
+ private:
+  struct Counters {
+    std::atomic<uint64_t> requests_{0};
+    std::atomic<uint64_t> waits_{0};
+    std::atomic<uint64_t> upgrades_{0};
+    std::atomic<uint64_t> deadlock_aborts_{0};
+    std::atomic<uint64_t> wait_time_us_{0};
+    std::array<std::atomic<uint64_t>, LOCK_WAIT_HISTOGRAM_BUCKETS> wait_histogram_{};
+  };
+
+  /** @return the counters of the table */
+  auto TableCounters(table_oid_t oid) -> Counters *;
+
+  /** @return the counters of the row, nullptr if the row is not tracked */
+  auto RowCounters(const RID &rid) -> Counters *;
+
+  static void Reset(Counters *counters);
+
+  static auto Copy(const Counters &counters, table_oid_t oid, bool is_row, RID rid) -> LockStatsEntry;
+
+  std::atomic<bool> enabled_{false};
+  std::atomic<uint64_t> row_requests_{0};
+  std::shared_mutex latch_;
+  std::unordered_map<table_oid_t, std::unique_ptr<Counters>> tables_;
+  /** The rows and the table they belong to */
+  std::unordered_map<RID, std::pair<table_oid_t, std::unique_ptr<Counters>>> rows_;
+};
+
+}  // namespace bustub
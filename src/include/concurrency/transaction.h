@@ -19,9 +19,11 @@
 #include <thread>  // NOLINT
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
 
 #include "common/config.h"
 #include "common/logger.h"
+#include "concurrency/undo_buffer.h"
 #include "storage/page/page.h"
 #include "storage/table/tuple.h"
 
@@ -46,8 +48,20 @@ enum class TransactionState { GROWING, SHRINKING, COMMITTED, ABORTED };
 
 /**
  * Transaction isolation level.
+ *
+ * SNAPSHOT_ISOLATION transactions read the versions committed before they began without taking any shared lock;
+ * their writes still take IX/X locks and abort on a write-write conflict with a transaction that committed later.
+ */
+enum class IsolationLevel { READ_UNCOMMITTED, REPEATABLE_READ, READ_COMMITTED, SNAPSHOT_ISOLATION };
+
+/**
+ * Concurrency control scheme of a transaction.
+ *
+ * TWO_PHASE_LOCKING transactions lock through the LockManager as their isolation level requires. OPTIMISTIC
+ * transactions (Silo-style OCC) never lock or block: they record the version word of every tuple they read, buffer
+ * their writes, and validate the reads at commit. Their writes only become visible, also to themselves, on commit.
  */
-enum class IsolationLevel { READ_UNCOMMITTED, REPEATABLE_READ, READ_COMMITTED };
+enum class ConcurrencyControl { TWO_PHASE_LOCKING, OPTIMISTIC };
 
 /**
  * Type of write operation.
@@ -56,6 +70,7 @@ enum class WType { INSERT = 0, DELETE, UPDATE };
 
 class TableHeap;
 class Catalog;
+class LockRequestPool;
 using table_oid_t = uint32_t;
 using index_oid_t = uint32_t;
 
@@ -64,15 +79,15 @@ using index_oid_t = uint32_t;
  */
 class TableWriteRecord {
  public:
-  TableWriteRecord(RID rid, WType wtype, const Tuple &tuple, TableHeap *table)
-      : rid_(rid), wtype_(wtype), tuple_(tuple), table_(table) {}
+  TableWriteRecord(RID rid, WType wtype, TableHeap *table, UndoImage undo = {})
+      : rid_(rid), wtype_(wtype), table_(table), undo_(undo) {}
 
   RID rid_;
   WType wtype_;
-  /** The tuple is only used for the update operation. */
-  Tuple tuple_;
   /** The table heap specifies which table this write record is for. */
   TableHeap *table_;
+  /** The before-image of the changed bytes, only used for the update operation. */
+  UndoImage undo_;
 };
 
 /**
@@ -100,6 +115,53 @@ class IndexWriteRecord {
   Catalog *catalog_;
 };
 
+/**
+ * OptimisticReadRecord remembers the version word of a tuple read by an optimistic transaction.
+ */
+class OptimisticReadRecord {
+ public:
+  OptimisticReadRecord(RID rid, uint64_t version, TableHeap *table) : rid_(rid), version_(version), table_(table) {}
+
+  RID rid_;
+  /** The version word of the tuple when it was read. */
+  uint64_t version_;
+  TableHeap *table_;
+};
+
+/**
+ * OptimisticScanRecord remembers the insert version of a table scanned by an optimistic transaction, so that
+ * tuples inserted into it before the commit (phantoms) fail the validation.
+ */
+class OptimisticScanRecord {
+ public:
+  OptimisticScanRecord(uint64_t version, TableHeap *table) : version_(version), table_(table) {}
+
+  uint64_t version_;
+  TableHeap *table_;
+};
+
+/**
+ * OptimisticWriteRecord is a write buffered by an optimistic transaction until it commits.
+ */
+class OptimisticWriteRecord {
+ public:
+  OptimisticWriteRecord(RID rid, WType wtype, const Tuple &tuple, table_oid_t table_oid, TableHeap *table,
+                        Catalog *catalog)
+      : rid_(rid), wtype_(wtype), tuple_(tuple), table_oid_(table_oid), table_(table), catalog_(catalog) {}
+
+  /** The deleted or updated tuple, unused for inserts. */
+  RID rid_;
+  WType wtype_;
+  /** The inserted tuple, the new image of an updated one, or the deleted one so that its index entries can be found. */
+  Tuple tuple_;
+  /** The tuple an update replaces, so that its index entries can be found. Only used for the update operation. */
+  Tuple old_tuple_;
+  table_oid_t table_oid_;
+  TableHeap *table_;
+  /** The catalog is needed to maintain the indexes of the table. */
+  Catalog *catalog_;
+};
+
 /**
  * Reason to a transaction abortion
  */
@@ -174,10 +236,14 @@ class Transaction {
         ix_table_lock_set_{new std::unordered_set<table_oid_t>},
         six_table_lock_set_{new std::unordered_set<table_oid_t>},
         s_row_lock_set_{new std::unordered_map<table_oid_t, std::unordered_set<RID>>},
-        x_row_lock_set_{new std::unordered_map<table_oid_t, std::unordered_set<RID>>} {
+        x_row_lock_set_{new std::unordered_map<table_oid_t, std::unordered_set<RID>>},
+        escalated_table_set_{new std::unordered_set<table_oid_t>} {
     // Initialize the sets that will be tracked.
     table_write_set_ = std::make_shared<std::deque<TableWriteRecord>>();
     index_write_set_ = std::make_shared<std::deque<IndexWriteRecord>>();
+    optimistic_read_set_ = std::make_shared<std::deque<OptimisticReadRecord>>();
+    optimistic_scan_set_ = std::make_shared<std::deque<OptimisticScanRecord>>();
+    optimistic_write_set_ = std::make_shared<std::deque<OptimisticWriteRecord>>();
     page_set_ = std::make_shared<std::deque<bustub::Page *>>();
     deleted_page_set_ = std::make_shared<std::unordered_set<page_id_t>>();
   }
@@ -195,12 +261,41 @@ class Transaction {
   /** @return the isolation level of this transaction */
   inline auto GetIsolationLevel() const -> IsolationLevel { return isolation_level_; }
 
+  /** @return the concurrency control scheme of this transaction */
+  inline auto GetConcurrencyControl() const -> ConcurrencyControl { return concurrency_control_; }
+
+  /** @param concurrency_control the concurrency control scheme, chosen on TransactionManager::Begin() */
+  inline void SetConcurrencyControl(ConcurrencyControl concurrency_control) {
+    concurrency_control_ = concurrency_control;
+  }
+
+  /** @return true if the transaction runs under optimistic concurrency control */
+  inline auto IsOptimistic() const -> bool { return concurrency_control_ == ConcurrencyControl::OPTIMISTIC; }
+
+  /** @return the tuples read by this optimistic transaction */
+  inline auto GetOptimisticReadSet() -> std::shared_ptr<std::deque<OptimisticReadRecord>> {
+    return optimistic_read_set_;
+  }
+
+  /** @return the tables scanned by this optimistic transaction */
+  inline auto GetOptimisticScanSet() -> std::shared_ptr<std::deque<OptimisticScanRecord>> {
+    return optimistic_scan_set_;
+  }
+
+  /** @return the writes buffered by this optimistic transaction */
+  inline auto GetOptimisticWriteSet() -> std::shared_ptr<std::deque<OptimisticWriteRecord>> {
+    return optimistic_write_set_;
+  }
+
   /** @return the list of table write records of this transaction */
   inline auto GetWriteSet() -> std::shared_ptr<std::deque<TableWriteRecord>> { return table_write_set_; }
 
   /** @return the list of index write records of this transaction */
   inline auto GetIndexWriteSet() -> std::shared_ptr<std::deque<IndexWriteRecord>> { return index_write_set_; }
 
+  /** @return the buffer holding the before-images of the table write set */
+  inline auto GetUndoBuffer() -> UndoBuffer * { return &undo_buffer_; }
+
   /** @return the page set */
   inline auto GetPageSet() -> std::shared_ptr<std::deque<Page *>> { return page_set_; }
 
@@ -304,6 +399,37 @@ class Transaction {
     return six_table_lock_set_->find(oid) != six_table_lock_set_->end();
   }
 
+  /** @return the set of tables whose row locks were escalated to a table lock */
+  inline auto GetEscalatedTableSet() -> std::shared_ptr<std::unordered_set<table_oid_t>> {
+    return escalated_table_set_;
+  }
+
+  /** @return true if the row locks of table oid were escalated to a table lock by this transaction */
+  auto IsTableEscalated(const table_oid_t &oid) -> bool {
+    return escalated_table_set_->find(oid) != escalated_table_set_->end();
+  }
+
+  /** @return the pool that the lock manager allocates this transaction's lock requests from, may be nullptr */
+  inline auto GetLockRequestPool() -> LockRequestPool * { return lock_request_pool_.get(); }
+
+  /**
+   * Set the lock request pool of this transaction.
+   * @param pool the pool, created by the lock manager on the first lock request
+   */
+  inline void SetLockRequestPool(std::shared_ptr<LockRequestPool> pool) { lock_request_pool_ = std::move(pool); }
+
+  /** @return the snapshot timestamp: a snapshot isolation txn sees exactly the versions committed at or before it */
+  inline auto GetReadTs() const -> timestamp_t { return read_ts_; }
+
+  /** @param read_ts the snapshot timestamp, assigned by the transaction manager on Begin() */
+  inline void SetReadTs(timestamp_t read_ts) { read_ts_ = read_ts; }
+
+  /** @return the commit timestamp, valid once the transaction committed */
+  inline auto GetCommitTs() const -> timestamp_t { return commit_ts_; }
+
+  /** @param commit_ts the commit timestamp, assigned by the transaction manager on Commit() */
+  inline void SetCommitTs(timestamp_t commit_ts) { commit_ts_ = commit_ts; }
+
   /** @return the current state of the transaction */
   inline auto GetState() -> TransactionState { return state_; }
 
@@ -340,8 +466,20 @@ class Transaction {
   std::shared_ptr<std::deque<TableWriteRecord>> table_write_set_;
   /** The undo set of indexes. */
   std::shared_ptr<std::deque<IndexWriteRecord>> index_write_set_;
+  /** The before-images referenced by the table write set. */
+  UndoBuffer undo_buffer_;
   /** The LSN of the last record written by the transaction. */
   lsn_t prev_lsn_;
+  /** The concurrency control scheme of the transaction. */
+  ConcurrencyControl concurrency_control_{ConcurrencyControl::TWO_PHASE_LOCKING};
+  /** OCC: the tuples read, the tables scanned and the buffered writes. */
+  std::shared_ptr<std::deque<OptimisticReadRecord>> optimistic_read_set_;
+  std::shared_ptr<std::deque<OptimisticScanRecord>> optimistic_scan_set_;
+  std::shared_ptr<std::deque<OptimisticWriteRecord>> optimistic_write_set_;
+  /** MVCC: the snapshot this transaction reads. */
+  timestamp_t read_ts_{0};
+  /** MVCC: the timestamp the writes of this transaction become visible at. */
+  timestamp_t commit_ts_{0};
 
   std::mutex latch_;
 
@@ -365,6 +503,11 @@ class Transaction {
   /** LockManager: the set of row locks held by this transaction. */
   std::shared_ptr<std::unordered_map<table_oid_t, std::unordered_set<RID>>> s_row_lock_set_;
   std::shared_ptr<std::unordered_map<table_oid_t, std::unordered_set<RID>>> x_row_lock_set_;
+  /** LockManager: the tables whose row locks were replaced by a table S/SIX/X lock (lock escalation). */
+  std::shared_ptr<std::unordered_set<table_oid_t>> escalated_table_set_;
+
+  /** LockManager: recycled lock request objects of this transaction. */
+  std::shared_ptr<LockRequestPool> lock_request_pool_;
 };
 
 }  // namespace bustub
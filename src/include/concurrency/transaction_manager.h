@@ -12,10 +12,17 @@
 
 #pragma once
 
+#include <algorithm>
+#include <array>
 #include <atomic>
+#include <limits>
+#include <mutex>  // NOLINT
+#include <set>
 #include <shared_mutex>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
+#include <vector>
 
 #include "common/config.h"
 #include "concurrency/lock_manager.h"
@@ -24,6 +31,8 @@
 
 namespace bustub {
 class LockManager;
+struct IndexInfo;
+struct TableInfo;
 
 /**
  * TransactionManager keeps track of all the transactions running in the system.
@@ -39,16 +48,19 @@ class TransactionManager {
    * Begins a new transaction.
    * @param txn an optional transaction object to be initialized, otherwise a new transaction is created.
    * @param isolation_level an optional isolation level of the transaction.
+   * @param concurrency_control an optional concurrency control scheme of the transaction.
    * @return an initialized transaction
    */
-  auto Begin(Transaction *txn = nullptr, IsolationLevel isolation_level = IsolationLevel::REPEATABLE_READ)
-      -> Transaction *;
+  auto Begin(Transaction *txn = nullptr, IsolationLevel isolation_level = IsolationLevel::REPEATABLE_READ,
+             ConcurrencyControl concurrency_control = ConcurrencyControl::TWO_PHASE_LOCKING) -> Transaction *;
 
   /**
-   * Commits a transaction.
+   * Commits a transaction. An optimistic transaction first validates its reads and installs its buffered writes;
+   * if the validation fails, it is aborted instead.
    * @param txn the transaction to commit
+   * @return true if the transaction committed, false if it failed the validation and was aborted
    */
-  void Commit(Transaction *txn);
+  auto Commit(Transaction *txn) -> bool;
 
   /**
    * Aborts a transaction
@@ -60,30 +72,133 @@ class TransactionManager {
    * Global list of running transactions
    */
 
-  /** The transaction map is a global list of all the running transactions in the system. */
-  static std::unordered_map<txn_id_t, Transaction *> txn_map;
-  static std::shared_mutex txn_map_mutex;
+  /** One independently latched partition of the transaction map, padded so partitions do not share cache lines. */
+  struct alignas(64) TxnMapPartition {
+    std::shared_mutex latch_;
+    std::unordered_map<txn_id_t, Transaction *> map_;
+  };
+
+  /**
+   * The transaction map is a global list of all the running transactions in the system. It is partitioned by
+   * transaction id, so that transactions beginning and ending on different threads rarely share a latch.
+   */
+  static std::array<TxnMapPartition, TXN_MAP_PARTITION_NUM> txn_map;
 
   /**
    * Locates and returns the transaction with the given transaction ID.
-   * @param txn_id the id of the transaction to be found, it must exist!
-   * @return the transaction with the given transaction id
+   * @param txn_id the id of the transaction to be found
+   * @return the transaction with the given transaction id, nullptr if it has already committed or aborted
    */
   static auto GetTransaction(txn_id_t txn_id) -> Transaction * {
-    std::shared_lock<std::shared_mutex> l(TransactionManager::txn_map_mutex);
-    assert(TransactionManager::txn_map.find(txn_id) != TransactionManager::txn_map.end());
-    auto *res = TransactionManager::txn_map[txn_id];
-    assert(res != nullptr);
-    return res;
+    auto &partition = TxnMapPartitionOf(txn_id);
+    std::shared_lock<std::shared_mutex> l(partition.latch_);
+    auto it = partition.map_.find(txn_id);
+    return it == partition.map_.end() ? nullptr : it->second;
   }
 
+  /**
+   * Add the index entry of a tuple txn inserted and record it in the index write set of txn. The entries of deleted
+   * tuples stay until their slots are freed, so a unique index may still hold the key for a tuple whose delete is
+   * committed or was done by txn itself; that entry is replaced, and a snapshot reading the deleted tuple can no
+   * longer reach it through this index.
+   * @param txn the inserting transaction
+   * @param table_info the table the tuple was inserted into
+   * @param index_info the index to add the entry to
+   * @param tuple the inserted tuple
+   * @param rid the rid of the inserted tuple
+   * @param catalog the catalog holding the table and the index
+   */
+  static void InsertIndexEntry(Transaction *txn, const TableInfo *table_info, IndexInfo *index_info,
+                               const Tuple &tuple, const RID &rid, Catalog *catalog);
+
   /** Prevents all transactions from performing operations, used for checkpointing. */
   void BlockAllTransactions();
 
   /** Resumes all transactions, used for checkpointing. */
   void ResumeTransactions();
 
+  /** @return the commit timestamp of the most recently committed transaction, i.e. of the last closed epoch */
+  auto GetLastCommitTs() const -> timestamp_t { return last_commit_ts_.load(); }
+
+  /**
+   * @return the oldest snapshot timestamp that is still or may soon be read. Versions committed at or before the
+   * watermark are visible to every running and every future transaction.
+   */
+  auto GetWatermark() -> timestamp_t {
+    std::scoped_lock<std::mutex> lock(ts_latch_);
+    return std::min(WatermarkUnlocked(), last_commit_ts_.load());
+  }
+
+  /**
+   * Hand the committed deletes that no running snapshot can see anymore over to the caller, which frees their slots.
+   * Deletes that are invisible to everyone at commit time are applied by Commit() itself; the others are deferred
+   * until the vacuum picks them up here.
+   * @return the tables and RIDs of the deleted tuples
+   */
+  auto TakeDeferredDeletes() -> std::vector<std::pair<TableHeap *, RID>>;
+
  private:
+  /** A delete committed while some running snapshot still sees the deleted tuple. */
+  struct DeferredDelete {
+    TableHeap *table_;
+    RID rid_;
+    timestamp_t commit_ts_;
+  };
+
+  /**
+   * Silo-style commit protocol of an optimistic transaction: claim the tuples it writes, validate its reads and
+   * scans, then install the buffered writes. Nothing ever waits; a claim or validation that fails aborts txn.
+   * @return false if txn failed and must be aborted
+   */
+  auto ValidateAndInstall(Transaction *txn) -> bool;
+
+  /**
+   * Take the 2PL locks a write of an optimistic transaction needs, without waiting for them.
+   * @return false if a 2PL transaction holds a conflicting lock
+   */
+  auto LockForInstall(Transaction *txn, const OptimisticWriteRecord &item) -> bool;
+
+  static auto TxnMapPartitionOf(txn_id_t txn_id) -> TxnMapPartition & {
+    return txn_map[static_cast<uint32_t>(txn_id) % TXN_MAP_PARTITION_NUM];
+  }
+
+  /** Remove a committed or aborted transaction from the transaction map. */
+  static void UnregisterTransaction(txn_id_t txn_id) {
+    auto &partition = TxnMapPartitionOf(txn_id);
+    std::unique_lock<std::shared_mutex> l(partition.latch_);
+    partition.map_.erase(txn_id);
+  }
+
+  /**
+   * Join the open commit epoch. The epoch is re-read after registering, so a committer never lands in an epoch
+   * that is already being closed.
+   * @return the open epoch, which is the commit timestamp of the caller
+   */
+  auto EnterEpoch() -> timestamp_t {
+    while (true) {
+      timestamp_t epoch = epoch_.load();
+      epoch_committers_[epoch % 2]++;
+      if (epoch_.load() == epoch) {
+        return epoch;
+      }
+      epoch_committers_[epoch % 2]--;
+    }
+  }
+
+  /**
+   * Wait until the epoch commit_ts has been closed, after which every new snapshot sees it. The first committer to
+   * get here closes the epoch on behalf of the whole group.
+   */
+  void CloseEpoch(timestamp_t commit_ts);
+
+  /** @return the oldest snapshot timestamp of the running transactions, ts_latch_ must be held */
+  auto WatermarkUnlocked() const -> timestamp_t {
+    return active_read_ts_.empty() ? std::numeric_limits<timestamp_t>::max() : *active_read_ts_.begin();
+  }
+
+  /** Drop the index entry recorded by a delete, right before the slot of the deleted tuple is freed. */
+  static void DropIndexEntry(const IndexWriteRecord &record, Transaction *txn);
+
   /**
    * Releases all the locks held by the given transaction.
    * @param txn the transaction whose locks should be released
@@ -135,6 +250,26 @@ class TransactionManager {
   }
 
   std::atomic<txn_id_t> next_txn_id_{0};
+
+  /**
+   * Commit timestamps are handed out by epoch: every transaction that commits while epoch e is open gets commit
+   * timestamp e. Closing an epoch opens the next one, waits for the committers of the closed one to finish stamping
+   * their versions and then publishes it as last_commit_ts_, which is what new snapshots read.
+   */
+  std::atomic<timestamp_t> epoch_{1};
+  /** Number of committers still stamping versions, indexed by the parity of their epoch */
+  std::array<std::atomic<uint32_t>, 2> epoch_committers_{};
+  /** Held by the committer that closes an epoch */
+  std::mutex epoch_latch_;
+  /** The most recently closed epoch; everything committed at or before it is visible to new snapshots */
+  std::atomic<timestamp_t> last_commit_ts_{0};
+  /** Protects active_read_ts_ and deferred_deletes_ */
+  std::mutex ts_latch_;
+  /** Snapshot timestamps of the running snapshot isolation transactions */
+  std::multiset<timestamp_t> active_read_ts_;
+  /** Deletes that the vacuum applies once the watermark passes their commit timestamp */
+  std::vector<DeferredDelete> deferred_deletes_;
+
   LockManager *lock_manager_ __attribute__((__unused__));
   LogManager *log_manager_ __attribute__((__unused__));
 
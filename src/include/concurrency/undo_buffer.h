@@ -0,0 +1,89 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// undo_buffer.h
+//
+// Identification: src/include/concurrency/undo_buffer.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+class UndoBuffer;
+
+/**
+ * The before-image of the bytes an update changed in a tuple. The bytes live in the UndoBuffer of the transaction.
+ *
+ * If the update kept the size of the tuple, only the range between the first and the last changed byte is kept and
+ * offset_ is where it starts in the tuple. Otherwise data_ holds the whole old tuple and offset_ is 0.
+ */
+struct UndoImage {
+  const char *data_{nullptr};
+  uint32_t offset_{0};
+  uint32_t size_{0};
+  /** Size of the whole old tuple */
+  uint32_t tuple_size_{0};
+
+  /**
+   * Build the undo image of an update.
+   * @param buffer where the before-image is copied to
+   * @param old_data the old tuple
+   * @param old_size the size of the old tuple
+   * @param new_data the new tuple
+   * @param new_size the size of the new tuple
+   */
+  static auto Diff(UndoBuffer *buffer, const char *old_data, uint32_t old_size, const char *new_data,
+                   uint32_t new_size) -> UndoImage;
+};
+
+/**
+ * UndoBuffer is a per-transaction bump allocator for undo images. Copies are appended to fixed-size chunks that are
+ * never moved, so the pointers it hands out stay valid until the buffer is cleared when the transaction ends.
+ */
+class UndoBuffer {
+ public:
+  UndoBuffer() = default;
+  ~UndoBuffer() = default;
+
+  DISALLOW_COPY(UndoBuffer);
+
+  /**
+   * Copy size bytes into the buffer.
+   * @return the copy, valid until Clear()
+   */
+  auto Append(const char *data, uint32_t size) -> const char *;
+
+  /**
+   * Drop every copy. The first chunk is kept for the next transaction that reuses the buffer, unless it was allocated
+   * for a copy larger than UNDO_BUFFER_CHUNK_SIZE.
+   */
+  void Clear();
+
+  /** @return the number of bytes handed out since the last Clear() */
+  auto Size() const -> size_t { return size_; }
+
+ private:
+  struct Chunk {
+    std::unique_ptr<char[]> data_;
+    size_t capacity_;
+  };
+
+  std::vector<Chunk> chunks_;
+  /** Bytes used in the last chunk */
+  size_t used_{0};
+  size_t size_{0};
+};
+
+}  // namespace bustub
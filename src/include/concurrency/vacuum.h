@@ -0,0 +1,97 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// vacuum.h
+//
+// Identification: src/include/concurrency/vacuum.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <condition_variable>  // NOLINT
+#include <mutex>  // NOLINT
+#include <shared_mutex>
+#include <thread>  // NOLINT
+
+#include "catalog/catalog.h"
+#include "concurrency/transaction_manager.h"
+
+namespace bustub {
+
+/** What one or more vacuum passes reclaimed. */
+struct VacuumStats {
+  /** Slots of deleted tuples that were freed */
+  size_t reclaimed_slots_{0};
+  /** Index entries of the deleted tuples that were removed */
+  size_t removed_index_entries_{0};
+  /** Bytes returned to the table pages and to the version stores */
+  size_t reclaimed_bytes_{0};
+
+  auto operator+=(const VacuumStats &other) -> VacuumStats & {
+    reclaimed_slots_ += other.reclaimed_slots_;
+    removed_index_entries_ += other.removed_index_entries_;
+    reclaimed_bytes_ += other.reclaimed_bytes_;
+    return *this;
+  }
+};
+
+/**
+ * Vacuum garbage collects what the running transactions can no longer see.
+ *
+ * A delete committed while a snapshot that still sees the tuple is running only marks the tuple deleted;
+ * TransactionManager defers it until the watermark passes its commit timestamp. Each vacuum pass frees the slots of
+ * those tuples, removes any index entry still pointing at them, prunes the version chains below the watermark and
+ * shrinks the slot arrays of the table pages.
+ */
+class Vacuum {
+ public:
+  /**
+   * @param catalog the catalog whose tables are vacuumed
+   * @param txn_manager the transaction manager that tracks the running snapshots and the deferred deletes
+   * @param catalog_lock optional latch guarding the catalog, held in shared mode during a pass
+   */
+  Vacuum(Catalog *catalog, TransactionManager *txn_manager, std::shared_mutex *catalog_lock = nullptr)
+      : catalog_(catalog), txn_manager_(txn_manager), catalog_lock_(catalog_lock) {}
+
+  ~Vacuum() { StopVacuumThread(); }
+
+  /** Run a vacuum pass every vacuum_interval in the background. */
+  void StartVacuumThread();
+
+  /** Stop the background thread, waiting for the pass in progress. */
+  void StopVacuumThread();
+
+  /**
+   * Run one vacuum pass.
+   * @return what this pass reclaimed
+   */
+  auto RunOnce() -> VacuumStats;
+
+  /** @return the total of all passes so far */
+  auto GetStats() -> VacuumStats {
+    std::scoped_lock<std::mutex> lock(stats_latch_);
+    return total_stats_;
+  }
+
+ private:
+  Catalog *catalog_;
+  TransactionManager *txn_manager_;
+  std::shared_mutex *catalog_lock_;
+
+  bool enable_vacuum_{false};
+  std::thread *vacuum_thread_{nullptr};
+  /** Protects enable_vacuum_ and wakes the background thread up when it is stopped */
+  std::mutex thread_latch_;
+  std::condition_variable thread_cv_;
+
+  /** Serializes the passes of the background thread and of RunOnce() callers */
+  std::mutex pass_latch_;
+  std::mutex stats_latch_;
+  VacuumStats total_stats_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,128 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// adaptive_radix_tree.h
+//
+// Identification: src/include/container/art/adaptive_radix_tree.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "common/config.h"
+#include "common/rid.h"
+
+namespace bustub {
+
+struct ARTNode;
+struct ARTInnerNode;
+struct ARTLeaf;
+
+/**
+ * AdaptiveRadixTree is an in-memory adaptive radix tree (Leis et al., "The Adaptive Radix Tree: ARTful Indexing for
+ * Main-Memory Databases") that maps binary-comparable keys of a fixed size to RIDs. A key may hold several RIDs.
+ *
+ * Inner nodes branch on one key byte and come in four sizes, with room for 4, 16, 48 and 256 children; a node grows
+ * into the next size when it is full and shrinks when few children are left. The bytes all keys below a node share
+ * are kept in the node (path compression), so that a node that would have a single child does not exist. Since all
+ * keys are equally long, no key is a prefix of another and every leaf hangs off the byte that tells its key apart.
+ *
+ * Concurrency follows optimistic lock coupling (Leis et al., "The ART of Practical Synchronization"). Every inner
+ * node carries a version; a reader notes it, reads the node without a latch and only uses what it read if the
+ * version is still the same afterwards, otherwise it restarts from the root. A writer upgrades the version of the
+ * nodes it changes to a lock, at most the node and its parent, and bumps the version when it is done. Leaves are
+ * never changed in place: a writer builds a new leaf and swaps it in. Nodes that were replaced are freed once no
+ * operation that started before may still read them (epoch based reclamation).
+ */
+class AdaptiveRadixTree {
+ public:
+  /**
+   * @param key_size the size of every key, in bytes, at most ART_MAX_KEY_SIZE
+   */
+  explicit AdaptiveRadixTree(size_t key_size);
+
+  ~AdaptiveRadixTree();
+
+  AdaptiveRadixTree(const AdaptiveRadixTree &) = delete;
+  auto operator=(const AdaptiveRadixTree &) -> AdaptiveRadixTree & = delete;
+
+  /**
+   * Add a RID to a key.
+   * @param key the key, key_size bytes
+   * @param rid the RID
+   * @param unique whether a key holds a single RID
+   * @return false if the key already holds the RID, or any RID when unique
+   */
+  auto Insert(const uint8_t *key, const RID &rid, bool unique) -> bool;
+
+  /**
+   * Remove a RID from a key.
+   * @return false if the key does not hold the RID
+   */
+  auto Remove(const uint8_t *key, const RID &rid) -> bool;
+
+  /**
+   * Append the RIDs of a key to result.
+   * @return whether the key holds any RID
+   */
+  auto GetValue(const uint8_t *key, std::vector<RID> *result) -> bool;
+
+  /** @return the size of every key, in bytes */
+  auto GetKeySize() const -> size_t { return key_size_; }
+
+ private:
+  /** Marks the thread as being inside an operation that may read nodes, for as long as it lives */
+  class EpochGuard {
+   public:
+    explicit EpochGuard(AdaptiveRadixTree *tree);
+    ~EpochGuard();
+
+   private:
+    std::atomic<uint64_t> *slot_;
+  };
+
+  /** One attempt at an operation, they return false when the attempt must restart */
+  auto TryInsert(const uint8_t *key, const RID &rid, bool unique, bool *inserted) -> bool;
+  auto TryRemove(const uint8_t *key, const RID &rid, bool *removed) -> bool;
+  auto TryGetValue(const uint8_t *key, std::vector<RID> *result, bool *found) -> bool;
+
+  /** Build a leaf of key holding rids */
+  auto MakeLeaf(const uint8_t *key, std::vector<RID> rids) const -> ARTLeaf *;
+
+  /** Free a node that was unlinked from the tree once no operation may read it anymore */
+  void Retire(ARTNode *node);
+
+  /** Free a node and everything below it, without latching */
+  static void FreeSubtree(ARTNode *node);
+
+  /** The size of every key, in bytes */
+  const size_t key_size_;
+  /** The root, a node with room for 256 children that is never replaced */
+  ARTInnerNode *root_;
+
+  /** The epoch an operation started in, per thread slot; 0 while no operation runs in the slot */
+  struct alignas(64) EpochSlot {
+    std::atomic<uint64_t> epoch_{0};
+  };
+  std::array<EpochSlot, ART_EPOCH_SLOTS> epoch_slots_;
+  /** The current epoch, it advances whenever retired nodes are reclaimed */
+  std::atomic<uint64_t> global_epoch_{1};
+  /** Protects retired_ */
+  std::mutex retired_latch_;
+  /** The nodes waiting to be freed, with the epoch they were unlinked in */
+  std::vector<std::pair<uint64_t, ARTNode *>> retired_;
+  /** The number of waiting nodes that makes the next retirement try to free them */
+  size_t reclaim_threshold_{ART_RECLAIM_BATCH};
+};
+
+}  // namespace bustub
@@ -19,19 +19,34 @@
 #include "buffer/buffer_pool_manager.h"
 #include "concurrency/transaction.h"
 #include "container/hash/hash_function.h"
+#include "storage/page/page.h"
 #include "storage/page/hash_table_bucket_page.h"
 #include "storage/page/hash_table_directory_page.h"
+#include "storage/page/hash_table_fingerprint_bucket_page.h"
 
 namespace bustub {
 
-#define HASH_TABLE_TYPE DiskExtendibleHashTable<KeyType, ValueType, KeyComparator>
+#define HASH_TABLE_TYPE DiskExtendibleHashTable<KeyType, ValueType, KeyComparator, BucketPage>
 
 /**
  * Implementation of extendible hash table that is backed by a buffer pool
  * manager. Non-unique keys are supported. Supports insert and delete. The
  * table grows/shrinks dynamically as buckets become full/empty.
+ *
+ * Concurrency: the latch of the directory page stands for the directory, and
+ * is always taken before the latch of a bucket page. Lookups, inserts and
+ * removes read-latch the directory and latch only their bucket page, a read
+ * latch for a lookup and a write latch for a change, so that operations on
+ * different buckets run in parallel. An insert into a full bucket or a remove
+ * that empties one lets go of both latches and retries under the write latch
+ * of the directory (SplitInsert, Merge), which no other operation can hold a
+ * bucket latch under, so splits and merges take no bucket latches.
+ *
+ * The buckets are HashTableBucketPage by default, HashTableFingerprintBucketPage
+ * keeps a fingerprint of every key to probe fewer of them.
  */
-template <typename KeyType, typename ValueType, typename KeyComparator>
+template <typename KeyType, typename ValueType, typename KeyComparator,
+          typename BucketPage = HASH_TABLE_BUCKET_TYPE>
 class DiskExtendibleHashTable {
  public:
   /**
@@ -122,22 +137,32 @@ class DiskExtendibleHashTable {
   auto KeyToPageId(KeyType key, HashTableDirectoryPage *dir_page) -> page_id_t;
 
   /**
-   * Fetches the directory page from the buffer pool manager.
+   * Fetches the directory page from the buffer pool manager. The page is pinned, not latched.
    *
    * @return a pointer to the directory page
    */
-  auto FetchDirectoryPage() -> HashTableDirectoryPage *;
+  auto FetchDirectoryPage() -> Page *;
 
   /**
-   * Fetches the a bucket page from the buffer pool manager using the bucket's page_id.
+   * Fetches the a bucket page from the buffer pool manager using the bucket's page_id. The page is pinned, not
+   * latched.
    *
    * @param bucket_page_id the page_id to fetch
    * @return a pointer to a bucket page
    */
-  auto FetchBucketPage(page_id_t bucket_page_id) -> HASH_TABLE_BUCKET_TYPE *;
+  auto FetchBucketPage(page_id_t bucket_page_id) -> Page *;
+
+  /** @return the directory stored in a page */
+  static auto AsDirectory(Page *page) -> HashTableDirectoryPage * {
+    return reinterpret_cast<HashTableDirectoryPage *>(page->GetData());
+  }
+
+  /** @return the bucket stored in a page */
+  static auto AsBucket(Page *page) -> BucketPage * { return reinterpret_cast<BucketPage *>(page->GetData()); }
 
   /**
-   * Performs insertion with an optional bucket splitting.
+   * Performs insertion with an optional bucket splitting. Takes the write latch of the directory, and splits the
+   * bucket of the key until the pair fits or the directory cannot grow anymore.
    *
    * @param transaction a pointer to the current transaction
    * @param key the key to insert
@@ -148,13 +173,16 @@ class DiskExtendibleHashTable {
 
   /**
    * Optionally merges an empty bucket into it's pair.  This is called by Remove,
-   * if Remove makes a bucket empty.
+   * if Remove makes a bucket empty. The merged bucket is merged again the same
+   * way with its own pair, for as long as one of the two is empty.
    *
    * There are three conditions under which we skip the merge:
-   * 1. The bucket is no longer empty.
+   * 1. Neither the bucket nor its split image is empty.
    * 2. The bucket has local depth 0.
    * 3. The bucket's local depth doesn't match its split image's local depth.
    *
+   * Takes the write latch of the directory, and shrinks the directory while it can.
+   *
    * @param transaction a pointer to the current transaction
    * @param key the key that was removed
    * @param value the value that was removed
@@ -165,9 +193,6 @@ class DiskExtendibleHashTable {
   page_id_t directory_page_id_;
   BufferPoolManager *buffer_pool_manager_;
   KeyComparator comparator_;
-
-  // Readers includes inserts and removes, writers are splits and merges
-  ReaderWriterLatch table_latch_;
   HashFunction<KeyType> hash_fn_;
 };
 
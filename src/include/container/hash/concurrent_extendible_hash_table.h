@@ -0,0 +1,152 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// concurrent_extendible_hash_table.h
+//
+// Identification: src/include/container/hash/concurrent_extendible_hash_table.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+/**
+ * concurrent_extendible_hash_table.h
+ *
+ * Implementation of in-memory hash table using extendible hashing, for many threads at once
+ */
+
+#pragma once
+
+#include <memory>
+#include <mutex>  // NOLINT
+#include <shared_mutex>
+#include <vector>
+
+#include "container/hash/hash_table.h"
+
+namespace bustub {
+
+/**
+ * ConcurrentExtendibleHashTable is an ExtendibleHashTable that lets operations on different buckets, and lookups in
+ * the same bucket, run at the same time.
+ *
+ * Every operation holds the directory latch shared for as long as it runs, and the latch of its bucket: shared to
+ * look a key up, exclusive to change the bucket. Only an insert that finds its bucket full takes the directory latch
+ * exclusively; then no other operation runs, and it splits the bucket, and doubles the directory if it has to,
+ * without any bucket latch.
+ *
+ * A bucket is a flat array of slots instead of a list. A key goes into the first free slot from a home position
+ * picked by its hash (linear probing); a removal moves the keys behind it back, so that a lookup stops at the first
+ * free slot. The array has about twice as many slots as the bucket holds keys, which keeps the probes short.
+ *
+ * @tparam K key type
+ * @tparam V value type
+ */
+template <typename K, typename V>
+class ConcurrentExtendibleHashTable : public HashTable<K, V> {
+ public:
+  /**
+   * @brief Create a new ConcurrentExtendibleHashTable.
+   * @param bucket_size: fixed size for each bucket
+   */
+  explicit ConcurrentExtendibleHashTable(size_t bucket_size);
+
+  /** @return The global depth of the directory. */
+  auto GetGlobalDepth() const -> int;
+
+  /** @return The local depth of the bucket that the given directory index points to. */
+  auto GetLocalDepth(int dir_index) const -> int;
+
+  /** @return The number of buckets in the directory. */
+  auto GetNumBuckets() const -> int;
+
+  /**
+   * @brief Find the value associated with the given key.
+   * @param key The key to be searched.
+   * @param[out] value The value associated with the key.
+   * @return True if the key is found, false otherwise.
+   */
+  auto Find(const K &key, V &value) -> bool override;
+
+  /**
+   * @brief Insert the given key-value pair into the hash table. If a key already exists, the value is updated. A full
+   * bucket is split, and the directory doubled if the bucket is as deep as it, until the key fits.
+   */
+  void Insert(const K &key, const V &value) override;
+
+  /**
+   * @brief Given the key, remove the corresponding key-value pair in the hash table.
+   * @return True if the key exists, false otherwise.
+   */
+  auto Remove(const K &key) -> bool override;
+
+  /**
+   * A bucket of the directory: an open-addressed array of slots, with linear probing.
+   */
+  class Bucket {
+   public:
+    Bucket(size_t size, int depth);
+
+    /** @brief Check if a bucket is full. */
+    inline auto IsFull() const -> bool { return count_ == size_; }
+
+    /** @brief Get the local depth of the bucket. */
+    inline auto GetDepth() const -> int { return depth_; }
+
+    /** @brief Increment the local depth of a bucket. */
+    inline void IncrementDepth() { depth_++; }
+
+    /** @return the value of the key with the given hash, nullptr if the bucket does not have it */
+    auto Find(const K &key, size_t hash) -> V *;
+
+    /** @return True if the key existed */
+    auto Remove(const K &key, size_t hash) -> bool;
+
+    /**
+     * @brief Insert the pair, or update the value if the key exists.
+     * @return False if the key is new and the bucket is full.
+     */
+    auto Insert(const K &key, const V &value, size_t hash) -> bool;
+
+    /** @brief Move the pairs whose hash has the given bit set into sibling. */
+    void MoveTo(Bucket *sibling, size_t bit);
+
+    /** Held shared to look a key up, exclusively to change the bucket */
+    std::shared_mutex latch_;
+
+   private:
+    struct Slot {
+      bool used_{false};
+      size_t hash_;
+      K key_;
+      V value_;
+    };
+
+    /** @return the slot a hash starts probing at */
+    inline auto Home(size_t hash) const -> size_t { return (hash * 0x9E3779B97F4A7C15ULL) >> (64 - slot_bits_); }
+
+    /** The number of pairs the bucket holds at most */
+    size_t size_;
+    int depth_;
+    /** The number of pairs the bucket holds */
+    size_t count_{0};
+    /** log2 of the number of slots */
+    int slot_bits_;
+    std::vector<Slot> slots_;
+  };
+
+ private:
+  /** @return the directory index of a hash, the directory latch must be held */
+  inline auto IndexOf(size_t hash) const -> size_t { return hash & ((size_t{1} << global_depth_) - 1); }
+
+  /** @brief Split a full bucket, the directory latch must be held exclusively. */
+  void RedistributeBucket(const std::shared_ptr<Bucket> &bucket);
+
+  int global_depth_;     // The global depth of the directory
+  size_t bucket_size_;   // The size of a bucket
+  int num_buckets_;      // The number of buckets in the hash table
+  mutable std::shared_mutex dir_latch_;        // Held shared by every operation, exclusively to change the directory
+  std::vector<std::shared_ptr<Bucket>> dir_;  // The directory of the hash table
+};
+
+}  // namespace bustub
@@ -67,6 +67,12 @@ class ExtendibleHashTable : public HashTable<K, V> {
    */
   auto GetNumBuckets() const -> int;
 
+  /**
+   * @brief Estimate the memory held by the directory, the buckets and their pairs.
+   * @return The estimated number of bytes.
+   */
+  auto GetMemoryUsage() const -> size_t;
+
   /**
    *
    * TODO(P1): Add implementation, Finished
@@ -104,7 +110,8 @@ class ExtendibleHashTable : public HashTable<K, V> {
    * TODO(P1): Add implementation
    *
    * @brief Given the key, remove the corresponding key-value pair in the hash table.
-   * Shrink & Combination is not required for this project
+   * A bucket left empty is merged into its split image if both have the same local depth, and the directory is
+   * halved while no bucket is as deep as it, so that the table shrinks back after a spike of keys.
    * @param key The key to be deleted.
    * @return True if the key exists, false otherwise.
    */
@@ -127,6 +134,12 @@ class ExtendibleHashTable : public HashTable<K, V> {
 
     /** @brief Increment the local depth of a bucket. */
     inline void IncrementDepth() { depth_++; }
+
+    /** @brief Decrement the local depth of a bucket. */
+    inline void DecrementDepth() { depth_--; }
+
+    /** @brief Check if a bucket is empty. */
+    inline auto IsEmpty() const -> bool { return list_.empty(); }
     // get elements in bucket, Return the array of pairs
     inline auto GetItems() -> std::list<std::pair<K, V>> & { return list_; }
 
@@ -189,13 +202,18 @@ class ExtendibleHashTable : public HashTable<K, V> {
   // The following functions are completely optional, you can delete them if you have your own ideas.
 
   /**
-   * @brief Redistribute the kv pairs in a full bucket.
+   * @brief Split a full bucket: increment its local depth, point half of its directory entries to a new bucket and
+   * redistribute the kv pairs between the two.
    * @param bucket The bucket to be redistributed.
    */
   auto RedistributeBucket(std::shared_ptr<Bucket> bucket) -> void;
 
-  // 进行 dir index ==> bucket 的重新映射之后进行 hash
-  auto RedistributeBucket1(std::list<std::pair<K, V>> &list) -> void;
+  /**
+   * @brief Merge the bucket at the given directory index with its split image while one of the two is empty and both
+   * have the same local depth, then halve the directory while every bucket is shallower than it.
+   * @param dir_index The directory index of a bucket that a pair was removed from.
+   */
+  auto MergeBucket(size_t dir_index) -> void;
 
   /*****************************************************************
    * Must acquire latch_ first before calling the below functions. *
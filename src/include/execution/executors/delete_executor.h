@@ -58,7 +58,13 @@ class DeleteExecutor : public AbstractExecutor {
  private:
   /** The delete plan node to be executed */
   const DeletePlanNode *plan_;
+  /** Metadata identifying the table that should be deleted from */
+  const TableInfo *table_info_;
   /** The child executor from which RIDs for deleted tuples are pulled */
   std::unique_ptr<AbstractExecutor> child_executor_;
+  /** The indexes that are maintained along with the table */
+  std::vector<IndexInfo *> indexes_;
+  /** Whether the number of deleted rows has been produced */
+  bool done_{false};
 };
 }  // namespace bustub
@@ -14,16 +14,25 @@
 
 #include <vector>
 
+#include "catalog/catalog.h"
 #include "common/rid.h"
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
 #include "execution/plans/index_scan_plan.h"
+#include "storage/index/b_plus_tree_index.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
 
 /**
- * IndexScanExecutor executes an index scan over a table.
+ * IndexScanExecutor executes an index scan over a table. It reads the rids of the plan's key range in key order
+ * first and then the tuples, so that no leaf latch is held while it waits for a row lock.
+ *
+ * An index-only scan reads the entries of the range along with the rids and yields them as they are, without
+ * fetching a single tuple. Under a snapshot it cannot tell which version of a row the transaction sees from the
+ * index, so it reads the tuples after all and yields their entries.
+ *
+ * An ART index is only scanned for a single key, which it looks up with ScanKey.
  */
 
 class IndexScanExecutor : public AbstractExecutor {
@@ -42,7 +51,31 @@ class IndexScanExecutor : public AbstractExecutor {
   auto Next(Tuple *tuple, RID *rid) -> bool override;
 
  private:
+  /** Collect the rids, and the entries if the scan does not read the table, of the plan's key range */
+  template <typename KeyType, typename KeyComparator>
+  void ScanTree(BPlusTreeIndex<KeyType, RID, KeyComparator> *tree);
+
+  /** Collect the rids of the key the plan fixes entirely, from an index that does not scan ranges */
+  void ProbeKey();
+
+  /** Read and lock the tuple of a rid, @return false if it is gone */
+  auto ReadTuple(const RID &rid, Tuple *tuple) -> bool;
+
   /** The index scan plan node to be executed. */
   const IndexScanPlanNode *plan_;
+  /** The index to scan */
+  const IndexInfo *index_info_;
+  /** The table the index is on */
+  const TableInfo *table_info_;
+  /** The rids of the key range, in the order of the scan */
+  std::vector<RID> rids_;
+  /** The entries of the rids, for an index-only scan that does not read the table */
+  std::vector<Tuple> entries_;
+  /** The next rid to read */
+  size_t cursor_{0};
+  /** Whether the scan takes shared locks, which depends on the isolation level */
+  bool locking_{true};
+  /** Whether the scan reads the tuples from the table */
+  bool read_table_{true};
 };
 }  // namespace bustub
@@ -14,6 +14,7 @@
 
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
@@ -57,6 +58,14 @@ class InsertExecutor : public AbstractExecutor {
  private:
   /** The insert plan node to be executed*/
   const InsertPlanNode *plan_;
+  /** Metadata identifying the table that should be inserted into */
+  const TableInfo *table_info_;
+  /** The child executor from which inserted tuples are pulled */
+  std::unique_ptr<AbstractExecutor> child_executor_;
+  /** The indexes that are maintained along with the table */
+  std::vector<IndexInfo *> indexes_;
+  /** Whether the number of inserted rows has been produced */
+  bool done_{false};
 };
 
 }  // namespace bustub
@@ -29,6 +29,10 @@ namespace bustub {
 
 /**
  * IndexJoinExecutor executes index join operations.
+ *
+ * Outer tuples are pulled in batches of INDEX_JOIN_BATCH_SIZE and their join keys looked up in the inner index with
+ * one Index::ScanKeys() call, which lets a b+ tree walk its leaves once per batch instead of descending from the root
+ * for every outer tuple. The joined tuples of a batch are produced in the order of its outer tuples.
  */
 class NestIndexJoinExecutor : public AbstractExecutor {
  public:
@@ -48,7 +52,31 @@ class NestIndexJoinExecutor : public AbstractExecutor {
   auto Next(Tuple *tuple, RID *rid) -> bool override;
 
  private:
+  /** Pull the next batch of outer tuples and look up their keys. @return false if the child is exhausted */
+  auto FillBatch() -> bool;
+  /** Read an inner tuple, taking a shared row lock first if the isolation level asks for one. */
+  auto ReadInner(const RID &rid, Tuple *tuple) -> bool;
+  /** @return the outer tuple followed by the inner one, or by nulls if inner is nullptr */
+  auto Join(const Tuple &outer, const Tuple *inner) const -> Tuple;
+
   /** The nested index join plan node. */
   const NestedIndexJoinPlanNode *plan_;
+  /** The outer table */
+  std::unique_ptr<AbstractExecutor> child_executor_;
+  /** The index probed for the inner tuples */
+  const IndexInfo *index_info_;
+  /** The inner table */
+  const TableInfo *table_info_;
+  /** Whether inner rows are read under shared locks, which depends on the isolation level */
+  bool locking_{true};
+  /** The current batch of outer tuples */
+  std::vector<Tuple> outer_tuples_;
+  /** The inner RIDs matching each outer tuple of the batch */
+  std::vector<std::vector<RID>> matches_;
+  /** The outer tuple being joined and its next match */
+  size_t outer_pos_{0};
+  size_t match_pos_{0};
+  /** Whether the current outer tuple produced a joined tuple yet */
+  bool outer_matched_{false};
 };
 }  // namespace bustub
@@ -12,11 +12,13 @@
 
 #pragma once
 
+#include <memory>
 #include <vector>
 
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
 #include "execution/plans/seq_scan_plan.h"
+#include "storage/table/table_iterator.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
@@ -50,5 +52,11 @@ class SeqScanExecutor : public AbstractExecutor {
  private:
   /** The sequential scan plan node to be executed */
   const SeqScanPlanNode *plan_;
+  /** Metadata identifying the table that should be scanned */
+  const TableInfo *table_info_;
+  /** The position of the scan in the table heap */
+  std::unique_ptr<TableIterator> iter_;
+  /** Whether the scan takes shared locks, which depends on the isolation level */
+  bool locking_{true};
 };
 }  // namespace bustub
@@ -14,24 +14,54 @@
 
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "catalog/catalog.h"
 #include "execution/expressions/abstract_expression.h"
 #include "execution/plans/abstract_plan.h"
+#include "fmt/ranges.h"
 
 namespace bustub {
 /**
- * IndexScanPlanNode identifies a table that should be scanned with an optional predicate.
+ * IndexScanPlanNode identifies a table that should be scanned in the order of an index, ascending or descending,
+ * optionally only over a range of keys and with a predicate.
+ *
+ * The range of a key over several columns is a prefix of constants the leading key columns equal, followed by an
+ * optional lower and upper bound on the next column: `user_id = 7 AND ts >= 100` on an index of (user_id, ts) scans
+ * the prefix (7) from the lower bound 100 on.
+ *
+ * An index-only scan yields the entries of the index, the key columns followed by the included columns, instead of
+ * the table's tuples, so its output schema is the entry schema of the index and its predicate refers to that.
  */
 class IndexScanPlanNode : public AbstractPlanNode {
  public:
   /**
    * Creates a new index scan plan node.
    * @param output the output format of this scan plan node
-   * @param table_oid the identifier of table to be scanned
+   * @param index_oid the identifier of the index to scan
+   * @param descending whether the scan goes from the greatest key to the least
+   * @param lower_bound a constant that every key is not less than, nullptr for no bound
+   * @param upper_bound a constant that every key is not greater than, nullptr for no bound
+   * @param filter_predicate the predicate every tuple satisfies, nullptr for none; the bounds only narrow the range
+   * of keys the scan reads and the predicate still covers them
+   * @param index_only whether the scan yields the index entries without reading the table
+   * @param prefix the constants the leading key columns equal, the bounds apply to the column after them
    */
-  IndexScanPlanNode(SchemaRef output, index_oid_t index_oid)
-      : AbstractPlanNode(std::move(output), {}), index_oid_(index_oid) {}
+  IndexScanPlanNode(SchemaRef output, index_oid_t index_oid, bool descending = false,
+                    AbstractExpressionRef lower_bound = nullptr, bool lower_inclusive = true,
+                    AbstractExpressionRef upper_bound = nullptr, bool upper_inclusive = true,
+                    AbstractExpressionRef filter_predicate = nullptr, bool index_only = false,
+                    std::vector<AbstractExpressionRef> prefix = {})
+      : AbstractPlanNode(std::move(output), {}),
+        index_oid_(index_oid),
+        descending_(descending),
+        lower_bound_(std::move(lower_bound)),
+        lower_inclusive_(lower_inclusive),
+        upper_bound_(std::move(upper_bound)),
+        upper_inclusive_(upper_inclusive),
+        filter_predicate_(std::move(filter_predicate)),
+        index_only_(index_only),
+        prefix_(std::move(prefix)) {}
 
   auto GetType() const -> PlanType override { return PlanType::IndexScan; }
 
@@ -43,11 +73,38 @@ class IndexScanPlanNode : public AbstractPlanNode {
   /** The table whose tuples should be scanned. */
   index_oid_t index_oid_;
 
-  // Add anything you want here for index lookup
+  /** Whether the scan yields the tuples in descending key order */
+  bool descending_;
+
+  /** The range of keys to scan, a bound is a constant expression or nullptr */
+  AbstractExpressionRef lower_bound_;
+  bool lower_inclusive_;
+  AbstractExpressionRef upper_bound_;
+  bool upper_inclusive_;
+
+  /** The predicate to filter the scanned tuples with, nullptr for none */
+  AbstractExpressionRef filter_predicate_;
+
+  /** Whether the scan yields the index entries without reading the table */
+  bool index_only_;
+
+  /** The constants the leading key columns equal, empty if the range starts at the first key column */
+  std::vector<AbstractExpressionRef> prefix_;
 
  protected:
   auto PlanNodeToString() const -> std::string override {
-    return fmt::format("IndexScan {{ index_oid={} }}", index_oid_);
+    std::string range;
+    if (!prefix_.empty()) {
+      range = fmt::format(", prefix={}", prefix_);
+    }
+    if (lower_bound_ != nullptr || upper_bound_ != nullptr) {
+      range += fmt::format(", range={}{}, {}{}", lower_inclusive_ ? "[" : "(",
+                          lower_bound_ == nullptr ? "-inf" : lower_bound_->ToString(),
+                          upper_bound_ == nullptr ? "+inf" : upper_bound_->ToString(), upper_inclusive_ ? "]" : ")");
+    }
+    std::string filter = filter_predicate_ == nullptr ? "" : fmt::format(", filter={}", filter_predicate_);
+    return fmt::format("IndexScan {{ index_oid={}{}{}{}{} }}", index_oid_, descending_ ? ", desc" : "",
+                       index_only_ ? ", index_only" : "", range, filter);
   }
 };
 
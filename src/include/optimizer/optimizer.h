@@ -29,6 +29,22 @@ class Optimizer {
   auto OptimizeCustom(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef;
 
  private:
+  /** The range of an index scan, see IndexScanPlanNode */
+  struct IndexScanRange {
+    /** The constants the leading key columns equal */
+    std::vector<AbstractExpressionRef> prefix_;
+    /** The bounds of the key column after the prefix, nullptr for none */
+    AbstractExpressionRef lower_bound_;
+    bool lower_inclusive_{true};
+    AbstractExpressionRef upper_bound_;
+    bool upper_inclusive_{true};
+
+    /** @return the number of key columns the range narrows */
+    auto Columns() const -> size_t {
+      return prefix_.size() + static_cast<size_t>(lower_bound_ != nullptr || upper_bound_ != nullptr);
+    }
+  };
+
   /**
    * @brief merge projections that do identical project.
    * Identical projection might be produced when there's `SELECT *`, aggregation, or when we need to rename the columns
@@ -85,6 +101,43 @@ class Optimizer {
    */
   auto OptimizeOrderByAsIndexScan(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef;
 
+  /**
+   * @brief narrow the key range of an index scan on column col_idx by the conjuncts of predicate that compare the
+   * column with an integer constant, e.g. `v1 >= 3 AND v1 < 10`. A bound is left as it is if no conjunct limits it.
+   */
+  void ExtractIndexRange(const AbstractExpression &predicate, uint32_t col_idx, AbstractExpressionRef *lower_bound,
+                         bool *lower_inclusive, AbstractExpressionRef *upper_bound, bool *upper_inclusive);
+
+  /**
+   * @brief optimize a projection over a scan as an index-only scan if an index entry holds every column the
+   * projection and the predicate read. An index scan becomes index-only if its index covers the projection, a
+   * sequential scan only turns into one over an index with included columns.
+   */
+  auto OptimizeIndexOnlyScan(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef;
+
+  /**
+   * @brief optimize a filter over a sequential scan as an index scan over the range of an index the predicate
+   * narrows, see MatchIndexPrefix(). The predicate stays the filter of the scan. The scan sees the same rows as the
+   * sequential scan under every isolation level, as deleted rows keep their index entries until no reader can see them.
+   */
+  auto OptimizeFilterAsIndexScan(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef;
+
+  /**
+   * @brief the range of an index with key columns key_attrs that the conjuncts of predicate allow: the leading key
+   * columns predicate sets equal to an integer constant make the prefix, and the column after them gets the bounds
+   * ExtractIndexRange() finds, e.g. `user_id = 7 AND ts >= 100` on (user_id, ts).
+   */
+  auto ExtractIndexPrefix(const AbstractExpression &predicate, const std::vector<uint32_t> &key_attrs)
+      -> IndexScanRange;
+
+  /**
+   * @brief find the index of table_name whose key the conjuncts of predicate narrow down to the most columns. An ART
+   * index only matches if they fix its whole key.
+   * @return the index and its range, nullopt if predicate limits the first key column of no index
+   */
+  auto MatchIndexPrefix(const std::string &table_name, const AbstractExpression &predicate)
+      -> std::optional<std::tuple<const IndexInfo *, IndexScanRange>>;
+
   /** @brief check if the index can be matched */
   auto MatchIndex(const std::string &table_name, uint32_t index_key_idx)
       -> std::optional<std::tuple<index_oid_t, std::string>>;
@@ -0,0 +1,63 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// art_index.h
+//
+// Identification: src/include/storage/index/art_index.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "container/art/adaptive_radix_tree.h"
+#include "storage/index/index.h"
+#include "storage/table/table_heap.h"
+
+namespace bustub {
+
+/**
+ * ARTIndex keeps an index in memory, in an adaptive radix tree (see AdaptiveRadixTree), for tables whose indexes
+ * are mostly probed for single keys. It answers ScanKey faster than a b+ tree, which goes through the buffer pool,
+ * but it does not scan ranges and does not include columns. Nothing of it is on disk; it is built from the table
+ * when it is created.
+ *
+ * The tree compares keys byte by byte, so the index encodes every key column big-endian with the sign bit flipped:
+ * the bytes of two keys then compare like the keys. NULL is stored as the least value of its type and comes first,
+ * like in GenericComparator. Only integer columns can be encoded.
+ */
+class ARTIndex : public Index {
+ public:
+  explicit ARTIndex(std::unique_ptr<IndexMetadata> &&metadata);
+
+  ~ARTIndex() override = default;
+
+  void InsertEntry(const Tuple &key, RID rid, Transaction *transaction) override;
+
+  void DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) override;
+
+  void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
+
+  /** Insert the key of every tuple of the index's table */
+  void BulkLoad(TableHeap *table_heap, const Schema &table_schema, Transaction *transaction);
+
+  /**
+   * @return the size of the encoded keys of a key schema, in bytes
+   * @throw NotImplementedException if a key column is not an integer
+   */
+  static auto EncodedKeySize(const Schema &key_schema) -> size_t;
+
+ private:
+  /** Encode a key for the tree, into key_size bytes */
+  void EncodeKey(const Tuple &key, uint8_t *bytes) const;
+
+  // container
+  AdaptiveRadixTree container_;
+};
+
+}  // namespace bustub
@@ -10,37 +10,102 @@
 //===----------------------------------------------------------------------===//
 #pragma once
 
+#include <atomic>
+#include <deque>
+#include <optional>
 #include <queue>
 #include <string>
 #include <vector>
 
+#include "common/rwlatch.h"
 #include "concurrency/transaction.h"
+#include "storage/index/bulk_load_sorter.h"
 #include "storage/index/index_iterator.h"
 #include "storage/page/b_plus_tree_internal_page.h"
 #include "storage/page/b_plus_tree_leaf_page.h"
+#include "storage/page/b_plus_tree_posting_page.h"
 
 namespace bustub {
 
 #define BPLUSTREE_TYPE BPlusTree<KeyType, ValueType, KeyComparator>
 
+/** How full the leaves of a b+ tree are, see BPlusTree::GetFillStats() */
+struct BPlusTreeFillStats {
+  /** Number of leaf pages */
+  size_t leaf_pages_{0};
+  /** Number of leaf entries, a key with a posting list counts once */
+  size_t entries_{0};
+  /** Mean fill of the leaves, see BPlusTreeLeafPage::Fill() */
+  double fill_factor_{0};
+};
+
+/** What a BPlusTree::Compact() run did */
+struct BPlusTreeCompactionStats {
+  BPlusTreeFillStats before_;
+  BPlusTreeFillStats after_;
+  /** Leaf pages that were merged away and deleted from the buffer pool */
+  size_t reclaimed_pages_{0};
+};
+
 /**
  * Main class providing the API for the Interactive B+ Tree.
  *
  * Implementation of simple b+ tree data structure where internal pages direct
  * the search and leaf pages contain actual data.
- * (1) We only support unique key
+ * (1) Keys are unique, or may repeat in a tree built with unique_keys off
  * (2) support insert & remove
  * (3) The structure should shrink and grow dynamically
  * (4) Implement index iterator for range scan
+ *
+ * Concurrency follows the B-link tree. Every page carries fence keys and every level is linked left to right (see
+ * the page types), so a descent does not need a parent to stay unchanged while it moves to the child: it holds at
+ * most one page at a time, and when a split moved its key to a right sibling meanwhile, it follows the right link.
+ * Merges and redistribution move keys to the left instead; a descent that finds its key below a page's low key, or
+ * finds a page the tree deleted, restarts from the root. In a plain tree with integer keys the internal pages are
+ * not latched at all: writers announce their changes through the page version (see Page::BeginUpdate()), and a
+ * reader only uses what it read if the version still holds afterwards. A point lookup reads the leaf that way as
+ * well, unless the key has a posting list. Otherwise the descent read-latches the page it is on, and so do index
+ * iterators at the leaves; writers write-latch the leaf. When the leaf would split or underflow, the writer
+ * gives up and restarts pessimistically: it write-latches from the root down and releases the latched ancestors
+ * whenever it reaches a page that cannot split or merge. root_latch_ serializes the writers that may replace the
+ * root; the pessimistic descent holds it exclusively until the root is known to stay the root. Readers load
+ * root_page_id_ without it.
+ *
+ * With compress_keys the tree uses the compressed page types and pushes the shortest key that separates two
+ * siblings up instead of the right sibling's first key. How many entries fit into a compressed page depends on the
+ * keys, so the tree asks the pages for room instead of comparing sizes. A compressed page that would need more room
+ * for a new separator during a removal does not borrow from its sibling; it stays below its min size until it can
+ * be merged.
+ *
+ * A non-unique tree keeps one leaf entry per key as well. The second value of a key turns the entry's value into a
+ * reference to a posting list (see BPlusTreePostingPage) that holds all values of the key, and removing values down
+ * to one turns it back. Posting pages are not latched, the latch of the leaf holding the entry protects them.
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTree {
   using InternalPage = BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator>;
   using LeafPage = BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>;
 
+  /** What a descent is going to do at the leaf, it decides which pages are safe. */
+  enum class Operation { SEARCH, INSERT, REMOVE };
+
+  /** Where a key lies relative to the fence keys of a page. */
+  enum class Fence { BELOW, INSIDE, BEYOND };
+
+  /** The pages held by a pessimistic writer. */
+  struct Context {
+    /** Whether the writer holds root_latch_ exclusively */
+    bool root_latched_{false};
+    /** Pinned and write-latched pages, from the highest page a change may reach down to the leaf */
+    std::deque<Page *> write_set_;
+    /** Pages emptied by merges, deleted once every latch is released */
+    std::vector<page_id_t> deleted_pages_;
+  };
+
  public:
   explicit BPlusTree(std::string name, BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
-                     int leaf_max_size = LEAF_PAGE_SIZE, int internal_max_size = INTERNAL_PAGE_SIZE);
+                     int leaf_max_size = LEAF_PAGE_SIZE, int internal_max_size = INTERNAL_PAGE_SIZE,
+                     bool compress_keys = false, bool unique_keys = true);
 
   // Returns true if this B+ tree has no keys and values.
   auto IsEmpty() const -> bool;
@@ -48,12 +113,29 @@ class BPlusTree {
   // Insert a key-value pair into this B+ tree.
   auto Insert(const KeyType &key, const ValueType &value, Transaction *transaction = nullptr) -> bool;
 
-  // Remove a key and its value from this B+ tree.
+  // Remove a key and its value from this B+ tree, every value of the key in a non-unique tree.
   void Remove(const KeyType &key, Transaction *transaction = nullptr);
 
-  // return the value associated with a given key
+  // Remove one key-value pair from this B+ tree.
+  void Remove(const KeyType &key, const ValueType &value, Transaction *transaction = nullptr);
+
+  // Build the empty tree bottom-up from the pairs of a finished sorter, filling pages to fill_factor.
+  auto BulkLoad(BulkLoadSorter<KeyType, ValueType, KeyComparator> *sorter, double fill_factor = BULK_LOAD_FILL_FACTOR)
+      -> bool;
+
+  // Repack sparse leaves into fewer ones filled to fill_factor and delete the rest, while the tree stays online.
+  auto Compact(double fill_factor = COMPACTION_FILL_FACTOR) -> BPlusTreeCompactionStats;
+
+  // Count the leaves and how full they are.
+  auto GetFillStats() -> BPlusTreeFillStats;
+
+  // return the values associated with a given key
   auto GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *transaction = nullptr) -> bool;
 
+  // return the values associated with each of a batch of keys sorted in ascending order
+  void GetValues(const std::vector<KeyType> &keys, std::vector<std::vector<ValueType>> *results,
+                 Transaction *transaction = nullptr);
+
   // return the page id of the root node
   auto GetRootPageId() -> page_id_t;
 
@@ -61,6 +143,9 @@ class BPlusTree {
   auto Begin() -> INDEXITERATOR_TYPE;
   auto Begin(const KeyType &key) -> INDEXITERATOR_TYPE;
   auto End() -> INDEXITERATOR_TYPE;
+  // reverse index iterator, from the last pair or from the last pair whose key is not greater than key
+  auto RBegin() -> INDEXITERATOR_TYPE;
+  auto RBegin(const KeyType &key) -> INDEXITERATOR_TYPE;
 
   // print the B+ tree
   void Print(BufferPoolManager *bpm);
@@ -77,6 +162,55 @@ class BPlusTree {
  private:
   void UpdateRootPageId(int insert_record = 0);
 
+  /* Descent */
+  auto FindLeafOptimistic(const KeyType *key, Operation op, bool rightmost = false) -> Page *;
+  auto FindLeafPessimistic(const KeyType &key, Operation op, Context *ctx) -> Page *;
+  auto NextPage(Page *page, const KeyType *key, bool rightmost) -> Page *;
+  auto DescendToLeaf(const KeyType *key, bool rightmost) -> Page *;
+  auto LatchLeaf(Page *page, const KeyType *key, bool rightmost, bool write) -> Page *;
+  auto LookupLeaf(Page *page, const KeyType &key, ValueType *value) -> std::optional<bool>;
+  template <typename NodeType>
+  auto FencePosition(const NodeType *node, const KeyType *key, bool rightmost) const -> Fence;
+  auto IsSafe(const BPlusTreePage *node, Operation op, const KeyType &key) const -> bool;
+  auto ReadEntry(const LeafPage *leaf, int index, std::vector<ValueType> *result) -> bool;
+  void ReleaseContext(Context *ctx, bool is_dirty);
+
+  /* Insertion */
+  void SplitLeafAndInsert(LeafPage *leaf, const KeyType &key, const ValueType &value, Context *ctx);
+  auto SeparatorBetween(const KeyType &left, const KeyType &right) const -> KeyType;
+  void StartNewTree(const KeyType &key, const ValueType &value, Context *ctx);
+  void InsertIntoParent(size_t level, BPlusTreePage *old_node, const KeyType &key, BPlusTreePage *new_node,
+                        Context *ctx);
+
+  /* Posting lists */
+  auto AddToPostingList(LeafPage *leaf, int index, const ValueType &value, Context *ctx) -> bool;
+  auto NewPostingList(const std::vector<ValueType> &values, Context *ctx) -> ValueType;
+  auto KeepsEntry(LeafPage *leaf, int index, const ValueType *value, Context *ctx) -> bool;
+  void CollapsePostingList(LeafPage *leaf, int index, Context *ctx);
+  void DropPostingList(const ValueType &stored, Context *ctx);
+
+  /* Removal */
+  void RemoveEntry(const KeyType &key, const ValueType *value);
+  void HandleUnderflow(size_t level, Context *ctx);
+  void CoalesceOrRedistributeLeaf(LeafPage *node, InternalPage *parent, int index, Page *page, Context *ctx);
+  void CoalesceOrRedistributeInternal(InternalPage *node, InternalPage *parent, int index, Page *page,
+                                      Context *ctx);
+  void AdjustRoot(Page *page, Context *ctx);
+  void Retire(Page *page, Context *ctx);
+  void DeletePages(Context *ctx);
+
+  /* Compaction */
+  auto LatchLeafParent(const KeyType *key, Context *ctx) -> Page *;
+  auto CompactLeaves(int first, double fill_factor, Context *ctx) -> int;
+  void FixUnderflow(page_id_t page_id, const KeyType *key);
+
+  /* Buffer pool helpers */
+  auto NewTreePage(page_id_t *page_id, Context *ctx) -> Page *;
+  auto FetchTreePage(page_id_t page_id, Context *ctx) -> Page *;
+  void SetParentPageId(page_id_t child_id, page_id_t parent_id);
+  void SetPrevLeaf(page_id_t leaf_id, page_id_t prev_id, Context *ctx);
+  auto MakeIterator(Page *page, int index, bool reverse, const KeyType &from) -> INDEXITERATOR_TYPE;
+
   /* Debug Routines for FREE!! */
   void ToGraph(BPlusTreePage *page, BufferPoolManager *bpm, std::ofstream &out) const;
 
@@ -84,11 +218,16 @@ class BPlusTree {
 
   // member variable
   std::string index_name_;
-  page_id_t root_page_id_;
+  std::atomic<page_id_t> root_page_id_;
+  ReaderWriterLatch root_latch_;
   BufferPoolManager *buffer_pool_manager_;
   KeyComparator comparator_;
   int leaf_max_size_;
   int internal_max_size_;
+  bool compress_keys_;
+  bool unique_keys_;
+  /** Whether descents read internal pages without latching them, see the class comment */
+  bool latch_free_reads_{false};
 };
 
 }  // namespace bustub
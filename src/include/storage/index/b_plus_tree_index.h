@@ -19,6 +19,7 @@
 #include "container/hash/hash_function.h"
 #include "storage/index/b_plus_tree.h"
 #include "storage/index/index.h"
+#include "storage/table/table_heap.h"
 
 namespace bustub {
 
@@ -35,15 +36,47 @@ class BPlusTreeIndex : public Index {
 
   void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
 
+  /** Sort the keys and look them up in one pass over the leaves, see BPlusTree::GetValues(). */
+  void ScanKeys(const std::vector<Tuple> &keys, std::vector<std::vector<RID>> *results,
+                Transaction *transaction) override;
+
+  /**
+   * Fill the index from every tuple of its table. An empty index is bulk loaded: the keys are sorted first, spilling
+   * to the buffer pool if they do not fit into one sort run, and the tree is built bottom-up. An index that already
+   * has entries gets the tuples inserted one by one.
+   * @param table_heap the table the index is built on
+   * @param table_schema the schema of the table's tuples
+   * @param fill_factor the fraction of every page a bulk load fills
+   */
+  void BulkLoad(TableHeap *table_heap, const Schema &table_schema, Transaction *transaction,
+                double fill_factor = BULK_LOAD_FILL_FACTOR);
+
+  /**
+   * @param prefix the values of the leading key columns, as many as the bound fixes
+   * @param after whether the bound goes after every entry that starts with prefix instead of before
+   * @return the entry a scan positions itself at to start or stop at the entries that start with prefix; the key
+   * itself if the prefix is the whole key and the index includes no columns
+   */
+  auto EntryBound(const std::vector<Value> &prefix, bool after) const -> KeyType;
+
   auto GetBeginIterator() -> INDEXITERATOR_TYPE;
 
   auto GetBeginIterator(const KeyType &key) -> INDEXITERATOR_TYPE;
 
   auto GetEndIterator() -> INDEXITERATOR_TYPE;
 
+  auto GetReverseBeginIterator() -> INDEXITERATOR_TYPE;
+
+  auto GetReverseBeginIterator(const KeyType &key) -> INDEXITERATOR_TYPE;
+
  protected:
-  // comparator for key
+  auto GetEntryColumnCount() const -> uint32_t { return GetEntrySchema()->GetColumnCount(); }
+
+  BufferPoolManager *buffer_pool_manager_;
+  // comparator for entries, see the constructor
   KeyComparator comparator_;
+  // comparator for the key columns of entries
+  KeyComparator key_comparator_;
   // container
   BPlusTree<KeyType, ValueType, KeyComparator> container_;
 };
@@ -0,0 +1,92 @@
+//===----------------------------------------------------------------------===//
+//
+//                         CMU-DB Project (15-445/645)
+//                         ***DO NO SHARE PUBLICLY***
+//
+// Identification: src/include/index/bulk_load_sorter.h
+//
+// Copyright (c) 2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+/**
+ * bulk_load_sorter.h
+ * Sorted input of a b+ tree bulk load
+ */
+#pragma once
+
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/macros.h"
+#include "storage/page/b_plus_tree_page.h"
+
+namespace bustub {
+
+#define BULK_LOAD_SORTER_TYPE BulkLoadSorter<KeyType, ValueType, KeyComparator>
+
+/**
+ * BulkLoadSorter collects the key & value pairs of a bulk load and hands them back in key order.
+ *
+ * Pairs are sorted in memory in runs of run_size. As long as everything fits into one run nothing leaves memory.
+ * Otherwise every full run is written to temporary pages of the buffer pool, and Next() merges the runs, reading
+ * each run back one page at a time. A run page is deleted as soon as it has been read, so the buffer pool never
+ * holds more than one pinned run page.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+class BulkLoadSorter {
+  /** A sorted run spilled to temporary pages. */
+  struct Run {
+    /** Pages of the run, in order */
+    std::vector<page_id_t> pages_;
+    /** Pairs of the run that are not read from its pages yet */
+    size_t unread_{0};
+    /** Index into pages_ of the next page to read */
+    size_t next_page_{0};
+    /** The page read last, pos_ is the next pair of it to merge */
+    std::vector<MappingType> buffer_;
+    size_t pos_{0};
+  };
+
+ public:
+  BulkLoadSorter(BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
+                 size_t run_size = BULK_LOAD_SORT_RUN_SIZE);
+  ~BulkLoadSorter();
+
+  DISALLOW_COPY_AND_MOVE(BulkLoadSorter);
+
+  /** Add a pair, only before Finish(). */
+  void Add(const KeyType &key, const ValueType &value);
+
+  /** Sort the pairs added so far, Next() returns them afterwards. */
+  void Finish();
+
+  /**
+   * @param[out] item the next pair in key order
+   * @return false once every pair has been returned
+   */
+  auto Next(MappingType *item) -> bool;
+
+  /** @return the number of sorted runs written to the buffer pool */
+  auto GetSpilledRunCount() const -> size_t { return runs_.size(); }
+
+ private:
+  void SortBuffer();
+  void SpillRun();
+  auto ReadPage(Run *run) -> bool;
+  auto RunGreater(size_t a, size_t b) const -> bool;
+
+  /** Number of pairs that fit into a run page */
+  static constexpr size_t PAIRS_PER_PAGE = BUSTUB_PAGE_SIZE / sizeof(MappingType);
+
+  BufferPoolManager *buffer_pool_manager_;
+  KeyComparator comparator_;
+  size_t run_size_;
+  /** The run being filled, or every pair if nothing was spilled */
+  std::vector<MappingType> buffer_;
+  size_t buffer_pos_{0};
+  std::vector<Run> runs_;
+  /** Min-heap of the runs that still have pairs, ordered by their next pair */
+  std::vector<size_t> heap_;
+};
+
+}  // namespace bustub
@@ -72,17 +72,42 @@ class GenericKey {
 
 /**
  * Function object returns true if lhs < rhs, used for trees
+ *
+ * A key whose only column is a TINYINT, SMALLINT, INTEGER or BIGINT is compared as a plain integer loaded from the
+ * key, without building a Value for either side. Every other key is compared column by column as Values. Either way
+ * NULL is the least value of a column, where the Value comparison alone would leave it unordered.
+ *
+ * The key schema may name a prefix of the columns the keys hold: an index with included columns compares its
+ * entries by the key columns only with the key schema, and by all of them with the entry schema.
  */
 template <size_t KeySize>
 class GenericComparator {
  public:
   inline auto operator()(const GenericKey<KeySize> &lhs, const GenericKey<KeySize> &rhs) const -> int {
+    switch (integer_key_size_) {
+      case sizeof(int8_t):
+        return CompareIntegers<int8_t>(lhs, rhs);
+      case sizeof(int16_t):
+        return CompareIntegers<int16_t>(lhs, rhs);
+      case sizeof(int32_t):
+        return CompareIntegers<int32_t>(lhs, rhs);
+      case sizeof(int64_t):
+        return CompareIntegers<int64_t>(lhs, rhs);
+      default:
+        break;
+    }
     uint32_t column_count = key_schema_->GetColumnCount();
 
     for (uint32_t i = 0; i < column_count; i++) {
       Value lhs_value = (lhs.ToValue(key_schema_, i));
       Value rhs_value = (rhs.ToValue(key_schema_, i));
 
+      if (lhs_value.IsNull() || rhs_value.IsNull()) {
+        if (lhs_value.IsNull() != rhs_value.IsNull()) {
+          return lhs_value.IsNull() ? -1 : 1;
+        }
+        continue;
+      }
       if (lhs_value.CompareLessThan(rhs_value) == CmpBool::CmpTrue) {
         return -1;
       }
@@ -94,13 +119,49 @@ class GenericComparator {
     return 0;
   }
 
-  GenericComparator(const GenericComparator &other) : key_schema_{other.key_schema_} {}
+  /** @return the width of the key's only column if the keys compare as integers, 0 otherwise */
+  inline auto IntegerKeySize() const -> size_t { return integer_key_size_; }
+
+  GenericComparator(const GenericComparator &other)
+      : key_schema_{other.key_schema_}, integer_key_size_{other.integer_key_size_} {}
 
-  // constructor
-  explicit GenericComparator(Schema *key_schema) : key_schema_(key_schema) {}
+  /**
+   * @param key_schema the schema of the keys
+   * @param integer_keys whether integer keys may be compared as integers, the Value comparison is used for every key
+   * otherwise
+   */
+  explicit GenericComparator(Schema *key_schema, bool integer_keys = true)
+      : key_schema_(key_schema), integer_key_size_(integer_keys ? IntegerKeySizeOf(key_schema) : 0) {}
 
  private:
+  static auto IntegerKeySizeOf(const Schema *key_schema) -> size_t {
+    if (key_schema->GetColumnCount() != 1) {
+      return 0;
+    }
+    const auto &column = key_schema->GetColumn(0);
+    switch (column.GetType()) {
+      case TypeId::TINYINT:
+      case TypeId::SMALLINT:
+      case TypeId::INTEGER:
+      case TypeId::BIGINT:
+        return column.GetOffset() == 0 && column.GetFixedLength() <= KeySize ? column.GetFixedLength() : 0;
+      default:
+        return 0;
+    }
+  }
+
+  template <typename Int>
+  static auto CompareIntegers(const GenericKey<KeySize> &lhs, const GenericKey<KeySize> &rhs) -> int {
+    Int lhs_value;
+    Int rhs_value;
+    memcpy(&lhs_value, lhs.data_, sizeof(Int));
+    memcpy(&rhs_value, rhs.data_, sizeof(Int));
+    return static_cast<int>(lhs_value > rhs_value) - static_cast<int>(lhs_value < rhs_value);
+  }
+
   Schema *key_schema_;
+  /** The width of the only key column if it is an integer, 0 otherwise */
+  size_t integer_key_size_;
 };
 
 }  // namespace bustub
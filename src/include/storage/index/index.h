@@ -43,11 +43,21 @@ class IndexMetadata {
    * @param table_name The name of the table on which the index is created
    * @param tuple_schema The schema of the indexed key
    * @param key_attrs The mapping from indexed columns to base table columns
+   * @param is_unique Whether a key may map to one record only
+   * @param include_attrs The base table columns stored in every entry after the key, which an index-only scan reads
+   * instead of the table
    */
   IndexMetadata(std::string index_name, std::string table_name, const Schema *tuple_schema,
-                std::vector<uint32_t> key_attrs)
-      : name_(std::move(index_name)), table_name_(std::move(table_name)), key_attrs_(std::move(key_attrs)) {
+                std::vector<uint32_t> key_attrs, bool is_unique = true, std::vector<uint32_t> include_attrs = {})
+      : name_(std::move(index_name)),
+        table_name_(std::move(table_name)),
+        key_attrs_(std::move(key_attrs)),
+        include_attrs_(std::move(include_attrs)),
+        is_unique_(is_unique) {
     key_schema_ = std::make_shared<Schema>(Schema::CopySchema(tuple_schema, key_attrs_));
+    entry_attrs_ = key_attrs_;
+    entry_attrs_.insert(entry_attrs_.end(), include_attrs_.begin(), include_attrs_.end());
+    entry_schema_ = std::make_shared<Schema>(Schema::CopySchema(tuple_schema, entry_attrs_));
   }
 
   ~IndexMetadata() = default;
@@ -72,6 +82,18 @@ class IndexMetadata {
   /** @return The mapping relation between indexed columns and base table columns */
   inline auto GetKeyAttrs() const -> const std::vector<uint32_t> & { return key_attrs_; }
 
+  /** @return The base table columns stored after the key */
+  inline auto GetIncludeAttrs() const -> const std::vector<uint32_t> & { return include_attrs_; }
+
+  /** @return The base table columns of an entry: the key columns followed by the included ones */
+  inline auto GetEntryAttrs() const -> const std::vector<uint32_t> & { return entry_attrs_; }
+
+  /** @return The schema of an entry, the key schema if the index includes no columns */
+  inline auto GetEntrySchema() const -> Schema * { return entry_schema_.get(); }
+
+  /** @return Whether a key may map to one record only */
+  inline auto IsUnique() const -> bool { return is_unique_; }
+
   /** @return A string representation for debugging */
   auto ToString() const -> std::string {
     std::stringstream os;
@@ -92,8 +114,16 @@ class IndexMetadata {
   std::string table_name_;
   /** The mapping relation between key schema and tuple schema */
   const std::vector<uint32_t> key_attrs_;
+  /** The base table columns stored after the key */
+  const std::vector<uint32_t> include_attrs_;
+  /** The key columns followed by the included columns */
+  std::vector<uint32_t> entry_attrs_;
+  /** Whether a key may map to one record only */
+  bool is_unique_;
   /** The schema of the indexed key */
   std::shared_ptr<Schema> key_schema_;
+  /** The schema of an entry, the key columns followed by the included columns */
+  std::shared_ptr<Schema> entry_schema_;
 };
 
 /////////////////////////////////////////////////////////////////////
@@ -139,6 +169,20 @@ class Index {
   /** @return The index key attributes */
   auto GetKeyAttrs() const -> const std::vector<uint32_t> & { return metadata_->GetKeyAttrs(); }
 
+  /** @return The schema of an entry, the key columns followed by the included columns */
+  auto GetEntrySchema() const -> Schema * { return metadata_->GetEntrySchema(); }
+
+  /** @return The base table columns of an entry */
+  auto GetEntryAttrs() const -> const std::vector<uint32_t> & { return metadata_->GetEntryAttrs(); }
+
+  /** @return Whether the index stores columns besides its key */
+  auto HasIncludedColumns() const -> bool { return !metadata_->GetIncludeAttrs().empty(); }
+
+  /** @return The entry of a table tuple, what InsertEntry() and DeleteEntry() take */
+  auto EntryFromTuple(const Tuple &tuple, const Schema &table_schema) const -> Tuple {
+    return tuple.KeyFromTuple(table_schema, *GetEntrySchema(), GetEntryAttrs());
+  }
+
   /** @return A string representation for debugging */
   auto ToString() const -> std::string {
     std::stringstream os;
@@ -153,7 +197,7 @@ class Index {
 
   /**
    * Insert an entry into the index.
-   * @param key The index key
+   * @param key The index entry, see EntryFromTuple(); the key alone if the index includes no columns
    * @param rid The RID associated with the key
    * @param transaction The transaction context
    */
@@ -161,8 +205,8 @@ class Index {
 
   /**
    * Delete an index entry by key.
-   * @param key The index key
-   * @param rid The RID associated with the key (unused)
+   * @param key The index entry, see EntryFromTuple()
+   * @param rid The RID associated with the key, only this RID is removed from a non-unique index
    * @param transaction The transaction context
    */
   virtual void DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) = 0;
@@ -175,6 +219,21 @@ class Index {
    */
   virtual void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) = 0;
 
+  /**
+   * Search the index for a batch of keys. An index that can look up several keys more cheaply than one at a time
+   * overrides this; by default every key is scanned on its own.
+   * @param keys The index keys, in any order
+   * @param results Receives one collection of RIDs per key, in the order of keys
+   * @param transaction The transaction context
+   */
+  virtual void ScanKeys(const std::vector<Tuple> &keys, std::vector<std::vector<RID>> *results,
+                        Transaction *transaction) {
+    results->assign(keys.size(), {});
+    for (size_t i = 0; i < keys.size(); i++) {
+      ScanKey(keys[i], &(*results)[i], transaction);
+    }
+  }
+
  private:
   /** The Index structure owns its metadata */
   std::unique_ptr<IndexMetadata> metadata_;
@@ -13,31 +13,124 @@
  * For range scan of b+ tree
  */
 #pragma once
+#include <functional>
+
 #include "storage/page/b_plus_tree_leaf_page.h"
+#include "storage/page/b_plus_tree_posting_page.h"
 
 namespace bustub {
 
 #define INDEXITERATOR_TYPE IndexIterator<KeyType, ValueType, KeyComparator>
 
+/**
+ * IndexIterator walks the leaf chain of a BPlusTree in key order, or in reverse key order if it is a reverse
+ * iterator. Either way operator++ moves on in the iterator's own direction and operator-- moves back.
+ *
+ * The iterator keeps its current leaf pinned and read-latched until it moves past the leaf's last pair, so the pair
+ * it points at stays valid and writers block only on that one leaf. It latches the next leaf before releasing the
+ * current one, the same left-to-right order that BPlusTree::Remove respects when it latches siblings. Moving to the
+ * previous leaf would go against that order, so the iterator only tries to latch it; if a writer holds it, the
+ * iterator releases its leaf and descends from the root again for the last key below the leaf instead. A thread must
+ * not modify the tree while it holds an iterator that is not at the end.
+ *
+ * A key of a non-unique tree whose values are in a posting list yields one pair per value. The iterator keeps the
+ * posting page it reads pinned; the latch of the current leaf protects it.
+ *
+ * With a bound the iterator ends at the first key past the bound, e.g. the upper end of a range scan.
+ */
 INDEX_TEMPLATE_ARGUMENTS
 class IndexIterator {
+  using LeafPage = BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>;
+
  public:
-  // you may define your own constructor based on your member variables
+  /** Descends to the leaf that covers a key, returns it pinned and read-latched, nullptr if the tree is empty */
+  using FindLeaf = std::function<Page *(const KeyType &)>;
+
+  /** Construct the end iterator. */
   IndexIterator();
+  /**
+   * Construct an iterator positioned at index in a leaf; a position past the leaf's last pair moves to the next
+   * leaf, a position before its first pair (index -1) to the previous one.
+   * @param page the leaf page, pinned and read-latched, the iterator takes over both
+   * @param reverse whether the iterator moves backwards
+   * @param from a key greater than every key before the position, used if index is -1 and the previous leaf cannot
+   * be latched
+   */
+  IndexIterator(BufferPoolManager *bpm, const KeyComparator *comparator, FindLeaf find_leaf, Page *page, int index,
+                bool reverse, const KeyType &from);
   ~IndexIterator();  // NOLINT
 
+  IndexIterator(const IndexIterator &) = delete;
+  auto operator=(const IndexIterator &) -> IndexIterator & = delete;
+  IndexIterator(IndexIterator &&other) noexcept;
+  auto operator=(IndexIterator &&other) noexcept -> IndexIterator &;
+
   auto IsEnd() -> bool;
 
+  /**
+   * End the iteration at the first key past key in the iterator's direction: greater for a forward iterator, less
+   * for a reverse one. An inclusive bound still yields key itself.
+   */
+  void SetBound(const KeyType &key, bool inclusive);
+
   auto operator*() -> const MappingType &;
 
   auto operator++() -> IndexIterator &;
 
-  auto operator==(const IndexIterator &itr) const -> bool { throw std::runtime_error("unimplemented"); }
+  auto operator--() -> IndexIterator &;
 
-  auto operator!=(const IndexIterator &itr) const -> bool { throw std::runtime_error("unimplemented"); }
+  auto operator==(const IndexIterator &itr) const -> bool {
+    return GetPageId() == itr.GetPageId() && index_ == itr.index_ && GetPostingPageId() == itr.GetPostingPageId() &&
+           posting_index_ == itr.posting_index_;
+  }
+
+  auto operator!=(const IndexIterator &itr) const -> bool { return !(*this == itr); }
 
  private:
-  // add your own private member variables here
+  auto GetPageId() const -> page_id_t { return page_ == nullptr ? INVALID_PAGE_ID : page_->GetPageId(); }
+  auto GetPostingPageId() const -> page_id_t {
+    return posting_page_ == nullptr ? INVALID_PAGE_ID : posting_page_->GetPageId();
+  }
+  auto GetLeaf() const -> LeafPage * { return reinterpret_cast<LeafPage *>(page_->GetData()); }
+  auto GetPostingList() const -> BPlusTreePostingPage * {
+    return reinterpret_cast<BPlusTreePostingPage *>(posting_page_->GetData());
+  }
+  /** Move to the next pair in key order. */
+  void Forward();
+  /** Move to the previous pair in key order. */
+  void Backward();
+  /** Move to the next leaf while the position is past the current leaf's last pair, then enter the pair. */
+  void SkipExhaustedLeaves();
+  /** Move to the previous leaf while the position is before the current leaf's first pair, then enter the pair. */
+  void SkipExhaustedLeavesBackward(const KeyType &from);
+  /** Pin the first (last) posting page if the current pair references a posting list. */
+  void EnterEntry(bool last);
+  /** Pin a posting page of the current pair and start at its first value. */
+  void EnterPostingPage(page_id_t page_id);
+  /** @return the posting page before page_id in the list starting at head_id, invalid for the head */
+  auto PostingPageBefore(page_id_t head_id, page_id_t page_id) -> page_id_t;
+  /** Unpin the current posting page. */
+  void ReleasePostingPage();
+  /** End the iteration if the current key is past the bound. */
+  void CheckBound();
+  /** Unlatch and unpin the current leaf and posting page. */
+  void Release();
+
+  BufferPoolManager *bpm_{nullptr};
+  const KeyComparator *comparator_{nullptr};
+  FindLeaf find_leaf_;
+  bool reverse_{false};
+  Page *page_{nullptr};
+  int index_{0};
+  /** The posting page holding the current value, nullptr unless the current pair references a posting list */
+  Page *posting_page_{nullptr};
+  int posting_index_{0};
+  /** The pair operator*() returned last, a compressed leaf has no pair to point into */
+  MappingType item_;
+  /** The bound set by SetBound() */
+  bool has_bound_{false};
+  KeyType bound_;
+  bool bound_inclusive_{false};
 };
 
 }  // namespace bustub
@@ -10,14 +10,19 @@
 //===----------------------------------------------------------------------===//
 #pragma once
 
+#include <algorithm>
 #include <queue>
+#include <utility>
+#include <vector>
 
 #include "storage/page/b_plus_tree_page.h"
+#include "storage/page/compressed_key_layout.h"
+#include "storage/page/integer_key_search.h"
 
 namespace bustub {
 
 #define B_PLUS_TREE_INTERNAL_PAGE_TYPE BPlusTreeInternalPage<KeyType, ValueType, KeyComparator>
-#define INTERNAL_PAGE_HEADER_SIZE 24
+#define INTERNAL_PAGE_HEADER_SIZE (32 + 2 * sizeof(KeyType))
 #define INTERNAL_PAGE_SIZE ((BUSTUB_PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / (sizeof(MappingType)))
 /**
  * Store n indexed keys and n+1 child pointers (page_id) within internal page.
@@ -31,18 +36,98 @@ namespace bustub {
  *  --------------------------------------------------------------------------
  * | HEADER | KEY(1)+PAGE_ID(1) | KEY(2)+PAGE_ID(2) | ... | KEY(n)+PAGE_ID(n) |
  *  --------------------------------------------------------------------------
+ *
+ *  Header format (size in byte, 32 bytes + two keys in total):
+ *  ---------------------------------------------------------------------
+ * | PageType (4) | LSN (4) | CurrentSize (4) | MaxSize (4) |
+ *  ---------------------------------------------------------------------
+ *  ----------------------------------------------------------------
+ * | ParentPageId (4) | PageId (4) | NextPageId (4) | HasLowKey (4) | LowKey | HighKey |
+ *  ----------------------------------------------------------------
+ *
+ * Like the leaves, the internal pages of each level are linked left to right through their next page id and carry
+ * fence keys: every key below the page satisfies low key <= K < high key. The first page of a level has no low key,
+ * the last one no next page and no high key.
+ *
+ * A COMPRESSED_INTERNAL_PAGE stores its pairs in the CompressedKeyLayout after the same header. Its keys are
+ * separators the tree truncated to the shortest key that still separates the two children, so their zero suffix
+ * is not stored. Whether another child fits depends on its key, see CanInsert().
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeInternalPage : public BPlusTreePage {
+  using Layout = CompressedKeyLayout<KeyType, ValueType>;
+  static constexpr size_t CAPACITY = BUSTUB_PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE;
+
  public:
+  /**
+   * Max size of a compressed internal page: twice the children that fit without any compression, less one, so both
+   * halves of a split fit and a page below the min size always has room for one more child.
+   */
+  static constexpr int COMPRESSED_MAX_SIZE = 2 * ((CAPACITY - Layout::HEADER_SIZE) / sizeof(MappingType)) - 1;
+
+  using KeyFormat = typename Layout::Format;
+
+  /** @return whether size entries in the given format fill at most fill_factor of a compressed page */
+  static auto Fits(const KeyFormat &format, int size, double fill_factor = 1.0) -> bool {
+    return static_cast<double>(format.Bytes(size)) <= static_cast<double>(CAPACITY) * fill_factor;
+  }
+
   // must call initialize method after "create" a new node
-  void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID, int max_size = INTERNAL_PAGE_SIZE);
+  void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID, int max_size = INTERNAL_PAGE_SIZE,
+            bool compressed = false);
 
   auto KeyAt(int index) const -> KeyType;
   void SetKeyAt(int index, const KeyType &key);
   auto ValueAt(int index) const -> ValueType;
+  void SetValueAt(int index, const ValueType &value);
+  auto ValueIndex(const ValueType &value) const -> int;
+
+  // right link and fence keys
+  auto GetNextPageId() const -> page_id_t;
+  void SetNextPageId(page_id_t next_page_id);
+  auto HasLowKey() const -> bool;
+  auto HasHighKey() const -> bool;
+  auto LowKey() const -> const KeyType &;
+  auto HighKey() const -> const KeyType &;
+  void SetLowKey(const KeyType &key);
+  void SetHighKey(const KeyType &key);
+
+  // lookup
+  auto Lookup(const KeyType &key, const KeyComparator &comparator) const -> ValueType;
+
+  // room checks, the tree splits a page instead of adding a child it has no room for
+  auto CanInsert(const KeyType &key) const -> bool;
+  auto CanInsertAnyKey() const -> bool;
+  auto CanSetKeyAt(int index, const KeyType &key) const -> bool;
+  auto CanMergeWith(const BPlusTreeInternalPage *sibling, const KeyType &middle_key) const -> bool;
+
+  // insertion, the caller makes sure the page has room for one more child
+  void PopulateNewRoot(const ValueType &old_value, const KeyType &new_key, const ValueType &new_value);
+  auto InsertNodeAfter(const ValueType &old_value, const KeyType &new_key, const ValueType &new_value) -> int;
+
+  // removal
+  void Remove(int index);
+  auto RemoveAndReturnOnlyChild() -> ValueType;
+
+  // split, merge and redistribute, the caller updates the parent page id of the moved children
+  void CopyAllTo(std::vector<std::pair<KeyType, ValueType>> *items) const;
+  void CopyNFrom(const std::pair<KeyType, ValueType> *items, int size);
+  void MoveAllTo(BPlusTreeInternalPage *recipient, const KeyType &middle_key);
+  void MoveFirstToEndOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key);
+  void MoveLastToFrontOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key);
 
  private:
+  auto Data() const -> const char * { return reinterpret_cast<const char *>(array_); }
+  auto Data() -> char * { return reinterpret_cast<char *>(array_); }
+  /** The first key is invalid and does not count for the format */
+  auto ReadFormat() const -> typename Layout::Format {
+    return Layout::ReadFormat(Data(), std::max(GetSize() - 1, 0));
+  }
+
+  page_id_t next_page_id_;
+  int has_low_key_;
+  KeyType low_key_;
+  KeyType high_key_;
   // Flexible array member for page data.
   MappingType array_[1];
 };
@@ -14,44 +14,117 @@
 #include <vector>
 
 #include "storage/page/b_plus_tree_page.h"
+#include "storage/page/compressed_key_layout.h"
+#include "storage/page/integer_key_search.h"
 
 namespace bustub {
 
 #define B_PLUS_TREE_LEAF_PAGE_TYPE BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>
-#define LEAF_PAGE_HEADER_SIZE 28
+#define LEAF_PAGE_HEADER_SIZE (32 + 2 * sizeof(KeyType))
 #define LEAF_PAGE_SIZE ((BUSTUB_PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / sizeof(MappingType))
 
 /**
  * Store indexed key and record id(record id = page id combined with slot id,
  * see include/common/rid.h for detailed implementation) together within leaf
- * page. Only support unique key.
+ * page. Keys are unique within a page; a non-unique tree keeps the values of a
+ * duplicate key in a posting list, see BPlusTreePostingPage.
  *
  * Leaf page format (keys are stored in order):
  *  ----------------------------------------------------------------------
  * | HEADER | KEY(1) + RID(1) | KEY(2) + RID(2) | ... | KEY(n) + RID(n)
  *  ----------------------------------------------------------------------
  *
- *  Header format (size in byte, 28 bytes in total):
+ *  Header format (size in byte, 32 bytes + two keys in total):
  *  ---------------------------------------------------------------------
  * | PageType (4) | LSN (4) | CurrentSize (4) | MaxSize (4) |
  *  ---------------------------------------------------------------------
- *  -----------------------------------------------
- * | ParentPageId (4) | PageId (4) | NextPageId (4)
- *  -----------------------------------------------
+ *  ----------------------------------------------------------------
+ * | ParentPageId (4) | PageId (4) | NextPageId (4) | PrevPageId (4)
+ *  ----------------------------------------------------------------
+ *  ----------------------------------------------------------------
+ * | LowKey | HighKey |
+ *  ----------------------------------------------------------------
+ *
+ * The next and previous page ids link the leaves in key order. A writer that changes which leaf comes before a page
+ * write-latches that page to update its previous page id, so a reader that holds a leaf's latch can rely on the
+ * leaf before it not to go away.
+ *
+ * The fence keys bound the keys the leaf is responsible for: low key <= K < high key. The first leaf has no low
+ * key and the last leaf no high key, so a leaf has a low key exactly if it has a previous leaf and a high key
+ * exactly if it has a next one. A reader that reaches a leaf through an outdated parent compares the key it looks
+ * for with the fences to notice, see BPlusTree.
+ *
+ * A COMPRESSED_LEAF_PAGE stores its pairs in the CompressedKeyLayout after the same header. The max size of such a
+ * page only bounds the number of pairs; whether another pair fits depends on its key, see CanInsert().
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeLeafPage : public BPlusTreePage {
+  using Layout = CompressedKeyLayout<KeyType, ValueType>;
+  static constexpr size_t CAPACITY = BUSTUB_PAGE_SIZE - LEAF_PAGE_HEADER_SIZE;
+
  public:
+  /**
+   * Max size of a compressed leaf: twice the pairs that fit without any compression, so a split always fits into
+   * two pages and a leaf below the min size always has room for one more pair.
+   */
+  static constexpr int COMPRESSED_MAX_SIZE = 2 * ((CAPACITY - Layout::HEADER_SIZE) / sizeof(MappingType));
+
+  using KeyFormat = typename Layout::Format;
+
+  /** @return whether size entries in the given format fill at most fill_factor of a compressed page */
+  static auto Fits(const KeyFormat &format, int size, double fill_factor = 1.0) -> bool {
+    return static_cast<double>(format.Bytes(size)) <= static_cast<double>(CAPACITY) * fill_factor;
+  }
+
   // After creating a new leaf page from buffer pool, must call initialize
   // method to set default values
-  void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID, int max_size = LEAF_PAGE_SIZE);
+  void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID, int max_size = LEAF_PAGE_SIZE,
+            bool compressed = false);
   // helper methods
   auto GetNextPageId() const -> page_id_t;
   void SetNextPageId(page_id_t next_page_id);
+  auto GetPrevPageId() const -> page_id_t;
+  void SetPrevPageId(page_id_t prev_page_id);
+  auto HasLowKey() const -> bool;
+  auto HasHighKey() const -> bool;
+  auto LowKey() const -> const KeyType &;
+  auto HighKey() const -> const KeyType &;
+  void SetLowKey(const KeyType &key);
+  void SetHighKey(const KeyType &key);
   auto KeyAt(int index) const -> KeyType;
+  auto ValueAt(int index) const -> ValueType;
+  void SetValueAt(int index, const ValueType &value);
+  auto GetItem(int index) const -> MappingType;
+  auto KeyIndex(const KeyType &key, const KeyComparator &comparator) const -> int;
+
+  // room checks, a leaf splits instead of taking a pair it has no room for
+  auto CanInsert(const KeyType &key) const -> bool;
+  auto CanMergeWith(const BPlusTreeLeafPage *sibling) const -> bool;
+  auto Fill() const -> double;
+
+  // insert and delete methods
+  auto Insert(const KeyType &key, const ValueType &value, const KeyComparator &comparator) -> int;
+  auto Lookup(const KeyType &key, ValueType *value, const KeyComparator &comparator) const -> bool;
+  auto RemoveAndDeleteRecord(const KeyType &key, const KeyComparator &comparator) -> int;
+
+  // split and merge utility methods
+  void MoveHalfTo(BPlusTreeLeafPage *recipient);
+  void MoveAllTo(BPlusTreeLeafPage *recipient);
+  void MoveFirstToEndOf(BPlusTreeLeafPage *recipient);
+  void MoveLastToFrontOf(BPlusTreeLeafPage *recipient);
+
+  // split and bulk load: copy the pairs out, or replace the content with size sorted pairs
+  void CopyAllTo(std::vector<MappingType> *items) const;
+  void CopyNFrom(const MappingType *items, int size);
 
  private:
+  auto Data() const -> const char * { return reinterpret_cast<const char *>(array_); }
+  auto Data() -> char * { return reinterpret_cast<char *>(array_); }
+
   page_id_t next_page_id_;
+  page_id_t prev_page_id_;
+  KeyType low_key_;
+  KeyType high_key_;
   // Flexible array member for page data.
   MappingType array_[1];
 };
@@ -24,8 +24,14 @@ namespace bustub {
 
 #define INDEX_TEMPLATE_ARGUMENTS template <typename KeyType, typename ValueType, typename KeyComparator>
 
-// define page type enum
-enum class IndexPageType { INVALID_INDEX_PAGE = 0, LEAF_PAGE, INTERNAL_PAGE };
+// define page type enum, the compressed types store their keys prefix and suffix compressed
+enum class IndexPageType {
+  INVALID_INDEX_PAGE = 0,
+  LEAF_PAGE,
+  INTERNAL_PAGE,
+  COMPRESSED_LEAF_PAGE,
+  COMPRESSED_INTERNAL_PAGE
+};
 
 /**
  * Both internal and leaf page are inherited from this page.
@@ -44,6 +50,8 @@ class BPlusTreePage {
  public:
   auto IsLeafPage() const -> bool;
   auto IsRootPage() const -> bool;
+  auto IsCompressed() const -> bool;
+  auto IsDeleted() const -> bool;
   void SetPageType(IndexPageType page_type);
 
   auto GetSize() const -> int;
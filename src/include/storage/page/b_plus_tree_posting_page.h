@@ -0,0 +1,68 @@
+//===----------------------------------------------------------------------===//
+//
+//                         CMU-DB Project (15-445/645)
+//                         ***DO NO SHARE PUBLICLY***
+//
+// Identification: src/include/page/b_plus_tree_posting_page.h
+//
+// Copyright (c) 2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include <climits>
+
+#include "common/config.h"
+#include "common/rid.h"
+
+namespace bustub {
+
+/**
+ * Posting list page of a non-unique b+ tree.
+ *
+ * A non-unique tree still keeps one leaf entry per key. Once a key has more than one value, the value of its entry
+ * becomes a reference to a chain of posting pages holding all of them. A chain belongs to its leaf entry: it is only
+ * read or changed under the latch of the leaf that holds the entry, and moves along with the entry when leaves
+ * split, merge or redistribute.
+ *
+ * Format (size in byte):
+ *  ----------------------------------------------------------------
+ * | NextPageId (4) | Size (4) | RID(1) (8) | RID(2) (8) | ... | RID(n) |
+ *  ----------------------------------------------------------------
+ */
+class BPlusTreePostingPage {
+ public:
+  /** Slot number that marks a leaf value as a posting list reference, no table page has that many slots */
+  static constexpr uint32_t LIST_SLOT = UINT32_MAX;
+  /** Number of values that fit into one posting page */
+  static constexpr int CAPACITY = (BUSTUB_PAGE_SIZE - 2 * sizeof(int32_t)) / sizeof(RID);
+
+  /** @return whether a leaf value references a posting list instead of being a value itself */
+  static auto IsListRef(const RID &value) -> bool { return value.GetSlotNum() == LIST_SLOT; }
+  /** @return the leaf value that references the posting list starting at page_id */
+  static auto ListRef(page_id_t page_id) -> RID { return {page_id, LIST_SLOT}; }
+
+  // must call initialize method after "create" a new posting page
+  void Init(page_id_t next_page_id = INVALID_PAGE_ID);
+
+  auto GetNextPageId() const -> page_id_t;
+  void SetNextPageId(page_id_t next_page_id);
+  auto GetSize() const -> int;
+  auto IsFull() const -> bool;
+
+  auto ValueAt(int index) const -> RID;
+  /** @return the index of value, -1 if the page does not hold it */
+  auto IndexOf(const RID &value) const -> int;
+  /** Append a value, the page must not be full. */
+  void Append(const RID &value);
+  /** Remove the value at index, the last value of the page takes its place. */
+  void RemoveAt(int index);
+
+ private:
+  page_id_t next_page_id_;
+  int size_;
+  // Flexible array member for page data.
+  RID array_[1];
+};
+
+}  // namespace bustub
@@ -0,0 +1,197 @@
+//===----------------------------------------------------------------------===//
+//
+//                         CMU-DB Project (15-445/645)
+//                         ***DO NO SHARE PUBLICLY***
+//
+// Identification: src/include/page/compressed_key_layout.h
+//
+// Copyright (c) 2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+namespace bustub {
+
+/**
+ * Entry layout of the compressed b+ tree page types.
+ *
+ * GenericKey pads every key with zeros up to its fixed size, and the keys of one page mostly start with the same
+ * bytes, e.g. the same leading columns of a composite key. A compressed page stores the bytes that all of its keys
+ * start with once (prefix elimination) and cuts every key after the last byte that is not zero in any of them (the
+ * padding, and the zeros a truncated separator ends with). All keys of a page keep the same number of bytes, so
+ * the entries stay fixed size and are binary searched like the plain layout:
+ *
+ *  ----------------------------------------------------------------------------------------
+ * | PrefixSize (2) | KeySize (2) | PREFIX | KEY(0) + VALUE(0) | KEY(1) + VALUE(1) | ... |
+ *  ----------------------------------------------------------------------------------------
+ *
+ * Keys are the prefix, their KeySize stored bytes and zeros. How many entries fit depends on the keys, so a page
+ * checks the room in bytes before it takes a key. Entries are not aligned, values are copied in and out.
+ */
+template <typename KeyType, typename ValueType>
+class CompressedKeyLayout {
+ public:
+  using Item = std::pair<KeyType, ValueType>;
+
+  /** Bytes of the layout header, PrefixSize and KeySize */
+  static constexpr size_t HEADER_SIZE = 2 * sizeof(uint16_t);
+
+  /**
+   * How the keys of a page are cut: all keys start with the same prefix_size_ bytes and are zero from end_ on. The
+   * page stores bytes [0, SharedSize()) once and bytes [SharedSize(), end_) per key.
+   */
+  struct Format {
+    /** Add a key to the keys the format covers. */
+    void Add(const KeyType &key) {
+      if (keys_++ == 0) {
+        first_ = key;
+        prefix_size_ = sizeof(KeyType);
+      } else {
+        prefix_size_ = CommonPrefix(first_, key, prefix_size_);
+      }
+      end_ = std::max(end_, Significant(key));
+    }
+
+    /** @return the bytes stored once, the shared prefix is zero after end_ like the rest of the keys */
+    auto SharedSize() const -> size_t { return std::min(prefix_size_, end_); }
+
+    /** @return the bytes count entries take in this format */
+    auto Bytes(size_t count) const -> size_t {
+      return HEADER_SIZE + SharedSize() + count * (end_ - SharedSize() + sizeof(ValueType));
+    }
+
+    /** A key carrying the shared prefix */
+    KeyType first_;
+    size_t keys_{0};
+    size_t prefix_size_{0};
+    size_t end_{0};
+  };
+
+  /**
+   * Read the format of a page back.
+   * @param keys the number of valid keys on the page, the format is empty without any
+   */
+  static auto ReadFormat(const char *data, size_t keys) -> Format {
+    Format format;
+    if (keys == 0) {
+      return format;
+    }
+    size_t shared_size = ReadUint16(data);
+    size_t key_size = ReadUint16(data + sizeof(uint16_t));
+    format.keys_ = keys;
+    format.end_ = shared_size + key_size;
+    // Without stored bytes the keys are equal up to end_, and all zero after it.
+    format.prefix_size_ = key_size == 0 ? sizeof(KeyType) : shared_size;
+    memset(reinterpret_cast<char *>(&format.first_), 0, sizeof(KeyType));
+    memcpy(reinterpret_cast<char *>(&format.first_), data + HEADER_SIZE, shared_size);
+    return format;
+  }
+
+  /**
+   * @param first_key index of the first valid key, the first key of an internal page is invalid
+   * @return whether count items fit into capacity bytes
+   */
+  static auto Fits(const Item *items, int count, int first_key, size_t capacity) -> bool {
+    return FormatOf(items, count, first_key).Bytes(count) <= capacity;
+  }
+
+  /** Write count items in the format of their valid keys. The caller makes sure that they fit. */
+  static void Write(char *data, const Item *items, int count, int first_key) {
+    Format format = FormatOf(items, count, first_key);
+    size_t shared_size = format.SharedSize();
+    size_t key_size = format.end_ - shared_size;
+    WriteUint16(data, shared_size);
+    WriteUint16(data + sizeof(uint16_t), key_size);
+    memcpy(data + HEADER_SIZE, reinterpret_cast<const char *>(&format.first_), shared_size);
+    char *entry = data + HEADER_SIZE + shared_size;
+    for (int i = 0; i < count; i++) {
+      memcpy(entry, reinterpret_cast<const char *>(&items[i].first) + shared_size, key_size);
+      memcpy(entry + key_size, &items[i].second, sizeof(ValueType));
+      entry += key_size + sizeof(ValueType);
+    }
+  }
+
+  static auto KeyAt(const char *data, int index) -> KeyType {
+    size_t prefix_size = ReadUint16(data);
+    size_t key_size = ReadUint16(data + sizeof(uint16_t));
+    KeyType key;
+    auto *bytes = reinterpret_cast<char *>(&key);
+    memcpy(bytes, data + HEADER_SIZE, prefix_size);
+    memcpy(bytes + prefix_size, EntryAt(data, index), key_size);
+    memset(bytes + prefix_size + key_size, 0, sizeof(KeyType) - prefix_size - key_size);
+    return key;
+  }
+
+  static auto ValueAt(const char *data, int index) -> ValueType {
+    ValueType value;
+    memcpy(&value, EntryAt(data, index) + ReadUint16(data + sizeof(uint16_t)), sizeof(ValueType));
+    return value;
+  }
+
+  static void SetValueAt(char *data, int index, const ValueType &value) {
+    memcpy(const_cast<char *>(EntryAt(data, index)) + ReadUint16(data + sizeof(uint16_t)), &value,
+           sizeof(ValueType));
+  }
+
+  static void ReadAll(const char *data, int count, std::vector<Item> *items) {
+    items->clear();
+    items->reserve(count);
+    for (int i = 0; i < count; i++) {
+      items->emplace_back(KeyAt(data, i), ValueAt(data, i));
+    }
+  }
+
+  /** @return the length of key without its trailing zeros */
+  static auto Significant(const KeyType &key) -> size_t {
+    const auto *bytes = reinterpret_cast<const char *>(&key);
+    size_t end = sizeof(KeyType);
+    while (end > 0 && bytes[end - 1] == 0) {
+      end--;
+    }
+    return end;
+  }
+
+ private:
+  static auto FormatOf(const Item *items, int count, int first_key) -> Format {
+    Format format;
+    for (int i = first_key; i < count; i++) {
+      format.Add(items[i].first);
+    }
+    return format;
+  }
+
+  static auto CommonPrefix(const KeyType &a, const KeyType &b, size_t limit) -> size_t {
+    const auto *bytes_a = reinterpret_cast<const char *>(&a);
+    const auto *bytes_b = reinterpret_cast<const char *>(&b);
+    size_t length = 0;
+    while (length < limit && bytes_a[length] == bytes_b[length]) {
+      length++;
+    }
+    return length;
+  }
+
+  static auto EntryAt(const char *data, int index) -> const char * {
+    size_t prefix_size = ReadUint16(data);
+    size_t key_size = ReadUint16(data + sizeof(uint16_t));
+    return data + HEADER_SIZE + prefix_size + index * (key_size + sizeof(ValueType));
+  }
+
+  static auto ReadUint16(const char *data) -> size_t {
+    uint16_t value;
+    memcpy(&value, data, sizeof(uint16_t));
+    return value;
+  }
+
+  static void WriteUint16(char *data, size_t value) {
+    auto narrow = static_cast<uint16_t>(value);
+    memcpy(data, &narrow, sizeof(uint16_t));
+  }
+};
+
+}  // namespace bustub
@@ -40,6 +40,9 @@ class HashTableBucketPage {
   // Delete all constructor / destructor to ensure memory safety
   HashTableBucketPage() = delete;
 
+  /** The number of slots of the page */
+  static constexpr uint32_t ARRAY_SIZE = BUCKET_ARRAY_SIZE;
+
   /**
    * Scan the bucket and collect values that have the matching key
    *
@@ -0,0 +1,108 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hash_table_fingerprint_bucket_page.h
+//
+// Identification: src/include/storage/page/hash_table_fingerprint_bucket_page.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include "common/config.h"
+#include "storage/index/int_comparator.h"
+#include "storage/page/hash_table_page_defs.h"
+
+namespace bustub {
+/**
+ * A bucket page that keeps a one byte fingerprint of the hash of every key, to find the slots worth comparing keys
+ * at without touching the pairs. It is a drop-in replacement for HashTableBucketPage in DiskExtendibleHashTable.
+ *
+ * Bucket page format (size in byte):
+ *  ---------------------------------------------------------------------------------------
+ * | NumReadable(4) | Fingerprints(n) | padding | KEY(1) + VALUE(1) | ... | KEY(n) + VALUE(n)
+ *  ---------------------------------------------------------------------------------------
+ *
+ * A fingerprint is the top byte of the murmur hash of the key, and 0 marks a free slot, so a key whose top byte is 0
+ * gets fingerprint 1. A lookup compares the fingerprint of its key against 16 slots at a time with SSE2, 32 with AVX2
+ * when the build targets it, and compares keys only at the slots that match, about one in 255 of the other keys. The
+ * pairs are not kept in any order and a removal just frees its slot, so there are no tombstones.
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+class HashTableFingerprintBucketPage {
+ public:
+  // Delete all constructor / destructor to ensure memory safety
+  HashTableFingerprintBucketPage() = delete;
+
+  /** The number of slots of the page */
+  static constexpr uint32_t ARRAY_SIZE = FINGERPRINT_BUCKET_ARRAY_SIZE;
+
+  /**
+   * Collect the values of the pairs that have the matching key
+   *
+   * @return true if at least one key matched
+   */
+  auto GetValue(KeyType key, KeyComparator cmp, std::vector<ValueType> *result) -> bool;
+
+  /**
+   * Attempts to insert a key and value into a free slot of the bucket.
+   *
+   * @return true if inserted, false if duplicate KV pair or bucket is full
+   */
+  auto Insert(KeyType key, ValueType value, KeyComparator cmp) -> bool;
+
+  /**
+   * Removes a key and value.
+   *
+   * @return true if removed, false if not found
+   */
+  auto Remove(KeyType key, ValueType value, KeyComparator cmp) -> bool;
+
+  /** @return key at index bucket_idx of the bucket */
+  auto KeyAt(uint32_t bucket_idx) const -> KeyType;
+
+  /** @return value at index bucket_idx of the bucket */
+  auto ValueAt(uint32_t bucket_idx) const -> ValueType;
+
+  /** Remove the KV pair at bucket_idx, if there is one */
+  void RemoveAt(uint32_t bucket_idx);
+
+  /** @return true if the slot at bucket_idx holds a pair */
+  auto IsReadable(uint32_t bucket_idx) const -> bool;
+
+  /** @return the number of pairs, i.e. current size */
+  auto NumReadable() -> uint32_t;
+
+  /** @return whether the bucket is full */
+  auto IsFull() -> bool;
+
+  /** @return whether the bucket is empty */
+  auto IsEmpty() -> bool;
+
+  /** Prints the bucket's occupancy information */
+  void PrintBucket();
+
+ private:
+  /** @return the fingerprint of a key, never 0 */
+  static auto Fingerprint(KeyType key) -> uint8_t;
+
+  /**
+   * Call visit(bucket_idx) for every slot whose fingerprint is fingerprint, in slot order, until it returns true.
+   * @return the slot visit returned true for, ARRAY_SIZE if it never did
+   */
+  template <typename Visit>
+  auto FindSlot(uint8_t fingerprint, Visit &&visit) const -> uint32_t;
+
+  uint32_t num_readable_;
+  uint8_t fingerprints_[FINGERPRINT_BUCKET_ARRAY_SIZE];
+  // Flexible array member for page data.
+  MappingType array_[1];
+};
+
+}  // namespace bustub
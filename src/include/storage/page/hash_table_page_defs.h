@@ -40,6 +40,18 @@
  */
 #define BUCKET_ARRAY_SIZE (4 * BUSTUB_PAGE_SIZE / (4 * sizeof(MappingType) + 1))
 
+/**
+ * Extendible Hashing Definitions for bucket pages with fingerprints
+ */
+#define HASH_TABLE_FINGERPRINT_BUCKET_TYPE HashTableFingerprintBucketPage<KeyType, ValueType, KeyComparator>
+
+/**
+ * FINGERPRINT_BUCKET_ARRAY_SIZE is the number of (key, value) pairs that can be stored in a fingerprint bucket page.
+ * Every pair takes one more byte for its fingerprint, and 8 bytes go to the count of pairs and the padding before the
+ * pairs. The number is rounded down to a multiple of 16, so that the fingerprints can be compared 16 at a time.
+ */
+#define FINGERPRINT_BUCKET_ARRAY_SIZE ((BUSTUB_PAGE_SIZE - 8) / (sizeof(MappingType) + 1) / 16 * 16)
+
 /**
  * DIRECTORY_ARRAY_SIZE is the number of page_ids that can fit in the directory page of an extendible hash index.
  * This is 512 because the directory array must grow in powers of 2, and 1024 page_ids leaves zero room for
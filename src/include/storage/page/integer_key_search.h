@@ -0,0 +1,103 @@
+//===----------------------------------------------------------------------===//
+//
+//                         CMU-DB Project (15-445/645)
+//                         ***DO NO SHARE PUBLICLY***
+//
+// Identification: src/include/page/integer_key_search.h
+//
+// Copyright (c) 2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+
+namespace bustub {
+
+/**
+ * Whether a comparator can tell that its keys are plain integers, see GenericComparator::IntegerKeySize(). Pages
+ * only take the integer search for such comparators, every other comparator keeps the generic binary search.
+ */
+template <typename KeyComparator, typename = void>
+struct HasIntegerKeys : std::false_type {};
+
+template <typename KeyComparator>
+struct HasIntegerKeys<KeyComparator, std::void_t<decltype(std::declval<const KeyComparator &>().IntegerKeySize())>>
+    : std::true_type {};
+
+/**
+ * In-node search over the keys of a plain b+ tree page whose keys are integers stored at the start of the key.
+ *
+ * The entries of a plain page are key/value pairs, so the keys lie stride bytes apart. The search loads every probe
+ * as an integer and halves the range without a branch on the comparison, which the compiler turns into a
+ * conditional move: the loop runs log2(size) times whatever the keys are, and there is no misprediction to pay for
+ * on a page that is already in cache.
+ */
+class IntegerKeySearch {
+ public:
+  /**
+   * @param data the key of the first entry
+   * @param stride the bytes from one key to the next
+   * @param size the number of entries
+   * @param key the key to search for, its first key_size bytes hold the integer
+   * @param key_size the width of the integer, 1, 2, 4 or 8 bytes
+   * @return the index of the first entry whose key is not less than key, size if there is none
+   */
+  static auto LowerBound(const char *data, size_t stride, int size, const void *key, size_t key_size) -> int {
+    return Dispatch<false>(data, stride, size, key, key_size);
+  }
+
+  /** @return the index of the first entry whose key is greater than key, size if there is none */
+  static auto UpperBound(const char *data, size_t stride, int size, const void *key, size_t key_size) -> int {
+    return Dispatch<true>(data, stride, size, key, key_size);
+  }
+
+ private:
+  template <bool Upper>
+  static auto Dispatch(const char *data, size_t stride, int size, const void *key, size_t key_size) -> int {
+    switch (key_size) {
+      case sizeof(int8_t):
+        return Search<int8_t, Upper>(data, stride, size, Load<int8_t>(key));
+      case sizeof(int16_t):
+        return Search<int16_t, Upper>(data, stride, size, Load<int16_t>(key));
+      case sizeof(int32_t):
+        return Search<int32_t, Upper>(data, stride, size, Load<int32_t>(key));
+      default:
+        return Search<int64_t, Upper>(data, stride, size, Load<int64_t>(key));
+    }
+  }
+
+  template <typename Int, bool Upper>
+  static auto Search(const char *data, size_t stride, int size, Int key) -> int {
+    if (size == 0) {
+      return 0;
+    }
+    // The answer lies in [base, base + n], every probe drops the half it is not in.
+    int base = 0;
+    int n = size;
+    while (n > 1) {
+      int half = n / 2;
+      base = Before<Upper>(Load<Int>(data + (base + half) * stride), key) ? base + half : base;
+      n -= half;
+    }
+    return base + static_cast<int>(Before<Upper>(Load<Int>(data + base * stride), key));
+  }
+
+  /** @return whether an entry with key probe comes before the bound of key */
+  template <bool Upper, typename Int>
+  static auto Before(Int probe, Int key) -> bool {
+    return Upper ? probe <= key : probe < key;
+  }
+
+  template <typename Int>
+  static auto Load(const void *data) -> Int {
+    Int value;
+    memcpy(&value, data, sizeof(Int));
+    return value;
+  }
+};
+
+}  // namespace bustub
@@ -12,8 +12,10 @@
 
 #pragma once
 
+#include <atomic>
 #include <cstring>
 #include <iostream>
+#include <thread>  // NOLINT
 
 #include "common/config.h"
 #include "common/rwlatch.h"
@@ -51,12 +53,49 @@ class Page {
   /** Acquire the page write latch. */
   inline void WLatch() { rwlatch_.WLock(); }
 
-  /** Release the page write latch. */
-  inline void WUnlatch() { rwlatch_.WUnlock(); }
+  /** Release the page write latch, which ends an update begun with BeginUpdate(). */
+  inline void WUnlatch() {
+    uint64_t version = version_.load(std::memory_order_relaxed);
+    if (version % 2 == 1) {
+      version_.store(version + 1, std::memory_order_release);
+    }
+    rwlatch_.WUnlock();
+  }
+
+  /**
+   * Announce that the holder of the write latch is about to change the page data. Readers that do not latch the
+   * page notice the change through the page version, see ReadVersion(). Calling it again before the write latch is
+   * released does nothing; a page that is latched but not changed keeps its version.
+   */
+  inline void BeginUpdate() {
+    uint64_t version = version_.load(std::memory_order_relaxed);
+    if (version % 2 == 0) {
+      version_.store(version + 1, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_release);
+    }
+  }
+
+  /** @return the version of the page data, waiting for an update in progress to end */
+  inline auto ReadVersion() -> uint64_t {
+    uint64_t version;
+    while ((version = version_.load(std::memory_order_acquire)) % 2 == 1) {
+      std::this_thread::yield();
+    }
+    return version;
+  }
+
+  /** @return true if the page data did not change since ReadVersion() returned version */
+  inline auto ValidateVersion(uint64_t version) -> bool {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return version_.load(std::memory_order_relaxed) == version;
+  }
 
   /** Acquire the page read latch. */
   inline void RLatch() { rwlatch_.RLock(); }
 
+  /** Acquire the page read latch if that does not need to wait. @return true if the latch is held now */
+  inline auto TryRLatch() -> bool { return rwlatch_.TryRLock(); }
+
   /** Release the page read latch. */
   inline void RUnlatch() { rwlatch_.RUnlock(); }
 
@@ -89,6 +128,8 @@ class Page {
   bool is_dirty_ = false;
   /** Page latch. */
   ReaderWriterLatch rwlatch_;
+  /** Version of the page data, odd while an update is in progress. */
+  std::atomic<uint64_t> version_{0};
 };
 
 }  // namespace bustub
@@ -110,9 +110,28 @@ class TablePage : public Page {
   /** To be called on commit or abort. Actually perform the delete or rollback an insert. */
   void ApplyDelete(const RID &rid, Transaction *txn, LogManager *log_manager);
 
+  /**
+   * Shrink the slot array past its last occupied slot. Slots in the middle stay, their RIDs may be reused by inserts.
+   * The tuple data itself never needs compaction, ApplyDelete() and UpdateTuple() keep it contiguous.
+   * @return the number of bytes returned to the free space
+   */
+  auto TrimEmptySlots() -> uint32_t;
+
   /** To be called on abort. Rollback a delete, i.e. this reverses a MarkDelete. */
   void RollbackDelete(const RID &rid, Transaction *txn, LogManager *log_manager);
 
+  /**
+   * To be called on abort. Rollback an update that kept the size of the tuple by copying the old bytes back in place.
+   * @param rid rid of the updated tuple
+   * @param tuple_size the size of the tuple before and after the update
+   * @param offset where the old bytes start in the tuple
+   * @param data the old bytes
+   * @param size the number of old bytes
+   * @return false if the tuple is gone or has a different size
+   */
+  auto RestoreTupleBytes(const RID &rid, uint32_t tuple_size, uint32_t offset, const char *data, uint32_t size)
+      -> bool;
+
   /**
    * Read a tuple from a table.
    * @param rid rid of the tuple to read
@@ -123,20 +142,34 @@ class TablePage : public Page {
    */
   auto GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, LockManager *lock_manager) -> bool;
 
+  /**
+   * Read a tuple from a table even if it is marked deleted; MVCC readers may still see the deleted version.
+   * @param rid rid of the tuple to read
+   * @param[out] tuple the tuple that was read
+   * @param[out] is_deleted whether the tuple is marked deleted
+   * @return true if the slot holds a tuple
+   */
+  auto GetTupleIgnoreDelete(const RID &rid, Tuple *tuple, bool *is_deleted) -> bool;
+
+  /** @return true if the slot of rid holds a tuple that is marked deleted */
+  auto IsMarkedDeleted(const RID &rid) -> bool;
+
   /** @return the rid of the first tuple in this page */
 
   /**
    * @param[out] first_rid the RID of the first tuple in this page
+   * @param include_deleted whether tuples marked deleted count as tuples
    * @return true if the first tuple exists, false otherwise
    */
-  auto GetFirstTupleRid(RID *first_rid) -> bool;
+  auto GetFirstTupleRid(RID *first_rid, bool include_deleted = false) -> bool;
 
   /**
    * @param cur_rid the RID of the current tuple
    * @param[out] next_rid the RID of the tuple following the current tuple
+   * @param include_deleted whether tuples marked deleted count as tuples
    * @return true if the next tuple exists, false otherwise
    */
-  auto GetNextTupleRid(const RID &cur_rid, RID *next_rid) -> bool;
+  auto GetNextTupleRid(const RID &cur_rid, RID *next_rid, bool include_deleted = false) -> bool;
 
  private:
   static_assert(sizeof(page_id_t) == 4);
@@ -12,11 +12,17 @@
 
 #pragma once
 
+#include <atomic>
+#include <mutex>  // NOLINT
+#include <unordered_set>
+#include <vector>
+
 #include "buffer/buffer_pool_manager.h"
 #include "recovery/log_manager.h"
 #include "storage/page/table_page.h"
 #include "storage/table/table_iterator.h"
 #include "storage/table/tuple.h"
+#include "storage/table/version_store.h"
 
 namespace bustub {
 
@@ -63,7 +69,7 @@ class TableHeap {
    * Mark the tuple as deleted. The actual delete will occur when ApplyDelete is called.
    * @param rid resource id of the tuple of delete
    * @param txn transaction performing the delete
-   * @return true iff the delete is successful (i.e the tuple exists)
+   * @return true iff the delete is successful (i.e the tuple exists), false on a write-write conflict
    */
   auto MarkDelete(const RID &rid, Transaction *txn) -> bool;  // for delete
 
@@ -72,7 +78,7 @@ class TableHeap {
    * @param tuple new tuple
    * @param rid rid of the old tuple
    * @param txn transaction performing the update
-   * @return true is update is successful.
+   * @return true is update is successful, false if it does not fit or on a write-write conflict (txn is aborted)
    */
   auto UpdateTuple(const Tuple &tuple, const RID &rid, Transaction *txn) -> bool;
 
@@ -91,11 +97,50 @@ class TableHeap {
   void RollbackDelete(const RID &rid, Transaction *txn);
 
   /**
-   * Read a tuple from the table.
+   * Called on abort to undo all the writes of a transaction to one page under a single page latch.
+   * @param page_id the page the writes went to
+   * @param records the write records of txn on that page, newest first
+   * @param txn transaction performing the rollback
+   */
+  void RollbackPage(page_id_t page_id, const std::vector<const TableWriteRecord *> &records, Transaction *txn);
+
+  /**
+   * Claim a tuple for the commit of an optimistic transaction: record txn as its writer without changing the page,
+   * so that other writers and optimistic validations see it as locked. VersionStore::Rollback() releases the claim.
+   * @return false if another transaction is writing the tuple or the slot is empty
+   */
+  auto ReserveWrite(const RID &rid, Transaction *txn) -> bool;
+
+  /**
+   * Read a tuple that is marked deleted, whichever transaction deleted it.
+   * @param rid rid of the deleted tuple
+   * @param[out] tuple the deleted tuple
+   * @return false if the slot is empty or holds a tuple that is not marked deleted
+   */
+  auto GetDeletedTuple(const RID &rid, Tuple *tuple) -> bool;
+
+  /**
+   * Free the slot of a tuple whose delete is committed and invisible to every running transaction.
+   * @param rid rid of the deleted tuple
+   * @param[out] tuple the deleted tuple, so that the caller can clean up its index entries
+   * @return the number of bytes returned to the free space of the page, 0 if the slot holds no deleted tuple
+   */
+  auto Reclaim(const RID &rid, Tuple *tuple) -> size_t;
+
+  /**
+   * Drop the tuple versions no snapshot can read anymore and shrink the slot arrays of the pages that had slots freed
+   * since the last call.
+   * @param watermark the oldest snapshot timestamp that is still in use
+   * @return the number of bytes reclaimed
+   */
+  auto Compact(timestamp_t watermark) -> size_t;
+
+  /**
+   * Read a tuple from the table. Snapshot isolation transactions read the version visible to their snapshot.
    * @param rid rid of the tuple to read
    * @param tuple output variable for the tuple
    * @param txn transaction performing the read
-   * @return true if the read was successful (i.e. the tuple exists)
+   * @return true if the read was successful (i.e. the tuple exists and is visible to txn)
    */
   auto GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, bool acquire_read_lock = true) -> bool;
 
@@ -108,11 +153,26 @@ class TableHeap {
   /** @return the id of the first page of this table */
   inline auto GetFirstPageId() const -> page_id_t { return first_page_id_; }
 
+  /** @return the version chains of the tuples in this table */
+  inline auto GetVersionStore() -> VersionStore * { return &version_store_; }
+
+  /**
+   * @return true if some tuple of this table is marked deleted. Index entries of a deleted tuple stay until its slot
+   * is freed, so only then may an index disagree with the table.
+   */
+  inline auto HasMarkedDeletes() const -> bool { return marked_deletes_.load() != 0; }
+
  private:
   BufferPoolManager *buffer_pool_manager_;
   LockManager *lock_manager_;
   LogManager *log_manager_;
   page_id_t first_page_id_{};
+  VersionStore version_store_;
+  /** Number of tuples marked deleted whose slot is not freed yet */
+  std::atomic<size_t> marked_deletes_{0};
+  /** Pages that had slots freed without trimming their slot arrays, Compact() trims them */
+  std::unordered_set<page_id_t> untrimmed_pages_;
+  std::mutex untrimmed_latch_;
 };
 
 }  // namespace bustub
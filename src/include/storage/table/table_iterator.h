@@ -58,6 +58,11 @@ class TableIterator {
   }
 
  private:
+  /** @return true if the iterator reads the snapshot of a snapshot isolation transaction */
+  auto IsSnapshotRead() const -> bool {
+    return txn_ != nullptr && txn_->GetIsolationLevel() == IsolationLevel::SNAPSHOT_ISOLATION;
+  }
+
   TableHeap *table_heap_;
   Tuple *tuple_;
   Transaction *txn_;
@@ -0,0 +1,154 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// version_store.h
+//
+// Identification: src/include/storage/table/version_store.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+#include "common/config.h"
+#include "common/rid.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+class Transaction;
+
+/**
+ * VersionStore keeps the MVCC version chains of the tuples of one TableHeap.
+ *
+ * The newest version of a tuple always lives in place on its TablePage (possibly marked deleted). A RID only has a
+ * version chain while its newest version is uncommitted, or while a running snapshot may still need the versions
+ * it replaced. A tuple without a chain was committed before every running snapshot and is visible to everyone.
+ *
+ * Writers check and record their writes while holding the write latch of the tuple's page, readers resolve the
+ * version they see while holding its read latch, so the page and the chain always describe the same newest version.
+ *
+ * For optimistic transactions the store also keeps a version word per tuple, set to a new value of a store wide clock
+ * whenever a write to the tuple commits, and an insert version per table, bumped by every insert. An uncommitted
+ * writer acts as the lock bit of the version word. The word of a tuple is dropped with its slot; as the clock never
+ * goes back, a tuple inserted into the freed slot later never repeats a version word of the old one.
+ */
+class VersionStore {
+ public:
+  /** A committed version of a tuple that a later write replaced. */
+  struct UndoVersion {
+    /** The tuple as it was before the write */
+    Tuple tuple_;
+    /** Whether the tuple was deleted at that point */
+    bool is_deleted_;
+    /** Commit timestamp of the version */
+    timestamp_t ts_;
+  };
+
+  /** The version chain of one RID. */
+  struct VersionChain {
+    /** Commit timestamp of the newest (in place) version, meaningless while writer_ is valid */
+    timestamp_t ts_{0};
+    /** The transaction that wrote the newest version if it is not committed yet, INVALID_TXN_ID otherwise */
+    txn_id_t writer_{INVALID_TXN_ID};
+    /** The versions replaced by the newest one, oldest first */
+    std::vector<UndoVersion> undo_;
+  };
+
+  /**
+   * Resolve the version of a tuple that a snapshot isolation transaction sees.
+   * @param rid the tuple
+   * @param txn the reading transaction
+   * @param[in,out] tuple in: the newest version read from the page, out: the visible version
+   * @param is_deleted whether the newest version is marked deleted on the page
+   * @return false if no version is visible to txn, or the visible version is a delete
+   */
+  auto Read(const RID &rid, Transaction *txn, Tuple *tuple, bool is_deleted) -> bool;
+
+  /**
+   * Check whether txn may overwrite or delete the newest version of a tuple. It may not if another transaction
+   * wrote it and did not commit yet, or if txn reads a snapshot and the newest version committed after it.
+   * @return false on a write-write conflict
+   */
+  auto CheckWrite(const RID &rid, Transaction *txn) -> bool;
+
+  /**
+   * Record that txn overwrote or deleted the newest version of a tuple. Only the first write of a transaction to a
+   * RID keeps the old version; later writes of the same transaction replace its own uncommitted version.
+   * @param old_tuple the newest version before the write
+   * @param old_deleted whether old_tuple was marked deleted
+   */
+  void RecordWrite(const RID &rid, Transaction *txn, const Tuple &old_tuple, bool old_deleted);
+
+  /** Record that txn inserted a tuple into an empty slot. */
+  void RecordInsert(const RID &rid, Transaction *txn);
+
+  /**
+   * Make the version written by txn_id visible at commit_ts and drop the versions no snapshot can read anymore.
+   * @param watermark the oldest snapshot timestamp that is still in use
+   */
+  void Commit(const RID &rid, txn_id_t txn_id, timestamp_t commit_ts, timestamp_t watermark);
+
+  /** Undo the version chain change of txn_id on rid; the page itself is restored by the caller. */
+  void Rollback(const RID &rid, txn_id_t txn_id);
+
+  /** Forget the chain and the version word of rid, its slot has been freed. */
+  void Erase(const RID &rid);
+
+  /**
+   * Drop the versions that no snapshot at or after the watermark can read anymore.
+   * @param watermark the oldest snapshot timestamp that is still in use
+   * @return the number of tuple bytes freed
+   */
+  auto Prune(timestamp_t watermark) -> size_t;
+
+  /**
+   * Read the version word of a tuple for an optimistic read.
+   * @param[out] version the version word
+   * @return false if another transaction wrote the tuple and did not commit yet
+   */
+  auto ReadVersion(const RID &rid, Transaction *txn, uint64_t *version) -> bool;
+
+  /** @return true if the version word of a tuple is still version and no other transaction is writing it */
+  auto ValidateVersion(const RID &rid, Transaction *txn, uint64_t version) -> bool;
+
+  /** @return the insert version of the table; it is odd while an optimistic transaction installs its inserts */
+  auto GetInsertVersion() const -> uint64_t { return insert_version_.load(); }
+
+  /**
+   * Make the insert version odd for an optimistic transaction that is about to install inserts, so that
+   * concurrent scans fail their validation. Never blocks.
+   * @return false if another optimistic transaction is installing inserts
+   */
+  auto LockInserts() -> bool;
+
+  /** End the insert installation started by LockInserts(). */
+  void UnlockInserts() { insert_version_ += 1; }
+
+  /** @return the number of RIDs that currently have a version chain */
+  auto Size() -> size_t;
+
+  /** @return the number of RIDs that currently have a version word */
+  auto VersionWordCount() -> size_t;
+
+ private:
+  /** Drop the undo versions of chain hidden behind a newer one committed at or before the watermark. */
+  static auto PruneUndo(VersionChain *chain, timestamp_t watermark) -> size_t;
+
+  std::unordered_map<RID, VersionChain> chains_;
+  /** Version words of the tuples whose writes have committed, a missing tuple has version 0 */
+  std::unordered_map<RID, uint64_t> versions_;
+  /** The last version word handed out */
+  uint64_t version_clock_{0};
+  std::atomic<uint64_t> insert_version_{0};
+  std::mutex latch_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,72 @@
+#include <memory>
+#include <optional>
+#include <tuple>
+
+#include "catalog/catalog.h"
+#include "execution/plans/abstract_plan.h"
+#include "execution/plans/filter_plan.h"
+#include "execution/plans/index_scan_plan.h"
+#include "execution/plans/seq_scan_plan.h"
+#include "optimizer/optimizer.h"
+
+namespace bustub {
+
+auto Optimizer::MatchIndexPrefix(const std::string &table_name, const AbstractExpression &predicate)
+    -> std::optional<std::tuple<const IndexInfo *, IndexScanRange>> {
+  std::optional<std::tuple<const IndexInfo *, IndexScanRange>> best;
+  for (const auto *index_info : catalog_.GetTableIndexes(table_name)) {
+    auto range = ExtractIndexPrefix(predicate, index_info->index_->GetKeyAttrs());
+    // An ART index only looks up whole keys. It wins a tie, it finds a key without going through the buffer pool.
+    bool art = index_info->index_type_ == IndexType::ARTIndex;
+    if (art && range.prefix_.size() != index_info->index_->GetIndexColumnCount()) {
+      continue;
+    }
+    if (range.Columns() != 0 && (best == std::nullopt || range.Columns() > std::get<1>(*best).Columns() ||
+                                 (art && range.Columns() == std::get<1>(*best).Columns()))) {
+      best = std::make_optional(std::make_tuple(index_info, std::move(range)));
+    }
+  }
+  return best;
+}
+
+auto Optimizer::OptimizeFilterAsIndexScan(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef {
+  std::vector<AbstractPlanNodeRef> children;
+  for (const auto &child : plan->GetChildren()) {
+    children.emplace_back(OptimizeFilterAsIndexScan(child));
+  }
+  auto optimized_plan = plan->CloneWithChildren(std::move(children));
+
+  // A filter right above the scan, or merged into it
+  AbstractExpressionRef predicate;
+  const auto *scan_plan = optimized_plan.get();
+  if (scan_plan->GetType() == PlanType::Filter) {
+    predicate = dynamic_cast<const FilterPlanNode &>(*scan_plan).GetPredicate();
+    BUSTUB_ENSURE(scan_plan->children_.size() == 1, "Filter with multiple children?? Impossible!");
+    scan_plan = scan_plan->children_[0].get();
+  }
+  if (scan_plan->GetType() != PlanType::SeqScan) {
+    return optimized_plan;
+  }
+  const auto &seq_scan = dynamic_cast<const SeqScanPlanNode &>(*scan_plan);
+  if (seq_scan.filter_predicate_ != nullptr) {
+    if (predicate != nullptr) {
+      return optimized_plan;
+    }
+    predicate = seq_scan.filter_predicate_;
+  }
+  if (predicate == nullptr) {
+    return optimized_plan;
+  }
+
+  auto match = MatchIndexPrefix(seq_scan.table_name_, *predicate);
+  if (match == std::nullopt) {
+    return optimized_plan;
+  }
+  const auto &[index, range] = *match;
+  // The bounds only narrow the keys the scan reads, the predicate still filters them
+  return std::make_shared<IndexScanPlanNode>(optimized_plan->output_schema_, index->index_oid_, false,
+                                             range.lower_bound_, range.lower_inclusive_, range.upper_bound_,
+                                             range.upper_inclusive_, predicate, false, range.prefix_);
+}
+
+}  // namespace bustub
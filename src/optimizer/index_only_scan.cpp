@@ -0,0 +1,134 @@
+#include <algorithm>
+#include <memory>
+#include <unordered_map>
+
+#include "catalog/catalog.h"
+#include "catalog/schema.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/plans/abstract_plan.h"
+#include "execution/plans/filter_plan.h"
+#include "execution/plans/index_scan_plan.h"
+#include "execution/plans/projection_plan.h"
+#include "execution/plans/seq_scan_plan.h"
+#include "optimizer/optimizer.h"
+
+namespace bustub {
+
+/**
+ * Rewrite the columns of expr, which refer to the table, to the positions of the same columns in an index entry.
+ * @return nullptr if expr refers to a column the entry does not hold
+ */
+static auto RewriteForEntry(const AbstractExpressionRef &expr, const std::unordered_map<uint32_t, uint32_t> &positions)
+    -> AbstractExpressionRef {
+  if (const auto *column = dynamic_cast<const ColumnValueExpression *>(expr.get()); column != nullptr) {
+    auto position = positions.find(column->GetColIdx());
+    if (column->GetTupleIdx() != 0 || position == positions.end()) {
+      return nullptr;
+    }
+    return std::make_shared<ColumnValueExpression>(0, position->second, column->GetReturnType());
+  }
+  std::vector<AbstractExpressionRef> children;
+  for (const auto &child : expr->GetChildren()) {
+    auto rewritten = RewriteForEntry(child, positions);
+    if (rewritten == nullptr) {
+      return nullptr;
+    }
+    children.emplace_back(std::move(rewritten));
+  }
+  return expr->CloneWithChildren(std::move(children));
+}
+
+auto Optimizer::OptimizeIndexOnlyScan(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef {
+  std::vector<AbstractPlanNodeRef> children;
+  for (const auto &child : plan->GetChildren()) {
+    children.emplace_back(OptimizeIndexOnlyScan(child));
+  }
+  auto optimized_plan = plan->CloneWithChildren(std::move(children));
+
+  if (optimized_plan->GetType() != PlanType::Projection) {
+    return optimized_plan;
+  }
+  const auto &projection = dynamic_cast<const ProjectionPlanNode &>(*optimized_plan);
+  const auto *child_plan = projection.GetChildPlan().get();
+
+  // A filter right above the scan becomes the predicate of the index-only scan
+  AbstractExpressionRef predicate;
+  if (child_plan->GetType() == PlanType::Filter) {
+    predicate = dynamic_cast<const FilterPlanNode &>(*child_plan).GetPredicate();
+    BUSTUB_ENSURE(child_plan->children_.size() == 1, "Filter with multiple children?? Impossible!");
+    child_plan = child_plan->children_[0].get();
+  }
+
+  // The index scan to turn index-only, or the one to scan instead of the table
+  std::vector<const IndexInfo *> candidates;
+  const IndexScanPlanNode *index_scan = nullptr;
+  if (child_plan->GetType() == PlanType::IndexScan) {
+    index_scan = dynamic_cast<const IndexScanPlanNode *>(child_plan);
+    if (index_scan->index_only_ || (predicate != nullptr && index_scan->filter_predicate_ != nullptr)) {
+      return optimized_plan;
+    }
+    // An ART index keeps no more than the keys and their rids
+    if (catalog_.GetIndex(index_scan->GetIndexOid())->index_type_ != IndexType::BPlusTreeIndex) {
+      return optimized_plan;
+    }
+    if (index_scan->filter_predicate_ != nullptr) {
+      predicate = index_scan->filter_predicate_;
+    }
+    candidates.push_back(catalog_.GetIndex(index_scan->GetIndexOid()));
+  } else if (child_plan->GetType() == PlanType::SeqScan) {
+    const auto &seq_scan = dynamic_cast<const SeqScanPlanNode &>(*child_plan);
+    if (seq_scan.filter_predicate_ != nullptr) {
+      if (predicate != nullptr) {
+        return optimized_plan;
+      }
+      predicate = seq_scan.filter_predicate_;
+    }
+    // Only an index built to cover queries replaces the table, a plain one would only change the order of the rows.
+    for (const auto *index : catalog_.GetTableIndexes(catalog_.GetTable(seq_scan.GetTableOid())->name_)) {
+      if (index->index_->HasIncludedColumns()) {
+        candidates.push_back(index);
+      }
+    }
+  }
+
+  for (const auto *index : candidates) {
+    const auto &entry_attrs = index->index_->GetEntryAttrs();
+    std::unordered_map<uint32_t, uint32_t> positions;
+    for (uint32_t i = 0; i < entry_attrs.size(); i++) {
+      positions.emplace(entry_attrs[i], i);
+    }
+    std::vector<AbstractExpressionRef> exprs;
+    for (const auto &expr : projection.GetExpressions()) {
+      exprs.emplace_back(RewriteForEntry(expr, positions));
+      if (exprs.back() == nullptr) {
+        break;
+      }
+    }
+    AbstractExpressionRef entry_predicate = predicate == nullptr ? nullptr : RewriteForEntry(predicate, positions);
+    if ((!exprs.empty() && exprs.back() == nullptr) || (predicate != nullptr && entry_predicate == nullptr)) {
+      continue;
+    }
+
+    auto entry_schema = std::make_shared<Schema>(*index->index_->GetEntrySchema());
+    AbstractPlanNodeRef scan;
+    if (index_scan != nullptr) {
+      scan = std::make_shared<IndexScanPlanNode>(entry_schema, index->index_oid_, index_scan->descending_,
+                                                 index_scan->lower_bound_, index_scan->lower_inclusive_,
+                                                 index_scan->upper_bound_, index_scan->upper_inclusive_,
+                                                 entry_predicate, true, index_scan->prefix_);
+    } else {
+      // Read only the range of keys the predicate allows
+      IndexScanRange range;
+      if (predicate != nullptr) {
+        range = ExtractIndexPrefix(*predicate, index->index_->GetKeyAttrs());
+      }
+      scan = std::make_shared<IndexScanPlanNode>(entry_schema, index->index_oid_, false, range.lower_bound_,
+                                                 range.lower_inclusive_, range.upper_bound_, range.upper_inclusive_,
+                                                 entry_predicate, true, range.prefix_);
+    }
+    return std::make_shared<ProjectionPlanNode>(projection.output_schema_, std::move(exprs), std::move(scan));
+  }
+  return optimized_plan;
+}
+
+}  // namespace bustub
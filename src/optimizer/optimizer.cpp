@@ -13,6 +13,8 @@ auto Optimizer::Optimize(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef
     p = OptimizeMergeFilterNLJ(p);
     p = OptimizeNLJAsIndexJoin(p);
     p = OptimizeOrderByAsIndexScan(p);
+    p = OptimizeFilterAsIndexScan(p);
+    p = OptimizeIndexOnlyScan(p);
     p = OptimizeSortLimitAsTopN(p);
     return p;
   }
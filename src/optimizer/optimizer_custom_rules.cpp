@@ -14,6 +14,8 @@ auto Optimizer::OptimizeCustom(const AbstractPlanNodeRef &plan) -> AbstractPlanN
   p = OptimizeNLJAsIndexJoin(p);
   // p = OptimizeNLJAsHashJoin(p);  // Enable this rule after you have implemented hash join.
   p = OptimizeOrderByAsIndexScan(p);
+  p = OptimizeFilterAsIndexScan(p);
+  p = OptimizeIndexOnlyScan(p);
   p = OptimizeSortLimitAsTopN(p);
   return p;
 }
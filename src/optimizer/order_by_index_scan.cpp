@@ -8,7 +8,9 @@
 #include "common/exception.h"
 #include "common/macros.h"
 #include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/comparison_expression.h"
 #include "execution/expressions/constant_value_expression.h"
+#include "execution/expressions/logic_expression.h"
 #include "execution/plans/abstract_plan.h"
 #include "execution/plans/filter_plan.h"
 #include "execution/plans/index_scan_plan.h"
@@ -37,9 +39,9 @@ auto Optimizer::OptimizeOrderByAsIndexScan(const AbstractPlanNodeRef &plan) -> A
       return optimized_plan;
     }
 
-    // Order type is asc or default
+    // Order type is asc, default or desc
     const auto &[order_type, expr] = order_bys[0];
-    if (!(order_type == OrderByType::ASC || order_type == OrderByType::DEFAULT)) {
+    if (!(order_type == OrderByType::ASC || order_type == OrderByType::DEFAULT || order_type == OrderByType::DESC)) {
       return optimized_plan;
     }
 
@@ -53,19 +55,41 @@ auto Optimizer::OptimizeOrderByAsIndexScan(const AbstractPlanNodeRef &plan) -> A
 
     // Has exactly one child
     BUSTUB_ENSURE(optimized_plan->children_.size() == 1, "Sort with multiple children?? Impossible!");
-    const auto &child_plan = optimized_plan->children_[0];
+    const auto *child_plan = optimized_plan->children_[0].get();
+
+    // A filter right above the scan, or merged into it, becomes the predicate of the index scan
+    AbstractExpressionRef predicate;
+    if (child_plan->GetType() == PlanType::Filter) {
+      predicate = dynamic_cast<const FilterPlanNode &>(*child_plan).GetPredicate();
+      BUSTUB_ENSURE(child_plan->children_.size() == 1, "Filter with multiple children?? Impossible!");
+      child_plan = child_plan->children_[0].get();
+    }
 
     if (child_plan->GetType() == PlanType::SeqScan) {
       const auto &seq_scan = dynamic_cast<const SeqScanPlanNode &>(*child_plan);
+      if (seq_scan.filter_predicate_ != nullptr) {
+        if (predicate != nullptr) {
+          return optimized_plan;
+        }
+        predicate = seq_scan.filter_predicate_;
+      }
       const auto *table_info = catalog_.GetTable(seq_scan.GetTableOid());
       const auto indices = catalog_.GetTableIndexes(table_info->name_);
 
       for (const auto *index : indices) {
+        // The entries of an index over several columns are in the order of its first one too. Only a b+ tree scans
+        // its entries in order.
         const auto &columns = index->key_schema_.GetColumns();
-        if (columns.size() == 1 &&
+        if (index->index_type_ == IndexType::BPlusTreeIndex &&
             columns[0].GetName() == table_info->schema_.GetColumn(order_by_column_id).GetName()) {
-          // Index matched, return index scan instead
-          return std::make_shared<IndexScanPlanNode>(optimized_plan->output_schema_, index->index_oid_);
+          // Index matched, return index scan instead, limited to the range the predicate allows
+          IndexScanRange range;
+          if (predicate != nullptr) {
+            range = ExtractIndexPrefix(*predicate, index->index_->GetKeyAttrs());
+          }
+          return std::make_shared<IndexScanPlanNode>(
+              optimized_plan->output_schema_, index->index_oid_, order_type == OrderByType::DESC, range.lower_bound_,
+              range.lower_inclusive_, range.upper_bound_, range.upper_inclusive_, predicate, false, range.prefix_);
         }
       }
     }
@@ -74,4 +98,110 @@ auto Optimizer::OptimizeOrderByAsIndexScan(const AbstractPlanNodeRef &plan) -> A
   return optimized_plan;
 }
 
+void Optimizer::ExtractIndexRange(const AbstractExpression &predicate, uint32_t col_idx,
+                                  AbstractExpressionRef *lower_bound, bool *lower_inclusive,
+                                  AbstractExpressionRef *upper_bound, bool *upper_inclusive) {
+  if (const auto *logic = dynamic_cast<const LogicExpression *>(&predicate); logic != nullptr) {
+    if (logic->logic_type_ == LogicType::And) {
+      ExtractIndexRange(*logic->GetChildAt(0), col_idx, lower_bound, lower_inclusive, upper_bound, upper_inclusive);
+      ExtractIndexRange(*logic->GetChildAt(1), col_idx, lower_bound, lower_inclusive, upper_bound, upper_inclusive);
+    }
+    return;
+  }
+  const auto *comparison = dynamic_cast<const ComparisonExpression *>(&predicate);
+  if (comparison == nullptr) {
+    return;
+  }
+  // Bring the comparison into the form <column> <comp_type> <constant>
+  auto comp_type = comparison->comp_type_;
+  const auto *column = dynamic_cast<const ColumnValueExpression *>(comparison->GetChildAt(0).get());
+  auto constant = comparison->GetChildAt(1);
+  if (column == nullptr) {
+    column = dynamic_cast<const ColumnValueExpression *>(comparison->GetChildAt(1).get());
+    constant = comparison->GetChildAt(0);
+    switch (comp_type) {
+      case ComparisonType::LessThan:
+        comp_type = ComparisonType::GreaterThan;
+        break;
+      case ComparisonType::LessThanOrEqual:
+        comp_type = ComparisonType::GreaterThanOrEqual;
+        break;
+      case ComparisonType::GreaterThan:
+        comp_type = ComparisonType::LessThan;
+        break;
+      case ComparisonType::GreaterThanOrEqual:
+        comp_type = ComparisonType::LessThanOrEqual;
+        break;
+      default:
+        break;
+    }
+  }
+  const auto *value_expr = dynamic_cast<const ConstantValueExpression *>(constant.get());
+  if (column == nullptr || column->GetTupleIdx() != 0 || column->GetColIdx() != col_idx || value_expr == nullptr ||
+      value_expr->val_.GetTypeId() != TypeId::INTEGER || value_expr->val_.IsNull()) {
+    return;
+  }
+  const auto &value = value_expr->val_;
+
+  // Keep the tighter of two bounds, an exclusive one wins over an inclusive one at the same value
+  auto tighten = [&constant, &value](AbstractExpressionRef *bound, bool *inclusive, bool new_inclusive, bool lower) {
+    if (*bound != nullptr) {
+      const auto &old_value = dynamic_cast<const ConstantValueExpression &>(**bound).val_;
+      if (old_value.CompareEquals(value) == CmpBool::CmpTrue) {
+        *inclusive = *inclusive && new_inclusive;
+        return;
+      }
+      bool tighter = lower ? value.CompareGreaterThan(old_value) == CmpBool::CmpTrue
+                           : value.CompareLessThan(old_value) == CmpBool::CmpTrue;
+      if (!tighter) {
+        return;
+      }
+    }
+    *bound = constant;
+    *inclusive = new_inclusive;
+  };
+  switch (comp_type) {
+    case ComparisonType::Equal:
+      tighten(lower_bound, lower_inclusive, true, true);
+      tighten(upper_bound, upper_inclusive, true, false);
+      break;
+    case ComparisonType::GreaterThan:
+    case ComparisonType::GreaterThanOrEqual:
+      tighten(lower_bound, lower_inclusive, comp_type == ComparisonType::GreaterThanOrEqual, true);
+      break;
+    case ComparisonType::LessThan:
+    case ComparisonType::LessThanOrEqual:
+      tighten(upper_bound, upper_inclusive, comp_type == ComparisonType::LessThanOrEqual, false);
+      break;
+    default:
+      break;
+  }
+}
+
+auto Optimizer::ExtractIndexPrefix(const AbstractExpression &predicate, const std::vector<uint32_t> &key_attrs)
+    -> IndexScanRange {
+  IndexScanRange range;
+  for (auto col_idx : key_attrs) {
+    AbstractExpressionRef lower_bound;
+    AbstractExpressionRef upper_bound;
+    bool lower_inclusive = true;
+    bool upper_inclusive = true;
+    ExtractIndexRange(predicate, col_idx, &lower_bound, &lower_inclusive, &upper_bound, &upper_inclusive);
+    // A column is fixed if its tightest bounds are the same constant, both inclusive
+    if (lower_bound != nullptr && upper_bound != nullptr && lower_inclusive && upper_inclusive &&
+        dynamic_cast<const ConstantValueExpression &>(*lower_bound)
+                .val_.CompareEquals(dynamic_cast<const ConstantValueExpression &>(*upper_bound).val_) ==
+            CmpBool::CmpTrue) {
+      range.prefix_.push_back(lower_bound);
+      continue;
+    }
+    range.lower_bound_ = lower_bound;
+    range.lower_inclusive_ = lower_inclusive;
+    range.upper_bound_ = upper_bound;
+    range.upper_inclusive_ = upper_inclusive;
+    break;
+  }
+  return range;
+}
+
 }  // namespace bustub
@@ -0,0 +1,80 @@
+#include <array>
+
+#include "common/exception.h"
+#include "storage/index/art_index.h"
+
+namespace bustub {
+
+ARTIndex::ARTIndex(std::unique_ptr<IndexMetadata> &&metadata)
+    : Index(std::move(metadata)), container_(EncodedKeySize(*GetKeySchema())) {}
+
+auto ARTIndex::EncodedKeySize(const Schema &key_schema) -> size_t {
+  size_t size = 0;
+  for (const auto &column : key_schema.GetColumns()) {
+    switch (column.GetType()) {
+      case TypeId::TINYINT:
+      case TypeId::SMALLINT:
+      case TypeId::INTEGER:
+      case TypeId::BIGINT:
+        size += column.GetFixedLength();
+        break;
+      default:
+        throw NotImplementedException("art indexes only support integer key columns");
+    }
+  }
+  return size;
+}
+
+void ARTIndex::EncodeKey(const Tuple &key, uint8_t *bytes) const {
+  const auto *key_schema = GetKeySchema();
+  for (uint32_t i = 0; i < key_schema->GetColumnCount(); i++) {
+    auto value = key.GetValue(key_schema, i);
+    int64_t integer;
+    switch (value.GetTypeId()) {
+      case TypeId::TINYINT:
+        integer = value.GetAs<int8_t>();
+        break;
+      case TypeId::SMALLINT:
+        integer = value.GetAs<int16_t>();
+        break;
+      case TypeId::INTEGER:
+        integer = value.GetAs<int32_t>();
+        break;
+      default:
+        integer = value.GetAs<int64_t>();
+        break;
+    }
+    size_t width = key_schema->GetColumn(i).GetFixedLength();
+    // Flipping the sign bit orders negative values before the others, byte by byte.
+    auto bits = static_cast<uint64_t>(integer) ^ (uint64_t{1} << (8 * width - 1));
+    for (size_t b = 0; b < width; b++) {
+      *bytes++ = static_cast<uint8_t>(bits >> (8 * (width - 1 - b)));
+    }
+  }
+}
+
+void ARTIndex::InsertEntry(const Tuple &key, RID rid, Transaction *transaction) {
+  std::array<uint8_t, ART_MAX_KEY_SIZE> index_key;
+  EncodeKey(key, index_key.data());
+  container_.Insert(index_key.data(), rid, GetMetadata()->IsUnique());
+}
+
+void ARTIndex::DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) {
+  std::array<uint8_t, ART_MAX_KEY_SIZE> index_key;
+  EncodeKey(key, index_key.data());
+  container_.Remove(index_key.data(), rid);
+}
+
+void ARTIndex::ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) {
+  std::array<uint8_t, ART_MAX_KEY_SIZE> index_key;
+  EncodeKey(key, index_key.data());
+  container_.GetValue(index_key.data(), result);
+}
+
+void ARTIndex::BulkLoad(TableHeap *table_heap, const Schema &table_schema, Transaction *transaction) {
+  for (auto tuple = table_heap->Begin(transaction); tuple != table_heap->End(); ++tuple) {
+    InsertEntry(EntryFromTuple(*tuple, table_schema), tuple->GetRid(), transaction);
+  }
+}
+
+}  // namespace bustub
@@ -1,3 +1,5 @@
+#include <algorithm>
+#include <cstring>
 #include <string>
 
 #include "common/exception.h"
@@ -9,30 +11,442 @@
 namespace bustub {
 INDEX_TEMPLATE_ARGUMENTS
 BPLUSTREE_TYPE::BPlusTree(std::string name, BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
-                          int leaf_max_size, int internal_max_size)
+                          int leaf_max_size, int internal_max_size, bool compress_keys, bool unique_keys)
     : index_name_(std::move(name)),
       root_page_id_(INVALID_PAGE_ID),
       buffer_pool_manager_(buffer_pool_manager),
       comparator_(comparator),
-      leaf_max_size_(leaf_max_size),
-      internal_max_size_(internal_max_size) {}
+      leaf_max_size_(compress_keys ? std::min(leaf_max_size, LeafPage::COMPRESSED_MAX_SIZE) : leaf_max_size),
+      internal_max_size_(compress_keys ? std::min(internal_max_size, InternalPage::COMPRESSED_MAX_SIZE)
+                                       : internal_max_size),
+      compress_keys_(compress_keys),
+      unique_keys_(unique_keys) {
+  // Only the integer search of a plain page is safe on a page that changes while it is read.
+  if constexpr (HasIntegerKeys<KeyComparator>::value) {
+    latch_free_reads_ = !compress_keys_ && comparator_.IntegerKeySize() != 0;
+  }
+}
 
 /*
  * Helper function to decide whether current b+tree is empty
  */
 INDEX_TEMPLATE_ARGUMENTS
-auto BPLUSTREE_TYPE::IsEmpty() const -> bool { return true; }
+auto BPLUSTREE_TYPE::IsEmpty() const -> bool { return root_page_id_ == INVALID_PAGE_ID; }
 /*****************************************************************************
  * SEARCH
  *****************************************************************************/
 /*
- * Return the only value that associated with input key
- * This method is used for point query
+ * Return the values that associated with input key, all values of its posting list in a non-unique tree
+ * This method is used for point query, which reads the leaf without a latch where it can, see LookupLeaf()
  * @return : true means key exists
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *transaction) -> bool {
-  return false;
+  while (latch_free_reads_) {
+    Page *page = DescendToLeaf(&key, false);
+    if (page == nullptr) {
+      return false;
+    }
+    ValueType value;
+    std::optional<bool> found = LookupLeaf(page, key, &value);
+    if (!found.has_value()) {
+      continue;
+    }
+    // The leaf latch protects a posting list, its values are read with the leaf latched below.
+    if (*found && BPlusTreePostingPage::IsListRef(value)) {
+      break;
+    }
+    if (*found) {
+      result->push_back(value);
+    }
+    return *found;
+  }
+  Page *page = FindLeafOptimistic(&key, Operation::SEARCH);
+  if (page == nullptr) {
+    return false;
+  }
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  int index = leaf->KeyIndex(key, comparator_);
+  bool found = index < leaf->GetSize() && comparator_(leaf->KeyAt(index), key) == 0;
+  bool complete = !found || ReadEntry(leaf, index, result);
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  if (!complete) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot fetch a b+ tree posting page");
+  }
+  return found;
+}
+
+/*
+ * Look up a batch of keys sorted in ascending order, results[i] gets the values of keys[i]. The batch stays on its
+ * leaf for as long as the keys fall into it and steps over to the next leaf once, the keys of a batch mostly lie
+ * close together; only a key beyond that leaf descends from the root again. Leaves are latched left to right, like
+ * an index iterator does.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::GetValues(const std::vector<KeyType> &keys, std::vector<std::vector<ValueType>> *results,
+                               Transaction *transaction) {
+  results->assign(keys.size(), {});
+  Page *page = nullptr;
+  auto release = [&]() {
+    if (page != nullptr) {
+      page->RUnlatch();
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+      page = nullptr;
+    }
+  };
+  for (size_t i = 0; i < keys.size(); i++) {
+    const KeyType &key = keys[i];
+    bool stepped = false;
+    // The leaf holds keys up to its last one, a greater key lies further right or is not in the tree.
+    while (page != nullptr) {
+      auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+      if (leaf->GetSize() > 0 && comparator_(key, leaf->KeyAt(leaf->GetSize() - 1)) <= 0) {
+        break;
+      }
+      page_id_t next_id = leaf->GetNextPageId();
+      if (next_id == INVALID_PAGE_ID) {
+        break;
+      }
+      if (stepped) {
+        release();
+        break;
+      }
+      Page *next = buffer_pool_manager_->FetchPage(next_id);
+      if (next == nullptr) {
+        release();
+        throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot fetch the next leaf page");
+      }
+      next->RLatch();
+      release();
+      page = next;
+      stepped = true;
+    }
+    if (page == nullptr) {
+      page = FindLeafOptimistic(&key, Operation::SEARCH);
+      if (page == nullptr) {
+        return;
+      }
+    }
+    auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    int index = leaf->KeyIndex(key, comparator_);
+    if (index < leaf->GetSize() && comparator_(leaf->KeyAt(index), key) == 0 &&
+        !ReadEntry(leaf, index, &(*results)[i])) {
+      release();
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot fetch a b+ tree posting page");
+    }
+  }
+  release();
+}
+
+/*
+ * Append the values of the entry at index of a leaf, all values of its posting list in a non-unique tree. The
+ * caller holds the leaf's latch, which protects the posting list.
+ * @return : false if a posting page cannot be fetched
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::ReadEntry(const LeafPage *leaf, int index, std::vector<ValueType> *result) -> bool {
+  ValueType value = leaf->ValueAt(index);
+  if (!BPlusTreePostingPage::IsListRef(value)) {
+    result->push_back(value);
+    return true;
+  }
+  for (page_id_t list_id = value.GetPageId(); list_id != INVALID_PAGE_ID;) {
+    Page *list_page = buffer_pool_manager_->FetchPage(list_id);
+    if (list_page == nullptr) {
+      return false;
+    }
+    auto *list = reinterpret_cast<BPlusTreePostingPage *>(list_page->GetData());
+    for (int i = 0; i < list->GetSize(); i++) {
+      result->push_back(list->ValueAt(i));
+    }
+    page_id_t next_id = list->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(list_id, false);
+    list_id = next_id;
+  }
+  return true;
+}
+
+/*
+ * Descend to the leaf that covers key, or to the leftmost (rightmost) leaf if key is nullptr. No page is held while
+ * the descent moves on from it, see the class comment: NextPage() takes one step through the internal pages and
+ * LatchLeaf() settles on the leaf, either of them may send the descent back to the root. The leaf is read-latched
+ * for a search and write-latched otherwise.
+ * @return : the pinned and latched leaf, nullptr if the tree is empty
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::FindLeafOptimistic(const KeyType *key, Operation op, bool rightmost) -> Page * {
+  while (true) {
+    Page *page = DescendToLeaf(key, rightmost);
+    if (page == nullptr) {
+      return nullptr;
+    }
+    page = LatchLeaf(page, key, rightmost, op != Operation::SEARCH);
+    if (page != nullptr) {
+      return page;
+    }
+  }
+}
+
+/*
+ * Descend through the internal pages to the leaf that covers key, see NextPage().
+ * @return : the pinned leaf, which is not latched, nullptr if the tree is empty
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::DescendToLeaf(const KeyType *key, bool rightmost) -> Page * {
+  while (true) {
+    page_id_t root_id = root_page_id_;
+    if (root_id == INVALID_PAGE_ID) {
+      return nullptr;
+    }
+    Page *page = buffer_pool_manager_->FetchPage(root_id);
+    if (page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot fetch the b+ tree root page");
+    }
+    // A root that was replaced before the pin may already be deleted, the pin holds on to a live one.
+    if (root_page_id_ != root_id) {
+      buffer_pool_manager_->UnpinPage(root_id, false);
+      continue;
+    }
+    // A deleted page is not a leaf either, NextPage() sends the descent back to the root then.
+    while (page != nullptr && !reinterpret_cast<BPlusTreePage *>(page->GetData())->IsLeafPage()) {
+      Page *next = NextPage(page, key, rightmost);
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+      page = next;
+    }
+    if (page != nullptr) {
+      return page;
+    }
+  }
+}
+
+/*
+ * One step of a descent at a pinned internal page: to the right sibling if key lies at or beyond the page's high
+ * key, to the child that covers key otherwise. With latch-free reads the page is read at a version, and the step
+ * only counts if the version still holds once the next page is pinned; a page that is still part of the tree then
+ * pointed at the next page while it was pinned, so the next page cannot have been deleted. Otherwise the page is
+ * read-latched until the next page is pinned.
+ * @return : the pinned next page, nullptr if the descent has to restart from the root
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::NextPage(Page *page, const KeyType *key, bool rightmost) -> Page * {
+  auto *node = reinterpret_cast<InternalPage *>(page->GetData());
+  while (true) {
+    uint64_t version = 0;
+    if (latch_free_reads_) {
+      version = page->ReadVersion();
+    } else {
+      page->RLatch();
+    }
+    Fence fence = node->IsDeleted() ? Fence::BELOW : FencePosition(node, key, rightmost);
+    page_id_t next_id = INVALID_PAGE_ID;
+    if (fence == Fence::BEYOND) {
+      next_id = node->GetNextPageId();
+    } else if (fence == Fence::INSIDE && key != nullptr) {
+      next_id = node->Lookup(*key, comparator_);
+    } else if (fence == Fence::INSIDE) {
+      // Like Lookup(), keep a torn size inside the page.
+      next_id = node->ValueAt(rightmost ? std::clamp(node->GetSize(), 1, node->GetMaxSize()) - 1 : 0);
+    }
+    // The ids read without a latch are only fetched once they are known to be no torn read.
+    Page *next = nullptr;
+    if (next_id != INVALID_PAGE_ID && (!latch_free_reads_ || page->ValidateVersion(version))) {
+      next = buffer_pool_manager_->FetchPage(next_id);
+      if (next == nullptr) {
+        if (!latch_free_reads_) {
+          page->RUnlatch();
+        }
+        throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot fetch a b+ tree page");
+      }
+    }
+    if (!latch_free_reads_) {
+      page->RUnlatch();
+      return next;
+    }
+    if (page->ValidateVersion(version)) {
+      return next;
+    }
+    if (next != nullptr) {
+      buffer_pool_manager_->UnpinPage(next->GetPageId(), false);
+    }
+  }
+}
+
+/*
+ * Latch the pinned leaf a descent reached and move right along the leaves for as long as key lies at or beyond the
+ * leaf's high key. The next leaf is latched before the current one is released, which the leaf's latch keeps from
+ * being deleted. A write-latched leaf is about to change, so its update begins for the readers of LookupLeaf().
+ * @return : the latched leaf that covers key, nullptr if the descent has to restart from the root
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::LatchLeaf(Page *page, const KeyType *key, bool rightmost, bool write) -> Page * {
+  auto latch = [write](Page *leaf_page) {
+    if (write) {
+      leaf_page->WLatch();
+    } else {
+      leaf_page->RLatch();
+    }
+  };
+  auto release = [this, write](Page *leaf_page) {
+    if (write) {
+      leaf_page->WUnlatch();
+    } else {
+      leaf_page->RUnlatch();
+    }
+    buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), false);
+  };
+  latch(page);
+  while (true) {
+    auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    Fence fence = leaf->IsDeleted() ? Fence::BELOW : FencePosition(leaf, key, rightmost);
+    if (fence == Fence::INSIDE) {
+      if (write) {
+        page->BeginUpdate();
+      }
+      return page;
+    }
+    if (fence == Fence::BELOW) {
+      release(page);
+      return nullptr;
+    }
+    Page *next = buffer_pool_manager_->FetchPage(leaf->GetNextPageId());
+    if (next == nullptr) {
+      release(page);
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot fetch the next leaf page");
+    }
+    latch(next);
+    release(page);
+    page = next;
+  }
+}
+
+/*
+ * Settle on the pinned leaf a descent reached like LatchLeaf() does, and look key up there, but without latching
+ * the leaves: with latch-free reads a leaf is read at a version like an internal page in NextPage(), and a move to
+ * the right or the entry read only counts if the version still holds afterwards. The leaf is unpinned.
+ * @return : whether key was found, its value in value; nullopt if the descent has to restart from the root
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::LookupLeaf(Page *page, const KeyType &key, ValueType *value) -> std::optional<bool> {
+  while (true) {
+    auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    uint64_t version = page->ReadVersion();
+    Fence fence = leaf->IsDeleted() ? Fence::BELOW : FencePosition(leaf, &key, false);
+    bool found = false;
+    page_id_t next_id = INVALID_PAGE_ID;
+    if (fence == Fence::INSIDE) {
+      // KeyIndex() keeps a torn size inside the page, so does the check of its result.
+      int index = leaf->KeyIndex(key, comparator_);
+      found = index < std::clamp(leaf->GetSize(), 0, leaf->GetMaxSize()) && comparator_(leaf->KeyAt(index), key) == 0;
+      if (found) {
+        *value = leaf->ValueAt(index);
+      }
+    } else if (fence == Fence::BEYOND) {
+      next_id = leaf->GetNextPageId();
+    }
+    Page *next = nullptr;
+    if (next_id != INVALID_PAGE_ID && page->ValidateVersion(version)) {
+      next = buffer_pool_manager_->FetchPage(next_id);
+      if (next == nullptr) {
+        buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+        throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot fetch the next leaf page");
+      }
+    }
+    if (!page->ValidateVersion(version)) {
+      if (next != nullptr) {
+        buffer_pool_manager_->UnpinPage(next->GetPageId(), false);
+      }
+      continue;
+    }
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    if (fence == Fence::INSIDE) {
+      return found;
+    }
+    if (next == nullptr) {
+      return std::nullopt;
+    }
+    page = next;
+  }
+}
+
+/*
+ * Compare key with the fence keys of a page. Without a key the leftmost descent belongs below any low key and the
+ * rightmost descent beyond any high key.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+template <typename NodeType>
+auto BPLUSTREE_TYPE::FencePosition(const NodeType *node, const KeyType *key, bool rightmost) const -> Fence {
+  if (node->HasLowKey() && (key == nullptr ? !rightmost : comparator_(*key, node->LowKey()) < 0)) {
+    return Fence::BELOW;
+  }
+  if (node->HasHighKey() && (key == nullptr ? rightmost : comparator_(*key, node->HighKey()) >= 0)) {
+    return Fence::BEYOND;
+  }
+  return Fence::INSIDE;
+}
+
+/*
+ * Descend to the leaf that covers key with write latches. Whenever the descent reaches a page that the operation
+ * cannot split or merge, the latches above it, including root_latch_, are released.
+ * @return : the leaf, which is the last page of the context's write set, nullptr if the tree is empty
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::FindLeafPessimistic(const KeyType &key, Operation op, Context *ctx) -> Page * {
+  root_latch_.WLock();
+  ctx->root_latched_ = true;
+  if (root_page_id_ == INVALID_PAGE_ID) {
+    return nullptr;
+  }
+  page_id_t page_id = root_page_id_;
+  while (true) {
+    Page *page = FetchTreePage(page_id, ctx);
+    page->WLatch();
+    auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+    if (IsSafe(node, op, key)) {
+      ReleaseContext(ctx, false);
+    }
+    ctx->write_set_.push_back(page);
+    if (node->IsLeafPage()) {
+      page->BeginUpdate();
+      return page;
+    }
+    page_id = reinterpret_cast<InternalPage *>(node)->Lookup(key, comparator_);
+  }
+}
+
+/*
+ * A page is safe for an operation on key if the operation cannot split or merge it, so no change reaches its
+ * parent. An internal page does not know the key a split below it would push up, it needs room for any key.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::IsSafe(const BPlusTreePage *node, Operation op, const KeyType &key) const -> bool {
+  if (op == Operation::INSERT) {
+    return node->IsLeafPage() ? reinterpret_cast<const LeafPage *>(node)->CanInsert(key)
+                              : reinterpret_cast<const InternalPage *>(node)->CanInsertAnyKey();
+  }
+  if (op == Operation::REMOVE) {
+    if (node->IsRootPage()) {
+      return node->IsLeafPage() ? node->GetSize() > 1 : node->GetSize() > 2;
+    }
+    return node->GetSize() > node->GetMinSize();
+  }
+  return true;
+}
+
+/*
+ * Unlatch and unpin every page of the write set and release root_latch_ if it is held.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::ReleaseContext(Context *ctx, bool is_dirty) {
+  if (ctx->root_latched_) {
+    root_latch_.WUnlock();
+    ctx->root_latched_ = false;
+  }
+  for (Page *page : ctx->write_set_) {
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), is_dirty);
+  }
+  ctx->write_set_.clear();
 }
 
 /*****************************************************************************
@@ -42,12 +456,572 @@ auto BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result
  * Insert constant key & value pair into b+ tree
  * if current tree is empty, start new tree, update root page id and insert
  * entry, otherwise insert into leaf page.
- * @return: since we only support unique key, if user try to insert duplicate
- * keys return false, otherwise return true.
+ * A non-unique tree adds the value of an existing key to the key's posting list, which never changes the leaf's
+ * size, so that needs no restart.
+ * @return: false if a unique tree already has the key or a non-unique tree
+ * already has the pair, otherwise return true.
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transaction *transaction) -> bool {
-  return false;
+  ValueType existing;
+  Page *page = FindLeafOptimistic(&key, Operation::INSERT);
+  if (page != nullptr) {
+    auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    if (leaf->Lookup(key, &existing, comparator_)) {
+      if (unique_keys_) {
+        page->WUnlatch();
+        buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+        return false;
+      }
+      Context ctx;
+      ctx.write_set_.push_back(page);
+      bool inserted = AddToPostingList(leaf, leaf->KeyIndex(key, comparator_), value, &ctx);
+      ReleaseContext(&ctx, inserted);
+      return inserted;
+    }
+    if (IsSafe(leaf, Operation::INSERT, key)) {
+      leaf->Insert(key, value, comparator_);
+      page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+      return true;
+    }
+    // The leaf splits, restart and latch the pages the split may reach.
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  }
+
+  Context ctx;
+  page = FindLeafPessimistic(key, Operation::INSERT, &ctx);
+  if (page == nullptr) {
+    StartNewTree(key, value, &ctx);
+    ReleaseContext(&ctx, true);
+    return true;
+  }
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  if (leaf->Lookup(key, &existing, comparator_)) {
+    bool inserted = !unique_keys_ && AddToPostingList(leaf, leaf->KeyIndex(key, comparator_), value, &ctx);
+    ReleaseContext(&ctx, inserted);
+    return inserted;
+  }
+  if (leaf->CanInsert(key)) {
+    leaf->Insert(key, value, comparator_);
+  } else {
+    SplitLeafAndInsert(leaf, key, value, &ctx);
+  }
+  ReleaseContext(&ctx, true);
+  return true;
+}
+
+/*
+ * Split a leaf that has no room for key around the new pair. The pairs are copied out and the two halves copied
+ * back, so a full compressed leaf never has to hold the new key. The leaf is the last page of the write set. The
+ * separator becomes the high key of the leaf and the low key of the new one, which is linked in before the parent
+ * learns about it: a reader that reaches the leaf through the parent's old state moves right.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::SplitLeafAndInsert(LeafPage *leaf, const KeyType &key, const ValueType &value, Context *ctx) {
+  std::vector<MappingType> items;
+  leaf->CopyAllTo(&items);
+  items.emplace(items.begin() + leaf->KeyIndex(key, comparator_), key, value);
+  int size = static_cast<int>(items.size());
+  int keep = size / 2;
+
+  page_id_t new_page_id;
+  Page *new_page = NewTreePage(&new_page_id, ctx);
+  auto *new_leaf = reinterpret_cast<LeafPage *>(new_page->GetData());
+  new_leaf->Init(new_page_id, leaf->GetParentPageId(), leaf_max_size_, compress_keys_);
+  leaf->CopyNFrom(items.data(), keep);
+  new_leaf->CopyNFrom(items.data() + keep, size - keep);
+  KeyType separator = SeparatorBetween(items[keep - 1].first, items[keep].first);
+  new_leaf->SetNextPageId(leaf->GetNextPageId());
+  new_leaf->SetPrevPageId(leaf->GetPageId());
+  new_leaf->SetLowKey(separator);
+  new_leaf->SetHighKey(leaf->HighKey());
+  leaf->SetNextPageId(new_page_id);
+  leaf->SetHighKey(separator);
+  SetPrevLeaf(new_leaf->GetNextPageId(), new_page_id, ctx);
+  InsertIntoParent(ctx->write_set_.size() - 1, leaf, separator, new_leaf, ctx);
+  buffer_pool_manager_->UnpinPage(new_page_id, true);
+}
+
+/*
+ * The key pushed up between two siblings whose keys end with left and start with right. A compressed tree looks
+ * for the shortest prefix of right, padded with zeros, that is still greater than left (suffix truncation); the
+ * padding is what a compressed page does not store. Any key s with left < s <= right separates the siblings.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::SeparatorBetween(const KeyType &left, const KeyType &right) const -> KeyType {
+  if (!compress_keys_) {
+    return right;
+  }
+  const auto *right_bytes = reinterpret_cast<const char *>(&right);
+  KeyType candidate;
+  auto *bytes = reinterpret_cast<char *>(&candidate);
+  memset(bytes, 0, sizeof(KeyType));
+  for (size_t length = 0; length < sizeof(KeyType); length++) {
+    if (comparator_(left, candidate) < 0 && comparator_(candidate, right) <= 0) {
+      return candidate;
+    }
+    bytes[length] = right_bytes[length];
+  }
+  return right;
+}
+
+/*
+ * Insert constant key & value pair into an empty tree
+ * User needs to first ask for new page from buffer pool manager(NOTICE: throw
+ * an "out of memory" exception if returned value is nullptr), then update b+
+ * tree's root page id and insert entry directly into leaf page.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value, Context *ctx) {
+  page_id_t page_id;
+  Page *page = NewTreePage(&page_id, ctx);
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  leaf->Init(page_id, INVALID_PAGE_ID, leaf_max_size_, compress_keys_);
+  leaf->Insert(key, value, comparator_);
+  root_page_id_ = page_id;
+  UpdateRootPageId(1);
+  buffer_pool_manager_->UnpinPage(page_id, true);
+}
+
+/*
+ * Insert key & value pair into internal page after split
+ * @param level : the position of old_node's page in the write set, its parent is the page right above it
+ * @param old_node : input page from split() method
+ * @param key : the separation key of the two nodes
+ * @param new_node : returned page from split() method
+ * User needs to first find the parent page of old_node, parent node must be
+ * adjusted to take info of new_node into account. Remember to deal with split
+ * recursively if necessary. A split parent hands its right link and high key
+ * to the new sibling, like a split leaf.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::InsertIntoParent(size_t level, BPlusTreePage *old_node, const KeyType &key,
+                                      BPlusTreePage *new_node, Context *ctx) {
+  if (old_node->IsRootPage()) {
+    BUSTUB_ASSERT(ctx->root_latched_, "splitting the root requires the root latch");
+    page_id_t root_id;
+    Page *root_page = NewTreePage(&root_id, ctx);
+    auto *root = reinterpret_cast<InternalPage *>(root_page->GetData());
+    root->Init(root_id, INVALID_PAGE_ID, internal_max_size_, compress_keys_);
+    root->PopulateNewRoot(old_node->GetPageId(), key, new_node->GetPageId());
+    old_node->SetParentPageId(root_id);
+    new_node->SetParentPageId(root_id);
+    root_page_id_ = root_id;
+    UpdateRootPageId(0);
+    buffer_pool_manager_->UnpinPage(root_id, true);
+    return;
+  }
+
+  // Only a safe page can start the write set, and a safe page does not split.
+  BUSTUB_ASSERT(level > 0, "the parent of a split page must be latched");
+  Page *parent_page = ctx->write_set_[level - 1];
+  parent_page->BeginUpdate();
+  auto *parent = reinterpret_cast<InternalPage *>(parent_page->GetData());
+  new_node->SetParentPageId(parent->GetPageId());
+  if (parent->CanInsert(key)) {
+    parent->InsertNodeAfter(old_node->GetPageId(), key, new_node->GetPageId());
+    return;
+  }
+
+  // The parent is full, split it around the new child.
+  std::vector<std::pair<KeyType, page_id_t>> items;
+  parent->CopyAllTo(&items);
+  items.insert(items.begin() + parent->ValueIndex(old_node->GetPageId()) + 1, {key, new_node->GetPageId()});
+  int keep = (static_cast<int>(items.size()) + 1) / 2;
+
+  page_id_t sibling_id;
+  Page *sibling_page = NewTreePage(&sibling_id, ctx);
+  auto *sibling = reinterpret_cast<InternalPage *>(sibling_page->GetData());
+  sibling->Init(sibling_id, parent->GetParentPageId(), internal_max_size_, compress_keys_);
+  parent->CopyNFrom(items.data(), keep);
+  sibling->CopyNFrom(items.data() + keep, static_cast<int>(items.size()) - keep);
+  sibling->SetNextPageId(parent->GetNextPageId());
+  sibling->SetLowKey(items[keep].first);
+  sibling->SetHighKey(parent->HighKey());
+  parent->SetNextPageId(sibling_id);
+  parent->SetHighKey(items[keep].first);
+  for (int i = 0; i < sibling->GetSize(); i++) {
+    SetParentPageId(sibling->ValueAt(i), sibling_id);
+  }
+  InsertIntoParent(level - 1, parent, items[keep].first, sibling, ctx);
+  buffer_pool_manager_->UnpinPage(sibling_id, true);
+}
+
+/*****************************************************************************
+ * POSTING LISTS
+ *****************************************************************************/
+/*
+ * Add value to the key at index of a leaf of a non-unique tree. A plain value and the new one move into a new
+ * posting list; otherwise the value goes into the first page of the list, or into a new first page if that is full.
+ * @return : false if the key already has the value
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::AddToPostingList(LeafPage *leaf, int index, const ValueType &value, Context *ctx) -> bool {
+  ValueType stored = leaf->ValueAt(index);
+  if (!BPlusTreePostingPage::IsListRef(stored)) {
+    if (stored == value) {
+      return false;
+    }
+    leaf->SetValueAt(index, NewPostingList({stored, value}, ctx));
+    return true;
+  }
+  page_id_t head_id = stored.GetPageId();
+  for (page_id_t list_id = head_id; list_id != INVALID_PAGE_ID;) {
+    auto *list = reinterpret_cast<BPlusTreePostingPage *>(FetchTreePage(list_id, ctx)->GetData());
+    bool found = list->IndexOf(value) >= 0;
+    page_id_t next_id = list->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(list_id, false);
+    if (found) {
+      return false;
+    }
+    list_id = next_id;
+  }
+  auto *head = reinterpret_cast<BPlusTreePostingPage *>(FetchTreePage(head_id, ctx)->GetData());
+  if (!head->IsFull()) {
+    head->Append(value);
+    buffer_pool_manager_->UnpinPage(head_id, true);
+    return true;
+  }
+  buffer_pool_manager_->UnpinPage(head_id, false);
+  page_id_t new_head_id;
+  auto *new_head = reinterpret_cast<BPlusTreePostingPage *>(NewTreePage(&new_head_id, ctx)->GetData());
+  new_head->Init(head_id);
+  new_head->Append(value);
+  buffer_pool_manager_->UnpinPage(new_head_id, true);
+  leaf->SetValueAt(index, BPlusTreePostingPage::ListRef(new_head_id));
+  return true;
+}
+
+/*
+ * Write values into a chain of full posting pages.
+ * @return : the leaf value that references the chain
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::NewPostingList(const std::vector<ValueType> &values, Context *ctx) -> ValueType {
+  page_id_t head_id = INVALID_PAGE_ID;
+  for (size_t start = 0; start < values.size(); start += BPlusTreePostingPage::CAPACITY) {
+    page_id_t list_id;
+    auto *list = reinterpret_cast<BPlusTreePostingPage *>(NewTreePage(&list_id, ctx)->GetData());
+    list->Init(head_id);
+    size_t end = std::min(values.size(), start + BPlusTreePostingPage::CAPACITY);
+    for (size_t i = start; i < end; i++) {
+      list->Append(values[i]);
+    }
+    buffer_pool_manager_->UnpinPage(list_id, true);
+    head_id = list_id;
+  }
+  return BPlusTreePostingPage::ListRef(head_id);
+}
+
+/*
+ * Remove value, or every value if it is nullptr, from the key at index of a leaf. A value leaves a posting list in
+ * place and the list turns back into a plain value once one is left. Emptied posting pages are unlinked and join
+ * the deleted pages of the context.
+ * @return : whether the entry stays in the leaf, false if the caller has to remove it
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::KeepsEntry(LeafPage *leaf, int index, const ValueType *value, Context *ctx) -> bool {
+  ValueType stored = leaf->ValueAt(index);
+  if (!BPlusTreePostingPage::IsListRef(stored)) {
+    return value != nullptr && !(stored == *value);
+  }
+  if (value == nullptr) {
+    return false;
+  }
+  page_id_t prev_id = INVALID_PAGE_ID;
+  for (page_id_t list_id = stored.GetPageId(); list_id != INVALID_PAGE_ID;) {
+    auto *list = reinterpret_cast<BPlusTreePostingPage *>(FetchTreePage(list_id, ctx)->GetData());
+    int pos = list->IndexOf(*value);
+    page_id_t next_id = list->GetNextPageId();
+    if (pos < 0) {
+      buffer_pool_manager_->UnpinPage(list_id, false);
+      prev_id = list_id;
+      list_id = next_id;
+      continue;
+    }
+    list->RemoveAt(pos);
+    bool emptied = list->GetSize() == 0;
+    buffer_pool_manager_->UnpinPage(list_id, true);
+    if (emptied && prev_id == INVALID_PAGE_ID) {
+      leaf->SetValueAt(index, BPlusTreePostingPage::ListRef(next_id));
+    } else if (emptied) {
+      auto *prev = reinterpret_cast<BPlusTreePostingPage *>(FetchTreePage(prev_id, ctx)->GetData());
+      prev->SetNextPageId(next_id);
+      buffer_pool_manager_->UnpinPage(prev_id, true);
+    }
+    if (emptied) {
+      ctx->deleted_pages_.push_back(list_id);
+    }
+    CollapsePostingList(leaf, index, ctx);
+    return true;
+  }
+  return true;
+}
+
+/*
+ * Turn a posting list of a single value back into a plain value.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::CollapsePostingList(LeafPage *leaf, int index, Context *ctx) {
+  page_id_t head_id = leaf->ValueAt(index).GetPageId();
+  auto *head = reinterpret_cast<BPlusTreePostingPage *>(FetchTreePage(head_id, ctx)->GetData());
+  bool single = head->GetNextPageId() == INVALID_PAGE_ID && head->GetSize() == 1;
+  if (single) {
+    leaf->SetValueAt(index, head->ValueAt(0));
+    ctx->deleted_pages_.push_back(head_id);
+  }
+  buffer_pool_manager_->UnpinPage(head_id, false);
+}
+
+/*
+ * Add every page of the posting list a removed entry referenced to the deleted pages of the context.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::DropPostingList(const ValueType &stored, Context *ctx) {
+  if (!BPlusTreePostingPage::IsListRef(stored)) {
+    return;
+  }
+  for (page_id_t list_id = stored.GetPageId(); list_id != INVALID_PAGE_ID;) {
+    auto *list = reinterpret_cast<BPlusTreePostingPage *>(FetchTreePage(list_id, ctx)->GetData());
+    page_id_t next_id = list->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(list_id, false);
+    ctx->deleted_pages_.push_back(list_id);
+    list_id = next_id;
+  }
+}
+
+/*****************************************************************************
+ * BULK LOAD
+ *****************************************************************************/
+namespace {
+/*
+ * Cut a sorted stream of items into pages of target items each. The last page would usually end up short, so the
+ * last two pages are held back until the stream ends: if the last one is below min_size it either joins the one
+ * before it or the two share their items evenly.
+ * fits(size, item) tells whether a page of size items has room for item as well; it sees the items of a page in
+ * order, starting with size 0, so a compressed page can track its key format as it fills.
+ */
+template <typename ItemType, typename NextFn, typename FitsFn, typename FlushFn>
+void PackPages(NextFn &&next, int target, int min_size, int max_size, FitsFn &&fits, FlushFn &&flush) {
+  auto fits_all = [&](const ItemType *items, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+      if (!fits(static_cast<int>(i), items[i])) {
+        return false;
+      }
+    }
+    return true;
+  };
+  std::vector<ItemType> prev;
+  std::vector<ItemType> cur;
+  ItemType item;
+  while (next(&item)) {
+    if (static_cast<int>(cur.size()) == target || !fits(static_cast<int>(cur.size()), item)) {
+      if (!prev.empty()) {
+        flush(prev);
+      }
+      prev.swap(cur);
+      cur.clear();
+      fits(0, item);
+    }
+    cur.push_back(item);
+  }
+  if (!prev.empty() && static_cast<int>(cur.size()) < min_size) {
+    std::vector<ItemType> all(prev);
+    all.insert(all.end(), cur.begin(), cur.end());
+    size_t keep = all.size() / 2;
+    if (static_cast<int>(all.size()) <= max_size && fits_all(all.data(), all.size())) {
+      prev.swap(all);
+      cur.clear();
+    } else if (fits_all(all.data(), keep) && fits_all(all.data() + keep, all.size() - keep)) {
+      prev.assign(all.begin(), all.begin() + keep);
+      cur.assign(all.begin() + keep, all.end());
+    }
+  }
+  if (!prev.empty()) {
+    flush(prev);
+  }
+  if (!cur.empty()) {
+    flush(cur);
+  }
+}
+
+/*
+ * Number of items a bulk loaded page gets: fill_factor of its capacity, but never below its minimum size.
+ */
+auto FillTarget(int capacity, int min_size, double fill_factor) -> int {
+  auto target = static_cast<int>(capacity * fill_factor);
+  return std::clamp(target, std::max(min_size, 1), capacity);
+}
+}  // namespace
+
+/*
+ * Build the tree from the pairs of sorter, which must be finished. Instead of descending once per pair, the leaves
+ * are written left to right, each filled to fill_factor, then every internal level is built from the first keys of
+ * the level below it in one pass, up to the root. The pages of each level are linked and fenced as they are
+ * written. Of equal keys a unique tree keeps only the first, a non-unique tree writes their values into a posting
+ * list. Compressed pages are filled to fill_factor of their bytes, and the leaf level pushes up truncated separators.
+ * @return false if the tree is not empty, nothing is loaded then
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::BulkLoad(BulkLoadSorter<KeyType, ValueType, KeyComparator> *sorter, double fill_factor)
+    -> bool {
+  Context ctx;
+  root_latch_.WLock();
+  ctx.root_latched_ = true;
+  if (root_page_id_ != INVALID_PAGE_ID) {
+    ReleaseContext(&ctx, false);
+    return false;
+  }
+
+  // The first key and page id of every page of the level built last.
+  std::vector<std::pair<KeyType, page_id_t>> level;
+  // The pair after the last key returned, read ahead to find the end of a run of equal keys.
+  bool has_pending = false;
+  MappingType pending;
+  auto next_pair = [&](MappingType *item) {
+    if (!has_pending && !sorter->Next(&pending)) {
+      return false;
+    }
+    has_pending = false;
+    *item = pending;
+    std::vector<ValueType> values;
+    while (sorter->Next(&pending)) {
+      if (comparator_(pending.first, item->first) != 0) {
+        has_pending = true;
+        break;
+      }
+      if (unique_keys_) {
+        continue;
+      }
+      if (values.empty()) {
+        values.push_back(item->second);
+      }
+      values.push_back(pending.second);
+    }
+    if (!values.empty()) {
+      item->second = NewPostingList(values, &ctx);
+    }
+    return true;
+  };
+  typename LeafPage::KeyFormat leaf_format;
+  auto leaf_fits = [&](int size, const MappingType &item) {
+    if (!compress_keys_) {
+      return true;
+    }
+    if (size == 0) {
+      leaf_format = {};
+    }
+    auto format = leaf_format;
+    format.Add(item.first);
+    if (!LeafPage::Fits(format, size + 1, fill_factor)) {
+      return false;
+    }
+    leaf_format = format;
+    return true;
+  };
+  // The leaf written last stays in the write set until the next leaf links to it.
+  KeyType prev_last_key;
+  auto flush_leaf = [&](const std::vector<MappingType> &items) {
+    page_id_t page_id;
+    Page *page = NewTreePage(&page_id, &ctx);
+    page->WLatch();
+    auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    leaf->Init(page_id, INVALID_PAGE_ID, leaf_max_size_, compress_keys_);
+    leaf->CopyNFrom(items.data(), static_cast<int>(items.size()));
+    if (!ctx.write_set_.empty()) {
+      Page *prev = ctx.write_set_.back();
+      auto *prev_leaf = reinterpret_cast<LeafPage *>(prev->GetData());
+      KeyType separator = SeparatorBetween(prev_last_key, items[0].first);
+      prev_leaf->SetNextPageId(page_id);
+      prev_leaf->SetHighKey(separator);
+      leaf->SetPrevPageId(prev->GetPageId());
+      leaf->SetLowKey(separator);
+      prev->WUnlatch();
+      buffer_pool_manager_->UnpinPage(prev->GetPageId(), true);
+      ctx.write_set_.pop_back();
+      level.emplace_back(separator, page_id);
+    } else {
+      level.emplace_back(items[0].first, page_id);
+    }
+    ctx.write_set_.push_back(page);
+    prev_last_key = items.back().first;
+  };
+  // A leaf can hold leaf_max_size_ - 1 pairs, it splits once it reaches leaf_max_size_.
+  int leaf_min = leaf_max_size_ / 2;
+  PackPages<MappingType>(next_pair, FillTarget(leaf_max_size_ - 1, leaf_min, fill_factor), leaf_min,
+                         leaf_max_size_ - 1, leaf_fits, flush_leaf);
+  // Every leaf is linked now, release the last one.
+  for (Page *page : ctx.write_set_) {
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+  }
+  ctx.write_set_.clear();
+  if (level.empty()) {
+    ReleaseContext(&ctx, false);
+    return true;
+  }
+
+  // Every internal page needs two children, the root included.
+  int internal_min = std::max((internal_max_size_ + 1) / 2, 2);
+  int internal_target = FillTarget(internal_max_size_, internal_min, fill_factor);
+  typename InternalPage::KeyFormat internal_format;
+  // The key of the first child of an internal page is invalid and takes no room.
+  auto internal_fits = [&](int size, const std::pair<KeyType, page_id_t> &child) {
+    if (!compress_keys_ || size == 0) {
+      internal_format = {};
+      return true;
+    }
+    auto format = internal_format;
+    format.Add(child.first);
+    if (!InternalPage::Fits(format, size + 1, fill_factor)) {
+      return false;
+    }
+    internal_format = format;
+    return true;
+  };
+  while (level.size() > 1) {
+    std::vector<std::pair<KeyType, page_id_t>> upper;
+    size_t pos = 0;
+    // The page of this level written last, it gets its right link and high key from the next one.
+    page_id_t prev_id = INVALID_PAGE_ID;
+    auto next_child = [&](std::pair<KeyType, page_id_t> *child) {
+      if (pos == level.size()) {
+        return false;
+      }
+      *child = level[pos++];
+      return true;
+    };
+    auto flush_internal = [&](const std::vector<std::pair<KeyType, page_id_t>> &children) {
+      page_id_t page_id;
+      Page *page = NewTreePage(&page_id, &ctx);
+      auto *node = reinterpret_cast<InternalPage *>(page->GetData());
+      node->Init(page_id, INVALID_PAGE_ID, internal_max_size_, compress_keys_);
+      node->CopyNFrom(children.data(), static_cast<int>(children.size()));
+      if (prev_id != INVALID_PAGE_ID) {
+        auto *prev = reinterpret_cast<InternalPage *>(FetchTreePage(prev_id, &ctx)->GetData());
+        prev->SetNextPageId(page_id);
+        prev->SetHighKey(children[0].first);
+        buffer_pool_manager_->UnpinPage(prev_id, true);
+        node->SetLowKey(children[0].first);
+      }
+      prev_id = page_id;
+      buffer_pool_manager_->UnpinPage(page_id, true);
+      for (const auto &child : children) {
+        SetParentPageId(child.second, page_id);
+      }
+      upper.emplace_back(children[0].first, page_id);
+    };
+    PackPages<std::pair<KeyType, page_id_t>>(next_child, internal_target, internal_min, internal_max_size_,
+                                             internal_fits, flush_internal);
+    level.swap(upper);
+  }
+
+  root_page_id_ = level[0].second;
+  UpdateRootPageId(1);
+  ReleaseContext(&ctx, true);
+  return true;
 }
 
 /*****************************************************************************
@@ -61,7 +1035,586 @@ auto BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transact
  * necessary.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {}
+void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) { RemoveEntry(key, nullptr); }
+
+/*
+ * Delete one key & value pair. A key with more values only loses this one from its posting list, a key whose value
+ * differs stays untouched.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::Remove(const KeyType &key, const ValueType &value, Transaction *transaction) {
+  RemoveEntry(key, &value);
+}
+
+/*
+ * Remove value, or every value if it is nullptr, from key. Values leaving a posting list do not change the leaf's
+ * size; only removing the entry itself may underflow the leaf and restart pessimistically.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::RemoveEntry(const KeyType &key, const ValueType *value) {
+  Page *page = FindLeafOptimistic(&key, Operation::REMOVE);
+  if (page == nullptr) {
+    return;
+  }
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  Context ctx;
+  ctx.write_set_.push_back(page);
+  int index = leaf->KeyIndex(key, comparator_);
+  bool found = index < leaf->GetSize() && comparator_(leaf->KeyAt(index), key) == 0;
+  if (!found || KeepsEntry(leaf, index, value, &ctx)) {
+    ReleaseContext(&ctx, found);
+    DeletePages(&ctx);
+    return;
+  }
+  if (IsSafe(leaf, Operation::REMOVE, key)) {
+    DropPostingList(leaf->ValueAt(index), &ctx);
+    leaf->RemoveAndDeleteRecord(key, comparator_);
+    ReleaseContext(&ctx, true);
+    DeletePages(&ctx);
+    return;
+  }
+  // The leaf underflows, restart and latch the pages a merge may reach.
+  ReleaseContext(&ctx, false);
+
+  page = FindLeafPessimistic(key, Operation::REMOVE, &ctx);
+  if (page == nullptr) {
+    ReleaseContext(&ctx, false);
+    return;
+  }
+  leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  // The entry may have changed while no latch was held.
+  index = leaf->KeyIndex(key, comparator_);
+  found = index < leaf->GetSize() && comparator_(leaf->KeyAt(index), key) == 0;
+  if (!found || KeepsEntry(leaf, index, value, &ctx)) {
+    ReleaseContext(&ctx, found);
+    DeletePages(&ctx);
+    return;
+  }
+  DropPostingList(leaf->ValueAt(index), &ctx);
+  leaf->RemoveAndDeleteRecord(key, comparator_);
+  HandleUnderflow(ctx.write_set_.size() - 1, &ctx);
+  ReleaseContext(&ctx, true);
+  DeletePages(&ctx);
+}
+
+/*
+ * Fix the page at the given level of the write set after a removal: adjust the root, or coalesce the page with or
+ * borrow from a sibling, and continue with the parent if it lost a child.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::HandleUnderflow(size_t level, Context *ctx) {
+  Page *page = ctx->write_set_[level];
+  auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  if (node->IsRootPage()) {
+    AdjustRoot(page, ctx);
+    return;
+  }
+  if (node->GetSize() >= node->GetMinSize()) {
+    return;
+  }
+  // Only a safe page can start the write set, and a safe page does not underflow.
+  BUSTUB_ASSERT(level > 0, "the parent of an underflowing page must be latched");
+  auto *parent = reinterpret_cast<InternalPage *>(ctx->write_set_[level - 1]->GetData());
+  // A compressed internal page may be left with one child when its sibling had no room for a merge.
+  if (parent->GetSize() == 1) {
+    return;
+  }
+  // Both a merge and a redistribution change the parent.
+  ctx->write_set_[level - 1]->BeginUpdate();
+  int index = parent->ValueIndex(node->GetPageId());
+  int parent_size = parent->GetSize();
+  if (node->IsLeafPage()) {
+    CoalesceOrRedistributeLeaf(reinterpret_cast<LeafPage *>(node), parent, index, page, ctx);
+  } else {
+    CoalesceOrRedistributeInternal(reinterpret_cast<InternalPage *>(node), parent, index, page, ctx);
+  }
+  if (parent->GetSize() < parent_size) {
+    // The pages below the parent are consistent again. Release them before the parent's level latches a sibling to
+    // its left: a writer holding that sibling may be waiting for one of them, see SetPrevLeaf().
+    for (size_t i = level; i < ctx->write_set_.size(); i++) {
+      ctx->write_set_[i]->WUnlatch();
+      buffer_pool_manager_->UnpinPage(ctx->write_set_[i]->GetPageId(), true);
+    }
+    ctx->write_set_.resize(level);
+    HandleUnderflow(level - 1, ctx);
+  }
+}
+
+/*
+ * Coalesce an underflowing leaf with its sibling, or move one pair over from the sibling if both do not fit in one
+ * page. The right sibling is preferred. The last child of a parent uses its left sibling; it releases its own latch
+ * first and takes both latches from left to right, the order in which index iterators walk the leaves. Holding the
+ * parent's write latch keeps any other writer away from both leaves meanwhile. If the new separation key does not
+ * fit into a compressed parent, the leaf is left below its min size. The fence keys between the two leaves follow
+ * the separation key; a merged leaf leaves its high key and right link to the leaf it moves into.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::CoalesceOrRedistributeLeaf(LeafPage *node, InternalPage *parent, int index, Page *page,
+                                                Context *ctx) {
+  if (index + 1 < parent->GetSize()) {
+    Page *sibling_page = FetchTreePage(parent->ValueAt(index + 1), ctx);
+    sibling_page->WLatch();
+    sibling_page->BeginUpdate();
+    auto *sibling = reinterpret_cast<LeafPage *>(sibling_page->GetData());
+    if (node->CanMergeWith(sibling)) {
+      sibling->MoveAllTo(node);
+      SetPrevLeaf(node->GetNextPageId(), node->GetPageId(), ctx);
+      parent->Remove(index + 1);
+      Retire(sibling_page, ctx);
+    } else {
+      KeyType separator = SeparatorBetween(sibling->KeyAt(0), sibling->KeyAt(1));
+      if (parent->CanSetKeyAt(index + 1, separator)) {
+        sibling->MoveFirstToEndOf(node);
+        parent->SetKeyAt(index + 1, separator);
+        node->SetHighKey(separator);
+        sibling->SetLowKey(separator);
+      }
+    }
+    sibling_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(sibling_page->GetPageId(), true);
+    return;
+  }
+
+  page->WUnlatch();
+  Page *sibling_page = FetchTreePage(parent->ValueAt(index - 1), ctx);
+  sibling_page->WLatch();
+  page->WLatch();
+  sibling_page->BeginUpdate();
+  page->BeginUpdate();
+  auto *sibling = reinterpret_cast<LeafPage *>(sibling_page->GetData());
+  if (sibling->CanMergeWith(node)) {
+    node->MoveAllTo(sibling);
+    SetPrevLeaf(sibling->GetNextPageId(), sibling->GetPageId(), ctx);
+    parent->Remove(index);
+    Retire(page, ctx);
+  } else {
+    int last = sibling->GetSize() - 1;
+    KeyType separator = SeparatorBetween(sibling->KeyAt(last - 1), sibling->KeyAt(last));
+    if (parent->CanSetKeyAt(index, separator)) {
+      sibling->MoveLastToFrontOf(node);
+      parent->SetKeyAt(index, separator);
+      sibling->SetHighKey(separator);
+      node->SetLowKey(separator);
+    }
+  }
+  sibling_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(sibling_page->GetPageId(), true);
+}
+
+/*
+ * Coalesce an underflowing internal page with its sibling or borrow one child from it, like the leaf version. The
+ * separation key in the parent moves down into the page that receives children, and the moved children learn
+ * their new parent. Readers may not latch internal pages, so both pages announce their update first.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::CoalesceOrRedistributeInternal(InternalPage *node, InternalPage *parent, int index, Page *page,
+                                                    Context *ctx) {
+  if (index + 1 < parent->GetSize()) {
+    Page *sibling_page = FetchTreePage(parent->ValueAt(index + 1), ctx);
+    sibling_page->WLatch();
+    page->BeginUpdate();
+    sibling_page->BeginUpdate();
+    auto *sibling = reinterpret_cast<InternalPage *>(sibling_page->GetData());
+    if (node->CanMergeWith(sibling, parent->KeyAt(index + 1))) {
+      int first_moved = node->GetSize();
+      sibling->MoveAllTo(node, parent->KeyAt(index + 1));
+      for (int i = first_moved; i < node->GetSize(); i++) {
+        SetParentPageId(node->ValueAt(i), node->GetPageId());
+      }
+      parent->Remove(index + 1);
+      Retire(sibling_page, ctx);
+    } else if (parent->CanSetKeyAt(index + 1, sibling->KeyAt(1))) {
+      KeyType moved_key = sibling->KeyAt(1);
+      sibling->MoveFirstToEndOf(node, parent->KeyAt(index + 1));
+      SetParentPageId(node->ValueAt(node->GetSize() - 1), node->GetPageId());
+      parent->SetKeyAt(index + 1, moved_key);
+      node->SetHighKey(moved_key);
+      sibling->SetLowKey(moved_key);
+    }
+    sibling_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(sibling_page->GetPageId(), true);
+    return;
+  }
+
+  page->WUnlatch();
+  Page *sibling_page = FetchTreePage(parent->ValueAt(index - 1), ctx);
+  sibling_page->WLatch();
+  page->WLatch();
+  sibling_page->BeginUpdate();
+  page->BeginUpdate();
+  auto *sibling = reinterpret_cast<InternalPage *>(sibling_page->GetData());
+  if (sibling->CanMergeWith(node, parent->KeyAt(index))) {
+    int first_moved = sibling->GetSize();
+    node->MoveAllTo(sibling, parent->KeyAt(index));
+    for (int i = first_moved; i < sibling->GetSize(); i++) {
+      SetParentPageId(sibling->ValueAt(i), sibling->GetPageId());
+    }
+    parent->Remove(index);
+    Retire(page, ctx);
+  } else if (parent->CanSetKeyAt(index, sibling->KeyAt(sibling->GetSize() - 1))) {
+    KeyType moved_key = sibling->KeyAt(sibling->GetSize() - 1);
+    sibling->MoveLastToFrontOf(node, parent->KeyAt(index));
+    SetParentPageId(node->ValueAt(0), node->GetPageId());
+    parent->SetKeyAt(index, moved_key);
+    sibling->SetHighKey(moved_key);
+    node->SetLowKey(moved_key);
+  }
+  sibling_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(sibling_page->GetPageId(), true);
+}
+
+/*
+ * Update root page if necessary
+ * NOTE: size of root page can be less than min size and this method is only
+ * called within HandleUnderflow() method
+ * case 1: when you delete the last element in root page, but root page still
+ * has one last child
+ * case 2: when you delete the last element in whole b+ tree
+ * The only child of a root has no siblings, so it has no fence keys either.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::AdjustRoot(Page *page, Context *ctx) {
+  auto *old_root = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  if (old_root->IsLeafPage()) {
+    if (old_root->GetSize() > 0) {
+      return;
+    }
+    BUSTUB_ASSERT(ctx->root_latched_, "emptying the tree requires the root latch");
+    root_page_id_ = INVALID_PAGE_ID;
+    UpdateRootPageId(0);
+    Retire(page, ctx);
+    return;
+  }
+  if (old_root->GetSize() > 1) {
+    return;
+  }
+  BUSTUB_ASSERT(ctx->root_latched_, "replacing the root requires the root latch");
+  page->BeginUpdate();
+  page_id_t child_id = reinterpret_cast<InternalPage *>(old_root)->RemoveAndReturnOnlyChild();
+  SetParentPageId(child_id, INVALID_PAGE_ID);
+  root_page_id_ = child_id;
+  UpdateRootPageId(0);
+  Retire(page, ctx);
+}
+
+/*
+ * Take a write-latched page that a merge emptied out of the tree. Descents that do not latch it or that pinned it
+ * before it was taken out may still reach it, so it is marked deleted before it joins the deleted pages of the
+ * context; they restart from the root when they see the mark.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::Retire(Page *page, Context *ctx) {
+  page->BeginUpdate();
+  reinterpret_cast<BPlusTreePage *>(page->GetData())->SetPageType(IndexPageType::INVALID_INDEX_PAGE);
+  ctx->deleted_pages_.push_back(page->GetPageId());
+}
+
+/*
+ * Delete the pages a removal emptied, once every latch of the context is released.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::DeletePages(Context *ctx) {
+  for (page_id_t page_id : ctx->deleted_pages_) {
+    buffer_pool_manager_->DeletePage(page_id);
+  }
+  ctx->deleted_pages_.clear();
+}
+
+/*****************************************************************************
+ * COMPACTION
+ *****************************************************************************/
+/*
+ * Compact the leaves from left to right, a window of up to COMPACTION_WINDOW leaves below one parent at a time, see
+ * CompactLeaves(). Only the parent and the leaves of one window are latched at a time, so readers and writers keep
+ * working on the rest of the tree; the next window is found by descending to its first key. The last leaf of a
+ * window starts the next one. A parent that gave up so many leaves that it fell below its min size is merged or
+ * redistributed like after a removal, see FixUnderflow().
+ * @return : the fill of the leaves before and after, and the number of leaf pages deleted
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::Compact(double fill_factor) -> BPlusTreeCompactionStats {
+  BPlusTreeCompactionStats stats;
+  stats.before_ = GetFillStats();
+  KeyType key;
+  bool has_key = false;
+  while (true) {
+    Context ctx;
+    Page *parent_page = LatchLeafParent(has_key ? &key : nullptr, &ctx);
+    if (parent_page == nullptr) {
+      break;
+    }
+    auto *parent = reinterpret_cast<InternalPage *>(parent_page->GetData());
+    int first = has_key ? parent->ValueIndex(parent->Lookup(key, comparator_)) : 0;
+    int size = parent->GetSize();
+    int leaves = CompactLeaves(first, fill_factor, &ctx);
+    int reclaimed = size - parent->GetSize();
+    stats.reclaimed_pages_ += reclaimed;
+    // A window merged into one leaf may take more leaves, otherwise its last leaf starts the next window.
+    int next = reclaimed > 0 && leaves == 1 ? first : first + std::max(leaves - 1, 1);
+    bool done = false;
+    if (next + 1 < parent->GetSize()) {
+      if (next != first) {
+        key = parent->KeyAt(next);
+        has_key = true;
+      }
+    } else if (parent->HasHighKey()) {
+      key = parent->HighKey();
+      has_key = true;
+    } else {
+      done = true;
+    }
+    page_id_t parent_id = parent->GetPageId();
+    bool underflow = !parent->IsRootPage() && parent->GetSize() < parent->GetMinSize();
+    bool has_low_key = parent->HasLowKey();
+    KeyType low_key = parent->LowKey();
+    ReleaseContext(&ctx, reclaimed > 0);
+    DeletePages(&ctx);
+    if (underflow) {
+      FixUnderflow(parent_id, has_low_key ? &low_key : nullptr);
+    }
+    if (done) {
+      break;
+    }
+  }
+  stats.after_ = GetFillStats();
+  return stats;
+}
+
+/*
+ * Walk the leaves from left to right like an index iterator and sum up their sizes and fill.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::GetFillStats() -> BPlusTreeFillStats {
+  BPlusTreeFillStats stats;
+  Page *page = FindLeafOptimistic(nullptr, Operation::SEARCH);
+  while (page != nullptr) {
+    auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    stats.leaf_pages_++;
+    stats.entries_ += leaf->GetSize();
+    stats.fill_factor_ += leaf->Fill();
+    Page *next = nullptr;
+    if (leaf->GetNextPageId() != INVALID_PAGE_ID) {
+      next = buffer_pool_manager_->FetchPage(leaf->GetNextPageId());
+      if (next == nullptr) {
+        page->RUnlatch();
+        buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+        throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot fetch the next leaf page");
+      }
+      next->RLatch();
+    }
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    page = next;
+  }
+  if (stats.leaf_pages_ != 0) {
+    stats.fill_factor_ /= static_cast<double>(stats.leaf_pages_);
+  }
+  return stats;
+}
+
+/*
+ * Descend to the internal page whose children are the leaves around key, or the leftmost one if key is nullptr,
+ * write-latching one page at a time from the root down. A writer that changes which children a page has holds the
+ * page's write latch, so the children stay where they are until the page is released.
+ * @return : the parent, which is the only page of the context's write set, nullptr if the tree is empty or its root
+ * is a leaf
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::LatchLeafParent(const KeyType *key, Context *ctx) -> Page * {
+  root_latch_.WLock();
+  ctx->root_latched_ = true;
+  if (root_page_id_ == INVALID_PAGE_ID) {
+    ReleaseContext(ctx, false);
+    return nullptr;
+  }
+  Page *page = FetchTreePage(root_page_id_, ctx);
+  page->WLatch();
+  ctx->write_set_.push_back(page);
+  root_latch_.WUnlock();
+  ctx->root_latched_ = false;
+  while (true) {
+    auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+    if (node->IsLeafPage()) {
+      ReleaseContext(ctx, false);
+      return nullptr;
+    }
+    auto *internal = reinterpret_cast<InternalPage *>(node);
+    page_id_t child_id = key == nullptr ? internal->ValueAt(0) : internal->Lookup(*key, comparator_);
+    Page *child = FetchTreePage(child_id, ctx);
+    if (reinterpret_cast<BPlusTreePage *>(child->GetData())->IsLeafPage()) {
+      buffer_pool_manager_->UnpinPage(child_id, false);
+      return page;
+    }
+    child->WLatch();
+    ReleaseContext(ctx, false);
+    ctx->write_set_.push_back(child);
+    page = child;
+  }
+}
+
+/*
+ * Descend to the internal page with the given id like a pessimistic removal does, following key or the leftmost
+ * path if key is nullptr, and handle its underflow. Nothing happens if the page is no longer below its min size or
+ * no longer on the path.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::FixUnderflow(page_id_t page_id, const KeyType *key) {
+  Context ctx;
+  root_latch_.WLock();
+  ctx.root_latched_ = true;
+  page_id_t next_id = root_page_id_;
+  while (next_id != INVALID_PAGE_ID) {
+    Page *page = FetchTreePage(next_id, &ctx);
+    page->WLatch();
+    auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+    if (node->GetSize() > node->GetMinSize() && (!node->IsRootPage() || node->GetSize() > 2)) {
+      ReleaseContext(&ctx, false);
+    }
+    ctx.write_set_.push_back(page);
+    if (next_id == page_id) {
+      HandleUnderflow(ctx.write_set_.size() - 1, &ctx);
+      break;
+    }
+    if (node->IsLeafPage()) {
+      break;
+    }
+    auto *internal = reinterpret_cast<InternalPage *>(node);
+    next_id = key == nullptr ? internal->ValueAt(0) : internal->Lookup(*key, comparator_);
+  }
+  ReleaseContext(&ctx, true);
+  DeletePages(&ctx);
+}
+
+/*
+ * Repack the pairs of up to COMPACTION_WINDOW leaves, starting with the child at first of the parent that starts the
+ * write set, into as few leaves as a bulk load at fill_factor would, as long as the parent keeps two children. The
+ * first leaves of the window take the pairs, the others are merged away. The leaves are
+ * write-latched from left to right like a coalesce does, and the fence keys and parent keys between them follow the
+ * new separation keys: a descent that reaches a leaf for a key that moved away finds it outside the fences and
+ * moves right or restarts. If the leaves would not get fewer, or the new separation keys do not fit into a
+ * compressed parent, nothing changes. The leaves are released, the parent stays in the write set.
+ * @return : the number of leaves the window consists of afterwards
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::CompactLeaves(int first, double fill_factor, Context *ctx) -> int {
+  Page *parent_page = ctx->write_set_.front();
+  auto *parent = reinterpret_cast<InternalPage *>(parent_page->GetData());
+  int count = std::min(COMPACTION_WINDOW, parent->GetSize() - first);
+  if (count < 2) {
+    return count;
+  }
+  std::vector<LeafPage *> leaves;
+  std::vector<MappingType> items;
+  std::vector<MappingType> leaf_items;
+  for (int i = 0; i < count; i++) {
+    Page *page = FetchTreePage(parent->ValueAt(first + i), ctx);
+    page->WLatch();
+    ctx->write_set_.push_back(page);
+    leaves.push_back(reinterpret_cast<LeafPage *>(page->GetData()));
+    leaves.back()->CopyAllTo(&leaf_items);
+    items.insert(items.end(), leaf_items.begin(), leaf_items.end());
+  }
+  auto release_leaves = [&](bool is_dirty) {
+    for (size_t i = 1; i < ctx->write_set_.size(); i++) {
+      ctx->write_set_[i]->WUnlatch();
+      buffer_pool_manager_->UnpinPage(ctx->write_set_[i]->GetPageId(), is_dirty);
+    }
+    ctx->write_set_.resize(1);
+  };
+
+  // The number of pairs of each new leaf, packed like a bulk load does.
+  int leaf_min = leaf_max_size_ / 2;
+  typename LeafPage::KeyFormat leaf_format;
+  auto leaf_fits = [&](int size, const MappingType &item) {
+    if (!compress_keys_) {
+      return true;
+    }
+    if (size == 0) {
+      leaf_format = {};
+    }
+    auto format = leaf_format;
+    format.Add(item.first);
+    if (!LeafPage::Fits(format, size + 1, fill_factor)) {
+      return false;
+    }
+    leaf_format = format;
+    return true;
+  };
+  auto pack = [&](int target) {
+    std::vector<int> sizes;
+    size_t pos = 0;
+    auto next_item = [&](MappingType *item) {
+      if (pos == items.size()) {
+        return false;
+      }
+      *item = items[pos++];
+      return true;
+    };
+    PackPages<MappingType>(next_item, target, leaf_min, leaf_max_size_ - 1, leaf_fits,
+                           [&](const std::vector<MappingType> &page) { sizes.push_back(page.size()); });
+    return sizes;
+  };
+  int total = static_cast<int>(items.size());
+  // The caller handles a parent that falls below its min size, but an internal page needs two children.
+  int min_leaves = std::max(count - (parent->GetSize() - 2), 1);
+  std::vector<int> sizes = pack(FillTarget(leaf_max_size_ - 1, leaf_min, fill_factor));
+  if (static_cast<int>(sizes.size()) < min_leaves) {
+    sizes = pack(std::max(total / min_leaves, 1));
+  }
+  int new_count = static_cast<int>(sizes.size());
+  if (new_count >= count || new_count < min_leaves) {
+    release_leaves(false);
+    return count;
+  }
+
+  // The parent keeps the window's first new_count children, the keys between them are the new separators.
+  std::vector<KeyType> separators;
+  std::vector<std::pair<KeyType, page_id_t>> children;
+  parent->CopyAllTo(&children);
+  int begin = 0;
+  for (int i = 0; i + 1 < new_count; i++) {
+    begin += sizes[i];
+    separators.push_back(SeparatorBetween(items[begin - 1].first, items[begin].first));
+    children[first + i + 1].first = separators.back();
+  }
+  children.erase(children.begin() + first + new_count, children.begin() + first + count);
+  if (compress_keys_) {
+    typename InternalPage::KeyFormat format;
+    for (size_t i = 1; i < children.size(); i++) {
+      format.Add(children[i].first);
+    }
+    if (!InternalPage::Fits(format, static_cast<int>(children.size()))) {
+      release_leaves(false);
+      return count;
+    }
+  }
+
+  parent_page->BeginUpdate();
+  for (size_t i = 1; i < ctx->write_set_.size(); i++) {
+    ctx->write_set_[i]->BeginUpdate();
+  }
+  LeafPage *last = leaves[new_count - 1];
+  last->SetNextPageId(leaves[count - 1]->GetNextPageId());
+  last->SetHighKey(leaves[count - 1]->HighKey());
+  begin = 0;
+  for (int i = 0; i < new_count; i++) {
+    leaves[i]->CopyNFrom(items.data() + begin, sizes[i]);
+    begin += sizes[i];
+    if (i > 0) {
+      leaves[i]->SetLowKey(separators[i - 1]);
+    }
+    if (i + 1 < new_count) {
+      leaves[i]->SetHighKey(separators[i]);
+    }
+  }
+  SetPrevLeaf(last->GetNextPageId(), last->GetPageId(), ctx);
+  parent->CopyNFrom(children.data(), static_cast<int>(children.size()));
+  for (int i = new_count; i < count; i++) {
+    Retire(ctx->write_set_[1 + i], ctx);
+  }
+  release_leaves(true);
+  return new_count;
+}
 
 /*****************************************************************************
  * INDEX ITERATOR
@@ -72,7 +1625,13 @@ void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {}
  * @return : index iterator
  */
 INDEX_TEMPLATE_ARGUMENTS
-auto BPLUSTREE_TYPE::Begin() -> INDEXITERATOR_TYPE { return INDEXITERATOR_TYPE(); }
+auto BPLUSTREE_TYPE::Begin() -> INDEXITERATOR_TYPE {
+  Page *page = FindLeafOptimistic(nullptr, Operation::SEARCH);
+  if (page == nullptr) {
+    return INDEXITERATOR_TYPE();
+  }
+  return MakeIterator(page, 0, false, {});
+}
 
 /*
  * Input parameter is low key, find the leaf page that contains the input key
@@ -80,7 +1639,14 @@ auto BPLUSTREE_TYPE::Begin() -> INDEXITERATOR_TYPE { return INDEXITERATOR_TYPE()
  * @return : index iterator
  */
 INDEX_TEMPLATE_ARGUMENTS
-auto BPLUSTREE_TYPE::Begin(const KeyType &key) -> INDEXITERATOR_TYPE { return INDEXITERATOR_TYPE(); }
+auto BPLUSTREE_TYPE::Begin(const KeyType &key) -> INDEXITERATOR_TYPE {
+  Page *page = FindLeafOptimistic(&key, Operation::SEARCH);
+  if (page == nullptr) {
+    return INDEXITERATOR_TYPE();
+  }
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  return MakeIterator(page, leaf->KeyIndex(key, comparator_), false, key);
+}
 
 /*
  * Input parameter is void, construct an index iterator representing the end
@@ -90,11 +1656,116 @@ auto BPLUSTREE_TYPE::Begin(const KeyType &key) -> INDEXITERATOR_TYPE { return IN
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::End() -> INDEXITERATOR_TYPE { return INDEXITERATOR_TYPE(); }
 
+/*
+ * Find the rightmost leaf page, then construct an index iterator that moves backwards from its last pair
+ * @return : index iterator
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::RBegin() -> INDEXITERATOR_TYPE {
+  Page *page = FindLeafOptimistic(nullptr, Operation::SEARCH, true);
+  if (page == nullptr) {
+    return INDEXITERATOR_TYPE();
+  }
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  KeyType from{};
+  if (leaf->GetSize() > 0) {
+    from = leaf->KeyAt(leaf->GetSize() - 1);
+  }
+  return MakeIterator(page, leaf->GetSize() - 1, true, from);
+}
+
+/*
+ * Find the leaf page that covers key, then construct an index iterator that moves backwards from the last pair
+ * whose key is not greater than key
+ * @return : index iterator
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::RBegin(const KeyType &key) -> INDEXITERATOR_TYPE {
+  Page *page = FindLeafOptimistic(&key, Operation::SEARCH);
+  if (page == nullptr) {
+    return INDEXITERATOR_TYPE();
+  }
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  int index = leaf->KeyIndex(key, comparator_);
+  if (index == leaf->GetSize() || comparator_(leaf->KeyAt(index), key) != 0) {
+    index--;
+  }
+  return MakeIterator(page, index, true, key);
+}
+
+/*
+ * Hand a latched leaf over to a new iterator. An iterator that moves backwards and cannot latch the leaf before its
+ * current one descends again for the last key below the current leaf.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::MakeIterator(Page *page, int index, bool reverse, const KeyType &from) -> INDEXITERATOR_TYPE {
+  auto find_leaf = [this](const KeyType &key) { return FindLeafOptimistic(&key, Operation::SEARCH); };
+  return INDEXITERATOR_TYPE(buffer_pool_manager_, &comparator_, find_leaf, page, index, reverse, from);
+}
+
 /**
  * @return Page id of the root of this tree
  */
 INDEX_TEMPLATE_ARGUMENTS
-auto BPLUSTREE_TYPE::GetRootPageId() -> page_id_t { return 0; }
+auto BPLUSTREE_TYPE::GetRootPageId() -> page_id_t { return root_page_id_; }
+
+/*****************************************************************************
+ * BUFFER POOL HELPERS
+ *****************************************************************************/
+/*
+ * Allocate a page for the tree. On failure the context is released before the out of memory exception is thrown.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::NewTreePage(page_id_t *page_id, Context *ctx) -> Page * {
+  Page *page = buffer_pool_manager_->NewPage(page_id);
+  if (page == nullptr) {
+    ReleaseContext(ctx, true);
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot allocate a b+ tree page");
+  }
+  return page;
+}
+
+/*
+ * Fetch a page of the tree. On failure the context is released before the out of memory exception is thrown.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::FetchTreePage(page_id_t page_id, Context *ctx) -> Page * {
+  Page *page = buffer_pool_manager_->FetchPage(page_id);
+  if (page == nullptr) {
+    ReleaseContext(ctx, true);
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot fetch a b+ tree page");
+  }
+  return page;
+}
+
+/*
+ * Record the new parent of a child that moved between internal pages. The parent page id is only used for
+ * IsRootPage() and debugging, the descent itself never follows it, so the child is not latched.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::SetParentPageId(page_id_t child_id, page_id_t parent_id) {
+  Page *page = buffer_pool_manager_->FetchPage(child_id);
+  BUSTUB_ASSERT(page != nullptr, "cannot fetch a b+ tree page");
+  reinterpret_cast<BPlusTreePage *>(page->GetData())->SetParentPageId(parent_id);
+  buffer_pool_manager_->UnpinPage(child_id, true);
+}
+
+/*
+ * Point a leaf back at the leaf before it, after a split or merge changed that leaf. Nothing to do if leaf_id is
+ * invalid. The leaf lies right of every leaf the writer holds, so latching it keeps the left to right order.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::SetPrevLeaf(page_id_t leaf_id, page_id_t prev_id, Context *ctx) {
+  if (leaf_id == INVALID_PAGE_ID) {
+    return;
+  }
+  Page *page = FetchTreePage(leaf_id, ctx);
+  page->WLatch();
+  page->BeginUpdate();
+  reinterpret_cast<LeafPage *>(page->GetData())->SetPrevPageId(prev_id);
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(leaf_id, true);
+}
 
 /*****************************************************************************
  * UTILITIES AND DEBUG
@@ -110,13 +1781,14 @@ auto BPLUSTREE_TYPE::GetRootPageId() -> page_id_t { return 0; }
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::UpdateRootPageId(int insert_record) {
   auto *header_page = static_cast<HeaderPage *>(buffer_pool_manager_->FetchPage(HEADER_PAGE_ID));
-  if (insert_record != 0) {
-    // create a new record<index_name + root_page_id> in header_page
-    header_page->InsertRecord(index_name_, root_page_id_);
-  } else {
+  // every index of the database shares the header page
+  header_page->WLatch();
+  // a tree that became empty and grows again already has its record
+  if (insert_record == 0 || !header_page->InsertRecord(index_name_, root_page_id_)) {
     // update root_page_id in header_page
     header_page->UpdateRecord(index_name_, root_page_id_);
   }
+  header_page->WUnlatch();
   buffer_pool_manager_->UnpinPage(HEADER_PAGE_ID, true);
 }
 
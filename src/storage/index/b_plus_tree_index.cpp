@@ -9,17 +9,35 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <numeric>
+
 #include "storage/index/b_plus_tree_index.h"
+#include "type/value_factory.h"
 
 namespace bustub {
 /*
  * Constructor
+ * Entries over several columns usually share their leading columns with their neighbours, so those indexes use the
+ * compressed page types, sized by bytes instead of by a fixed number of pairs.
+ *
+ * The tree of a non-unique index with included columns orders its entries by all their columns, so that two rows
+ * with the same key but different included values get an entry each. A unique index keeps one entry per key and
+ * orders by the key alone.
  */
 INDEX_TEMPLATE_ARGUMENTS
 BPLUSTREE_INDEX_TYPE::BPlusTreeIndex(std::unique_ptr<IndexMetadata> &&metadata, BufferPoolManager *buffer_pool_manager)
     : Index(std::move(metadata)),
-      comparator_(GetMetadata()->GetKeySchema()),
-      container_(GetMetadata()->GetName(), buffer_pool_manager, comparator_) {}
+      buffer_pool_manager_(buffer_pool_manager),
+      comparator_(GetMetadata()->IsUnique() ? GetMetadata()->GetKeySchema() : GetMetadata()->GetEntrySchema()),
+      key_comparator_(GetMetadata()->GetKeySchema()),
+      container_(GetMetadata()->GetName(), buffer_pool_manager, comparator_,
+                 GetEntryColumnCount() > 1 ? BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>::COMPRESSED_MAX_SIZE
+                                           : LEAF_PAGE_SIZE,
+                 GetEntryColumnCount() > 1
+                     ? BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator>::COMPRESSED_MAX_SIZE
+                     : INTERNAL_PAGE_SIZE,
+                 GetEntryColumnCount() > 1, GetMetadata()->IsUnique()) {}
 
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid, Transaction *transaction) {
@@ -36,11 +54,23 @@ void BPLUSTREE_INDEX_TYPE::DeleteEntry(const Tuple &key, RID rid, Transaction *t
   KeyType index_key;
   index_key.SetFromKey(key);
 
-  container_.Remove(index_key, transaction);
+  container_.Remove(index_key, rid, transaction);
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) {
+  if (HasIncludedColumns()) {
+    // The entries of the key lie next to each other, from the least included values on.
+    std::vector<Value> values;
+    for (uint32_t i = 0; i < GetIndexColumnCount(); i++) {
+      values.push_back(key.GetValue(GetKeySchema(), i));
+    }
+    KeyType first = EntryBound(values, false);
+    for (auto iter = container_.Begin(first); !iter.IsEnd() && key_comparator_((*iter).first, first) == 0; ++iter) {
+      result->push_back((*iter).second);
+    }
+    return;
+  }
   // construct scan index key
   KeyType index_key;
   index_key.SetFromKey(key);
@@ -48,6 +78,74 @@ void BPLUSTREE_INDEX_TYPE::ScanKey(const Tuple &key, std::vector<RID> *result, T
   container_.GetValue(index_key, result, transaction);
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::ScanKeys(const std::vector<Tuple> &keys, std::vector<std::vector<RID>> *results,
+                                    Transaction *transaction) {
+  if (HasIncludedColumns()) {
+    results->assign(keys.size(), {});
+    for (size_t i = 0; i < keys.size(); i++) {
+      ScanKey(keys[i], &(*results)[i], transaction);
+    }
+    return;
+  }
+  std::vector<KeyType> index_keys(keys.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    index_keys[i].SetFromKey(keys[i]);
+  }
+  std::vector<size_t> order(keys.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(),
+                   [&](size_t a, size_t b) { return comparator_(index_keys[a], index_keys[b]) < 0; });
+  std::vector<KeyType> sorted_keys;
+  sorted_keys.reserve(keys.size());
+  for (size_t i : order) {
+    sorted_keys.push_back(index_keys[i]);
+  }
+  std::vector<std::vector<RID>> sorted_results;
+  container_.GetValues(sorted_keys, &sorted_results, transaction);
+  results->resize(keys.size());
+  for (size_t i = 0; i < order.size(); i++) {
+    (*results)[order[i]] = std::move(sorted_results[i]);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::BulkLoad(TableHeap *table_heap, const Schema &table_schema, Transaction *transaction,
+                                    double fill_factor) {
+  BulkLoadSorter<KeyType, ValueType, KeyComparator> sorter(buffer_pool_manager_, comparator_);
+  KeyType index_key;
+  for (auto tuple = table_heap->Begin(transaction); tuple != table_heap->End(); ++tuple) {
+    index_key.SetFromKey(EntryFromTuple(*tuple, table_schema));
+    sorter.Add(index_key, tuple->GetRid());
+  }
+  sorter.Finish();
+  if (container_.BulkLoad(&sorter, fill_factor)) {
+    return;
+  }
+  MappingType item;
+  while (sorter.Next(&item)) {
+    container_.Insert(item.first, item.second, transaction);
+  }
+}
+
+/*
+ * NULL is the least value of a column and the max value of its type the greatest, see GenericComparator. An entry
+ * whose columns after the prefix hold those exact values compares equal to the bound, so a scan still checks the
+ * prefix of the entries at either end of its range.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::EntryBound(const std::vector<Value> &prefix, bool after) const -> KeyType {
+  std::vector<Value> values(prefix);
+  auto *entry_schema = GetEntrySchema();
+  for (uint32_t i = prefix.size(); i < entry_schema->GetColumnCount(); i++) {
+    auto type = entry_schema->GetColumn(i).GetType();
+    values.push_back(after ? Type::GetMaxValue(type) : ValueFactory::GetNullValueByType(type));
+  }
+  KeyType bound;
+  bound.SetFromKey(Tuple(values, entry_schema));
+  return bound;
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_INDEX_TYPE::GetBeginIterator() -> INDEXITERATOR_TYPE { return container_.Begin(); }
 
@@ -57,6 +155,14 @@ auto BPLUSTREE_INDEX_TYPE::GetBeginIterator(const KeyType &key) -> INDEXITERATOR
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_INDEX_TYPE::GetEndIterator() -> INDEXITERATOR_TYPE { return container_.End(); }
 
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::GetReverseBeginIterator() -> INDEXITERATOR_TYPE { return container_.RBegin(); }
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::GetReverseBeginIterator(const KeyType &key) -> INDEXITERATOR_TYPE {
+  return container_.RBegin(key);
+}
+
 template class BPlusTreeIndex<GenericKey<4>, RID, GenericComparator<4>>;
 template class BPlusTreeIndex<GenericKey<8>, RID, GenericComparator<8>>;
 template class BPlusTreeIndex<GenericKey<16>, RID, GenericComparator<16>>;
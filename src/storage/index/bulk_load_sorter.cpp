@@ -0,0 +1,151 @@
+/**
+ * bulk_load_sorter.cpp
+ */
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#include "common/exception.h"
+#include "common/rid.h"
+#include "storage/index/bulk_load_sorter.h"
+
+namespace bustub {
+
+INDEX_TEMPLATE_ARGUMENTS
+BULK_LOAD_SORTER_TYPE::BulkLoadSorter(BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
+                                      size_t run_size)
+    : buffer_pool_manager_(buffer_pool_manager), comparator_(comparator), run_size_(std::max<size_t>(run_size, 1)) {}
+
+INDEX_TEMPLATE_ARGUMENTS
+BULK_LOAD_SORTER_TYPE::~BulkLoadSorter() {
+  // Pages of runs that were not merged to the end.
+  for (auto &run : runs_) {
+    for (size_t i = run.next_page_; i < run.pages_.size(); i++) {
+      buffer_pool_manager_->DeletePage(run.pages_[i]);
+    }
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BULK_LOAD_SORTER_TYPE::Add(const KeyType &key, const ValueType &value) {
+  buffer_.emplace_back(key, value);
+  if (buffer_.size() >= run_size_) {
+    SpillRun();
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BULK_LOAD_SORTER_TYPE::Finish() {
+  if (runs_.empty()) {
+    // Everything fits into one run, Next() reads the buffer directly.
+    SortBuffer();
+    return;
+  }
+  if (!buffer_.empty()) {
+    SpillRun();
+  }
+  for (size_t i = 0; i < runs_.size(); i++) {
+    if (ReadPage(&runs_[i])) {
+      heap_.push_back(i);
+    }
+  }
+  std::make_heap(heap_.begin(), heap_.end(), [this](size_t a, size_t b) { return RunGreater(a, b); });
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BULK_LOAD_SORTER_TYPE::Next(MappingType *item) -> bool {
+  if (runs_.empty()) {
+    if (buffer_pos_ == buffer_.size()) {
+      return false;
+    }
+    *item = buffer_[buffer_pos_++];
+    return true;
+  }
+  if (heap_.empty()) {
+    return false;
+  }
+  auto greater = [this](size_t a, size_t b) { return RunGreater(a, b); };
+  std::pop_heap(heap_.begin(), heap_.end(), greater);
+  auto &run = runs_[heap_.back()];
+  *item = run.buffer_[run.pos_++];
+  if (run.pos_ < run.buffer_.size() || ReadPage(&run)) {
+    std::push_heap(heap_.begin(), heap_.end(), greater);
+  } else {
+    heap_.pop_back();
+  }
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BULK_LOAD_SORTER_TYPE::SortBuffer() {
+  std::stable_sort(buffer_.begin(), buffer_.end(),
+                   [this](const MappingType &a, const MappingType &b) { return comparator_(a.first, b.first) < 0; });
+}
+
+/*
+ * Sort the buffer and write it out as a new run.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BULK_LOAD_SORTER_TYPE::SpillRun() {
+  SortBuffer();
+  Run run;
+  run.unread_ = buffer_.size();
+  for (size_t offset = 0; offset < buffer_.size(); offset += PAIRS_PER_PAGE) {
+    page_id_t page_id;
+    Page *page = buffer_pool_manager_->NewPage(&page_id);
+    if (page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot allocate a bulk load run page");
+    }
+    size_t count = std::min(PAIRS_PER_PAGE, buffer_.size() - offset);
+    memcpy(page->GetData(), &buffer_[offset], count * sizeof(MappingType));
+    buffer_pool_manager_->UnpinPage(page_id, true);
+    run.pages_.push_back(page_id);
+  }
+  runs_.push_back(std::move(run));
+  buffer_.clear();
+}
+
+/*
+ * Read the next page of a run into its buffer and delete the page.
+ * @return false if the run has no pairs left
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BULK_LOAD_SORTER_TYPE::ReadPage(Run *run) -> bool {
+  if (run->next_page_ == run->pages_.size()) {
+    return false;
+  }
+  page_id_t page_id = run->pages_[run->next_page_];
+  Page *page = buffer_pool_manager_->FetchPage(page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot fetch a bulk load run page");
+  }
+  size_t count = std::min(PAIRS_PER_PAGE, run->unread_);
+  const auto *items = reinterpret_cast<const MappingType *>(page->GetData());
+  run->buffer_.assign(items, items + count);
+  buffer_pool_manager_->UnpinPage(page_id, false);
+  buffer_pool_manager_->DeletePage(page_id);
+  run->unread_ -= count;
+  run->next_page_++;
+  run->pos_ = 0;
+  return true;
+}
+
+/*
+ * Heap order of the runs: the run with the smaller next pair is on top.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BULK_LOAD_SORTER_TYPE::RunGreater(size_t a, size_t b) const -> bool {
+  const auto &run_a = runs_[a];
+  const auto &run_b = runs_[b];
+  int cmp = comparator_(run_a.buffer_[run_a.pos_].first, run_b.buffer_[run_b.pos_].first);
+  // Equal keys come out in the order they were added, runs were spilled in that order.
+  return cmp != 0 ? cmp > 0 : a > b;
+}
+
+template class BulkLoadSorter<GenericKey<4>, RID, GenericComparator<4>>;
+template class BulkLoadSorter<GenericKey<8>, RID, GenericComparator<8>>;
+template class BulkLoadSorter<GenericKey<16>, RID, GenericComparator<16>>;
+template class BulkLoadSorter<GenericKey<32>, RID, GenericComparator<32>>;
+template class BulkLoadSorter<GenericKey<64>, RID, GenericComparator<64>>;
+
+}  // namespace bustub
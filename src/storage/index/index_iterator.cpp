@@ -2,29 +2,285 @@
  * index_iterator.cpp
  */
 #include <cassert>
+#include <thread>  // NOLINT
+#include <utility>
 
+#include "common/exception.h"
 #include "storage/index/index_iterator.h"
 
 namespace bustub {
 
-/*
- * NOTE: you can change the destructor/constructor method here
- * set your own input parameters
- */
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE::IndexIterator() = default;
 
 INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE::~IndexIterator() = default;  // NOLINT
+INDEXITERATOR_TYPE::IndexIterator(BufferPoolManager *bpm, const KeyComparator *comparator, FindLeaf find_leaf,
+                                  Page *page, int index, bool reverse, const KeyType &from)
+    : bpm_(bpm), comparator_(comparator), find_leaf_(std::move(find_leaf)), reverse_(reverse), page_(page),
+      index_(index) {
+  if (index_ < 0) {
+    SkipExhaustedLeavesBackward(from);
+  } else {
+    SkipExhaustedLeaves();
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE::~IndexIterator() { Release(); }  // NOLINT
+
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE::IndexIterator(IndexIterator &&other) noexcept
+    : bpm_(other.bpm_),
+      comparator_(other.comparator_),
+      find_leaf_(std::move(other.find_leaf_)),
+      reverse_(other.reverse_),
+      page_(other.page_),
+      index_(other.index_),
+      posting_page_(other.posting_page_),
+      posting_index_(other.posting_index_),
+      has_bound_(other.has_bound_),
+      bound_(other.bound_),
+      bound_inclusive_(other.bound_inclusive_) {
+  other.page_ = nullptr;
+  other.index_ = 0;
+  other.posting_page_ = nullptr;
+  other.posting_index_ = 0;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto INDEXITERATOR_TYPE::operator=(IndexIterator &&other) noexcept -> IndexIterator & {
+  if (this != &other) {
+    Release();
+    bpm_ = other.bpm_;
+    comparator_ = other.comparator_;
+    find_leaf_ = std::move(other.find_leaf_);
+    reverse_ = other.reverse_;
+    page_ = other.page_;
+    index_ = other.index_;
+    posting_page_ = other.posting_page_;
+    posting_index_ = other.posting_index_;
+    has_bound_ = other.has_bound_;
+    bound_ = other.bound_;
+    bound_inclusive_ = other.bound_inclusive_;
+    other.page_ = nullptr;
+    other.index_ = 0;
+    other.posting_page_ = nullptr;
+    other.posting_index_ = 0;
+  }
+  return *this;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto INDEXITERATOR_TYPE::IsEnd() -> bool { return page_ == nullptr; }
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::SetBound(const KeyType &key, bool inclusive) {
+  has_bound_ = true;
+  bound_ = key;
+  bound_inclusive_ = inclusive;
+  CheckBound();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto INDEXITERATOR_TYPE::operator*() -> const MappingType & {
+  assert(page_ != nullptr);
+  item_ = GetLeaf()->GetItem(index_);
+  if (posting_page_ != nullptr) {
+    item_.second = GetPostingList()->ValueAt(posting_index_);
+  }
+  return item_;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto INDEXITERATOR_TYPE::operator++() -> INDEXITERATOR_TYPE & {
+  if (reverse_) {
+    Backward();
+  } else {
+    Forward();
+  }
+  return *this;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto INDEXITERATOR_TYPE::operator--() -> INDEXITERATOR_TYPE & {
+  if (reverse_) {
+    Forward();
+  } else {
+    Backward();
+  }
+  return *this;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::Forward() {
+  if (posting_page_ != nullptr) {
+    if (++posting_index_ < GetPostingList()->GetSize()) {
+      return;
+    }
+    page_id_t next_page_id = GetPostingList()->GetNextPageId();
+    ReleasePostingPage();
+    // Emptied posting pages are unlinked, a linked page has a value.
+    if (next_page_id != INVALID_PAGE_ID) {
+      EnterPostingPage(next_page_id);
+      return;
+    }
+  }
+  index_++;
+  SkipExhaustedLeaves();
+  CheckBound();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::Backward() {
+  assert(page_ != nullptr);
+  if (posting_page_ != nullptr) {
+    if (--posting_index_ >= 0) {
+      return;
+    }
+    page_id_t prev_page_id = PostingPageBefore(GetLeaf()->ValueAt(index_).GetPageId(), posting_page_->GetPageId());
+    ReleasePostingPage();
+    if (prev_page_id != INVALID_PAGE_ID) {
+      EnterPostingPage(prev_page_id);
+      posting_index_ = GetPostingList()->GetSize() - 1;
+      return;
+    }
+  }
+  KeyType from = GetLeaf()->KeyAt(index_);
+  index_--;
+  SkipExhaustedLeavesBackward(from);
+  CheckBound();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::SkipExhaustedLeaves() {
+  while (page_ != nullptr && index_ >= GetLeaf()->GetSize()) {
+    page_id_t next_page_id = GetLeaf()->GetNextPageId();
+    Page *next = next_page_id == INVALID_PAGE_ID ? nullptr : bpm_->FetchPage(next_page_id);
+    if (next_page_id != INVALID_PAGE_ID && next == nullptr) {
+      Release();
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot fetch the next leaf page");
+    }
+    if (next != nullptr) {
+      next->RLatch();
+    }
+    Release();
+    page_ = next;
+    index_ = 0;
+  }
+  EnterEntry(false);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::SkipExhaustedLeavesBackward(const KeyType &from) {
+  while (page_ != nullptr && index_ < 0) {
+    page_id_t prev_page_id = GetLeaf()->GetPrevPageId();
+    if (prev_page_id == INVALID_PAGE_ID) {
+      Release();
+      break;
+    }
+    // A writer deletes the previous leaf only after it relinked the current one, which waits for our latch, so the
+    // previous leaf stays a leaf while we hold the current one.
+    Page *prev = bpm_->FetchPage(prev_page_id);
+    if (prev == nullptr) {
+      Release();
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot fetch the previous leaf page");
+    }
+    if (prev->TryRLatch()) {
+      Release();
+      page_ = prev;
+      index_ = GetLeaf()->GetSize() - 1;
+      continue;
+    }
+    // A writer latched the previous leaf first and may wait for ours, back off and look the position up again.
+    bpm_->UnpinPage(prev_page_id, false);
+    Release();
+    std::this_thread::yield();
+    page_ = find_leaf_(from);
+    if (page_ != nullptr) {
+      index_ = GetLeaf()->KeyIndex(from, *comparator_) - 1;
+    }
+  }
+  EnterEntry(true);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::EnterEntry(bool last) {
+  if (page_ == nullptr) {
+    return;
+  }
+  ValueType value = GetLeaf()->ValueAt(index_);
+  if (!BPlusTreePostingPage::IsListRef(value)) {
+    return;
+  }
+  page_id_t page_id = value.GetPageId();
+  if (last) {
+    page_id = PostingPageBefore(page_id, INVALID_PAGE_ID);
+  }
+  EnterPostingPage(page_id);
+  if (last) {
+    posting_index_ = GetPostingList()->GetSize() - 1;
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::EnterPostingPage(page_id_t page_id) {
+  posting_page_ = bpm_->FetchPage(page_id);
+  posting_index_ = 0;
+  if (posting_page_ == nullptr) {
+    Release();
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot fetch a posting page");
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto INDEXITERATOR_TYPE::PostingPageBefore(page_id_t head_id, page_id_t page_id) -> page_id_t {
+  page_id_t prev_page_id = INVALID_PAGE_ID;
+  for (page_id_t cur = head_id; cur != page_id;) {
+    Page *page = bpm_->FetchPage(cur);
+    if (page == nullptr) {
+      Release();
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot fetch a posting page");
+    }
+    prev_page_id = cur;
+    cur = reinterpret_cast<BPlusTreePostingPage *>(page->GetData())->GetNextPageId();
+    bpm_->UnpinPage(prev_page_id, false);
+  }
+  return prev_page_id;
+}
 
 INDEX_TEMPLATE_ARGUMENTS
-auto INDEXITERATOR_TYPE::IsEnd() -> bool { throw std::runtime_error("unimplemented"); }
+void INDEXITERATOR_TYPE::ReleasePostingPage() {
+  if (posting_page_ != nullptr) {
+    bpm_->UnpinPage(posting_page_->GetPageId(), false);
+    posting_page_ = nullptr;
+  }
+  posting_index_ = 0;
+}
 
 INDEX_TEMPLATE_ARGUMENTS
-auto INDEXITERATOR_TYPE::operator*() -> const MappingType & { throw std::runtime_error("unimplemented"); }
+void INDEXITERATOR_TYPE::CheckBound() {
+  if (page_ == nullptr || !has_bound_) {
+    return;
+  }
+  int cmp = (*comparator_)(GetLeaf()->KeyAt(index_), bound_);
+  if (reverse_) {
+    cmp = -cmp;
+  }
+  if (cmp > 0 || (cmp == 0 && !bound_inclusive_)) {
+    Release();
+  }
+}
 
 INDEX_TEMPLATE_ARGUMENTS
-auto INDEXITERATOR_TYPE::operator++() -> INDEXITERATOR_TYPE & { throw std::runtime_error("unimplemented"); }
+void INDEXITERATOR_TYPE::Release() {
+  ReleasePostingPage();
+  if (page_ != nullptr) {
+    page_->RUnlatch();
+    bpm_->UnpinPage(page_->GetPageId(), false);
+    page_ = nullptr;
+  }
+  index_ = 0;
+}
 
 template class IndexIterator<GenericKey<4>, RID, GenericComparator<4>>;
 
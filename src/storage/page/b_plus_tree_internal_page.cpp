@@ -9,6 +9,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <iostream>
 #include <sstream>
 
@@ -21,31 +22,382 @@ namespace bustub {
  *****************************************************************************/
 /*
  * Init method after creating a new internal page
- * Including set page type, set current size, set page id, set parent id and set
- * max page size
+ * Including set page type, set current size, set page id, set parent id, set
+ * max page size and clear the right link and the low key
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size) {}
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size, bool compressed) {
+  SetPageType(compressed ? IndexPageType::COMPRESSED_INTERNAL_PAGE : IndexPageType::INTERNAL_PAGE);
+  SetSize(0);
+  SetPageId(page_id);
+  SetParentPageId(parent_id);
+  SetMaxSize(max_size);
+  SetNextPageId(INVALID_PAGE_ID);
+  has_low_key_ = 0;
+  if (compressed) {
+    Layout::Write(Data(), nullptr, 0, 1);
+  }
+}
+
+/*
+ * Helper methods to get/set the right link and the fence keys. The high key is only meaningful if the page has a
+ * next page.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::GetNextPageId() const -> page_id_t { return next_page_id_; }
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::HasLowKey() const -> bool { return has_low_key_ != 0; }
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::HasHighKey() const -> bool { return next_page_id_ != INVALID_PAGE_ID; }
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::LowKey() const -> const KeyType & { return low_key_; }
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::HighKey() const -> const KeyType & { return high_key_; }
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetLowKey(const KeyType &key) {
+  low_key_ = key;
+  has_low_key_ = 1;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetHighKey(const KeyType &key) { high_key_ = key; }
+
 /*
  * Helper method to get/set the key associated with input "index"(a.k.a
  * array offset)
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::KeyAt(int index) const -> KeyType {
-  // replace with your own code
-  KeyType key{};
-  return key;
+  return IsCompressed() ? Layout::KeyAt(Data(), index) : array_[index].first;
 }
 
+/*
+ * A compressed page must have room for the key, see CanSetKeyAt().
+ */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetKeyAt(int index, const KeyType &key) {}
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetKeyAt(int index, const KeyType &key) {
+  if (IsCompressed()) {
+    std::vector<MappingType> items;
+    CopyAllTo(&items);
+    items[index].first = key;
+    CopyNFrom(items.data(), GetSize());
+    return;
+  }
+  array_[index].first = key;
+}
 
 /*
- * Helper method to get the value associated with input "index"(a.k.a array
+ * Helper method to get/set the value associated with input "index"(a.k.a array
  * offset)
  */
 INDEX_TEMPLATE_ARGUMENTS
-auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueAt(int index) const -> ValueType { return 0; }
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueAt(int index) const -> ValueType {
+  return IsCompressed() ? Layout::ValueAt(Data(), index) : array_[index].second;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetValueAt(int index, const ValueType &value) {
+  if (IsCompressed()) {
+    Layout::SetValueAt(Data(), index, value);
+    return;
+  }
+  array_[index].second = value;
+}
+
+/*
+ * Helper method to find and return array index(or offset), so that its value
+ * equals to input "value"
+ * @return : the index, or -1 if no child pointer equals to value
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueIndex(const ValueType &value) const -> int {
+  for (int i = 0; i < GetSize(); i++) {
+    if (ValueAt(i) == value) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+/*****************************************************************************
+ * LOOKUP
+ *****************************************************************************/
+/*
+ * Find and return the child pointer(page_id) which points to the child page
+ * that contains input "key"
+ * Start the search from the second key(the first key should always be invalid)
+ * Integer keys of a plain page are searched as integers, see IntegerKeySearch. The tree reads such pages without
+ * latching them, so the size may be torn by a concurrent update; the tree discards that result, but the search
+ * stays inside the page.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::Lookup(const KeyType &key, const KeyComparator &comparator) const -> ValueType {
+  if constexpr (HasIntegerKeys<KeyComparator>::value) {
+    if (!IsCompressed() && comparator.IntegerKeySize() != 0) {
+      int size = std::clamp(GetSize(), 1, GetMaxSize());
+      int index = IntegerKeySearch::UpperBound(reinterpret_cast<const char *>(&array_[1].first), sizeof(MappingType),
+                                               size - 1, &key, comparator.IntegerKeySize());
+      return ValueAt(index);
+    }
+  }
+  // find the last index whose key is less than or equal to the input key
+  int left = 1;
+  int right = GetSize() - 1;
+  while (left <= right) {
+    int mid = left + (right - left) / 2;
+    if (comparator(KeyAt(mid), key) <= 0) {
+      left = mid + 1;
+    } else {
+      right = mid - 1;
+    }
+  }
+  return ValueAt(left - 1);
+}
+
+/*
+ * Whether the page has room for one more child whose separation key is key. A plain page holds up to max size
+ * children; a compressed page also needs the bytes for the child in the format that includes the key.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::CanInsert(const KeyType &key) const -> bool {
+  if (GetSize() >= GetMaxSize()) {
+    return false;
+  }
+  if (!IsCompressed()) {
+    return true;
+  }
+  auto format = ReadFormat();
+  format.Add(key);
+  return Fits(format, GetSize() + 1);
+}
+
+/*
+ * Whether the page has room for one more child whatever its key is, for a descent that does not know the key a
+ * split below would push up yet.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::CanInsertAnyKey() const -> bool {
+  if (GetSize() >= GetMaxSize()) {
+    return false;
+  }
+  // No key takes more than its full size, and a key shared as the prefix is only stored once.
+  return !IsCompressed() || Layout::HEADER_SIZE + (GetSize() + 1) * sizeof(MappingType) <= CAPACITY;
+}
+
+/*
+ * Whether the key at index can be replaced by key. A new key may shorten the shared prefix or lengthen the stored
+ * keys of a compressed page.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::CanSetKeyAt(int index, const KeyType &key) const -> bool {
+  if (!IsCompressed()) {
+    return true;
+  }
+  auto format = ReadFormat();
+  format.Add(key);
+  return Fits(format, GetSize());
+}
+
+/*
+ * Whether the children of this page and its sibling fit into one page, the middle key joining them.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::CanMergeWith(const BPlusTreeInternalPage *sibling, const KeyType &middle_key) const
+    -> bool {
+  int size = GetSize() + sibling->GetSize();
+  if (size > GetMaxSize()) {
+    return false;
+  }
+  if (!IsCompressed()) {
+    return true;
+  }
+  auto format = ReadFormat();
+  format.Add(middle_key);
+  for (int i = 1; i < sibling->GetSize(); i++) {
+    format.Add(sibling->KeyAt(i));
+  }
+  return Fits(format, size);
+}
+
+/*****************************************************************************
+ * INSERTION
+ *****************************************************************************/
+/*
+ * Populate new root page with old_value + new_key & new_value
+ * When the insertion cause overflow from leaf page all the way upto the root
+ * page, you should create a new root page and populate its elements.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::PopulateNewRoot(const ValueType &old_value, const KeyType &new_key,
+                                                     const ValueType &new_value) {
+  MappingType items[2];
+  items[0].second = old_value;
+  items[1].first = new_key;
+  items[1].second = new_value;
+  CopyNFrom(items, 2);
+}
+
+/*
+ * Insert new_key & new_value pair right after the pair with its value ==
+ * old_value
+ * @return:  new size after insertion
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::InsertNodeAfter(const ValueType &old_value, const KeyType &new_key,
+                                                     const ValueType &new_value) -> int {
+  int index = ValueIndex(old_value) + 1;
+  if (IsCompressed()) {
+    std::vector<MappingType> items;
+    CopyAllTo(&items);
+    items.emplace(items.begin() + index, new_key, new_value);
+    CopyNFrom(items.data(), static_cast<int>(items.size()));
+    return GetSize();
+  }
+  std::move_backward(array_ + index, array_ + GetSize(), array_ + GetSize() + 1);
+  array_[index].first = new_key;
+  array_[index].second = new_value;
+  IncreaseSize(1);
+  return GetSize();
+}
+
+/*****************************************************************************
+ * REMOVE
+ *****************************************************************************/
+/*
+ * Remove the key & value pair in internal page according to input index(a.k.a
+ * array offset)
+ * NOTE: store key&value pair continuously after deletion
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Remove(int index) {
+  if (IsCompressed()) {
+    std::vector<MappingType> items;
+    CopyAllTo(&items);
+    items.erase(items.begin() + index);
+    CopyNFrom(items.data(), static_cast<int>(items.size()));
+    return;
+  }
+  std::move(array_ + index + 1, array_ + GetSize(), array_ + index);
+  IncreaseSize(-1);
+}
+
+/*
+ * Remove the only key & value pair in internal page and return the value
+ * NOTE: only call this method within AdjustRoot()(in b_plus_tree.cpp)
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::RemoveAndReturnOnlyChild() -> ValueType {
+  ValueType child = ValueAt(0);
+  SetSize(0);
+  return child;
+}
+
+/*****************************************************************************
+ * SPLIT, MERGE AND REDISTRIBUTE
+ *****************************************************************************/
+/*
+ * Copy all key & value pairs out of this page. A split copies the pairs out, inserts the new child and copies the
+ * two halves back, so a full page never has to hold one child more than its capacity.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyAllTo(std::vector<std::pair<KeyType, ValueType>> *items) const {
+  if (IsCompressed()) {
+    Layout::ReadAll(Data(), GetSize(), items);
+    return;
+  }
+  items->assign(array_, array_ + GetSize());
+}
+
+/*
+ * Replace the content of this page with size key & value pairs starting at items. A compressed page must have room
+ * for them.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyNFrom(const std::pair<KeyType, ValueType> *items, int size) {
+  if (IsCompressed()) {
+    BUSTUB_ASSERT(Layout::Fits(items, size, 1, CAPACITY), "compressed internal page overflow");
+    Layout::Write(Data(), items, size, 1);
+  } else {
+    std::copy(items, items + size, array_);
+  }
+  SetSize(size);
+}
+
+/*
+ * Remove all of key & value pairs from this page to "recipient" page, which is its left sibling. The middle_key is
+ * the separation key in the parent page, it becomes the key of this page's first child. The sibling takes over the
+ * right link and the high key.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveAllTo(BPlusTreeInternalPage *recipient, const KeyType &middle_key) {
+  recipient->SetNextPageId(GetNextPageId());
+  recipient->SetHighKey(HighKey());
+  if (IsCompressed()) {
+    std::vector<MappingType> items;
+    std::vector<MappingType> moved;
+    recipient->CopyAllTo(&items);
+    CopyAllTo(&moved);
+    moved[0].first = middle_key;
+    items.insert(items.end(), moved.begin(), moved.end());
+    recipient->CopyNFrom(items.data(), static_cast<int>(items.size()));
+    SetSize(0);
+    return;
+  }
+  SetKeyAt(0, middle_key);
+  std::copy(array_, array_ + GetSize(), recipient->array_ + recipient->GetSize());
+  recipient->IncreaseSize(GetSize());
+  SetSize(0);
+}
+
+/*
+ * Remove the first key & value pair from this page to the tail of "recipient" page, which is its left sibling.
+ * The middle_key is the separation key in the parent page; the caller replaces it with this page's new first key.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveFirstToEndOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key) {
+  if (IsCompressed()) {
+    std::vector<MappingType> items;
+    recipient->CopyAllTo(&items);
+    items.emplace_back(middle_key, ValueAt(0));
+    recipient->CopyNFrom(items.data(), static_cast<int>(items.size()));
+    Remove(0);
+    return;
+  }
+  recipient->array_[recipient->GetSize()] = {middle_key, array_[0].second};
+  recipient->IncreaseSize(1);
+  Remove(0);
+}
+
+/*
+ * Remove the last key & value pair from this page to head of "recipient" page, which is its right sibling.
+ * The middle_key is the separation key in the parent page; the caller replaces it with the moved key.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveLastToFrontOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key) {
+  if (IsCompressed()) {
+    std::vector<MappingType> items;
+    recipient->CopyAllTo(&items);
+    items[0].first = middle_key;
+    items.emplace(items.begin(), KeyType(), ValueAt(GetSize() - 1));
+    recipient->CopyNFrom(items.data(), static_cast<int>(items.size()));
+    Remove(GetSize() - 1);
+    return;
+  }
+  std::move_backward(recipient->array_, recipient->array_ + recipient->GetSize(),
+                     recipient->array_ + recipient->GetSize() + 1);
+  recipient->array_[0].second = array_[GetSize() - 1].second;
+  recipient->array_[1].first = middle_key;
+  recipient->IncreaseSize(1);
+  IncreaseSize(-1);
+}
 
 // valuetype for internalNode should be page id_t
 template class BPlusTreeInternalPage<GenericKey<4>, page_id_t, GenericComparator<4>>;
@@ -9,6 +9,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <sstream>
 
 #include "common/exception.h"
@@ -24,19 +25,58 @@ namespace bustub {
 /**
  * Init method after creating a new leaf page
  * Including set page type, set current size to zero, set page id/parent id, set
- * next page id and set max size
+ * next/prev page id and set max size
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size) {}
+void B_PLUS_TREE_LEAF_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size, bool compressed) {
+  SetPageType(compressed ? IndexPageType::COMPRESSED_LEAF_PAGE : IndexPageType::LEAF_PAGE);
+  SetSize(0);
+  SetPageId(page_id);
+  SetParentPageId(parent_id);
+  SetNextPageId(INVALID_PAGE_ID);
+  SetPrevPageId(INVALID_PAGE_ID);
+  SetMaxSize(max_size);
+  if (compressed) {
+    Layout::Write(Data(), nullptr, 0, 0);
+  }
+}
 
 /**
- * Helper methods to set/get next page id
+ * Helper methods to set/get next and prev page id
  */
 INDEX_TEMPLATE_ARGUMENTS
-auto B_PLUS_TREE_LEAF_PAGE_TYPE::GetNextPageId() const -> page_id_t { return INVALID_PAGE_ID; }
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::GetNextPageId() const -> page_id_t { return next_page_id_; }
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::GetPrevPageId() const -> page_id_t { return prev_page_id_; }
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::SetPrevPageId(page_id_t prev_page_id) { prev_page_id_ = prev_page_id; }
+
+/*
+ * Helper methods to get/set the fence keys. The low key is only meaningful if the leaf has a previous leaf, the
+ * high key only if it has a next one.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::HasLowKey() const -> bool { return prev_page_id_ != INVALID_PAGE_ID; }
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::HasHighKey() const -> bool { return next_page_id_ != INVALID_PAGE_ID; }
 
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::SetNextPageId(page_id_t next_page_id) {}
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::LowKey() const -> const KeyType & { return low_key_; }
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::HighKey() const -> const KeyType & { return high_key_; }
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::SetLowKey(const KeyType &key) { low_key_ = key; }
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::SetHighKey(const KeyType &key) { high_key_ = key; }
 
 /*
  * Helper method to find and return the key associated with input "index"(a.k.a
@@ -44,9 +84,285 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::SetNextPageId(page_id_t next_page_id) {}
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto B_PLUS_TREE_LEAF_PAGE_TYPE::KeyAt(int index) const -> KeyType {
-  // replace with your own code
-  KeyType key{};
-  return key;
+  return IsCompressed() ? Layout::KeyAt(Data(), index) : array_[index].first;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::ValueAt(int index) const -> ValueType {
+  return IsCompressed() ? Layout::ValueAt(Data(), index) : array_[index].second;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::SetValueAt(int index, const ValueType &value) {
+  if (IsCompressed()) {
+    Layout::SetValueAt(Data(), index, value);
+    return;
+  }
+  array_[index].second = value;
+}
+
+/*
+ * Helper method to find and return the key & value pair associated with input
+ * "index"(a.k.a array offset)
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::GetItem(int index) const -> MappingType {
+  return IsCompressed() ? MappingType(KeyAt(index), ValueAt(index)) : array_[index];
+}
+
+/**
+ * Helper method to find the first index i so that array_[i].first >= key
+ * NOTE: This method is only used when generating index iterator
+ * Integer keys of a plain page are searched as integers, see IntegerKeySearch. Like Lookup() of an internal page,
+ * the search stays inside the page when the tree reads it without a latch and the size is torn.
+ * @return : the index, which is GetSize() if every key is smaller than key
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::KeyIndex(const KeyType &key, const KeyComparator &comparator) const -> int {
+  if constexpr (HasIntegerKeys<KeyComparator>::value) {
+    if (!IsCompressed() && comparator.IntegerKeySize() != 0) {
+      return IntegerKeySearch::LowerBound(reinterpret_cast<const char *>(&array_[0].first), sizeof(MappingType),
+                                          std::clamp(GetSize(), 0, GetMaxSize()), &key, comparator.IntegerKeySize());
+    }
+  }
+  int left = 0;
+  int right = GetSize();
+  while (left < right) {
+    int mid = left + (right - left) / 2;
+    if (comparator(KeyAt(mid), key) < 0) {
+      left = mid + 1;
+    } else {
+      right = mid;
+    }
+  }
+  return left;
+}
+
+/*
+ * Whether the page has room for one more pair with the given key. A plain leaf splits once it holds max size
+ * pairs; a compressed leaf also needs the bytes for the pair in the format that includes the new key.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::CanInsert(const KeyType &key) const -> bool {
+  if (GetSize() + 1 >= GetMaxSize()) {
+    return false;
+  }
+  if (!IsCompressed()) {
+    return true;
+  }
+  auto format = Layout::ReadFormat(Data(), GetSize());
+  format.Add(key);
+  return Fits(format, GetSize() + 1);
+}
+
+/*
+ * Whether the pairs of this page and its sibling fit into one page.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::CanMergeWith(const BPlusTreeLeafPage *sibling) const -> bool {
+  int size = GetSize() + sibling->GetSize();
+  if (size >= GetMaxSize()) {
+    return false;
+  }
+  if (!IsCompressed()) {
+    return true;
+  }
+  auto format = Layout::ReadFormat(Data(), GetSize());
+  for (int i = 0; i < sibling->GetSize(); i++) {
+    format.Add(sibling->KeyAt(i));
+  }
+  return Fits(format, size);
+}
+
+/*
+ * How full the page is: the fraction of the pairs a plain leaf holds before it splits, or the fraction of the bytes
+ * for pairs a compressed leaf uses.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::Fill() const -> double {
+  if (!IsCompressed()) {
+    return static_cast<double>(GetSize()) / (GetMaxSize() - 1);
+  }
+  return static_cast<double>(Layout::ReadFormat(Data(), GetSize()).Bytes(GetSize())) / CAPACITY;
+}
+
+/*****************************************************************************
+ * INSERTION
+ *****************************************************************************/
+/*
+ * Insert key & value pair into leaf page ordered by key
+ * @return page size after insertion, unchanged if the key already exists
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::Insert(const KeyType &key, const ValueType &value, const KeyComparator &comparator)
+    -> int {
+  int index = KeyIndex(key, comparator);
+  if (index < GetSize() && comparator(KeyAt(index), key) == 0) {
+    return GetSize();
+  }
+  if (IsCompressed()) {
+    std::vector<MappingType> items;
+    CopyAllTo(&items);
+    items.emplace(items.begin() + index, key, value);
+    CopyNFrom(items.data(), static_cast<int>(items.size()));
+    return GetSize();
+  }
+  std::move_backward(array_ + index, array_ + GetSize(), array_ + GetSize() + 1);
+  array_[index].first = key;
+  array_[index].second = value;
+  IncreaseSize(1);
+  return GetSize();
+}
+
+/*****************************************************************************
+ * LOOKUP
+ *****************************************************************************/
+/*
+ * For the given key, check to see whether it exists in the leaf page. If it
+ * does, then store its corresponding value in input "value" and return true.
+ * If the key does not exist, then return false
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::Lookup(const KeyType &key, ValueType *value, const KeyComparator &comparator) const
+    -> bool {
+  int index = KeyIndex(key, comparator);
+  if (index == GetSize() || comparator(KeyAt(index), key) != 0) {
+    return false;
+  }
+  *value = ValueAt(index);
+  return true;
+}
+
+/*****************************************************************************
+ * REMOVE
+ *****************************************************************************/
+/*
+ * First look through leaf page to see whether delete key exist or not. If
+ * exist, perform deletion, otherwise return immediately.
+ * NOTE: store key&value pair continuously after deletion
+ * @return   page size after deletion
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::RemoveAndDeleteRecord(const KeyType &key, const KeyComparator &comparator) -> int {
+  int index = KeyIndex(key, comparator);
+  if (index == GetSize() || comparator(KeyAt(index), key) != 0) {
+    return GetSize();
+  }
+  if (IsCompressed()) {
+    std::vector<MappingType> items;
+    CopyAllTo(&items);
+    items.erase(items.begin() + index);
+    CopyNFrom(items.data(), static_cast<int>(items.size()));
+    return GetSize();
+  }
+  std::move(array_ + index + 1, array_ + GetSize(), array_ + index);
+  IncreaseSize(-1);
+  return GetSize();
+}
+
+/*****************************************************************************
+ * SPLIT, MERGE AND REDISTRIBUTE
+ *****************************************************************************/
+/*
+ * Remove half of key & value pairs from this page to "recipient" page, a new page that becomes the right sibling
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveHalfTo(BPlusTreeLeafPage *recipient) {
+  int keep = GetSize() / 2;
+  std::vector<MappingType> items;
+  CopyAllTo(&items);
+  recipient->CopyNFrom(items.data() + keep, GetSize() - keep);
+  CopyNFrom(items.data(), keep);
+}
+
+/*
+ * Copy all key & value pairs out of this page
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyAllTo(std::vector<MappingType> *items) const {
+  if (IsCompressed()) {
+    Layout::ReadAll(Data(), GetSize(), items);
+    return;
+  }
+  items->assign(array_, array_ + GetSize());
+}
+
+/*
+ * Replace the content of this page with size pairs that are already sorted by key. A compressed page must have
+ * room for them, see CanInsert() and CanMergeWith().
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyNFrom(const MappingType *items, int size) {
+  if (IsCompressed()) {
+    BUSTUB_ASSERT(Layout::Fits(items, size, 0, CAPACITY), "compressed leaf page overflow");
+    Layout::Write(Data(), items, size, 0);
+  } else {
+    std::copy(items, items + size, array_);
+  }
+  SetSize(size);
+}
+
+/*
+ * Remove all of key & value pairs from this page to "recipient" page, which is its left sibling. Don't forget to
+ * update the next_page id in the sibling page; the sibling takes over the high key as well
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveAllTo(BPlusTreeLeafPage *recipient) {
+  if (IsCompressed()) {
+    std::vector<MappingType> items;
+    std::vector<MappingType> moved;
+    recipient->CopyAllTo(&items);
+    CopyAllTo(&moved);
+    items.insert(items.end(), moved.begin(), moved.end());
+    recipient->CopyNFrom(items.data(), static_cast<int>(items.size()));
+  } else {
+    std::copy(array_, array_ + GetSize(), recipient->array_ + recipient->GetSize());
+    recipient->IncreaseSize(GetSize());
+  }
+  recipient->SetNextPageId(GetNextPageId());
+  recipient->SetHighKey(HighKey());
+  SetSize(0);
+}
+
+/*
+ * Remove the first key & value pair from this page to the tail of "recipient" page, which is its left sibling.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveFirstToEndOf(BPlusTreeLeafPage *recipient) {
+  if (IsCompressed()) {
+    std::vector<MappingType> items;
+    recipient->CopyAllTo(&items);
+    items.push_back(GetItem(0));
+    recipient->CopyNFrom(items.data(), static_cast<int>(items.size()));
+    CopyAllTo(&items);
+    CopyNFrom(items.data() + 1, GetSize() - 1);
+    return;
+  }
+  recipient->array_[recipient->GetSize()] = array_[0];
+  recipient->IncreaseSize(1);
+  std::move(array_ + 1, array_ + GetSize(), array_);
+  IncreaseSize(-1);
+}
+
+/*
+ * Remove the last key & value pair from this page to the head of "recipient" page, which is its right sibling.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveLastToFrontOf(BPlusTreeLeafPage *recipient) {
+  if (IsCompressed()) {
+    std::vector<MappingType> items;
+    recipient->CopyAllTo(&items);
+    items.insert(items.begin(), GetItem(GetSize() - 1));
+    recipient->CopyNFrom(items.data(), static_cast<int>(items.size()));
+    CopyAllTo(&items);
+    CopyNFrom(items.data(), GetSize() - 1);
+    return;
+  }
+  std::move_backward(recipient->array_, recipient->array_ + recipient->GetSize(),
+                     recipient->array_ + recipient->GetSize() + 1);
+  recipient->array_[0] = array_[GetSize() - 1];
+  recipient->IncreaseSize(1);
+  IncreaseSize(-1);
 }
 
 template class BPlusTreeLeafPage<GenericKey<4>, RID, GenericComparator<4>>;
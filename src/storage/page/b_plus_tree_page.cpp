@@ -17,41 +17,50 @@ namespace bustub {
  * Helper methods to get/set page type
  * Page type enum class is defined in b_plus_tree_page.h
  */
-auto BPlusTreePage::IsLeafPage() const -> bool { return false; }
-auto BPlusTreePage::IsRootPage() const -> bool { return false; }
-void BPlusTreePage::SetPageType(IndexPageType page_type) {}
+auto BPlusTreePage::IsLeafPage() const -> bool {
+  return page_type_ == IndexPageType::LEAF_PAGE || page_type_ == IndexPageType::COMPRESSED_LEAF_PAGE;
+}
+auto BPlusTreePage::IsRootPage() const -> bool { return parent_page_id_ == INVALID_PAGE_ID; }
+auto BPlusTreePage::IsCompressed() const -> bool {
+  return page_type_ == IndexPageType::COMPRESSED_LEAF_PAGE || page_type_ == IndexPageType::COMPRESSED_INTERNAL_PAGE;
+}
+/* A page the tree took out of the index is marked INVALID_INDEX_PAGE until the buffer pool deletes it */
+auto BPlusTreePage::IsDeleted() const -> bool { return page_type_ == IndexPageType::INVALID_INDEX_PAGE; }
+void BPlusTreePage::SetPageType(IndexPageType page_type) { page_type_ = page_type; }
 
 /*
  * Helper methods to get/set size (number of key/value pairs stored in that
  * page)
  */
-auto BPlusTreePage::GetSize() const -> int { return 0; }
-void BPlusTreePage::SetSize(int size) {}
-void BPlusTreePage::IncreaseSize(int amount) {}
+auto BPlusTreePage::GetSize() const -> int { return size_; }
+void BPlusTreePage::SetSize(int size) { size_ = size; }
+void BPlusTreePage::IncreaseSize(int amount) { size_ += amount; }
 
 /*
  * Helper methods to get/set max size (capacity) of the page
  */
-auto BPlusTreePage::GetMaxSize() const -> int { return 0; }
-void BPlusTreePage::SetMaxSize(int size) {}
+auto BPlusTreePage::GetMaxSize() const -> int { return max_size_; }
+void BPlusTreePage::SetMaxSize(int size) { max_size_ = size; }
 
 /*
  * Helper method to get min page size
  * Generally, min page size == max page size / 2
+ * A leaf splits as soon as it holds max_size pairs, an internal page once it would hold more than max_size
+ * children, so each half of a split internal page keeps at least (max_size + 1) / 2 children.
  */
-auto BPlusTreePage::GetMinSize() const -> int { return 0; }
+auto BPlusTreePage::GetMinSize() const -> int { return IsLeafPage() ? max_size_ / 2 : (max_size_ + 1) / 2; }
 
 /*
  * Helper methods to get/set parent page id
  */
-auto BPlusTreePage::GetParentPageId() const -> page_id_t { return 0; }
-void BPlusTreePage::SetParentPageId(page_id_t parent_page_id) {}
+auto BPlusTreePage::GetParentPageId() const -> page_id_t { return parent_page_id_; }
+void BPlusTreePage::SetParentPageId(page_id_t parent_page_id) { parent_page_id_ = parent_page_id; }
 
 /*
  * Helper methods to get/set self page id
  */
-auto BPlusTreePage::GetPageId() const -> page_id_t { return 0; }
-void BPlusTreePage::SetPageId(page_id_t page_id) {}
+auto BPlusTreePage::GetPageId() const -> page_id_t { return page_id_; }
+void BPlusTreePage::SetPageId(page_id_t page_id) { page_id_ = page_id; }
 
 /*
  * Helper methods to set lsn
@@ -0,0 +1,51 @@
+//===----------------------------------------------------------------------===//
+//
+//                         CMU-DB Project (15-445/645)
+//                         ***DO NO SHARE PUBLICLY***
+//
+// Identification: src/page/b_plus_tree_posting_page.cpp
+//
+// Copyright (c) 2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/page/b_plus_tree_posting_page.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+void BPlusTreePostingPage::Init(page_id_t next_page_id) {
+  next_page_id_ = next_page_id;
+  size_ = 0;
+}
+
+auto BPlusTreePostingPage::GetNextPageId() const -> page_id_t { return next_page_id_; }
+
+void BPlusTreePostingPage::SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
+
+auto BPlusTreePostingPage::GetSize() const -> int { return size_; }
+
+auto BPlusTreePostingPage::IsFull() const -> bool { return size_ == CAPACITY; }
+
+auto BPlusTreePostingPage::ValueAt(int index) const -> RID { return array_[index]; }
+
+auto BPlusTreePostingPage::IndexOf(const RID &value) const -> int {
+  for (int i = 0; i < size_; i++) {
+    if (array_[i] == value) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+void BPlusTreePostingPage::Append(const RID &value) {
+  BUSTUB_ASSERT(!IsFull(), "posting page overflow");
+  array_[size_++] = value;
+}
+
+void BPlusTreePostingPage::RemoveAt(int index) {
+  array_[index] = array_[size_ - 1];
+  size_--;
+}
+
+}  // namespace bustub
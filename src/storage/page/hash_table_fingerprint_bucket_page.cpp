@@ -0,0 +1,167 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hash_table_fingerprint_bucket_page.cpp
+//
+// Identification: src/storage/page/hash_table_fingerprint_bucket_page.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "storage/page/hash_table_fingerprint_bucket_page.h"
+#include "common/logger.h"
+#include "common/rid.h"
+#include "container/hash/hash_function.h"
+#include "storage/index/generic_key.h"
+
+namespace bustub {
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_FINGERPRINT_BUCKET_TYPE::Fingerprint(KeyType key) -> uint8_t {
+  // The top byte, the extendible hash table picks buckets by the low bits.
+  auto fingerprint = static_cast<uint8_t>(HashFunction<KeyType>().GetHash(key) >> 56);
+  return fingerprint == 0 ? 1 : fingerprint;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+template <typename Visit>
+auto HASH_TABLE_FINGERPRINT_BUCKET_TYPE::FindSlot(uint8_t fingerprint, Visit &&visit) const -> uint32_t {
+  uint32_t base = 0;
+#if defined(__AVX2__)
+  const __m256i wide = _mm256_set1_epi8(static_cast<char>(fingerprint));
+  for (; base + 32 <= ARRAY_SIZE; base += 32) {
+    __m256i group = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(fingerprints_ + base));
+    auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(group, wide)));
+    for (; mask != 0; mask &= mask - 1) {
+      uint32_t bucket_idx = base + __builtin_ctz(mask);
+      if (visit(bucket_idx)) {
+        return bucket_idx;
+      }
+    }
+  }
+#endif
+#if defined(__SSE2__)
+  // ARRAY_SIZE is a multiple of 16, this takes the last group that AVX2 left, or all of them.
+  const __m128i narrow = _mm_set1_epi8(static_cast<char>(fingerprint));
+  for (; base < ARRAY_SIZE; base += 16) {
+    __m128i group = _mm_loadu_si128(reinterpret_cast<const __m128i *>(fingerprints_ + base));
+    auto mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(group, narrow)));
+    for (; mask != 0; mask &= mask - 1) {
+      uint32_t bucket_idx = base + __builtin_ctz(mask);
+      if (visit(bucket_idx)) {
+        return bucket_idx;
+      }
+    }
+  }
+#else
+  for (; base < ARRAY_SIZE; base++) {
+    if (fingerprints_[base] == fingerprint && visit(base)) {
+      return base;
+    }
+  }
+#endif
+  return ARRAY_SIZE;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_FINGERPRINT_BUCKET_TYPE::GetValue(KeyType key, KeyComparator cmp, std::vector<ValueType> *result)
+    -> bool {
+  bool found = false;
+  FindSlot(Fingerprint(key), [&](uint32_t bucket_idx) {
+    if (cmp(array_[bucket_idx].first, key) == 0) {
+      result->push_back(array_[bucket_idx].second);
+      found = true;
+    }
+    return false;
+  });
+  return found;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_FINGERPRINT_BUCKET_TYPE::Insert(KeyType key, ValueType value, KeyComparator cmp) -> bool {
+  uint8_t fingerprint = Fingerprint(key);
+  uint32_t duplicate = FindSlot(fingerprint, [&](uint32_t bucket_idx) {
+    return cmp(array_[bucket_idx].first, key) == 0 && array_[bucket_idx].second == value;
+  });
+  if (duplicate != ARRAY_SIZE || IsFull()) {
+    return false;
+  }
+  uint32_t free_idx = FindSlot(0, [](uint32_t /*bucket_idx*/) { return true; });
+  array_[free_idx] = MappingType(key, value);
+  fingerprints_[free_idx] = fingerprint;
+  num_readable_++;
+  return true;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_FINGERPRINT_BUCKET_TYPE::Remove(KeyType key, ValueType value, KeyComparator cmp) -> bool {
+  uint32_t bucket_idx = FindSlot(Fingerprint(key), [&](uint32_t bucket_idx) {
+    return cmp(array_[bucket_idx].first, key) == 0 && array_[bucket_idx].second == value;
+  });
+  if (bucket_idx == ARRAY_SIZE) {
+    return false;
+  }
+  RemoveAt(bucket_idx);
+  return true;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_FINGERPRINT_BUCKET_TYPE::KeyAt(uint32_t bucket_idx) const -> KeyType {
+  return array_[bucket_idx].first;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_FINGERPRINT_BUCKET_TYPE::ValueAt(uint32_t bucket_idx) const -> ValueType {
+  return array_[bucket_idx].second;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_FINGERPRINT_BUCKET_TYPE::RemoveAt(uint32_t bucket_idx) {
+  if (IsReadable(bucket_idx)) {
+    fingerprints_[bucket_idx] = 0;
+    num_readable_--;
+  }
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_FINGERPRINT_BUCKET_TYPE::IsReadable(uint32_t bucket_idx) const -> bool {
+  return fingerprints_[bucket_idx] != 0;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_FINGERPRINT_BUCKET_TYPE::NumReadable() -> uint32_t {
+  return num_readable_;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_FINGERPRINT_BUCKET_TYPE::IsFull() -> bool {
+  return num_readable_ == ARRAY_SIZE;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_FINGERPRINT_BUCKET_TYPE::IsEmpty() -> bool {
+  return num_readable_ == 0;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_FINGERPRINT_BUCKET_TYPE::PrintBucket() {
+  LOG_INFO("Bucket Capacity: %u, Taken: %u, Free: %u", ARRAY_SIZE, num_readable_, ARRAY_SIZE - num_readable_);
+}
+
+template class HashTableFingerprintBucketPage<int, int, IntComparator>;
+
+template class HashTableFingerprintBucketPage<GenericKey<4>, RID, GenericComparator<4>>;
+template class HashTableFingerprintBucketPage<GenericKey<8>, RID, GenericComparator<8>>;
+template class HashTableFingerprintBucketPage<GenericKey<16>, RID, GenericComparator<16>>;
+template class HashTableFingerprintBucketPage<GenericKey<32>, RID, GenericComparator<32>>;
+template class HashTableFingerprintBucketPage<GenericKey<64>, RID, GenericComparator<64>>;
+
+}  // namespace bustub
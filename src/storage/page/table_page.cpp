@@ -259,6 +259,16 @@ void TablePage::ApplyDelete(const RID &rid, Transaction *txn, LogManager *log_ma
   }
 }
 
+auto TablePage::TrimEmptySlots() -> uint32_t {
+  uint32_t tuple_count = GetTupleCount();
+  while (tuple_count > 0 && GetTupleSize(tuple_count - 1) == 0) {
+    tuple_count--;
+  }
+  auto reclaimed = static_cast<uint32_t>((GetTupleCount() - tuple_count) * SIZE_TUPLE);
+  SetTupleCount(tuple_count);
+  return reclaimed;
+}
+
 void TablePage::RollbackDelete(const RID &rid, Transaction *txn, LogManager *log_manager) {
   // Log the rollback.
   /**
@@ -282,6 +292,16 @@ void TablePage::RollbackDelete(const RID &rid, Transaction *txn, LogManager *log
   }
 }
 
+auto TablePage::RestoreTupleBytes(const RID &rid, uint32_t tuple_size, uint32_t offset, const char *data, uint32_t size)
+    -> bool {
+  uint32_t slot_num = rid.GetSlotNum();
+  if (slot_num >= GetTupleCount() || GetTupleSize(slot_num) != tuple_size || offset + size > tuple_size) {
+    return false;
+  }
+  memcpy(GetData() + GetTupleOffsetAtSlot(slot_num) + offset, data, size);
+  return true;
+}
+
 auto TablePage::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, LockManager *lock_manager) -> bool {
   // Get the current slot number.
   uint32_t slot_num = rid.GetSlotNum();
@@ -326,10 +346,38 @@ auto TablePage::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, LockMan
   return true;
 }
 
-auto TablePage::GetFirstTupleRid(RID *first_rid) -> bool {
+auto TablePage::IsMarkedDeleted(const RID &rid) -> bool {
+  uint32_t slot_num = rid.GetSlotNum();
+  return slot_num < GetTupleCount() && GetTupleSize(slot_num) != 0 && IsDeleted(GetTupleSize(slot_num));
+}
+
+auto TablePage::GetTupleIgnoreDelete(const RID &rid, Tuple *tuple, bool *is_deleted) -> bool {
+  uint32_t slot_num = rid.GetSlotNum();
+  if (slot_num >= GetTupleCount() || GetTupleSize(slot_num) == 0) {
+    return false;
+  }
+  uint32_t tuple_size = GetTupleSize(slot_num);
+  *is_deleted = IsDeleted(tuple_size);
+  if (*is_deleted) {
+    tuple_size = UnsetDeletedFlag(tuple_size);
+  }
+
+  uint32_t tuple_offset = GetTupleOffsetAtSlot(slot_num);
+  tuple->size_ = tuple_size;
+  if (tuple->allocated_) {
+    delete[] tuple->data_;
+  }
+  tuple->data_ = new char[tuple->size_];
+  memcpy(tuple->data_, GetData() + tuple_offset, tuple->size_);
+  tuple->rid_ = rid;
+  tuple->allocated_ = true;
+  return true;
+}
+
+auto TablePage::GetFirstTupleRid(RID *first_rid, bool include_deleted) -> bool {
   // Find and return the first valid tuple.
   for (uint32_t i = 0; i < GetTupleCount(); ++i) {
-    if (!IsDeleted(GetTupleSize(i))) {
+    if (include_deleted ? GetTupleSize(i) != 0 : !IsDeleted(GetTupleSize(i))) {
       first_rid->Set(GetTablePageId(), i);
       return true;
     }
@@ -338,11 +386,11 @@ auto TablePage::GetFirstTupleRid(RID *first_rid) -> bool {
   return false;
 }
 
-auto TablePage::GetNextTupleRid(const RID &cur_rid, RID *next_rid) -> bool {
+auto TablePage::GetNextTupleRid(const RID &cur_rid, RID *next_rid, bool include_deleted) -> bool {
   BUSTUB_ASSERT(cur_rid.GetPageId() == GetTablePageId(), "Wrong table!");
   // Find and return the first valid tuple after our current slot number.
   for (auto i = cur_rid.GetSlotNum() + 1; i < GetTupleCount(); ++i) {
-    if (!IsDeleted(GetTupleSize(i))) {
+    if (include_deleted ? GetTupleSize(i) != 0 : !IsDeleted(GetTupleSize(i))) {
       next_rid->Set(GetTablePageId(), i);
       return true;
     }
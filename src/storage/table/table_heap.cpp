@@ -82,12 +82,14 @@ auto TableHeap::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn) -> b
       cur_page = new_page;
     }
   }
+  // The new tuple stays invisible to snapshots until the transaction commits.
+  version_store_.RecordInsert(*rid, txn);
   // This line has caused most of us to double-take and "whoa double unlatch".
   // We are not, in fact, double unlatching. See the invariant above.
   cur_page->WUnlatch();
   buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), true);
   // Update the transaction's write set.
-  txn->GetWriteSet()->emplace_back(*rid, WType::INSERT, Tuple{}, this);
+  txn->GetWriteSet()->emplace_back(*rid, WType::INSERT, this);
   return true;
 }
 
@@ -100,13 +102,25 @@ auto TableHeap::MarkDelete(const RID &rid, Transaction *txn) -> bool {
     txn->SetState(TransactionState::ABORTED);
     return false;
   }
-  // Otherwise, mark the tuple as deleted.
+  // Otherwise, mark the tuple as deleted, keeping the old version for the snapshots that still see it.
   page->WLatch();
-  page->MarkDelete(rid, txn, lock_manager_, log_manager_);
+  if (!version_store_.CheckWrite(rid, txn)) {
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetTablePageId(), false);
+    txn->SetState(TransactionState::ABORTED);
+    return false;
+  }
+  Tuple old_tuple;
+  bool old_deleted = false;
+  if (page->GetTupleIgnoreDelete(rid, &old_tuple, &old_deleted) &&
+      page->MarkDelete(rid, txn, lock_manager_, log_manager_)) {
+    version_store_.RecordWrite(rid, txn, old_tuple, old_deleted);
+    marked_deletes_++;
+  }
   page->WUnlatch();
   buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
   // Update the transaction's write set.
-  txn->GetWriteSet()->emplace_back(rid, WType::DELETE, Tuple{}, this);
+  txn->GetWriteSet()->emplace_back(rid, WType::DELETE, this);
   return true;
 }
 
@@ -121,12 +135,22 @@ auto TableHeap::UpdateTuple(const Tuple &tuple, const RID &rid, Transaction *txn
   // Update the tuple; but first save the old value for rollbacks.
   Tuple old_tuple;
   page->WLatch();
+  if (!version_store_.CheckWrite(rid, txn)) {
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetTablePageId(), false);
+    txn->SetState(TransactionState::ABORTED);
+    return false;
+  }
   bool is_updated = page->UpdateTuple(tuple, &old_tuple, rid, txn, lock_manager_, log_manager_);
+  if (is_updated) {
+    version_store_.RecordWrite(rid, txn, old_tuple, false);
+  }
   page->WUnlatch();
   buffer_pool_manager_->UnpinPage(page->GetTablePageId(), is_updated);
-  // Update the transaction's write set.
-  if (is_updated && txn->GetState() != TransactionState::ABORTED) {
-    txn->GetWriteSet()->emplace_back(rid, WType::UPDATE, old_tuple, this);
+  // Update the transaction's write set, keeping only the bytes the update changed.
+  if (is_updated) {
+    auto undo = UndoImage::Diff(txn->GetUndoBuffer(), old_tuple.data_, old_tuple.size_, tuple.data_, tuple.size_);
+    txn->GetWriteSet()->emplace_back(rid, WType::UPDATE, this, undo);
   }
   return is_updated;
 }
@@ -137,12 +161,70 @@ void TableHeap::ApplyDelete(const RID &rid, Transaction *txn) {
   BUSTUB_ASSERT(page != nullptr, "Couldn't find a page containing that RID.");
   // Delete the tuple from the page.
   page->WLatch();
+  if (page->IsMarkedDeleted(rid)) {
+    marked_deletes_--;
+  }
   page->ApplyDelete(rid, txn, log_manager_);
+  version_store_.Erase(rid);
   /** Commented out to make compatible with p4; This is called only on commit or delete, which consequently unlocks the
    * tuple; so should be fine */
   // lock_manager_->Unlock(txn, rid);
   page->WUnlatch();
   buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
+  std::scoped_lock<std::mutex> lock(untrimmed_latch_);
+  untrimmed_pages_.insert(rid.GetPageId());
+}
+
+auto TableHeap::ReserveWrite(const RID &rid, Transaction *txn) -> bool {
+  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
+  BUSTUB_ASSERT(page != nullptr, "Couldn't find a page containing that RID.");
+  page->WLatch();
+  Tuple old_tuple;
+  bool old_deleted = false;
+  bool reserved = version_store_.CheckWrite(rid, txn) && page->GetTupleIgnoreDelete(rid, &old_tuple, &old_deleted);
+  if (reserved) {
+    version_store_.RecordWrite(rid, txn, old_tuple, old_deleted);
+  }
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetTablePageId(), false);
+  return reserved;
+}
+
+auto TableHeap::Reclaim(const RID &rid, Tuple *tuple) -> size_t {
+  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
+  BUSTUB_ASSERT(page != nullptr, "Couldn't find a page containing that RID.");
+  page->WLatch();
+  bool is_deleted = false;
+  size_t reclaimed = 0;
+  if (page->GetTupleIgnoreDelete(rid, tuple, &is_deleted) && is_deleted) {
+    page->ApplyDelete(rid, nullptr, log_manager_);
+    version_store_.Erase(rid);
+    marked_deletes_--;
+    reclaimed = tuple->GetLength() + page->TrimEmptySlots();
+  }
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetTablePageId(), reclaimed != 0);
+  return reclaimed;
+}
+
+auto TableHeap::Compact(timestamp_t watermark) -> size_t {
+  size_t reclaimed = version_store_.Prune(watermark);
+  std::unordered_set<page_id_t> pages;
+  {
+    std::scoped_lock<std::mutex> lock(untrimmed_latch_);
+    pages.swap(untrimmed_pages_);
+  }
+  // Reclaim() trims the pages it frees slots on itself, so only the slots freed at commit or abort are left.
+  for (auto page_id : pages) {
+    auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    BUSTUB_ASSERT(page != nullptr, "Couldn't fetch a table page.");
+    page->WLatch();
+    uint32_t trimmed = page->TrimEmptySlots();
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id, trimmed != 0);
+    reclaimed += trimmed;
+  }
+  return reclaimed;
 }
 
 void TableHeap::RollbackDelete(const RID &rid, Transaction *txn) {
@@ -151,11 +233,64 @@ void TableHeap::RollbackDelete(const RID &rid, Transaction *txn) {
   BUSTUB_ASSERT(page != nullptr, "Couldn't find a page containing that RID.");
   // Rollback the delete.
   page->WLatch();
+  if (page->IsMarkedDeleted(rid)) {
+    marked_deletes_--;
+  }
   page->RollbackDelete(rid, txn, log_manager_);
   page->WUnlatch();
   buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
 }
 
+void TableHeap::RollbackPage(page_id_t page_id, const std::vector<const TableWriteRecord *> &records,
+                             Transaction *txn) {
+  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+  BUSTUB_ASSERT(page != nullptr, "Couldn't find a page containing that RID.");
+  bool freed_slots = false;
+  page->WLatch();
+  for (const auto *record : records) {
+    const auto &rid = record->rid_;
+    if (record->wtype_ != WType::UPDATE && page->IsMarkedDeleted(rid)) {
+      marked_deletes_--;
+    }
+    if (record->wtype_ == WType::DELETE) {
+      page->RollbackDelete(rid, txn, log_manager_);
+    } else if (record->wtype_ == WType::INSERT) {
+      page->ApplyDelete(rid, txn, log_manager_);
+      version_store_.Erase(rid);
+      freed_slots = true;
+    } else if (record->wtype_ == WType::UPDATE) {
+      const auto &undo = record->undo_;
+      if (!page->RestoreTupleBytes(rid, undo.tuple_size_, undo.offset_, undo.data_, undo.size_) &&
+          undo.size_ == undo.tuple_size_) {
+        // The update changed the size of the tuple, the undo image is the whole old tuple.
+        Tuple old_tuple;
+        old_tuple.data_ = const_cast<char *>(undo.data_);
+        old_tuple.size_ = undo.tuple_size_;
+        Tuple replaced;
+        page->UpdateTuple(old_tuple, &replaced, rid, txn, lock_manager_, log_manager_);
+        old_tuple.data_ = nullptr;
+      }
+    }
+  }
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(page_id, true);
+  if (freed_slots) {
+    std::scoped_lock<std::mutex> lock(untrimmed_latch_);
+    untrimmed_pages_.insert(page_id);
+  }
+}
+
+auto TableHeap::GetDeletedTuple(const RID &rid, Tuple *tuple) -> bool {
+  auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
+  BUSTUB_ASSERT(page != nullptr, "Couldn't find a page containing that RID.");
+  page->RLatch();
+  bool is_deleted = false;
+  bool found = page->GetTupleIgnoreDelete(rid, tuple, &is_deleted) && is_deleted;
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetTablePageId(), false);
+  return found;
+}
+
 auto TableHeap::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, bool acquire_read_lock) -> bool {
   // Find the page which contains the tuple.
   auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
@@ -168,7 +303,25 @@ auto TableHeap::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, bool ac
   if (acquire_read_lock) {
     page->RLatch();
   }
-  bool res = page->GetTuple(rid, tuple, txn, lock_manager_);
+  bool res;
+  if (txn != nullptr && txn->IsOptimistic()) {
+    // Read the tuple and its version word under the same latch, a committing writer changes both under it.
+    uint64_t version;
+    res = page->GetTuple(rid, tuple, txn, lock_manager_);
+    if (res && !version_store_.ReadVersion(rid, txn, &version)) {
+      // Never wait for the writer, the read would fail the validation anyway.
+      txn->SetState(TransactionState::ABORTED);
+      res = false;
+    }
+    if (res) {
+      txn->GetOptimisticReadSet()->emplace_back(rid, version, this);
+    }
+  } else if (txn != nullptr && txn->GetIsolationLevel() == IsolationLevel::SNAPSHOT_ISOLATION) {
+    bool is_deleted = false;
+    res = page->GetTupleIgnoreDelete(rid, tuple, &is_deleted) && version_store_.Read(rid, txn, tuple, is_deleted);
+  } else {
+    res = page->GetTuple(rid, tuple, txn, lock_manager_);
+  }
   if (acquire_read_lock) {
     page->RUnlatch();
   }
@@ -180,12 +333,17 @@ auto TableHeap::Begin(Transaction *txn) -> TableIterator {
   // Start an iterator from the first page.
   // TODO(Wuwen): Hacky fix for now. Removing empty pages is a better way to handle this.
   RID rid;
+  if (txn != nullptr && txn->IsOptimistic()) {
+    txn->GetOptimisticScanSet()->emplace_back(version_store_.GetInsertVersion(), this);
+  }
+  // Snapshot readers also visit tuples marked deleted, the delete may be invisible to their snapshot.
+  bool include_deleted = txn != nullptr && txn->GetIsolationLevel() == IsolationLevel::SNAPSHOT_ISOLATION;
   auto page_id = first_page_id_;
   while (page_id != INVALID_PAGE_ID) {
     auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
     page->RLatch();
     // If this fails because there is no tuple, then RID will be the default-constructed value, which means EOF.
-    auto found_tuple = page->GetFirstTupleRid(&rid);
+    auto found_tuple = page->GetFirstTupleRid(&rid, include_deleted);
     page->RUnlatch();
     buffer_pool_manager_->UnpinPage(page_id, false);
     if (found_tuple) {
@@ -22,7 +22,11 @@ TableIterator::TableIterator(TableHeap *table_heap, RID rid, Transaction *txn)
     : table_heap_(table_heap), tuple_(new Tuple(rid)), txn_(txn) {
   if (rid.GetPageId() != INVALID_PAGE_ID) {
     if (!table_heap_->GetTuple(tuple_->rid_, tuple_, txn_)) {
-      throw bustub::Exception("read non-existing tuple");
+      if (!IsSnapshotRead()) {
+        throw bustub::Exception("read non-existing tuple");
+      }
+      // The first tuple is invisible to the snapshot of txn.
+      ++(*this);
     }
   }
 }
@@ -43,31 +47,40 @@ auto TableIterator::operator++() -> TableIterator & {
   BUSTUB_ENSURE(cur_page != nullptr, "BPM full");  // all pages are pinned
 
   cur_page->RLatch();
+  // Snapshot readers also visit tuples marked deleted and skip the tuples their snapshot does not see.
+  bool snapshot = IsSnapshotRead();
+  RID cur_tuple_rid = tuple_->rid_;
   RID next_tuple_rid;
-  if (!cur_page->GetNextTupleRid(tuple_->rid_,
-                                 &next_tuple_rid)) {  // end of this page
-    while (cur_page->GetNextPageId() != INVALID_PAGE_ID) {
-      auto next_page = static_cast<TablePage *>(buffer_pool_manager->FetchPage(cur_page->GetNextPageId()));
-      cur_page->RUnlatch();
-      buffer_pool_manager->UnpinPage(cur_page->GetTablePageId(), false);
-      cur_page = next_page;
-      cur_page->RLatch();
-      if (cur_page->GetFirstTupleRid(&next_tuple_rid)) {
-        break;
+  while (true) {
+    if (!cur_page->GetNextTupleRid(cur_tuple_rid, &next_tuple_rid, snapshot)) {  // end of this page
+      while (cur_page->GetNextPageId() != INVALID_PAGE_ID) {
+        auto next_page = static_cast<TablePage *>(buffer_pool_manager->FetchPage(cur_page->GetNextPageId()));
+        cur_page->RUnlatch();
+        buffer_pool_manager->UnpinPage(cur_page->GetTablePageId(), false);
+        cur_page = next_page;
+        cur_page->RLatch();
+        if (cur_page->GetFirstTupleRid(&next_tuple_rid, snapshot)) {
+          break;
+        }
       }
     }
-  }
-  tuple_->rid_ = next_tuple_rid;
-
-  if (*this != table_heap_->End()) {
+    if (next_tuple_rid.GetPageId() == INVALID_PAGE_ID) {
+      break;
+    }
     // DO NOT ACQUIRE READ LOCK twice in a single thread otherwise it may deadlock.
     // See https://users.rust-lang.org/t/how-bad-is-the-potential-deadlock-mentioned-in-rwlocks-document/67234
-    if (!table_heap_->GetTuple(tuple_->rid_, tuple_, txn_, false)) {
+    if (table_heap_->GetTuple(next_tuple_rid, tuple_, txn_, false)) {
+      break;
+    }
+    if (!snapshot) {
       cur_page->RUnlatch();
       buffer_pool_manager->UnpinPage(cur_page->GetTablePageId(), false);
       throw bustub::Exception("read non-existing tuple");
     }
+    cur_tuple_rid = next_tuple_rid;
   }
+  tuple_->rid_ = next_tuple_rid;
+
   // release until copy the tuple
   cur_page->RUnlatch();
   buffer_pool_manager->UnpinPage(cur_page->GetTablePageId(), false);
@@ -0,0 +1,185 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// version_store.cpp
+//
+// Identification: src/storage/table/version_store.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/table/version_store.h"
+
+#include "concurrency/transaction.h"
+
+namespace bustub {
+
+auto VersionStore::Read(const RID &rid, Transaction *txn, Tuple *tuple, bool is_deleted) -> bool {
+  std::scoped_lock<std::mutex> lock(latch_);
+  auto it = chains_.find(rid);
+  if (it == chains_.end()) {
+    return !is_deleted;
+  }
+  const auto &chain = it->second;
+  bool own = chain.writer_ == txn->GetTransactionId();
+  if (own || (chain.writer_ == INVALID_TXN_ID && chain.ts_ <= txn->GetReadTs())) {
+    return !is_deleted;
+  }
+  for (auto undo = chain.undo_.rbegin(); undo != chain.undo_.rend(); ++undo) {
+    if (undo->ts_ <= txn->GetReadTs()) {
+      if (undo->is_deleted_) {
+        return false;
+      }
+      *tuple = undo->tuple_;
+      return true;
+    }
+  }
+  // Inserted after the snapshot was taken.
+  return false;
+}
+
+auto VersionStore::CheckWrite(const RID &rid, Transaction *txn) -> bool {
+  std::scoped_lock<std::mutex> lock(latch_);
+  auto it = chains_.find(rid);
+  if (it == chains_.end()) {
+    return true;
+  }
+  const auto &chain = it->second;
+  if (chain.writer_ != INVALID_TXN_ID) {
+    return chain.writer_ == txn->GetTransactionId();
+  }
+  return txn->GetIsolationLevel() != IsolationLevel::SNAPSHOT_ISOLATION || chain.ts_ <= txn->GetReadTs();
+}
+
+void VersionStore::RecordWrite(const RID &rid, Transaction *txn, const Tuple &old_tuple, bool old_deleted) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  auto &chain = chains_[rid];
+  if (chain.writer_ == txn->GetTransactionId()) {
+    return;
+  }
+  chain.undo_.push_back({old_tuple, old_deleted, chain.ts_});
+  chain.writer_ = txn->GetTransactionId();
+}
+
+void VersionStore::RecordInsert(const RID &rid, Transaction *txn) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  auto &chain = chains_[rid];
+  chain.writer_ = txn->GetTransactionId();
+  // Keeps the parity, an optimistic insert installation in progress stays visible.
+  insert_version_ += 2;
+}
+
+void VersionStore::Commit(const RID &rid, txn_id_t txn_id, timestamp_t commit_ts, timestamp_t watermark) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  auto it = chains_.find(rid);
+  if (it == chains_.end() || it->second.writer_ != txn_id) {
+    return;
+  }
+  auto &chain = it->second;
+  chain.writer_ = INVALID_TXN_ID;
+  chain.ts_ = commit_ts;
+  versions_[rid] = ++version_clock_;
+  if (commit_ts <= watermark) {
+    // Every running snapshot sees the new version.
+    chains_.erase(it);
+    return;
+  }
+  PruneUndo(&chain, watermark);
+}
+
+void VersionStore::Rollback(const RID &rid, txn_id_t txn_id) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  auto it = chains_.find(rid);
+  if (it == chains_.end() || it->second.writer_ != txn_id) {
+    return;
+  }
+  auto &chain = it->second;
+  if (chain.undo_.empty()) {
+    // The transaction inserted the tuple.
+    chains_.erase(it);
+    return;
+  }
+  chain.ts_ = chain.undo_.back().ts_;
+  chain.writer_ = INVALID_TXN_ID;
+  chain.undo_.pop_back();
+  if (chain.undo_.empty() && chain.ts_ == 0) {
+    chains_.erase(it);
+  }
+}
+
+void VersionStore::Erase(const RID &rid) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  chains_.erase(rid);
+  versions_.erase(rid);
+}
+
+auto VersionStore::ReadVersion(const RID &rid, Transaction *txn, uint64_t *version) -> bool {
+  std::scoped_lock<std::mutex> lock(latch_);
+  auto chain = chains_.find(rid);
+  if (chain != chains_.end() && chain->second.writer_ != INVALID_TXN_ID &&
+      chain->second.writer_ != txn->GetTransactionId()) {
+    return false;
+  }
+  auto it = versions_.find(rid);
+  *version = it == versions_.end() ? 0 : it->second;
+  return true;
+}
+
+auto VersionStore::ValidateVersion(const RID &rid, Transaction *txn, uint64_t version) -> bool {
+  uint64_t current;
+  return ReadVersion(rid, txn, &current) && current == version;
+}
+
+auto VersionStore::LockInserts() -> bool {
+  uint64_t version = insert_version_.load();
+  return version % 2 == 0 && insert_version_.compare_exchange_strong(version, version + 1);
+}
+
+auto VersionStore::Prune(timestamp_t watermark) -> size_t {
+  std::scoped_lock<std::mutex> lock(latch_);
+  size_t reclaimed = 0;
+  for (auto it = chains_.begin(); it != chains_.end();) {
+    auto &chain = it->second;
+    if (chain.writer_ == INVALID_TXN_ID && chain.ts_ <= watermark) {
+      // Every running snapshot sees the newest version.
+      for (const auto &undo : chain.undo_) {
+        reclaimed += undo.tuple_.GetLength();
+      }
+      it = chains_.erase(it);
+      continue;
+    }
+    reclaimed += PruneUndo(&chain, watermark);
+    ++it;
+  }
+  return reclaimed;
+}
+
+auto VersionStore::PruneUndo(VersionChain *chain, timestamp_t watermark) -> size_t {
+  // Snapshots at or after the watermark never read past the newest undo version committed at or before it.
+  auto &undo = chain->undo_;
+  size_t reclaimed = 0;
+  for (size_t i = undo.size(); i-- > 0;) {
+    if (undo[i].ts_ <= watermark) {
+      for (size_t j = 0; j < i; j++) {
+        reclaimed += undo[j].tuple_.GetLength();
+      }
+      undo.erase(undo.begin(), undo.begin() + i);
+      break;
+    }
+  }
+  return reclaimed;
+}
+
+auto VersionStore::Size() -> size_t {
+  std::scoped_lock<std::mutex> lock(latch_);
+  return chains_.size();
+}
+
+auto VersionStore::VersionWordCount() -> size_t {
+  std::scoped_lock<std::mutex> lock(latch_);
+  return versions_.size();
+}
+
+}  // namespace bustub
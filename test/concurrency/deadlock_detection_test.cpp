@@ -21,7 +21,7 @@
       << "Test Failed Due to Time Out";
 
 namespace bustub {
-TEST(LockManagerDeadlockDetectionTest, DISABLED_EdgeTest) {
+TEST(LockManagerDeadlockDetectionTest, EdgeTest) {
   LockManager lock_mgr{};
 
   const int num_nodes = 100;
@@ -63,7 +63,7 @@ TEST(LockManagerDeadlockDetectionTest, DISABLED_EdgeTest) {
   }
 }
 
-TEST(LockManagerDeadlockDetectionTest, DISABLED_BasicDeadlockDetectionTest) {
+TEST(LockManagerDeadlockDetectionTest, BasicDeadlockDetectionTest) {
   LockManager lock_mgr{};
   TransactionManager txn_mgr{&lock_mgr};
 
@@ -122,4 +122,71 @@ TEST(LockManagerDeadlockDetectionTest, DISABLED_BasicDeadlockDetectionTest) {
   delete txn0;
   delete txn1;
 }
+
+TEST(LockManagerDeadlockDetectionTest, WaitDieTest) {
+  LockManager lock_mgr{LockManager::DeadlockPolicy::WAIT_DIE};
+  TransactionManager txn_mgr{&lock_mgr};
+
+  table_oid_t toid{0};
+  RID rid0{0, 0};
+  RID rid1{1, 1};
+  auto *txn0 = txn_mgr.Begin();
+  auto *txn1 = txn_mgr.Begin();
+
+  EXPECT_TRUE(lock_mgr.LockTable(txn0, LockManager::LockMode::INTENTION_EXCLUSIVE, toid));
+  EXPECT_TRUE(lock_mgr.LockRow(txn0, LockManager::LockMode::EXCLUSIVE, toid, rid1));
+  EXPECT_TRUE(lock_mgr.LockTable(txn1, LockManager::LockMode::INTENTION_EXCLUSIVE, toid));
+  EXPECT_TRUE(lock_mgr.LockRow(txn1, LockManager::LockMode::EXCLUSIVE, toid, rid0));
+
+  // The older txn0 is allowed to wait for txn1.
+  std::thread t0([&] {
+    EXPECT_TRUE(lock_mgr.LockRow(txn0, LockManager::LockMode::EXCLUSIVE, toid, rid0));
+    txn_mgr.Commit(txn0);
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+  // The younger txn1 dies instead of waiting for txn0, which breaks the cycle without any detection.
+  EXPECT_THROW(lock_mgr.LockRow(txn1, LockManager::LockMode::EXCLUSIVE, toid, rid1), TransactionAbortException);
+  EXPECT_EQ(TransactionState::ABORTED, txn1->GetState());
+  txn_mgr.Abort(txn1);
+
+  t0.join();
+  EXPECT_EQ(TransactionState::COMMITTED, txn0->GetState());
+
+  delete txn0;
+  delete txn1;
+}
+
+TEST(LockManagerDeadlockDetectionTest, WoundWaitTest) {
+  LockManager lock_mgr{LockManager::DeadlockPolicy::WOUND_WAIT};
+  TransactionManager txn_mgr{&lock_mgr};
+
+  table_oid_t toid{0};
+  RID rid0{0, 0};
+  RID rid1{1, 1};
+  auto *txn0 = txn_mgr.Begin();
+  auto *txn1 = txn_mgr.Begin();
+
+  EXPECT_TRUE(lock_mgr.LockTable(txn0, LockManager::LockMode::INTENTION_EXCLUSIVE, toid));
+  EXPECT_TRUE(lock_mgr.LockRow(txn0, LockManager::LockMode::EXCLUSIVE, toid, rid1));
+  EXPECT_TRUE(lock_mgr.LockTable(txn1, LockManager::LockMode::INTENTION_EXCLUSIVE, toid));
+  EXPECT_TRUE(lock_mgr.LockRow(txn1, LockManager::LockMode::EXCLUSIVE, toid, rid0));
+
+  // The younger txn1 waits for txn0.
+  std::thread t1([&] {
+    EXPECT_FALSE(lock_mgr.LockRow(txn1, LockManager::LockMode::EXCLUSIVE, toid, rid1));
+    EXPECT_EQ(TransactionState::ABORTED, txn1->GetState());
+    txn_mgr.Abort(txn1);
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+  // The older txn0 wounds txn1, which is woken up on the queue of rid1 and releases rid0 when it rolls back.
+  EXPECT_TRUE(lock_mgr.LockRow(txn0, LockManager::LockMode::EXCLUSIVE, toid, rid0));
+  t1.join();
+  txn_mgr.Commit(txn0);
+  EXPECT_EQ(TransactionState::COMMITTED, txn0->GetState());
+
+  delete txn0;
+  delete txn1;
+}
 }  // namespace bustub
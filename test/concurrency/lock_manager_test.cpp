@@ -109,7 +109,7 @@ void TableLockTest1() {
     delete txns[i];
   }
 }
-TEST(LockManagerTest, DISABLED_TableLockTest1) { TableLockTest1(); }  // NOLINT
+TEST(LockManagerTest, TableLockTest1) { TableLockTest1(); }  // NOLINT
 
 /** Upgrading single transaction from S -> X */
 void TableLockUpgradeTest1() {
@@ -134,7 +134,7 @@ void TableLockUpgradeTest1() {
 
   delete txn1;
 }
-TEST(LockManagerTest, DISABLED_TableLockUpgradeTest1) { TableLockUpgradeTest1(); }  // NOLINT
+TEST(LockManagerTest, TableLockUpgradeTest1) { TableLockUpgradeTest1(); }  // NOLINT
 
 void RowLockTest1() {
   LockManager lock_mgr{};
@@ -190,7 +190,7 @@ void RowLockTest1() {
     delete txns[i];
   }
 }
-TEST(LockManagerTest, DISABLED_RowLockTest1) { RowLockTest1(); }  // NOLINT
+TEST(LockManagerTest, RowLockTest1) { RowLockTest1(); }  // NOLINT
 
 void TwoPLTest1() {
   LockManager lock_mgr{};
@@ -239,6 +239,183 @@ void TwoPLTest1() {
   delete txn;
 }
 
-TEST(LockManagerTest, DISABLED_TwoPLTest1) { TwoPLTest1(); }  // NOLINT
+TEST(LockManagerTest, TwoPLTest1) { TwoPLTest1(); }  // NOLINT
+
+/** Rows spread over every lock table partition; upgrading S -> X recycles requests through the txn pool */
+void RowLockPartitionTest() {
+  LockManager lock_mgr{};
+  TransactionManager txn_mgr{&lock_mgr};
+  table_oid_t oid = 0;
+
+  const int num_txns = 8;
+  const int rows_per_txn = 100;
+  std::vector<Transaction *> txns;
+  for (int i = 0; i < num_txns; i++) {
+    txns.push_back(txn_mgr.Begin());
+  }
+
+  auto task = [&](int txn_id) {
+    auto *txn = txns[txn_id];
+    EXPECT_TRUE(lock_mgr.LockTable(txn, LockManager::LockMode::INTENTION_EXCLUSIVE, oid));
+    for (int i = 0; i < rows_per_txn; i++) {
+      RID rid{txn_id, static_cast<uint32_t>(i)};
+      EXPECT_TRUE(lock_mgr.LockRow(txn, LockManager::LockMode::SHARED, oid, rid));
+      EXPECT_TRUE(lock_mgr.LockRow(txn, LockManager::LockMode::EXCLUSIVE, oid, rid));
+    }
+    CheckGrowing(txn);
+    CheckTxnRowLockSize(txn, oid, 0, rows_per_txn);
+    txn_mgr.Commit(txn);
+    CheckCommitted(txn);
+    CheckTxnRowLockSize(txn, oid, 0, 0);
+    CheckTableLockSizes(txn, 0, 0, 0, 0, 0);
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(num_txns);
+  for (int i = 0; i < num_txns; i++) {
+    threads.emplace_back(std::thread{task, i});
+  }
+  for (int i = 0; i < num_txns; i++) {
+    threads[i].join();
+    delete txns[i];
+  }
+  /** The queues of the released rows are gone */
+  EXPECT_EQ(lock_mgr.GetQueueCount(), 0U);
+
+  /** Every row is free again */
+  auto *txn = txn_mgr.Begin();
+  EXPECT_TRUE(lock_mgr.LockTable(txn, LockManager::LockMode::EXCLUSIVE, oid));
+  for (int t = 0; t < num_txns; t++) {
+    for (int i = 0; i < rows_per_txn; i++) {
+      EXPECT_TRUE(lock_mgr.LockRow(txn, LockManager::LockMode::EXCLUSIVE, oid, RID{t, static_cast<uint32_t>(i)}));
+    }
+  }
+  CheckTxnRowLockSize(txn, oid, 0, num_txns * rows_per_txn);
+  EXPECT_EQ(lock_mgr.GetQueueCount(), num_txns * rows_per_txn + 1);
+  txn_mgr.Commit(txn);
+  EXPECT_EQ(lock_mgr.GetQueueCount(), 0U);
+  delete txn;
+}
+TEST(LockManagerTest, RowLockPartitionTest) { RowLockPartitionTest(); }  // NOLINT
+
+/** Row locks beyond the escalation threshold are replaced by a table lock */
+void RowLockEscalationTest() {
+  LockManager lock_mgr{};
+  TransactionManager txn_mgr{&lock_mgr};
+  lock_mgr.SetLockEscalationThreshold(10);
+  table_oid_t oid = 0;
+
+  /** IS + S rows escalate to S */
+  auto *txn0 = txn_mgr.Begin();
+  EXPECT_TRUE(lock_mgr.LockTable(txn0, LockManager::LockMode::INTENTION_SHARED, oid));
+  for (uint32_t i = 0; i < 10; i++) {
+    EXPECT_TRUE(lock_mgr.LockRow(txn0, LockManager::LockMode::SHARED, oid, RID{0, i}));
+  }
+  CheckTxnRowLockSize(txn0, oid, 10, 0);
+  EXPECT_TRUE(lock_mgr.LockRow(txn0, LockManager::LockMode::SHARED, oid, RID{0, 10}));
+  CheckTxnRowLockSize(txn0, oid, 0, 0);
+  CheckTableLockSizes(txn0, 1, 0, 0, 0, 0);
+  EXPECT_TRUE(txn0->IsTableEscalated(oid));
+  CheckGrowing(txn0);
+
+  /** Further shared row locks are covered by the table lock, unlocking them is a no-op */
+  EXPECT_TRUE(lock_mgr.LockRow(txn0, LockManager::LockMode::SHARED, oid, RID{0, 11}));
+  CheckTxnRowLockSize(txn0, oid, 0, 0);
+  EXPECT_TRUE(lock_mgr.UnlockRow(txn0, oid, RID{0, 11}));
+  CheckGrowing(txn0);
+
+  EXPECT_TRUE(lock_mgr.UnlockTable(txn0, oid));
+  EXPECT_FALSE(txn0->IsTableEscalated(oid));
+  CheckShrinking(txn0);
+  txn_mgr.Commit(txn0);
+  delete txn0;
+
+  /** Escalation never stands in for a missing table lock: IS + S rows past the threshold, then an X row */
+  auto *txn3 = txn_mgr.Begin();
+  EXPECT_TRUE(lock_mgr.LockTable(txn3, LockManager::LockMode::INTENTION_SHARED, oid));
+  for (uint32_t i = 0; i < 10; i++) {
+    EXPECT_TRUE(lock_mgr.LockRow(txn3, LockManager::LockMode::SHARED, oid, RID{3, i}));
+  }
+  bool aborted = false;
+  try {
+    lock_mgr.LockRow(txn3, LockManager::LockMode::EXCLUSIVE, oid, RID{3, 10});
+  } catch (TransactionAbortException &e) {
+    aborted = e.GetAbortReason() == AbortReason::TABLE_LOCK_NOT_PRESENT;
+  }
+  EXPECT_TRUE(aborted);
+  CheckAborted(txn3);
+  CheckTxnRowLockSize(txn3, oid, 10, 0);
+  CheckTableLockSizes(txn3, 0, 0, 1, 0, 0);
+  EXPECT_FALSE(txn3->IsTableEscalated(oid));
+  txn_mgr.Abort(txn3);
+  delete txn3;
+
+  /** IX + S rows escalate to SIX, the escalated rows are free for other transactions */
+  auto *txn1 = txn_mgr.Begin();
+  EXPECT_TRUE(lock_mgr.LockTable(txn1, LockManager::LockMode::INTENTION_EXCLUSIVE, oid));
+  for (uint32_t i = 0; i <= 10; i++) {
+    EXPECT_TRUE(lock_mgr.LockRow(txn1, LockManager::LockMode::SHARED, oid, RID{1, i}));
+  }
+  CheckTxnRowLockSize(txn1, oid, 0, 0);
+  CheckTableLockSizes(txn1, 0, 0, 0, 0, 1);
+
+  auto *txn2 = txn_mgr.Begin();
+  EXPECT_TRUE(lock_mgr.LockTable(txn2, LockManager::LockMode::INTENTION_SHARED, oid));
+  EXPECT_TRUE(lock_mgr.LockRow(txn2, LockManager::LockMode::SHARED, oid, RID{1, 0}));
+  txn_mgr.Commit(txn2);
+  txn_mgr.Commit(txn1);
+  CheckTableLockSizes(txn1, 0, 0, 0, 0, 0);
+  delete txn1;
+  delete txn2;
+}
+TEST(LockManagerTest, RowLockEscalationTest) { RowLockEscalationTest(); }  // NOLINT
+
+/** Lock stats count requests, waits and upgrades per table and sampled row */
+void LockStatsTest() {
+  LockManager lock_mgr{};
+  TransactionManager txn_mgr{&lock_mgr};
+  table_oid_t oid = 0;
+  RID rid{0, 0};
+
+  /** Nothing is counted while the stats are off */
+  auto *txn0 = txn_mgr.Begin();
+  EXPECT_TRUE(lock_mgr.LockTable(txn0, LockManager::LockMode::INTENTION_EXCLUSIVE, oid));
+  txn_mgr.Commit(txn0);
+  delete txn0;
+  EXPECT_TRUE(lock_mgr.GetLockStats()->Snapshot().empty());
+
+  lock_mgr.GetLockStats()->Enable(true);
+  auto *txn1 = txn_mgr.Begin();
+  auto *txn2 = txn_mgr.Begin();
+  EXPECT_TRUE(lock_mgr.LockTable(txn1, LockManager::LockMode::INTENTION_SHARED, oid));
+  EXPECT_TRUE(lock_mgr.LockTable(txn1, LockManager::LockMode::SHARED_INTENTION_EXCLUSIVE, oid));
+  EXPECT_TRUE(lock_mgr.LockRow(txn1, LockManager::LockMode::EXCLUSIVE, oid, rid));
+  EXPECT_TRUE(lock_mgr.LockTable(txn2, LockManager::LockMode::INTENTION_SHARED, oid));
+  std::thread waiter([&] { EXPECT_TRUE(lock_mgr.LockRow(txn2, LockManager::LockMode::SHARED, oid, rid)); });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  txn_mgr.Commit(txn1);
+  waiter.join();
+  txn_mgr.Commit(txn2);
+  delete txn1;
+  delete txn2;
+
+  auto entries = lock_mgr.GetLockStats()->Snapshot();
+  ASSERT_EQ(entries.size(), 2U);
+  const auto &table = entries[0];
+  EXPECT_FALSE(table.is_row_);
+  EXPECT_EQ(table.requests_, 5U);
+  EXPECT_EQ(table.upgrades_, 1U);
+  EXPECT_EQ(table.waits_, 1U);
+  EXPECT_GE(table.wait_time_us_, 40000U);
+  EXPECT_GE(table.WaitPercentileUs(0.99), table.wait_time_us_);
+  EXPECT_EQ(table.deadlock_aborts_, 0U);
+  /** The first row request is always sampled, every later request on the row is counted */
+  const auto &row = entries[1];
+  EXPECT_TRUE(row.is_row_);
+  EXPECT_EQ(row.rid_, rid);
+  EXPECT_EQ(row.requests_, 2U);
+  EXPECT_EQ(row.waits_, 1U);
+}
+TEST(LockManagerTest, LockStatsTest) { LockStatsTest(); }  // NOLINT
 
 }  // namespace bustub
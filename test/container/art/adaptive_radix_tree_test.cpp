@@ -0,0 +1,147 @@
+/**
+ * adaptive_radix_tree_test.cpp
+ */
+
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <random>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "container/art/adaptive_radix_tree.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+/** A big-endian key, so that keys close to each other share their leading bytes */
+static auto MakeKey(uint32_t value) -> std::array<uint8_t, 4> {
+  return {static_cast<uint8_t>(value >> 24), static_cast<uint8_t>(value >> 16), static_cast<uint8_t>(value >> 8),
+          static_cast<uint8_t>(value)};
+}
+
+TEST(AdaptiveRadixTreeTest, SampleTest) {
+  AdaptiveRadixTree tree(4);
+  std::vector<RID> result;
+
+  // Keys that share three, two, one and no leading bytes
+  for (uint32_t value : {0x01020304U, 0x01020305U, 0x01027000U, 0x01700000U, 0x70000000U}) {
+    auto key = MakeKey(value);
+    EXPECT_TRUE(tree.Insert(key.data(), RID(value), true));
+  }
+  for (uint32_t value : {0x01020304U, 0x01020305U, 0x01027000U, 0x01700000U, 0x70000000U}) {
+    auto key = MakeKey(value);
+    result.clear();
+    EXPECT_TRUE(tree.GetValue(key.data(), &result));
+    ASSERT_EQ(1, result.size());
+    EXPECT_EQ(RID(value), result[0]);
+  }
+  // A key that leaves a compressed path in its middle, and one that ends where another branches
+  for (uint32_t value : {0x01020404U, 0x01020300U, 0x02000000U}) {
+    auto key = MakeKey(value);
+    result.clear();
+    EXPECT_FALSE(tree.GetValue(key.data(), &result));
+    EXPECT_TRUE(result.empty());
+  }
+
+  // A unique tree keeps the first RID of a key
+  auto key = MakeKey(0x01020304U);
+  EXPECT_FALSE(tree.Insert(key.data(), RID(1), true));
+  EXPECT_FALSE(tree.Remove(key.data(), RID(1)));
+  EXPECT_TRUE(tree.Remove(key.data(), RID(0x01020304U)));
+  result.clear();
+  EXPECT_FALSE(tree.GetValue(key.data(), &result));
+
+  auto other = MakeKey(0x01020305U);
+  result.clear();
+  EXPECT_TRUE(tree.GetValue(other.data(), &result));
+}
+
+TEST(AdaptiveRadixTreeTest, DuplicateKeyTest) {
+  AdaptiveRadixTree tree(4);
+  auto key = MakeKey(42);
+  EXPECT_TRUE(tree.Insert(key.data(), RID(1, 1), false));
+  EXPECT_TRUE(tree.Insert(key.data(), RID(1, 2), false));
+  EXPECT_TRUE(tree.Insert(key.data(), RID(1, 3), false));
+  EXPECT_FALSE(tree.Insert(key.data(), RID(1, 2), false));
+
+  std::vector<RID> result;
+  EXPECT_TRUE(tree.GetValue(key.data(), &result));
+  EXPECT_EQ((std::vector<RID>{RID(1, 1), RID(1, 2), RID(1, 3)}), result);
+
+  EXPECT_TRUE(tree.Remove(key.data(), RID(1, 2)));
+  EXPECT_FALSE(tree.Remove(key.data(), RID(1, 2)));
+  result.clear();
+  EXPECT_TRUE(tree.GetValue(key.data(), &result));
+  EXPECT_EQ((std::vector<RID>{RID(1, 1), RID(1, 3)}), result);
+}
+
+TEST(AdaptiveRadixTreeTest, GrowAndShrinkTest) {
+  // 256 children below one node make it grow through every size, removing them makes it shrink through them again.
+  AdaptiveRadixTree tree(4);
+  std::vector<RID> result;
+  for (uint32_t round = 0; round < 2; round++) {
+    for (uint32_t i = 0; i < 256; i++) {
+      auto key = MakeKey(0x00010000U | (i << 8) | round);
+      EXPECT_TRUE(tree.Insert(key.data(), RID(i), true));
+    }
+    for (uint32_t i = 0; i < 256; i++) {
+      auto key = MakeKey(0x00010000U | (i << 8) | round);
+      result.clear();
+      ASSERT_TRUE(tree.GetValue(key.data(), &result));
+      EXPECT_EQ(RID(i), result[0]);
+    }
+    for (uint32_t i = 0; i < 256; i++) {
+      auto key = MakeKey(0x00010000U | (i << 8) | round);
+      EXPECT_TRUE(tree.Remove(key.data(), RID(i)));
+      for (uint32_t j = i + 1; j < 256; j += 37) {
+        auto left = MakeKey(0x00010000U | (j << 8) | round);
+        result.clear();
+        ASSERT_TRUE(tree.GetValue(left.data(), &result));
+      }
+    }
+  }
+}
+
+TEST(AdaptiveRadixTreeTest, ConcurrentTest) {
+  const int num_threads = 8;
+  const uint32_t keys_per_thread = 10000;
+  AdaptiveRadixTree tree(4);
+
+  // Every thread inserts its own keys, reads them back and removes every other one, while the others do the same.
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([tid, &tree] {
+      std::vector<uint32_t> values;
+      for (uint32_t i = 0; i < keys_per_thread; i++) {
+        values.push_back(i * num_threads + tid);
+      }
+      std::shuffle(values.begin(), values.end(), std::mt19937(tid));
+      for (auto value : values) {
+        auto key = MakeKey(value * 2654435761U);
+        EXPECT_TRUE(tree.Insert(key.data(), RID(value), true));
+      }
+      std::vector<RID> result;
+      for (auto value : values) {
+        auto key = MakeKey(value * 2654435761U);
+        result.clear();
+        EXPECT_TRUE(tree.GetValue(key.data(), &result));
+        if (value % 2 == 0) {
+          EXPECT_TRUE(tree.Remove(key.data(), RID(value)));
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  std::vector<RID> result;
+  for (uint32_t value = 0; value < keys_per_thread * num_threads; value++) {
+    auto key = MakeKey(value * 2654435761U);
+    result.clear();
+    EXPECT_EQ(value % 2 == 1, tree.GetValue(key.data(), &result));
+  }
+}
+
+}  // namespace bustub
@@ -10,6 +10,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <thread>  // NOLINT
 #include <vector>
 
@@ -19,11 +20,12 @@
 #include "storage/disk/disk_manager.h"
 #include "storage/page/hash_table_bucket_page.h"
 #include "storage/page/hash_table_directory_page.h"
+#include "storage/page/hash_table_fingerprint_bucket_page.h"
 
 namespace bustub {
 
 // NOLINTNEXTLINE
-TEST(HashTablePageTest, DISABLED_DirectoryPageSampleTest) {
+TEST(HashTablePageTest, DirectoryPageSampleTest) {
   auto *disk_manager = new DiskManager("test.db");
   auto *bpm = new BufferPoolManagerInstance(5, disk_manager);
 
@@ -57,7 +59,7 @@ TEST(HashTablePageTest, DISABLED_DirectoryPageSampleTest) {
 }
 
 // NOLINTNEXTLINE
-TEST(HashTablePageTest, DISABLED_BucketPageSampleTest) {
+TEST(HashTablePageTest, BucketPageSampleTest) {
   auto *disk_manager = new DiskManager("test.db");
   auto *bpm = new BufferPoolManagerInstance(5, disk_manager);
 
@@ -114,4 +116,69 @@ TEST(HashTablePageTest, DISABLED_BucketPageSampleTest) {
   delete bpm;
 }
 
+// NOLINTNEXTLINE
+TEST(HashTablePageTest, FingerprintBucketPageTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(5, disk_manager);
+
+  page_id_t bucket_page_id = INVALID_PAGE_ID;
+  using FingerprintBucketPage = HashTableFingerprintBucketPage<int, int, IntComparator>;
+  auto bucket_page = reinterpret_cast<FingerprintBucketPage *>(bpm->NewPage(&bucket_page_id, nullptr)->GetData());
+  const int capacity = FingerprintBucketPage::ARRAY_SIZE;
+
+  // fill the bucket, a pair per key and a second one for every tenth key
+  EXPECT_TRUE(bucket_page->IsEmpty());
+  int inserted = 0;
+  for (int i = 0; inserted < capacity; i++) {
+    EXPECT_TRUE(bucket_page->Insert(i, i, IntComparator()));
+    EXPECT_FALSE(bucket_page->Insert(i, i, IntComparator()));
+    inserted++;
+    if (i % 10 == 0 && inserted < capacity) {
+      EXPECT_TRUE(bucket_page->Insert(i, -i - 1, IntComparator()));
+      inserted++;
+    }
+  }
+  EXPECT_TRUE(bucket_page->IsFull());
+  EXPECT_EQ(capacity, bucket_page->NumReadable());
+  EXPECT_FALSE(bucket_page->Insert(-1, -1, IntComparator()));
+
+  std::vector<int> result;
+  EXPECT_TRUE(bucket_page->GetValue(20, IntComparator(), &result));
+  std::sort(result.begin(), result.end());
+  EXPECT_EQ((std::vector<int>{-21, 20}), result);
+  for (int i = 1; i < 10; i++) {
+    result.clear();
+    EXPECT_TRUE(bucket_page->GetValue(i, IntComparator(), &result));
+    EXPECT_EQ(std::vector<int>{i}, result);
+  }
+  result.clear();
+  EXPECT_FALSE(bucket_page->GetValue(-1, IntComparator(), &result));
+
+  // removed pairs free their slots for new ones
+  EXPECT_TRUE(bucket_page->Remove(20, -21, IntComparator()));
+  EXPECT_FALSE(bucket_page->Remove(20, -21, IntComparator()));
+  EXPECT_TRUE(bucket_page->Remove(5, 5, IntComparator()));
+  EXPECT_FALSE(bucket_page->IsFull());
+  result.clear();
+  EXPECT_FALSE(bucket_page->GetValue(5, IntComparator(), &result));
+  EXPECT_TRUE(bucket_page->Insert(-1, -1, IntComparator()));
+  EXPECT_TRUE(bucket_page->Insert(-2, -2, IntComparator()));
+  EXPECT_TRUE(bucket_page->IsFull());
+  result.clear();
+  EXPECT_TRUE(bucket_page->GetValue(-2, IntComparator(), &result));
+  EXPECT_EQ(std::vector<int>{-2}, result);
+
+  int readable = 0;
+  for (int i = 0; i < capacity; i++) {
+    readable += static_cast<int>(bucket_page->IsReadable(i));
+  }
+  EXPECT_EQ(capacity, readable);
+
+  bpm->UnpinPage(bucket_page_id, true, nullptr);
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
 }  // namespace bustub
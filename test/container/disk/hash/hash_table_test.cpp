@@ -22,9 +22,7 @@
 namespace bustub {
 
 // NOLINTNEXTLINE
-
-// NOLINTNEXTLINE
-TEST(HashTableTest, DISABLED_SampleTest) {
+TEST(HashTableTest, SampleTest) {
   auto *disk_manager = new DiskManager("test.db");
   auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
   DiskExtendibleHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), HashFunction<int>());
@@ -117,4 +115,117 @@ TEST(HashTableTest, DISABLED_SampleTest) {
   delete bpm;
 }
 
+// NOLINTNEXTLINE
+TEST(HashTableTest, GrowShrinkTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  DiskExtendibleHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), HashFunction<int>());
+  const int num_keys = 20000;
+
+  // Enough pairs to split the first bucket many times over
+  for (int i = 0; i < num_keys; i++) {
+    EXPECT_TRUE(ht.Insert(nullptr, i, i));
+  }
+  ht.VerifyIntegrity();
+  EXPECT_GT(ht.GetGlobalDepth(), 4);
+  for (int i = 0; i < num_keys; i++) {
+    std::vector<int> res;
+    ht.GetValue(nullptr, i, &res);
+    ASSERT_EQ(1, res.size()) << "Failed to keep " << i << std::endl;
+    EXPECT_EQ(i, res[0]);
+  }
+
+  // Emptied buckets merge back into their split images and the directory shrinks with them.
+  for (int i = 0; i < num_keys; i++) {
+    EXPECT_TRUE(ht.Remove(nullptr, i, i));
+  }
+  ht.VerifyIntegrity();
+  EXPECT_EQ(0, ht.GetGlobalDepth());
+  for (int i = 0; i < num_keys; i += 97) {
+    std::vector<int> res;
+    EXPECT_FALSE(ht.GetValue(nullptr, i, &res));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+// NOLINTNEXTLINE
+TEST(HashTableTest, FingerprintBucketTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  DiskExtendibleHashTable<int, int, IntComparator, HashTableFingerprintBucketPage<int, int, IntComparator>> ht(
+      "blah", bpm, IntComparator(), HashFunction<int>());
+  const int num_keys = 20000;
+
+  // Two values for every key, split over buckets with fingerprints
+  for (int i = 0; i < num_keys; i++) {
+    EXPECT_TRUE(ht.Insert(nullptr, i, i));
+    EXPECT_TRUE(ht.Insert(nullptr, i, -i - 1));
+    EXPECT_FALSE(ht.Insert(nullptr, i, i));
+  }
+  ht.VerifyIntegrity();
+  for (int i = 0; i < num_keys; i++) {
+    std::vector<int> res;
+    ht.GetValue(nullptr, i, &res);
+    ASSERT_EQ(2, res.size()) << "Failed to keep " << i << std::endl;
+  }
+
+  for (int i = 0; i < num_keys; i++) {
+    EXPECT_TRUE(ht.Remove(nullptr, i, i));
+    EXPECT_TRUE(ht.Remove(nullptr, i, -i - 1));
+  }
+  ht.VerifyIntegrity();
+  EXPECT_EQ(0, ht.GetGlobalDepth());
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+// NOLINTNEXTLINE
+TEST(HashTableTest, ConcurrentTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  DiskExtendibleHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), HashFunction<int>());
+  const int num_threads = 4;
+  const int keys_per_thread = 5000;
+
+  // Every thread inserts its own keys, reads them back and removes every other one, splitting and merging buckets
+  // under the others.
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([tid, &ht] {
+      for (int i = 0; i < keys_per_thread; i++) {
+        EXPECT_TRUE(ht.Insert(nullptr, i * num_threads + tid, tid));
+      }
+      for (int i = 0; i < keys_per_thread; i++) {
+        std::vector<int> res;
+        ht.GetValue(nullptr, i * num_threads + tid, &res);
+        EXPECT_EQ(std::vector<int>{tid}, res);
+        if (i % 2 == 0) {
+          EXPECT_TRUE(ht.Remove(nullptr, i * num_threads + tid, tid));
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  ht.VerifyIntegrity();
+
+  for (int key = 0; key < keys_per_thread * num_threads; key++) {
+    std::vector<int> res;
+    EXPECT_EQ((key / num_threads) % 2 == 1, ht.GetValue(nullptr, key, &res));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
 }  // namespace bustub
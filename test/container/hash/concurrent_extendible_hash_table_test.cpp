@@ -0,0 +1,136 @@
+/**
+ * concurrent_extendible_hash_table_test.cpp
+ */
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "container/hash/concurrent_extendible_hash_table.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+TEST(ConcurrentExtendibleHashTableTest, SampleTest) {
+  auto table = std::make_unique<ConcurrentExtendibleHashTable<int, std::string>>(2);
+
+  table->Insert(1, "a");
+  table->Insert(2, "b");
+  table->Insert(3, "c");
+  table->Insert(4, "d");
+  table->Insert(5, "e");
+  table->Insert(6, "f");
+  table->Insert(7, "g");
+  table->Insert(8, "h");
+  table->Insert(9, "i");
+  EXPECT_EQ(3, table->GetGlobalDepth());
+  EXPECT_EQ(2, table->GetLocalDepth(0));
+  EXPECT_EQ(3, table->GetLocalDepth(1));
+  EXPECT_EQ(2, table->GetLocalDepth(2));
+  EXPECT_EQ(2, table->GetLocalDepth(3));
+  EXPECT_EQ(5, table->GetNumBuckets());
+
+  std::string result;
+  table->Find(9, result);
+  EXPECT_EQ("i", result);
+  table->Find(8, result);
+  EXPECT_EQ("h", result);
+  table->Find(2, result);
+  EXPECT_EQ("b", result);
+  EXPECT_FALSE(table->Find(10, result));
+
+  // An existing key gets its value updated
+  table->Insert(2, "bb");
+  table->Find(2, result);
+  EXPECT_EQ("bb", result);
+
+  EXPECT_TRUE(table->Remove(8));
+  EXPECT_TRUE(table->Remove(4));
+  EXPECT_TRUE(table->Remove(1));
+  EXPECT_FALSE(table->Remove(20));
+  EXPECT_FALSE(table->Find(8, result));
+}
+
+TEST(ConcurrentExtendibleHashTableTest, ProbeAndRemoveTest) {
+  // Large buckets and keys removed in random order, so that removals have to move back the keys probed past them.
+  const int num_keys = 5000;
+  auto table = std::make_unique<ConcurrentExtendibleHashTable<int, int>>(64);
+  std::vector<int> keys(num_keys);
+  for (int i = 0; i < num_keys; i++) {
+    keys[i] = i * 7919;
+    table->Insert(keys[i], i);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(15445));
+  for (int i = 0; i < num_keys; i++) {
+    EXPECT_TRUE(table->Remove(keys[i]));
+    EXPECT_FALSE(table->Remove(keys[i]));
+    for (int j = i + 1; j < num_keys; j += 97) {
+      int value;
+      ASSERT_TRUE(table->Find(keys[j], value));
+      EXPECT_EQ(keys[j] / 7919, value);
+    }
+  }
+}
+
+TEST(ConcurrentExtendibleHashTableTest, ConcurrentInsertTest) {
+  const int num_runs = 50;
+  const int num_threads = 3;
+
+  // Run concurrent test multiple times to guarantee correctness.
+  for (int run = 0; run < num_runs; run++) {
+    auto table = std::make_unique<ConcurrentExtendibleHashTable<int, int>>(2);
+    std::vector<std::thread> threads;
+    threads.reserve(num_threads);
+
+    for (int tid = 0; tid < num_threads; tid++) {
+      threads.emplace_back([tid, &table]() { table->Insert(tid, tid); });
+    }
+    for (int i = 0; i < num_threads; i++) {
+      threads[i].join();
+    }
+
+    EXPECT_EQ(table->GetGlobalDepth(), 1);
+    for (int i = 0; i < num_threads; i++) {
+      int val;
+      EXPECT_TRUE(table->Find(i, val));
+      EXPECT_EQ(i, val);
+    }
+  }
+}
+
+TEST(ConcurrentExtendibleHashTableTest, ConcurrentMixedTest) {
+  const int num_threads = 8;
+  const int keys_per_thread = 5000;
+  auto table = std::make_unique<ConcurrentExtendibleHashTable<int, int>>(4);
+
+  // Every thread inserts its own keys, reads them back and removes every other one, splitting buckets under the others.
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([tid, &table] {
+      for (int i = 0; i < keys_per_thread; i++) {
+        table->Insert(i * num_threads + tid, tid);
+      }
+      for (int i = 0; i < keys_per_thread; i++) {
+        int value;
+        EXPECT_TRUE(table->Find(i * num_threads + tid, value));
+        EXPECT_EQ(tid, value);
+        if (i % 2 == 0) {
+          EXPECT_TRUE(table->Remove(i * num_threads + tid));
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  for (int key = 0; key < keys_per_thread * num_threads; key++) {
+    int value;
+    EXPECT_EQ((key / num_threads) % 2 == 1, table->Find(key, value));
+  }
+}
+
+}  // namespace bustub
@@ -3,6 +3,7 @@
  */
 
 #include <memory>
+#include <string>
 #include <thread>  // NOLINT
 
 #include "container/hash/extendible_hash_table.h"
@@ -42,6 +43,66 @@ TEST(ExtendibleHashTableTest, SampleTest) {
   EXPECT_FALSE(table->Remove(20));
 }
 
+TEST(ExtendibleHashTableTest, MergeTest) {
+  auto table = std::make_unique<ExtendibleHashTable<int, std::string>>(2);
+  for (int i = 1; i <= 9; i++) {
+    table->Insert(i, std::to_string(i));
+  }
+  EXPECT_EQ(3, table->GetGlobalDepth());
+  EXPECT_EQ(5, table->GetNumBuckets());
+
+  // Emptying the bucket of 1 and 9 merges it back into the bucket of 5, the directory then halves.
+  EXPECT_TRUE(table->Remove(1));
+  EXPECT_EQ(3, table->GetGlobalDepth());
+  EXPECT_TRUE(table->Remove(9));
+  EXPECT_EQ(2, table->GetGlobalDepth());
+  EXPECT_EQ(4, table->GetNumBuckets());
+  EXPECT_EQ(2, table->GetLocalDepth(1));
+  EXPECT_EQ(2, table->GetLocalDepth(3));
+
+  // Emptying the bucket of 3 and 7 merges it with the bucket of 5.
+  EXPECT_TRUE(table->Remove(3));
+  EXPECT_TRUE(table->Remove(7));
+  EXPECT_EQ(3, table->GetNumBuckets());
+  EXPECT_EQ(1, table->GetLocalDepth(1));
+  EXPECT_EQ(1, table->GetLocalDepth(3));
+
+  std::string result;
+  for (int i : {2, 4, 5, 6, 8}) {
+    EXPECT_TRUE(table->Find(i, result));
+    EXPECT_EQ(std::to_string(i), result);
+  }
+  for (int i : {2, 4, 5, 6, 8}) {
+    EXPECT_TRUE(table->Remove(i));
+  }
+  EXPECT_EQ(1, table->GetGlobalDepth());
+  EXPECT_EQ(2, table->GetNumBuckets());
+}
+
+TEST(ExtendibleHashTableTest, ChurnTest) {
+  const int num_keys = 10000;
+  auto table = std::make_unique<ExtendibleHashTable<int, int>>(4);
+  size_t empty_usage = table->GetMemoryUsage();
+
+  // The table grows with every round of keys and shrinks back to where it started once they are gone.
+  for (int round = 0; round < 3; round++) {
+    for (int i = 0; i < num_keys; i++) {
+      table->Insert(i * 3 + round, i);
+    }
+    EXPECT_GT(table->GetGlobalDepth(), 10);
+    EXPECT_GT(table->GetMemoryUsage(), empty_usage);
+    for (int i = 0; i < num_keys; i++) {
+      int value;
+      ASSERT_TRUE(table->Find(i * 3 + round, value));
+      EXPECT_EQ(i, value);
+      EXPECT_TRUE(table->Remove(i * 3 + round));
+    }
+    EXPECT_EQ(1, table->GetGlobalDepth());
+    EXPECT_EQ(2, table->GetNumBuckets());
+    EXPECT_EQ(empty_usage, table->GetMemoryUsage());
+  }
+}
+
 TEST(ExtendibleHashTableTest, ConcurrentInsertTest) {
   const int num_runs = 50;
   const int num_threads = 3;
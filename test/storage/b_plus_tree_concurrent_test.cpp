@@ -100,7 +100,7 @@ void DeleteHelperSplit(BPlusTree<GenericKey<8>, RID, GenericComparator<8>> *tree
   delete transaction;
 }
 
-TEST(BPlusTreeConcurrentTest, DISABLED_InsertTest1) {
+TEST(BPlusTreeConcurrentTest, InsertTest1) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema.get());
@@ -152,7 +152,7 @@ TEST(BPlusTreeConcurrentTest, DISABLED_InsertTest1) {
   remove("test.log");
 }
 
-TEST(BPlusTreeConcurrentTest, DISABLED_InsertTest2) {
+TEST(BPlusTreeConcurrentTest, InsertTest2) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema.get());
@@ -203,7 +203,7 @@ TEST(BPlusTreeConcurrentTest, DISABLED_InsertTest2) {
   remove("test.log");
 }
 
-TEST(BPlusTreeConcurrentTest, DISABLED_DeleteTest1) {
+TEST(BPlusTreeConcurrentTest, DeleteTest1) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema.get());
@@ -245,7 +245,7 @@ TEST(BPlusTreeConcurrentTest, DISABLED_DeleteTest1) {
   remove("test.log");
 }
 
-TEST(BPlusTreeConcurrentTest, DISABLED_DeleteTest2) {
+TEST(BPlusTreeConcurrentTest, DeleteTest2) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema.get());
@@ -288,7 +288,7 @@ TEST(BPlusTreeConcurrentTest, DISABLED_DeleteTest2) {
   remove("test.log");
 }
 
-TEST(BPlusTreeConcurrentTest, DISABLED_MixTest) {
+TEST(BPlusTreeConcurrentTest, MixTest) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema.get());
@@ -333,4 +333,295 @@ TEST(BPlusTreeConcurrentTest, DISABLED_MixTest) {
   remove("test.log");
 }
 
+TEST(BPlusTreeConcurrentTest, MixedStressTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(256, disk_manager);
+  // small pages, so that most writers restart pessimistically and split or merge
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 3, 4);
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  const int64_t num_threads = 8;
+  const int64_t scale_factor = 2000;
+  // every thread owns the keys congruent to its id, inserts them, reads them back and removes the odd ones
+  auto worker = [&tree](uint64_t thread_itr) {
+    GenericKey<8> index_key;
+    RID rid;
+    std::vector<RID> rids;
+    auto *transaction = new Transaction(static_cast<txn_id_t>(thread_itr));
+    for (int64_t key = static_cast<int64_t>(thread_itr); key < scale_factor; key += num_threads) {
+      rid.Set(0, key);
+      index_key.SetFromInteger(key);
+      EXPECT_TRUE(tree.Insert(index_key, rid, transaction));
+    }
+    for (int64_t key = static_cast<int64_t>(thread_itr); key < scale_factor; key += num_threads) {
+      rids.clear();
+      index_key.SetFromInteger(key);
+      EXPECT_TRUE(tree.GetValue(index_key, &rids));
+      if (key % 2 == 1) {
+        tree.Remove(index_key, transaction);
+      }
+    }
+    delete transaction;
+  };
+  LaunchParallelTest(num_threads, worker);
+
+  std::vector<RID> rids;
+  GenericKey<8> index_key;
+  for (int64_t key = 0; key < scale_factor; key++) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    EXPECT_EQ(tree.GetValue(index_key, &rids), key % 2 == 0);
+  }
+  int64_t current_key = 0;
+  for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator) {
+    EXPECT_EQ((*iterator).second.GetSlotNum(), current_key);
+    current_key = current_key + 2;
+  }
+  EXPECT_EQ(current_key, scale_factor);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeConcurrentTest, ReverseScanStressTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(256, disk_manager);
+  // small pages, so that writers split and merge the leaves the scans step back into
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 3, 4);
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  const int64_t num_threads = 8;
+  const int64_t scale_factor = 1000;
+  GenericKey<8> index_key;
+  RID rid;
+  auto *transaction = new Transaction(0);
+  for (int64_t key = 0; key < scale_factor; key += 2) {
+    rid.Set(0, key);
+    index_key.SetFromInteger(key);
+    tree.Insert(index_key, rid, transaction);
+  }
+  delete transaction;
+
+  // half of the threads insert and remove the odd keys, the others scan backwards and must see every even key
+  auto worker = [&tree](uint64_t thread_itr) {
+    GenericKey<8> index_key;
+    RID rid;
+    auto *transaction = new Transaction(static_cast<txn_id_t>(thread_itr));
+    if (thread_itr % 2 == 0) {
+      for (int64_t key = 1 + static_cast<int64_t>(thread_itr); key < scale_factor; key += num_threads) {
+        rid.Set(0, key);
+        index_key.SetFromInteger(key);
+        tree.Insert(index_key, rid, transaction);
+      }
+      for (int64_t key = 1 + static_cast<int64_t>(thread_itr); key < scale_factor; key += num_threads) {
+        index_key.SetFromInteger(key);
+        tree.Remove(index_key, transaction);
+      }
+    } else {
+      for (int round = 0; round < 5; round++) {
+        int64_t expected = scale_factor - 2;
+        for (auto iterator = tree.RBegin(); !iterator.IsEnd(); ++iterator) {
+          int64_t key = (*iterator).first.ToString();
+          if (key % 2 == 0) {
+            EXPECT_EQ(key, expected);
+            expected -= 2;
+          }
+        }
+        EXPECT_EQ(expected, -2);
+      }
+    }
+    delete transaction;
+  };
+  LaunchParallelTest(num_threads, worker);
+
+  int64_t current_key = scale_factor - 2;
+  for (auto iterator = tree.RBegin(); !iterator.IsEnd(); ++iterator) {
+    EXPECT_EQ((*iterator).second.GetSlotNum(), current_key);
+    current_key = current_key - 2;
+  }
+  EXPECT_EQ(current_key, -2);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeConcurrentTest, MoveRightStressTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  // integer keys read internal pages and, for the lookups, leaves without latches, the Value comparator read-latches
+  // them
+  for (bool integer_keys : {true, false}) {
+    GenericComparator<8> comparator(key_schema.get(), integer_keys);
+    SCOPED_TRACE(integer_keys ? "integer keys" : "value keys");
+
+    auto *disk_manager = new DiskManager("test.db");
+    BufferPoolManager *bpm = new BufferPoolManagerInstance(256, disk_manager);
+    // small pages, so that the lookups keep running into splits and merges on every level
+    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 3, 4);
+    // create and fetch header_page
+    page_id_t page_id;
+    auto header_page = bpm->NewPage(&page_id);
+    (void)header_page;
+
+    const int64_t num_threads = 8;
+    const int64_t scale_factor = 1200;
+    GenericKey<8> index_key;
+    RID rid;
+    for (int64_t key = 0; key < scale_factor; key += 4) {
+      rid.Set(0, key);
+      index_key.SetFromInteger(key);
+      tree.Insert(index_key, rid);
+    }
+
+    // half of the threads insert and remove the keys between the multiples of four, the others look up every
+    // multiple of four and must find it
+    auto worker = [&tree](uint64_t thread_itr) {
+      GenericKey<8> index_key;
+      RID rid;
+      std::vector<RID> rids;
+      if (thread_itr % 2 == 0) {
+        int64_t offset = 1 + static_cast<int64_t>(thread_itr / 2) % 3;
+        for (int round = 0; round < 3; round++) {
+          for (int64_t key = offset; key < scale_factor; key += 4) {
+            rid.Set(0, key);
+            index_key.SetFromInteger(key);
+            tree.Insert(index_key, rid);
+          }
+          for (int64_t key = offset; key < scale_factor; key += 4) {
+            index_key.SetFromInteger(key);
+            tree.Remove(index_key);
+          }
+        }
+      } else {
+        for (int round = 0; round < 10; round++) {
+          for (int64_t key = 0; key < scale_factor; key += 4) {
+            rids.clear();
+            index_key.SetFromInteger(key);
+            EXPECT_TRUE(tree.GetValue(index_key, &rids));
+            ASSERT_EQ(rids.size(), 1);
+            EXPECT_EQ(rids[0].GetSlotNum(), key);
+          }
+        }
+      }
+    };
+    LaunchParallelTest(num_threads, worker);
+
+    int64_t current_key = 0;
+    for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator) {
+      EXPECT_EQ((*iterator).second.GetSlotNum(), current_key);
+      current_key = current_key + 4;
+    }
+    EXPECT_EQ(current_key, scale_factor);
+
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete disk_manager;
+    delete bpm;
+    remove("test.db");
+    remove("test.log");
+  }
+}
+
+TEST(BPlusTreeConcurrentTest, CompactStressTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(256, disk_manager);
+  // small pages, so that the compaction repacks leaves below parents that keep changing
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 5, 6);
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  const int64_t num_threads = 8;
+  const int64_t scale_factor = 2000;
+  GenericKey<8> index_key;
+  RID rid;
+  for (int64_t key = 0; key < scale_factor; key++) {
+    rid.Set(0, key);
+    index_key.SetFromInteger(key);
+    tree.Insert(index_key, rid);
+  }
+  for (int64_t key = 0; key < scale_factor; key++) {
+    if (key % 4 != 0) {
+      index_key.SetFromInteger(key);
+      tree.Remove(index_key);
+    }
+  }
+
+  // one thread compacts over and over, three insert and remove the keys between the multiples of four, the others
+  // look up every multiple of four and must find it
+  auto worker = [&tree](uint64_t thread_itr) {
+    GenericKey<8> index_key;
+    RID rid;
+    std::vector<RID> rids;
+    if (thread_itr == 0) {
+      for (int round = 0; round < 10; round++) {
+        auto stats = tree.Compact();
+        EXPECT_GE(stats.after_.entries_, scale_factor / 4);
+      }
+    } else if (thread_itr < 4) {
+      for (int round = 0; round < 3; round++) {
+        for (int64_t key = static_cast<int64_t>(thread_itr); key < scale_factor; key += 4) {
+          rid.Set(0, key);
+          index_key.SetFromInteger(key);
+          tree.Insert(index_key, rid);
+        }
+        for (int64_t key = static_cast<int64_t>(thread_itr); key < scale_factor; key += 4) {
+          index_key.SetFromInteger(key);
+          tree.Remove(index_key);
+        }
+      }
+    } else {
+      for (int round = 0; round < 5; round++) {
+        for (int64_t key = 0; key < scale_factor; key += 4) {
+          rids.clear();
+          index_key.SetFromInteger(key);
+          EXPECT_TRUE(tree.GetValue(index_key, &rids));
+          ASSERT_EQ(rids.size(), 1);
+          EXPECT_EQ(rids[0].GetSlotNum(), key);
+        }
+      }
+    }
+  };
+  LaunchParallelTest(num_threads, worker);
+
+  auto stats = tree.Compact();
+  EXPECT_EQ(stats.after_.entries_, scale_factor / 4);
+  int64_t current_key = 0;
+  for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator) {
+    EXPECT_EQ((*iterator).second.GetSlotNum(), current_key);
+    current_key = current_key + 4;
+  }
+  EXPECT_EQ(current_key, scale_factor);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
 }  // namespace bustub
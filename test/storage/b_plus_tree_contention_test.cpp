@@ -154,4 +154,67 @@ TEST(BPlusTreeTest, DISABLED_BPlusTreeContentionBenchmark2) {  // NOLINT
             << std::endl;
 }
 
+/**
+ * Insert and then look up 32768 keys with 1, 2, 4, ..., 32 threads. Every thread works on an interleaved share of
+ * the keys, so the threads keep meeting on the same leaves and the latch protocol decides how well they scale.
+ */
+TEST(BPlusTreeTest, DISABLED_BPlusTreeScalingBenchmark) {  // NOLINT
+  const int64_t num_keys = 32768;
+  std::cout << "<<< BEGIN" << std::endl;
+  for (size_t num_threads = 1; num_threads <= 32; num_threads *= 2) {
+    auto key_schema = ParseCreateStatement("a bigint");
+    GenericComparator<8> comparator(key_schema.get());
+    auto *disk_manager = new DiskManagerMemory(256 << 10);
+    BufferPoolManager *bpm = new BufferPoolManagerInstance(1024, disk_manager);
+    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
+    page_id_t page_id;
+    auto *header_page = bpm->NewPage(&page_id);
+    (void)header_page;
+
+    std::vector<std::thread> threads;
+    auto insert_start = std::chrono::system_clock::now();
+    for (size_t i = 0; i < num_threads; i++) {
+      threads.emplace_back([&tree, i, num_threads, num_keys]() {
+        GenericKey<8> index_key;
+        RID rid;
+        for (auto key = static_cast<int64_t>(i); key < num_keys; key += num_threads) {
+          rid.Set(0, key);
+          index_key.SetFromInteger(key);
+          tree.Insert(index_key, rid);
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    auto lookup_start = std::chrono::system_clock::now();
+    threads.clear();
+    for (size_t i = 0; i < num_threads; i++) {
+      threads.emplace_back([&tree, i, num_threads, num_keys]() {
+        GenericKey<8> index_key;
+        std::vector<RID> rids;
+        for (auto key = static_cast<int64_t>(i); key < num_keys; key += num_threads) {
+          rids.clear();
+          index_key.SetFromInteger(key);
+          ASSERT_TRUE(tree.GetValue(index_key, &rids));
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    auto lookup_end = std::chrono::system_clock::now();
+
+    auto insert_ms = std::chrono::duration_cast<std::chrono::milliseconds>(lookup_start - insert_start).count();
+    auto lookup_ms = std::chrono::duration_cast<std::chrono::milliseconds>(lookup_end - lookup_start).count();
+    std::cout << "threads: " << num_threads << " insert_ms: " << insert_ms << " lookup_ms: " << lookup_ms
+              << std::endl;
+
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete bpm;
+    delete disk_manager;
+  }
+  std::cout << ">>> END" << std::endl;
+}
+
 }  // namespace bustub
@@ -12,6 +12,7 @@
 
 #include <algorithm>
 #include <cstdio>
+#include <random>
 
 #include "buffer/buffer_pool_manager_instance.h"
 #include "gtest/gtest.h"
@@ -20,7 +21,7 @@
 
 namespace bustub {
 
-TEST(BPlusTreeTests, DISABLED_DeleteTest1) {
+TEST(BPlusTreeTests, DeleteTest1) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema.get());
@@ -92,7 +93,7 @@ TEST(BPlusTreeTests, DISABLED_DeleteTest1) {
   remove("test.log");
 }
 
-TEST(BPlusTreeTests, DISABLED_DeleteTest2) {
+TEST(BPlusTreeTests, DeleteTest2) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema.get());
@@ -163,4 +164,166 @@ TEST(BPlusTreeTests, DISABLED_DeleteTest2) {
   remove("test.db");
   remove("test.log");
 }
+
+TEST(BPlusTreeTests, DeleteMergeTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  // small pages, so that removals merge and redistribute on every level
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 3, 4);
+  GenericKey<8> index_key;
+  RID rid;
+  auto *transaction = new Transaction(0);
+
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  std::vector<int64_t> keys;
+  for (int64_t key = 1; key <= 500; key++) {
+    keys.push_back(key);
+  }
+  std::default_random_engine rng(15445);
+  std::shuffle(keys.begin(), keys.end(), rng);
+  for (auto key : keys) {
+    rid.Set(static_cast<int32_t>(key >> 32), key & 0xFFFFFFFF);
+    index_key.SetFromInteger(key);
+    tree.Insert(index_key, rid, transaction);
+  }
+
+  // remove every key but the multiples of seven
+  std::shuffle(keys.begin(), keys.end(), rng);
+  for (auto key : keys) {
+    if (key % 7 != 0) {
+      index_key.SetFromInteger(key);
+      tree.Remove(index_key, transaction);
+    }
+  }
+
+  std::vector<RID> rids;
+  for (int64_t key = 1; key <= 500; key++) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    EXPECT_EQ(tree.GetValue(index_key, &rids), key % 7 == 0);
+  }
+  int64_t current_key = 7;
+  for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator) {
+    EXPECT_EQ((*iterator).second.GetSlotNum(), current_key);
+    current_key = current_key + 7;
+  }
+  EXPECT_EQ(current_key, 504);
+
+  // removing the rest empties the tree, which can grow again afterwards
+  for (int64_t key = 7; key <= 500; key += 7) {
+    index_key.SetFromInteger(key);
+    tree.Remove(index_key, transaction);
+  }
+  EXPECT_TRUE(tree.IsEmpty());
+  EXPECT_TRUE(tree.Begin() == tree.End());
+  index_key.SetFromInteger(42);
+  EXPECT_TRUE(tree.Insert(index_key, rid, transaction));
+  EXPECT_FALSE(tree.IsEmpty());
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeTests, CompactTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  GenericKey<8> index_key;
+  RID rid;
+  auto *transaction = new Transaction(0);
+
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  std::vector<int64_t> keys;
+  for (int64_t key = 1; key <= 2000; key++) {
+    keys.push_back(key);
+  }
+  std::default_random_engine rng(15445);
+  for (bool compress : {false, true}) {
+    SCOPED_TRACE(compress ? "compressed" : "plain");
+    // leaves of 7 pairs below parents with room to lose children
+    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 8, 16, compress);
+    std::shuffle(keys.begin(), keys.end(), rng);
+    for (auto key : keys) {
+      rid.Set(static_cast<int32_t>(key >> 32), key & 0xFFFFFFFF);
+      index_key.SetFromInteger(key);
+      tree.Insert(index_key, rid, transaction);
+    }
+    // keep every third key, which leaves most leaves close to their min size
+    for (auto key : keys) {
+      if (key % 3 != 0) {
+        index_key.SetFromInteger(key);
+        tree.Remove(index_key, transaction);
+      }
+    }
+
+    auto stats = tree.Compact(1.0);
+    EXPECT_EQ(stats.before_.entries_, 666);
+    EXPECT_EQ(stats.after_.entries_, 666);
+    EXPECT_LT(stats.after_.leaf_pages_, stats.before_.leaf_pages_ * 4 / 5);
+    EXPECT_EQ(stats.reclaimed_pages_, stats.before_.leaf_pages_ - stats.after_.leaf_pages_);
+    EXPECT_GT(stats.after_.fill_factor_, stats.before_.fill_factor_);
+    if (!compress) {
+      // only the last leaf below each parent may stay partly empty
+      EXPECT_GT(stats.after_.fill_factor_, 0.85);
+    }
+    EXPECT_EQ(tree.GetFillStats().leaf_pages_, stats.after_.leaf_pages_);
+
+    std::vector<RID> rids;
+    for (int64_t key = 1; key <= 2000; key++) {
+      rids.clear();
+      index_key.SetFromInteger(key);
+      EXPECT_EQ(tree.GetValue(index_key, &rids), key % 3 == 0);
+    }
+    int64_t current_key = 3;
+    for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator) {
+      EXPECT_EQ((*iterator).second.GetSlotNum(), current_key);
+      current_key = current_key + 3;
+    }
+    EXPECT_EQ(current_key, 2001);
+
+    // the compacted leaves split and merge as usual
+    for (auto key : keys) {
+      rid.Set(static_cast<int32_t>(key >> 32), key & 0xFFFFFFFF);
+      index_key.SetFromInteger(key);
+      EXPECT_EQ(tree.Insert(index_key, rid, transaction), key % 3 != 0);
+    }
+    current_key = 1;
+    for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator) {
+      EXPECT_EQ((*iterator).second.GetSlotNum(), current_key);
+      current_key = current_key + 1;
+    }
+    EXPECT_EQ(current_key, 2001);
+    for (auto key : keys) {
+      index_key.SetFromInteger(key);
+      tree.Remove(index_key, transaction);
+    }
+    EXPECT_TRUE(tree.IsEmpty());
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
 }  // namespace bustub
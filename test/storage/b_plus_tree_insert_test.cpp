@@ -12,6 +12,8 @@
 
 #include <algorithm>
 #include <cstdio>
+#include <random>
+#include <set>
 
 #include "buffer/buffer_pool_manager_instance.h"
 #include "gtest/gtest.h"
@@ -20,7 +22,7 @@
 
 namespace bustub {
 
-TEST(BPlusTreeTests, DISABLED_InsertTest1) {
+TEST(BPlusTreeTests, InsertTest1) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema.get());
@@ -64,7 +66,7 @@ TEST(BPlusTreeTests, DISABLED_InsertTest1) {
   remove("test.log");
 }
 
-TEST(BPlusTreeTests, DISABLED_InsertTest2) {
+TEST(BPlusTreeTests, InsertTest2) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema.get());
@@ -127,7 +129,7 @@ TEST(BPlusTreeTests, DISABLED_InsertTest2) {
   remove("test.log");
 }
 
-TEST(BPlusTreeTests, DISABLED_InsertTest3) {
+TEST(BPlusTreeTests, InsertTest3) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema.get());
@@ -195,4 +197,581 @@ TEST(BPlusTreeTests, DISABLED_InsertTest3) {
   remove("test.db");
   remove("test.log");
 }
+
+TEST(BPlusTreeTests, InsertSplitTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  // small pages, so that leaves and internal pages split many times
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 3, 4);
+  GenericKey<8> index_key;
+  RID rid;
+  auto *transaction = new Transaction(0);
+
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  std::vector<int64_t> keys;
+  for (int64_t key = 1; key <= 1000; key++) {
+    keys.push_back(key);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::default_random_engine(15445));
+  for (auto key : keys) {
+    rid.Set(static_cast<int32_t>(key >> 32), key & 0xFFFFFFFF);
+    index_key.SetFromInteger(key);
+    EXPECT_TRUE(tree.Insert(index_key, rid, transaction));
+  }
+  // duplicate keys are rejected
+  index_key.SetFromInteger(keys[0]);
+  EXPECT_FALSE(tree.Insert(index_key, rid, transaction));
+
+  auto root_page = reinterpret_cast<BPlusTreePage *>(bpm->FetchPage(tree.GetRootPageId())->GetData());
+  EXPECT_FALSE(root_page->IsLeafPage());
+  EXPECT_TRUE(root_page->IsRootPage());
+  bpm->UnpinPage(tree.GetRootPageId(), false);
+
+  std::vector<RID> rids;
+  for (auto key : keys) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    ASSERT_TRUE(tree.GetValue(index_key, &rids));
+    ASSERT_EQ(rids.size(), 1);
+    EXPECT_EQ(rids[0].GetSlotNum(), key);
+  }
+  index_key.SetFromInteger(1001);
+  rids.clear();
+  EXPECT_FALSE(tree.GetValue(index_key, &rids));
+
+  int64_t current_key = 1;
+  for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator) {
+    EXPECT_EQ((*iterator).second.GetSlotNum(), current_key);
+    current_key = current_key + 1;
+  }
+  EXPECT_EQ(current_key, 1001);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeTests, BulkLoadTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 5, 4);
+  GenericKey<8> index_key;
+  RID rid;
+  auto *transaction = new Transaction(0);
+
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  std::vector<int64_t> keys;
+  for (int64_t key = 1; key <= 1000; key++) {
+    keys.push_back(key);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::default_random_engine(15445));
+  // small sort runs, so that the pairs are spilled and merged; every tenth key comes twice, the first one wins
+  BulkLoadSorter<GenericKey<8>, RID, GenericComparator<8>> sorter(bpm, comparator, 64);
+  for (auto key : keys) {
+    rid.Set(0, key);
+    index_key.SetFromInteger(key);
+    sorter.Add(index_key, rid);
+    if (key % 10 == 0) {
+      rid.Set(1, key);
+      sorter.Add(index_key, rid);
+    }
+  }
+  sorter.Finish();
+  EXPECT_GT(sorter.GetSpilledRunCount(), 1);
+  ASSERT_TRUE(tree.BulkLoad(&sorter, 0.7));
+
+  std::vector<RID> rids;
+  for (auto key : keys) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    ASSERT_TRUE(tree.GetValue(index_key, &rids));
+    ASSERT_EQ(rids.size(), 1);
+    EXPECT_EQ(rids[0].GetPageId(), 0);
+    EXPECT_EQ(rids[0].GetSlotNum(), key);
+  }
+  int64_t current_key = 1;
+  for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator) {
+    EXPECT_EQ((*iterator).second.GetSlotNum(), current_key);
+    current_key = current_key + 1;
+  }
+  EXPECT_EQ(current_key, 1001);
+
+  // a loaded tree refuses a second load, and splits and merges like any other tree
+  BulkLoadSorter<GenericKey<8>, RID, GenericComparator<8>> empty_sorter(bpm, comparator);
+  empty_sorter.Finish();
+  EXPECT_FALSE(tree.BulkLoad(&empty_sorter));
+  for (int64_t key = 1001; key <= 1500; key++) {
+    rid.Set(0, key);
+    index_key.SetFromInteger(key);
+    EXPECT_TRUE(tree.Insert(index_key, rid, transaction));
+  }
+  for (int64_t key = 1; key <= 1500; key++) {
+    if (key % 3 != 0) {
+      index_key.SetFromInteger(key);
+      tree.Remove(index_key, transaction);
+    }
+  }
+  current_key = 3;
+  for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator) {
+    EXPECT_EQ((*iterator).second.GetSlotNum(), current_key);
+    current_key = current_key + 3;
+  }
+  EXPECT_EQ(current_key, 1503);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeTests, CompressedKeyTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint,b bigint");
+  GenericComparator<16> comparator(key_schema.get());
+
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  using LeafPage = BPlusTreeLeafPage<GenericKey<16>, RID, GenericComparator<16>>;
+  using InternalPage = BPlusTreeInternalPage<GenericKey<16>, page_id_t, GenericComparator<16>>;
+  BPlusTree<GenericKey<16>, RID, GenericComparator<16>> plain_tree("foo_plain", bpm, comparator);
+  BPlusTree<GenericKey<16>, RID, GenericComparator<16>> tree("foo_pk", bpm, comparator, LeafPage::COMPRESSED_MAX_SIZE,
+                                                             InternalPage::COMPRESSED_MAX_SIZE, true);
+  GenericKey<16> index_key;
+  RID rid;
+  auto *transaction = new Transaction(0);
+
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  // keys (a, b) with few distinct a, so the keys of a page share their first column
+  auto set_key = [&](int64_t key) {
+    int64_t a = key / 1000;
+    int64_t b = key % 1000;
+    memcpy(index_key.data_, &a, sizeof(int64_t));
+    memcpy(index_key.data_ + sizeof(int64_t), &b, sizeof(int64_t));
+  };
+  std::vector<int64_t> keys;
+  for (int64_t key = 0; key < 5000; key++) {
+    keys.push_back(key);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::default_random_engine(15445));
+
+  // both trees take the same keys, the compressed one needs fewer pages for them
+  page_id_t first_page;
+  page_id_t last_page;
+  bpm->UnpinPage(bpm->NewPage(&first_page)->GetPageId(), false);
+  for (auto key : keys) {
+    set_key(key);
+    rid.Set(0, key);
+    EXPECT_TRUE(plain_tree.Insert(index_key, rid, transaction));
+  }
+  bpm->UnpinPage(bpm->NewPage(&last_page)->GetPageId(), false);
+  int plain_pages = last_page - first_page;
+  first_page = last_page;
+  for (auto key : keys) {
+    set_key(key);
+    rid.Set(0, key);
+    EXPECT_TRUE(tree.Insert(index_key, rid, transaction));
+    EXPECT_FALSE(tree.Insert(index_key, rid, transaction));
+  }
+  bpm->UnpinPage(bpm->NewPage(&last_page)->GetPageId(), false);
+  EXPECT_LT(last_page - first_page, plain_pages * 3 / 4);
+
+  std::vector<RID> rids;
+  for (auto key : keys) {
+    rids.clear();
+    set_key(key);
+    ASSERT_TRUE(tree.GetValue(index_key, &rids));
+    ASSERT_EQ(rids.size(), 1);
+    EXPECT_EQ(rids[0].GetSlotNum(), key);
+  }
+  int64_t current_key = 0;
+  for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator) {
+    EXPECT_EQ((*iterator).second.GetSlotNum(), current_key);
+    current_key = current_key + 1;
+  }
+  EXPECT_EQ(current_key, 5000);
+
+  // removals merge and redistribute compressed pages
+  for (auto key : keys) {
+    if (key % 7 != 0) {
+      set_key(key);
+      tree.Remove(index_key, transaction);
+    }
+  }
+  for (int64_t key = 0; key < 5000; key++) {
+    rids.clear();
+    set_key(key);
+    EXPECT_EQ(tree.GetValue(index_key, &rids), key % 7 == 0);
+  }
+  current_key = 0;
+  for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator) {
+    EXPECT_EQ((*iterator).second.GetSlotNum(), current_key);
+    current_key = current_key + 7;
+  }
+  EXPECT_EQ(current_key, 5005);
+
+  // a bulk load fills compressed pages by their bytes
+  BPlusTree<GenericKey<16>, RID, GenericComparator<16>> loaded_tree(
+      "foo_loaded", bpm, comparator, LeafPage::COMPRESSED_MAX_SIZE, InternalPage::COMPRESSED_MAX_SIZE, true);
+  BulkLoadSorter<GenericKey<16>, RID, GenericComparator<16>> sorter(bpm, comparator);
+  for (auto key : keys) {
+    set_key(key);
+    rid.Set(0, key);
+    sorter.Add(index_key, rid);
+  }
+  sorter.Finish();
+  ASSERT_TRUE(loaded_tree.BulkLoad(&sorter));
+  for (auto key : keys) {
+    rids.clear();
+    set_key(key);
+    ASSERT_TRUE(loaded_tree.GetValue(index_key, &rids));
+    EXPECT_EQ(rids[0].GetSlotNum(), key);
+  }
+  current_key = 0;
+  for (auto iterator = loaded_tree.Begin(); iterator != loaded_tree.End(); ++iterator) {
+    EXPECT_EQ((*iterator).second.GetSlotNum(), current_key);
+    current_key = current_key + 1;
+  }
+  EXPECT_EQ(current_key, 5000);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeTests, DuplicateKeyTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  // create b+ tree that keeps every value of a key
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 4, 5, false, false);
+  GenericKey<8> index_key;
+  RID rid;
+  auto *transaction = new Transaction(0);
+
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  // every fourth key has enough values for a chain of posting pages, the others one to three
+  auto value_count = [](int64_t key) { return key % 4 == 0 ? 1100 : static_cast<int>(key % 4); };
+  std::vector<std::pair<int64_t, int>> pairs;
+  for (int64_t key = 0; key < 40; key++) {
+    for (int value = 0; value < value_count(key); value++) {
+      pairs.emplace_back(key, value);
+    }
+  }
+  std::shuffle(pairs.begin(), pairs.end(), std::default_random_engine(15445));
+  for (auto [key, value] : pairs) {
+    index_key.SetFromInteger(key);
+    rid.Set(static_cast<int32_t>(key), value);
+    EXPECT_TRUE(tree.Insert(index_key, rid, transaction));
+  }
+  for (int64_t key = 0; key < 40; key++) {
+    index_key.SetFromInteger(key);
+    rid.Set(static_cast<int32_t>(key), 0);
+    EXPECT_FALSE(tree.Insert(index_key, rid, transaction));
+  }
+
+  // a key yields all of its values, once each
+  auto check = [&](auto &checked_tree, auto expected_count) {
+    std::vector<RID> rids;
+    for (int64_t key = 0; key < 40; key++) {
+      rids.clear();
+      index_key.SetFromInteger(key);
+      EXPECT_EQ(checked_tree.GetValue(index_key, &rids), expected_count(key) > 0);
+      std::set<uint32_t> slots;
+      for (const auto &value : rids) {
+        EXPECT_EQ(value.GetPageId(), key);
+        slots.insert(value.GetSlotNum());
+      }
+      EXPECT_EQ(slots.size(), expected_count(key));
+      EXPECT_EQ(rids.size(), expected_count(key));
+    }
+    std::vector<size_t> counts(40);
+    int64_t last_key = 0;
+    for (auto iterator = checked_tree.Begin(); iterator != checked_tree.End(); ++iterator) {
+      int64_t key = (*iterator).second.GetPageId();
+      EXPECT_GE(key, last_key);
+      counts[key]++;
+      last_key = key;
+    }
+    for (int64_t key = 0; key < 40; key++) {
+      EXPECT_EQ(counts[key], expected_count(key));
+    }
+  };
+  check(tree, [&](int64_t key) { return static_cast<size_t>(value_count(key)); });
+  index_key.SetFromInteger(8);
+  auto iterator = tree.Begin(index_key);
+  EXPECT_EQ((*iterator).second.GetPageId(), 8);
+  iterator = tree.End();
+
+  // removing single values shrinks posting lists, a list of two turns back into a plain value
+  for (auto [key, value] : pairs) {
+    if (value % 2 == 1) {
+      index_key.SetFromInteger(key);
+      rid.Set(static_cast<int32_t>(key), value);
+      tree.Remove(index_key, rid, transaction);
+    }
+  }
+  index_key.SetFromInteger(3);
+  rid.Set(3, 1);
+  tree.Remove(index_key, rid, transaction);
+  auto halved_count = [&](int64_t key) { return static_cast<size_t>((value_count(key) + 1) / 2); };
+  check(tree, halved_count);
+
+  // removing a key drops its whole posting list
+  for (int64_t key = 0; key < 40; key += 4) {
+    index_key.SetFromInteger(key);
+    tree.Remove(index_key, transaction);
+  }
+  check(tree, [&](int64_t key) { return key % 4 == 0 ? 0 : halved_count(key); });
+
+  // a bulk load writes the values of equal keys into posting lists
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> loaded_tree("foo_loaded", bpm, comparator, 4, 5, false, false);
+  BulkLoadSorter<GenericKey<8>, RID, GenericComparator<8>> sorter(bpm, comparator);
+  for (auto [key, value] : pairs) {
+    index_key.SetFromInteger(key);
+    rid.Set(static_cast<int32_t>(key), value);
+    sorter.Add(index_key, rid);
+  }
+  sorter.Finish();
+  ASSERT_TRUE(loaded_tree.BulkLoad(&sorter));
+  check(loaded_tree, [&](int64_t key) { return static_cast<size_t>(value_count(key)); });
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+
+TEST(BPlusTreeTests, GetValuesTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  // create b+ tree
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 4, 5, false, false);
+  GenericKey<8> index_key;
+  RID rid;
+  auto *transaction = new Transaction(0);
+
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  // even keys only, key 10 with two values
+  std::vector<GenericKey<8>> keys;
+  std::vector<std::vector<RID>> results;
+  index_key.SetFromInteger(0);
+  keys.push_back(index_key);
+  tree.GetValues(keys, &results, transaction);
+  ASSERT_EQ(results.size(), 1);
+  EXPECT_TRUE(results[0].empty());
+  for (int64_t key = 0; key < 1000; key += 2) {
+    index_key.SetFromInteger(key);
+    rid.Set(0, key);
+    EXPECT_TRUE(tree.Insert(index_key, rid, transaction));
+  }
+  index_key.SetFromInteger(10);
+  rid.Set(0, 11);
+  EXPECT_TRUE(tree.Insert(index_key, rid, transaction));
+
+  // dense runs stay on their leaves, gaps descend again, keys past the last leaf are missing
+  keys.clear();
+  for (int64_t key : {-1, 0, 0, 1, 2, 3, 10, 12, 14, 16, 18, 20, 500, 501, 502, 900, 998, 999, 2000}) {
+    index_key.SetFromInteger(key);
+    keys.push_back(index_key);
+  }
+  tree.GetValues(keys, &results, transaction);
+  ASSERT_EQ(results.size(), keys.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    int64_t key = keys[i].ToString();
+    bool present = key >= 0 && key < 1000 && key % 2 == 0;
+    ASSERT_EQ(results[i].size(), present ? (key == 10 ? 2 : 1) : 0) << "key " << key;
+    if (present) {
+      EXPECT_EQ(results[i][0].GetSlotNum(), key);
+    }
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeTests, ReverseIteratorTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  // create b+ tree
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 4, 5, false, false);
+  GenericKey<8> index_key;
+  RID rid;
+  auto *transaction = new Transaction(0);
+
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  EXPECT_TRUE(tree.RBegin().IsEnd());
+  // even keys only, key 10 with two values
+  for (int64_t key = 0; key < 1000; key += 2) {
+    index_key.SetFromInteger(key);
+    rid.Set(0, key);
+    EXPECT_TRUE(tree.Insert(index_key, rid, transaction));
+  }
+  index_key.SetFromInteger(10);
+  rid.Set(0, 11);
+  EXPECT_TRUE(tree.Insert(index_key, rid, transaction));
+
+  // the whole tree backwards
+  int64_t expected = 998;
+  int count = 0;
+  for (auto it = tree.RBegin(); !it.IsEnd(); ++it, count++) {
+    int64_t key = (*it).first.ToString();
+    EXPECT_EQ(key, expected);
+    if (key != 10 || (*it).second.GetSlotNum() == 10) {
+      expected -= 2;
+    }
+  }
+  EXPECT_EQ(count, 501);
+
+  // a descending range scan from an absent key, and an ascending one with an exclusive bound
+  index_key.SetFromInteger(501);
+  auto rit = tree.RBegin(index_key);
+  index_key.SetFromInteger(100);
+  rit.SetBound(index_key, true);
+  for (expected = 500; !rit.IsEnd(); ++rit, expected -= 2) {
+    EXPECT_EQ((*rit).first.ToString(), expected);
+  }
+  EXPECT_EQ(expected, 98);
+  auto it = tree.Begin(index_key);
+  index_key.SetFromInteger(200);
+  it.SetBound(index_key, false);
+  for (expected = 100; it != tree.End(); ++it, expected += 2) {
+    EXPECT_EQ((*it).first.ToString(), expected);
+  }
+  EXPECT_EQ(expected, 200);
+
+  // stepping back through a posting list and over the first key
+  index_key.SetFromInteger(12);
+  it = tree.Begin(index_key);
+  --it;
+  EXPECT_EQ((*it).first.ToString(), 10);
+  --it;
+  EXPECT_EQ((*it).first.ToString(), 10);
+  --it;
+  EXPECT_EQ((*it).first.ToString(), 8);
+  it = tree.Begin();
+  --it;
+  EXPECT_TRUE(it.IsEnd());
+
+  // merges keep the previous leaf links
+  index_key.SetFromInteger(10);
+  tree.Remove(index_key, rid, transaction);
+  for (int64_t key = 0; key < 1000; key += 4) {
+    index_key.SetFromInteger(key);
+    tree.Remove(index_key, transaction);
+  }
+  expected = 998;
+  for (auto rit = tree.RBegin(); !rit.IsEnd(); ++rit, expected -= 4) {
+    EXPECT_EQ((*rit).first.ToString(), expected);
+  }
+  EXPECT_EQ(expected, -2);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeTests, IntegerKeySearchTest) {
+  using LeafPage = BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>>;
+  using InternalPage = BPlusTreeInternalPage<GenericKey<8>, page_id_t, GenericComparator<8>>;
+  for (const char *column : {"a tinyint", "a smallint", "a int", "a bigint"}) {
+    auto key_schema = ParseCreateStatement(column);
+    GenericComparator<8> comparator(key_schema.get());
+    GenericComparator<8> value_comparator(key_schema.get(), false);
+    ASSERT_NE(comparator.IntegerKeySize(), 0) << column;
+    ASSERT_EQ(value_comparator.IntegerKeySize(), 0) << column;
+
+    // keys -60, -57, ..., 60 in a leaf, the same keys as separators of an internal page
+    std::vector<char> leaf_data(BUSTUB_PAGE_SIZE);
+    std::vector<char> internal_data(BUSTUB_PAGE_SIZE);
+    auto *leaf = reinterpret_cast<LeafPage *>(leaf_data.data());
+    auto *internal = reinterpret_cast<InternalPage *>(internal_data.data());
+    leaf->Init(1, INVALID_PAGE_ID, 64);
+    internal->Init(2, INVALID_PAGE_ID, 64);
+    GenericKey<8> index_key;
+    index_key.SetFromInteger(-60);
+    internal->PopulateNewRoot(39, index_key, 40);
+    for (int64_t key = -60; key <= 60; key += 3) {
+      index_key.SetFromInteger(key);
+      leaf->Insert(index_key, RID(0, key + 60), comparator);
+      if (key > -60) {
+        internal->InsertNodeAfter(static_cast<page_id_t>(key + 97), index_key, static_cast<page_id_t>(key + 100));
+      }
+    }
+
+    // the integer search agrees with the value comparison on every key, between the keys and past both ends
+    for (int64_t key = -64; key <= 64; key++) {
+      index_key.SetFromInteger(key);
+      EXPECT_EQ(leaf->KeyIndex(index_key, comparator), leaf->KeyIndex(index_key, value_comparator))
+          << column << " key " << key;
+      EXPECT_EQ(internal->Lookup(index_key, comparator), internal->Lookup(index_key, value_comparator))
+          << column << " key " << key;
+    }
+    index_key.SetFromInteger(-61);
+    EXPECT_EQ(internal->Lookup(index_key, comparator), 39);
+    index_key.SetFromInteger(61);
+    EXPECT_EQ(internal->Lookup(index_key, comparator), 160);
+  }
+}
+
 }  // namespace bustub
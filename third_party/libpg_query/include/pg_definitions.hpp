@@ -41,7 +41,7 @@ typedef uint32_t PGOid;
 #define FUNC_MAX_ARGS 100
 #define FLEXIBLE_ARRAY_MEMBER
 
-#define DEFAULT_INDEX_TYPE "art"
+#define DEFAULT_INDEX_TYPE "btree"
 #define INTERVAL_MASK(b) (1 << (b))
 
 #ifdef _MSC_VER
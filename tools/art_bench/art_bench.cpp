@@ -0,0 +1,191 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "argparse/argparse.hpp"
+#include "buffer/buffer_pool_manager_instance.h"
+#include "catalog/schema.h"
+#include "container/hash/extendible_hash_table.h"
+#include "fmt/core.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/index/art_index.h"
+#include "storage/index/b_plus_tree_index.h"
+
+/**
+ * Point lookup benchmark of the ART index against the b+ tree index and the in-memory extendible hash table.
+ *
+ * The indexes hold the keys 0, 2, 4, ... of one INTEGER column, inserted in random order, and are probed with the
+ * same random keys, half of which are not in the index. The indexes are probed through Index::ScanKey, key tuples
+ * built up front. The disk-based ExtendibleHashTableIndex has no implementation of its table in this tree, so the
+ * hash case probes the in-memory ExtendibleHashTable instead, which maps the keys straight to the slots of their
+ * rids. Every structure is measured for inserting all keys, for lookups from one thread, and for lookups split
+ * among reader threads.
+ */
+
+static const char *BENCH_DB_FILE = "art_bench.db";
+
+struct ArtBenchConfig {
+  size_t keys_{100000};
+  size_t probes_{1000000};
+  size_t threads_{4};
+  uint64_t seed_{15445};
+};
+
+/** Print one case of the benchmark */
+void Report(const char *structure, const char *operation, size_t threads, size_t operations,
+            std::chrono::nanoseconds elapsed, uint64_t checksum) {
+  fmt::print("<<< BEGIN\n");
+  fmt::print("structure: {}\n", structure);
+  fmt::print("case: {}\n", operation);
+  fmt::print("threads: {}\n", threads);
+  fmt::print("operations: {}\n", operations);
+  fmt::print("ns_per_operation: {:.1f}\n", static_cast<double>(elapsed.count()) * threads / operations);
+  fmt::print("operations_per_second: {:.0f}\n", operations * 1e9 / elapsed.count());
+  // Printed so that the compiler cannot drop the lookups.
+  fmt::print("checksum: {}\n", checksum);
+  fmt::print(">>> END\n");
+}
+
+/** Call lookup(i) for every probe i, split among threads, and report the time it took */
+void MeasureLookups(const char *structure, size_t threads, size_t probes,
+                    const std::function<uint64_t(size_t)> &lookup) {
+  std::atomic<uint64_t> checksum{0};
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> readers;
+  for (size_t t = 0; t < threads; t++) {
+    readers.emplace_back([t, threads, probes, &lookup, &checksum] {
+      uint64_t found = 0;
+      for (size_t i = t; i < probes; i += threads) {
+        found += lookup(i);
+      }
+      checksum += found;
+    });
+  }
+  for (auto &reader : readers) {
+    reader.join();
+  }
+  auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+  Report(structure, threads == 1 ? "lookup" : "concurrent_lookup", threads, probes, elapsed, checksum.load());
+}
+
+/** Insert the keys into an index, then probe it from one thread and from config.threads_ */
+void RunIndex(const char *structure, bustub::Index *index, const ArtBenchConfig &config,
+              const std::vector<bustub::Tuple> &keys, const std::vector<bustub::Tuple> &probes) {
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < keys.size(); i++) {
+    index->InsertEntry(keys[i], bustub::RID(0, i), nullptr);
+  }
+  auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+  Report(structure, "insert", 1, keys.size(), elapsed, keys.size());
+
+  auto lookup = [index, &probes](size_t i) -> uint64_t {
+    std::vector<bustub::RID> result;
+    index->ScanKey(probes[i], &result, nullptr);
+    return result.size();
+  };
+  MeasureLookups(structure, 1, probes.size(), lookup);
+  MeasureLookups(structure, config.threads_, probes.size(), lookup);
+}
+
+void RunHashTable(const ArtBenchConfig &config, const std::vector<int32_t> &keys, const std::vector<int32_t> &probes) {
+  bustub::ExtendibleHashTable<int, int> table(bustub::BUCKET_SIZE);
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < keys.size(); i++) {
+    table.Insert(keys[i], static_cast<int>(i));
+  }
+  auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+  Report("extendible_hash_table", "insert", 1, keys.size(), elapsed, keys.size());
+
+  auto lookup = [&table, &probes](size_t i) -> uint64_t {
+    int slot;
+    return static_cast<uint64_t>(table.Find(probes[i], slot));
+  };
+  MeasureLookups("extendible_hash_table", 1, probes.size(), lookup);
+  MeasureLookups("extendible_hash_table", config.threads_, probes.size(), lookup);
+}
+
+// NOLINTNEXTLINE
+auto main(int argc, char **argv) -> int {
+  argparse::ArgumentParser program("bustub-art-bench");
+  program.add_argument("--keys").help("number of keys in every index");
+  program.add_argument("--probes").help("number of lookups per case");
+  program.add_argument("--threads").help("number of reader threads of the concurrent lookup cases");
+
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::runtime_error &err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  ArtBenchConfig config;
+  if (program.present("--keys")) {
+    config.keys_ = std::max<size_t>(1, std::stoul(program.get("--keys")));
+  }
+  if (program.present("--probes")) {
+    config.probes_ = std::max<size_t>(1, std::stoul(program.get("--probes")));
+  }
+  if (program.present("--threads")) {
+    config.threads_ = std::max<size_t>(1, std::stoul(program.get("--threads")));
+  }
+
+  fmt::print(stderr, "art-bench: keys={} probes={} threads={}\n", config.keys_, config.probes_, config.threads_);
+
+  bustub::Schema table_schema({bustub::Column("a", bustub::TypeId::INTEGER)});
+  std::mt19937_64 rng(config.seed_);
+  std::vector<int32_t> keys(config.keys_);
+  std::iota(keys.begin(), keys.end(), 0);
+  std::transform(keys.begin(), keys.end(), keys.begin(), [](int32_t key) { return 2 * key; });
+  std::shuffle(keys.begin(), keys.end(), rng);
+  std::uniform_int_distribution<int32_t> dist(0, static_cast<int32_t>(2 * config.keys_));
+  std::vector<int32_t> probes(config.probes_);
+  std::generate(probes.begin(), probes.end(), [&dist, &rng] { return dist(rng); });
+
+  auto to_tuples = [&table_schema](const std::vector<int32_t> &values) {
+    std::vector<bustub::Tuple> tuples;
+    tuples.reserve(values.size());
+    for (auto value : values) {
+      tuples.emplace_back(std::vector<bustub::Value>{bustub::Value(bustub::TypeId::INTEGER, value)}, &table_schema);
+    }
+    return tuples;
+  };
+  auto key_tuples = to_tuples(keys);
+  auto probe_tuples = to_tuples(probes);
+
+  {
+    bustub::ARTIndex index(
+        std::make_unique<bustub::IndexMetadata>("art", "t", &table_schema, std::vector<uint32_t>{0}));
+    RunIndex("art_index", &index, config, key_tuples, probe_tuples);
+  }
+
+  {
+    auto disk_manager = std::make_unique<bustub::DiskManager>(BENCH_DB_FILE);
+    auto bpm = std::make_unique<bustub::BufferPoolManagerInstance>(4096, disk_manager.get());
+    bustub::page_id_t header_page_id;
+    bpm->NewPage(&header_page_id);
+    {
+      bustub::BPlusTreeIndexForOneIntegerColumn index(
+          std::make_unique<bustub::IndexMetadata>("b_plus_tree", "t", &table_schema, std::vector<uint32_t>{0}),
+          bpm.get());
+      RunIndex("b_plus_tree_index", &index, config, key_tuples, probe_tuples);
+    }
+    bpm->UnpinPage(header_page_id, true);
+    bpm.reset();
+    disk_manager->ShutDown();
+    std::remove(BENCH_DB_FILE);
+    std::remove("art_bench.log");
+  }
+
+  RunHashTable(config, keys, probes);
+  return 0;
+}
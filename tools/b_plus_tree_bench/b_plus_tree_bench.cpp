@@ -0,0 +1,213 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "argparse/argparse.hpp"
+#include "buffer/buffer_pool_manager_instance.h"
+#include "catalog/schema.h"
+#include "fmt/core.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/index/b_plus_tree.h"
+
+/**
+ * Lookup latency benchmark for the in-node search of b+ tree pages.
+ *
+ * Every case runs twice on the same BIGINT keys: once with the comparator searching integer keys as integers, and
+ * once with the comparator forced to compare Values, the path every key took before. The node cases search a full
+ * leaf (KeyIndex) and a full internal page (Lookup) held in plain memory, so they measure the search alone. The tree
+ * case looks keys up with GetValue in a tree built through the buffer pool, latching and pinning included. The
+ * concurrent case splits the probes among reader threads while one writer keeps inserting keys between the existing
+ * ones, so readers run into leaves that split under them.
+ */
+
+using bustub::BUSTUB_PAGE_SIZE;
+
+static const char *BENCH_DB_FILE = "b_plus_tree_bench.db";
+
+using Key = bustub::GenericKey<8>;
+using Comparator = bustub::GenericComparator<8>;
+using LeafPage = bustub::BPlusTreeLeafPage<Key, bustub::RID, Comparator>;
+using InternalPage = bustub::BPlusTreeInternalPage<Key, bustub::page_id_t, Comparator>;
+using Tree = bustub::BPlusTree<Key, bustub::RID, Comparator>;
+
+/** Entries of a full page, the header size macros expect a KeyType in scope */
+using KeyType = Key;
+static constexpr int LEAF_ENTRIES = (BUSTUB_PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / sizeof(std::pair<Key, bustub::RID>);
+static constexpr int INTERNAL_ENTRIES =
+    (BUSTUB_PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / sizeof(std::pair<Key, bustub::page_id_t>);
+
+struct TreeBenchConfig {
+  size_t keys_{100000};
+  size_t probes_{1000000};
+  size_t threads_{4};
+  uint64_t seed_{15445};
+};
+
+auto MakeKey(int64_t value) -> Key {
+  Key key;
+  key.SetFromInteger(value);
+  return key;
+}
+
+/** Run fn once per probe key and print the mean latency. */
+template <typename Fn>
+void Measure(const char *name, const Comparator &comparator, const std::vector<Key> &probes, Fn &&fn) {
+  uint64_t checksum = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (const auto &probe : probes) {
+    checksum += fn(probe);
+  }
+  auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+  fmt::print("<<< BEGIN\n");
+  fmt::print("case: {}\n", name);
+  fmt::print("search: {}\n", comparator.IntegerKeySize() != 0 ? "integer" : "value");
+  fmt::print("probes: {}\n", probes.size());
+  fmt::print("ns_per_lookup: {:.1f}\n", static_cast<double>(elapsed.count()) / probes.size());
+  // Printed so that the compiler cannot drop the lookups.
+  fmt::print("checksum: {}\n", checksum);
+  fmt::print(">>> END\n");
+}
+
+void RunNodeSearch(const Comparator &comparator, const std::vector<Key> &probes) {
+  // Keys 0, 2, 4, ... so that half of the probes fall between two keys.
+  std::vector<char> leaf_data(BUSTUB_PAGE_SIZE);
+  auto *leaf = reinterpret_cast<LeafPage *>(leaf_data.data());
+  leaf->Init(1);
+  for (int i = 0; i < LEAF_ENTRIES - 1; i++) {
+    leaf->Insert(MakeKey(2 * i), bustub::RID(0, i), comparator);
+  }
+  Measure("leaf_key_index", comparator, probes,
+          [leaf, &comparator](const Key &key) { return leaf->KeyIndex(key, comparator); });
+
+  std::vector<char> internal_data(BUSTUB_PAGE_SIZE);
+  auto *internal = reinterpret_cast<InternalPage *>(internal_data.data());
+  internal->Init(2);
+  internal->PopulateNewRoot(0, MakeKey(0), 1);
+  for (int i = 1; i < INTERNAL_ENTRIES - 1; i++) {
+    internal->InsertNodeAfter(i, MakeKey(2 * i), i + 1);
+  }
+  Measure("internal_lookup", comparator, probes,
+          [internal, &comparator](const Key &key) { return internal->Lookup(key, comparator); });
+}
+
+/** Look the probes up from config.threads_ readers while a writer inserts the odd keys, and print the throughput. */
+void RunConcurrentLookup(const TreeBenchConfig &config, const Comparator &comparator, const std::vector<Key> &probes,
+                         Tree *tree) {
+  std::atomic<bool> done{false};
+  std::atomic<uint64_t> checksum{0};
+  size_t inserted = 0;
+  std::thread writer([&done, &inserted, &config, tree] {
+    for (size_t i = 0; i < config.keys_ && !done; i++, inserted++) {
+      tree->Insert(MakeKey(2 * i + 1), bustub::RID(1, i));
+    }
+  });
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> readers;
+  for (size_t t = 0; t < config.threads_; t++) {
+    readers.emplace_back([t, &config, &probes, &checksum, tree] {
+      std::vector<bustub::RID> result;
+      uint64_t found = 0;
+      for (size_t i = t; i < probes.size(); i += config.threads_) {
+        result.clear();
+        found += static_cast<uint64_t>(tree->GetValue(probes[i], &result));
+      }
+      checksum += found;
+    });
+  }
+  for (auto &reader : readers) {
+    reader.join();
+  }
+  auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+  done = true;
+  writer.join();
+  fmt::print("<<< BEGIN\n");
+  fmt::print("case: tree_concurrent_get_value\n");
+  fmt::print("search: {}\n", comparator.IntegerKeySize() != 0 ? "integer" : "value");
+  fmt::print("threads: {}\n", config.threads_);
+  fmt::print("probes: {}\n", probes.size());
+  fmt::print("inserts_meanwhile: {}\n", inserted);
+  fmt::print("lookups_per_second: {:.0f}\n", probes.size() * 1e9 / elapsed.count());
+  fmt::print("checksum: {}\n", checksum.load());
+  fmt::print(">>> END\n");
+}
+
+void RunTreeLookup(const TreeBenchConfig &config, const Comparator &comparator, const std::vector<Key> &probes) {
+  auto disk_manager = std::make_unique<bustub::DiskManager>(BENCH_DB_FILE);
+  auto bpm = std::make_unique<bustub::BufferPoolManagerInstance>(4096, disk_manager.get());
+  bustub::page_id_t header_page_id;
+  bpm->NewPage(&header_page_id);
+  {
+    Tree tree("bench_index", bpm.get(), comparator);
+    for (size_t i = 0; i < config.keys_; i++) {
+      tree.Insert(MakeKey(2 * i), bustub::RID(0, i));
+    }
+    std::vector<bustub::RID> result;
+    Measure("tree_get_value", comparator, probes, [&tree, &result](const Key &key) {
+      result.clear();
+      return tree.GetValue(key, &result);
+    });
+    RunConcurrentLookup(config, comparator, probes, &tree);
+  }
+  bpm->UnpinPage(header_page_id, true);
+  bpm.reset();
+  disk_manager->ShutDown();
+  std::remove(BENCH_DB_FILE);
+  std::remove("b_plus_tree_bench.log");
+}
+
+// NOLINTNEXTLINE
+auto main(int argc, char **argv) -> int {
+  argparse::ArgumentParser program("bustub-b-plus-tree-bench");
+  program.add_argument("--keys").help("number of keys in the tree of the tree lookup case");
+  program.add_argument("--probes").help("number of lookups per case");
+  program.add_argument("--threads").help("number of reader threads of the concurrent lookup case");
+
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::runtime_error &err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  TreeBenchConfig config;
+  if (program.present("--keys")) {
+    config.keys_ = std::max<size_t>(1, std::stoul(program.get("--keys")));
+  }
+  if (program.present("--probes")) {
+    config.probes_ = std::max<size_t>(1, std::stoul(program.get("--probes")));
+  }
+
+  if (program.present("--threads")) {
+    config.threads_ = std::max<size_t>(1, std::stoul(program.get("--threads")));
+  }
+
+  fmt::print(stderr, "b-plus-tree-bench: keys={} probes={} threads={}\n", config.keys_, config.probes_,
+             config.threads_);
+
+  bustub::Schema key_schema({bustub::Column("a", bustub::TypeId::BIGINT)});
+  // The same random probes for every case, over the key range of the largest case.
+  std::mt19937_64 rng(config.seed_);
+  int64_t key_range = 2 * std::max<int64_t>(config.keys_, std::max(LEAF_ENTRIES, INTERNAL_ENTRIES));
+  std::uniform_int_distribution<int64_t> dist(0, key_range);
+  std::vector<Key> probes;
+  probes.reserve(config.probes_);
+  for (size_t i = 0; i < config.probes_; i++) {
+    probes.push_back(MakeKey(dist(rng)));
+  }
+
+  for (bool integer_keys : {true, false}) {
+    Comparator comparator(&key_schema, integer_keys);
+    RunNodeSearch(comparator, probes);
+    RunTreeLookup(config, comparator, probes);
+  }
+  return 0;
+}
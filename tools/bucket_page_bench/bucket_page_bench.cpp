@@ -0,0 +1,128 @@
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "argparse/argparse.hpp"
+#include "catalog/schema.h"
+#include "common/config.h"
+#include "common/rid.h"
+#include "fmt/core.h"
+#include "storage/index/generic_key.h"
+#include "storage/page/hash_table_bucket_page.h"
+#include "storage/page/hash_table_fingerprint_bucket_page.h"
+
+/**
+ * Lookup benchmark of the bucket pages of the disk extendible hash table: HashTableBucketPage, which compares the
+ * key of every slot, against HashTableFingerprintBucketPage, which compares a byte per slot with SIMD first.
+ *
+ * Every case fills a set of pages of 8 byte keys and RIDs to a load factor of their capacity, and then probes them
+ * with random keys, half of which are in the pages. The pages are plain memory, so the cases measure the probing
+ * alone, without the buffer pool.
+ */
+
+using Key = bustub::GenericKey<8>;
+using Comparator = bustub::GenericComparator<8>;
+using PlainPage = bustub::HashTableBucketPage<Key, bustub::RID, Comparator>;
+using FingerprintPage = bustub::HashTableFingerprintBucketPage<Key, bustub::RID, Comparator>;
+
+struct BucketPageBenchConfig {
+  size_t pages_{256};
+  size_t probes_{1000000};
+  uint64_t seed_{15445};
+};
+
+auto MakeKey(const bustub::Schema &schema, int32_t value) -> Key {
+  Key key;
+  key.SetFromKey(bustub::Tuple({bustub::Value(bustub::TypeId::INTEGER, value)}, &schema));
+  return key;
+}
+
+template <typename BucketPage>
+void RunCase(const char *structure, const BucketPageBenchConfig &config, double load_factor) {
+  bustub::Schema schema({bustub::Column("a", bustub::TypeId::INTEGER)});
+  Comparator cmp(&schema);
+  auto per_page = static_cast<int32_t>(BucketPage::ARRAY_SIZE * load_factor);
+  std::vector<char> memory(config.pages_ * bustub::BUSTUB_PAGE_SIZE, 0);
+  auto page = [&memory](size_t i) {
+    return reinterpret_cast<BucketPage *>(memory.data() + i * bustub::BUSTUB_PAGE_SIZE);
+  };
+
+  // Page i holds the even keys from i * 2 * per_page on.
+  for (size_t i = 0; i < config.pages_; i++) {
+    for (int32_t j = 0; j < per_page; j++) {
+      auto value = static_cast<int32_t>(i * 2 * per_page + 2 * j);
+      page(i)->Insert(MakeKey(schema, value), bustub::RID(value), cmp);
+    }
+  }
+  std::mt19937_64 rng(config.seed_);
+  std::uniform_int_distribution<size_t> page_dist(0, config.pages_ - 1);
+  std::uniform_int_distribution<int32_t> slot_dist(0, 2 * per_page - 1);
+  std::vector<std::pair<size_t, Key>> probes;
+  probes.reserve(config.probes_);
+  for (size_t i = 0; i < config.probes_; i++) {
+    size_t target = page_dist(rng);
+    probes.emplace_back(target, MakeKey(schema, static_cast<int32_t>(target * 2 * per_page + slot_dist(rng))));
+  }
+
+  uint64_t found = 0;
+  std::vector<bustub::RID> result;
+  auto start = std::chrono::steady_clock::now();
+  for (auto &[target, key] : probes) {
+    result.clear();
+    found += static_cast<uint64_t>(page(target)->GetValue(key, cmp, &result));
+  }
+  auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+
+  fmt::print("<<< BEGIN\n");
+  fmt::print("structure: {}\n", structure);
+  fmt::print("capacity: {}\n", BucketPage::ARRAY_SIZE);
+  fmt::print("load_factor: {:.2f}\n", load_factor);
+  fmt::print("operations: {}\n", config.probes_);
+  fmt::print("ns_per_operation: {:.1f}\n", static_cast<double>(elapsed.count()) / config.probes_);
+  fmt::print("operations_per_second: {:.0f}\n", config.probes_ * 1e9 / elapsed.count());
+  // Printed so that the compiler cannot drop the lookups.
+  fmt::print("checksum: {}\n", found);
+  fmt::print(">>> END\n");
+}
+
+// NOLINTNEXTLINE
+auto main(int argc, char **argv) -> int {
+  argparse::ArgumentParser program("bustub-bucket-page-bench");
+  program.add_argument("--pages").help("number of bucket pages of every case");
+  program.add_argument("--probes").help("number of lookups per case");
+
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::runtime_error &err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  BucketPageBenchConfig config;
+  if (program.present("--pages")) {
+    config.pages_ = std::max<size_t>(1, std::stoul(program.get("--pages")));
+  }
+  if (program.present("--probes")) {
+    config.probes_ = std::max<size_t>(1, std::stoul(program.get("--probes")));
+  }
+
+#if defined(__AVX2__)
+  const char *simd = "avx2";
+#elif defined(__SSE2__)
+  const char *simd = "sse2";
+#else
+  const char *simd = "none";
+#endif
+  fmt::print(stderr, "bucket-page-bench: pages={} probes={} simd={}\n", config.pages_, config.probes_, simd);
+
+  for (double load_factor : {0.5, 0.75, 0.9, 1.0}) {
+    RunCase<PlainPage>("hash_table_bucket_page", config, load_factor);
+    RunCase<FingerprintPage>("hash_table_fingerprint_bucket_page", config, load_factor);
+  }
+  return 0;
+}
@@ -0,0 +1,153 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "argparse/argparse.hpp"
+#include "buffer/buffer_pool_manager_instance.h"
+#include "catalog/schema.h"
+#include "fmt/core.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/index/extendible_hash_table_index.h"
+
+/**
+ * Multi-threaded benchmark of the ExtendibleHashTableIndex.
+ *
+ * For 1, 2, 4, ... up to the given number of threads, a new index on one INTEGER column is filled with the keys
+ * 0, 2, 4, ... in random order, the threads inserting disjoint shares of them, which splits buckets under the other
+ * threads. Then the threads probe random keys, half of which are not in the index, and finally remove every key,
+ * which merges the buckets again. Every phase reports its throughput.
+ */
+
+static const char *BENCH_DB_FILE = "disk_hash_bench.db";
+
+using HashIndex = bustub::ExtendibleHashTableIndex<bustub::GenericKey<8>, bustub::RID, bustub::GenericComparator<8>>;
+
+struct DiskHashBenchConfig {
+  size_t keys_{50000};
+  size_t probes_{500000};
+  size_t max_threads_{8};
+  size_t pool_size_{1024};
+  uint64_t seed_{15445};
+};
+
+/** Run op(i) for every i below count, split among threads, and report the time it took */
+void RunPhase(const char *phase, size_t threads, size_t count, const std::function<uint64_t(size_t)> &op) {
+  std::atomic<uint64_t> checksum{0};
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> workers;
+  for (size_t t = 0; t < threads; t++) {
+    workers.emplace_back([t, threads, count, &op, &checksum] {
+      uint64_t done = 0;
+      for (size_t i = t; i < count; i += threads) {
+        done += op(i);
+      }
+      checksum += done;
+    });
+  }
+  for (auto &worker : workers) {
+    worker.join();
+  }
+  auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+
+  fmt::print("<<< BEGIN\n");
+  fmt::print("structure: extendible_hash_table_index\n");
+  fmt::print("case: {}\n", phase);
+  fmt::print("threads: {}\n", threads);
+  fmt::print("operations: {}\n", count);
+  fmt::print("operations_per_second: {:.0f}\n", count * 1e9 / elapsed.count());
+  // The successful operations, printed so that the compiler cannot drop the lookups.
+  fmt::print("checksum: {}\n", checksum.load());
+  fmt::print(">>> END\n");
+}
+
+// NOLINTNEXTLINE
+auto main(int argc, char **argv) -> int {
+  argparse::ArgumentParser program("bustub-disk-hash-bench");
+  program.add_argument("--keys").help("number of keys in the index");
+  program.add_argument("--probes").help("number of lookups per case");
+  program.add_argument("--max-threads").help("highest number of threads, every power of two up to it is run");
+  program.add_argument("--pool-size").help("number of frames of the buffer pool");
+
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::runtime_error &err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  DiskHashBenchConfig config;
+  if (program.present("--keys")) {
+    config.keys_ = std::max<size_t>(1, std::stoul(program.get("--keys")));
+  }
+  if (program.present("--probes")) {
+    config.probes_ = std::max<size_t>(1, std::stoul(program.get("--probes")));
+  }
+  if (program.present("--max-threads")) {
+    config.max_threads_ = std::max<size_t>(1, std::stoul(program.get("--max-threads")));
+  }
+  if (program.present("--pool-size")) {
+    config.pool_size_ = std::max<size_t>(16, std::stoul(program.get("--pool-size")));
+  }
+
+  fmt::print(stderr, "disk-hash-bench: keys={} probes={} max_threads={} pool_size={}\n", config.keys_,
+             config.probes_, config.max_threads_, config.pool_size_);
+
+  bustub::Schema table_schema({bustub::Column("a", bustub::TypeId::INTEGER)});
+  std::mt19937_64 rng(config.seed_);
+  std::vector<int32_t> keys(config.keys_);
+  std::iota(keys.begin(), keys.end(), 0);
+  std::transform(keys.begin(), keys.end(), keys.begin(), [](int32_t key) { return 2 * key; });
+  std::shuffle(keys.begin(), keys.end(), rng);
+  std::uniform_int_distribution<int32_t> dist(0, static_cast<int32_t>(2 * config.keys_));
+  std::vector<int32_t> probes(config.probes_);
+  std::generate(probes.begin(), probes.end(), [&dist, &rng] { return dist(rng); });
+
+  auto to_tuples = [&table_schema](const std::vector<int32_t> &values) {
+    std::vector<bustub::Tuple> tuples;
+    tuples.reserve(values.size());
+    for (auto value : values) {
+      tuples.emplace_back(std::vector<bustub::Value>{bustub::Value(bustub::TypeId::INTEGER, value)}, &table_schema);
+    }
+    return tuples;
+  };
+  auto key_tuples = to_tuples(keys);
+  auto probe_tuples = to_tuples(probes);
+
+  for (size_t threads = 1; threads <= config.max_threads_; threads *= 2) {
+    auto disk_manager = std::make_unique<bustub::DiskManager>(BENCH_DB_FILE);
+    auto bpm = std::make_unique<bustub::BufferPoolManagerInstance>(config.pool_size_, disk_manager.get());
+    {
+      HashIndex index(
+          std::make_unique<bustub::IndexMetadata>("hash", "t", &table_schema, std::vector<uint32_t>{0}), bpm.get(),
+          bustub::HashFunction<bustub::GenericKey<8>>());
+      RunPhase("insert", threads, key_tuples.size(), [&index, &key_tuples](size_t i) -> uint64_t {
+        index.InsertEntry(key_tuples[i], bustub::RID(0, i), nullptr);
+        return 1;
+      });
+      RunPhase("lookup", threads, probe_tuples.size(), [&index, &probe_tuples](size_t i) -> uint64_t {
+        std::vector<bustub::RID> result;
+        index.ScanKey(probe_tuples[i], &result, nullptr);
+        return result.size();
+      });
+      RunPhase("remove", threads, key_tuples.size(), [&index, &key_tuples](size_t i) -> uint64_t {
+        index.DeleteEntry(key_tuples[i], bustub::RID(0, i), nullptr);
+        return 1;
+      });
+    }
+    bpm.reset();
+    disk_manager->ShutDown();
+    std::remove(BENCH_DB_FILE);
+    std::remove("disk_hash_bench.log");
+  }
+  return 0;
+}
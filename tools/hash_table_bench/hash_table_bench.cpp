@@ -0,0 +1,172 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "argparse/argparse.hpp"
+#include "common/config.h"
+#include "container/hash/concurrent_extendible_hash_table.h"
+#include "container/hash/extendible_hash_table.h"
+#include "fmt/core.h"
+
+/**
+ * Throughput benchmark of the ConcurrentExtendibleHashTable against the ExtendibleHashTable, which serializes every
+ * operation on one mutex.
+ *
+ * Both tables are loaded with half of the key space, then every thread runs its share of a mix of lookups, inserts
+ * and removals of random keys from the whole key space, mostly lookups by default. The mix runs at 1, 2, 4, ... up to
+ * the given number of threads, on a new table every time.
+ *
+ * The churn case then measures the memory the ExtendibleHashTable holds over rounds that insert the whole key space
+ * and remove it again, to show that the table shrinks back after every spike.
+ */
+
+struct HashTableBenchConfig {
+  size_t keys_{1 << 20};
+  size_t operations_{4000000};
+  size_t max_threads_{32};
+  /** Out of 100 operations, the ones that are inserts and the ones that are removals; the others are lookups */
+  size_t insert_percent_{5};
+  size_t remove_percent_{5};
+  size_t churn_rounds_{3};
+  uint64_t seed_{15445};
+};
+
+template <typename Table>
+void RunMix(const char *structure, const HashTableBenchConfig &config, size_t threads) {
+  Table table(bustub::BUCKET_SIZE);
+  for (size_t key = 0; key < config.keys_; key += 2) {
+    table.Insert(static_cast<int>(key), static_cast<int>(key));
+  }
+
+  std::atomic<uint64_t> checksum{0};
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> workers;
+  for (size_t t = 0; t < threads; t++) {
+    workers.emplace_back([t, threads, &config, &table, &checksum] {
+      std::mt19937_64 rng(config.seed_ + t);
+      std::uniform_int_distribution<int> key_dist(0, static_cast<int>(config.keys_) - 1);
+      std::uniform_int_distribution<size_t> op_dist(0, 99);
+      uint64_t found = 0;
+      for (size_t i = t; i < config.operations_; i += threads) {
+        int key = key_dist(rng);
+        size_t op = op_dist(rng);
+        if (op < config.insert_percent_) {
+          table.Insert(key, key);
+        } else if (op < config.insert_percent_ + config.remove_percent_) {
+          found += static_cast<uint64_t>(table.Remove(key));
+        } else {
+          int value;
+          found += static_cast<uint64_t>(table.Find(key, value));
+        }
+      }
+      checksum += found;
+    });
+  }
+  for (auto &worker : workers) {
+    worker.join();
+  }
+  auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+
+  fmt::print("<<< BEGIN\n");
+  fmt::print("structure: {}\n", structure);
+  fmt::print("threads: {}\n", threads);
+  fmt::print("operations: {}\n", config.operations_);
+  fmt::print("operations_per_second: {:.0f}\n", config.operations_ * 1e9 / elapsed.count());
+  fmt::print("global_depth: {}\n", table.GetGlobalDepth());
+  fmt::print("buckets: {}\n", table.GetNumBuckets());
+  // Printed so that the compiler cannot drop the lookups.
+  fmt::print("checksum: {}\n", checksum.load());
+  fmt::print(">>> END\n");
+}
+
+/** Print the shape and memory of the table after a step of the churn case */
+void ReportChurn(const bustub::ExtendibleHashTable<int, int> &table, size_t round, const char *step) {
+  fmt::print("<<< BEGIN\n");
+  fmt::print("structure: extendible_hash_table\n");
+  fmt::print("case: churn\n");
+  fmt::print("round: {}\n", round);
+  fmt::print("step: {}\n", step);
+  fmt::print("global_depth: {}\n", table.GetGlobalDepth());
+  fmt::print("buckets: {}\n", table.GetNumBuckets());
+  fmt::print("memory_bytes: {}\n", table.GetMemoryUsage());
+  fmt::print(">>> END\n");
+}
+
+void RunChurn(const HashTableBenchConfig &config) {
+  bustub::ExtendibleHashTable<int, int> table(bustub::BUCKET_SIZE);
+  std::mt19937_64 rng(config.seed_);
+  std::vector<int> keys(config.keys_);
+  for (size_t i = 0; i < keys.size(); i++) {
+    keys[i] = static_cast<int>(i);
+  }
+  ReportChurn(table, 0, "start");
+  for (size_t round = 1; round <= config.churn_rounds_; round++) {
+    std::shuffle(keys.begin(), keys.end(), rng);
+    for (auto key : keys) {
+      table.Insert(key, key);
+    }
+    ReportChurn(table, round, "grown");
+    std::shuffle(keys.begin(), keys.end(), rng);
+    for (auto key : keys) {
+      table.Remove(key);
+    }
+    ReportChurn(table, round, "shrunk");
+  }
+}
+
+// NOLINTNEXTLINE
+auto main(int argc, char **argv) -> int {
+  argparse::ArgumentParser program("bustub-hash-table-bench");
+  program.add_argument("--keys").help("size of the key space, half of which is loaded up front");
+  program.add_argument("--operations").help("number of operations per case, split among the threads");
+  program.add_argument("--max-threads").help("highest number of threads, every power of two up to it is run");
+  program.add_argument("--insert-percent").help("percentage of the operations that are inserts");
+  program.add_argument("--remove-percent").help("percentage of the operations that are removals");
+  program.add_argument("--churn-rounds").help("number of times the churn case fills and empties the table");
+
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::runtime_error &err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  HashTableBenchConfig config;
+  if (program.present("--keys")) {
+    config.keys_ = std::max<size_t>(2, std::stoul(program.get("--keys")));
+  }
+  if (program.present("--operations")) {
+    config.operations_ = std::max<size_t>(1, std::stoul(program.get("--operations")));
+  }
+  if (program.present("--max-threads")) {
+    config.max_threads_ = std::max<size_t>(1, std::stoul(program.get("--max-threads")));
+  }
+  if (program.present("--insert-percent")) {
+    config.insert_percent_ = std::min<size_t>(100, std::stoul(program.get("--insert-percent")));
+  }
+  if (program.present("--remove-percent")) {
+    config.remove_percent_ =
+        std::min<size_t>(100 - config.insert_percent_, std::stoul(program.get("--remove-percent")));
+  }
+
+  if (program.present("--churn-rounds")) {
+    config.churn_rounds_ = std::stoul(program.get("--churn-rounds"));
+  }
+
+  fmt::print(stderr, "hash-table-bench: keys={} operations={} max_threads={} insert={}% remove={}%\n", config.keys_,
+             config.operations_, config.max_threads_, config.insert_percent_, config.remove_percent_);
+
+  for (size_t threads = 1; threads <= config.max_threads_; threads *= 2) {
+    RunMix<bustub::ExtendibleHashTable<int, int>>("extendible_hash_table", config, threads);
+    RunMix<bustub::ConcurrentExtendibleHashTable<int, int>>("concurrent_extendible_hash_table", config, threads);
+  }
+  RunChurn(config);
+  return 0;
+}
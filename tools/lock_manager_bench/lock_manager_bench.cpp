@@ -0,0 +1,231 @@
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "argparse/argparse.hpp"
+#include "concurrency/lock_manager.h"
+#include "concurrency/transaction.h"
+#include "concurrency/transaction_manager.h"
+#include "fmt/core.h"
+
+#include <sys/time.h>
+
+/**
+ * Row-locking contention benchmark that drives LockManager directly, without the SQL layer.
+ *
+ * Every worker runs short transactions that take an IX lock on one table and then S/X locks on a handful of rows.
+ * A fraction of the row accesses (--hot-ratio) goes to a small set of hot rows (--hot-rows), the rest is spread
+ * uniformly over the table, so the skew can be dialed from "no conflicts" to "everyone fights over one row".
+ */
+
+static const bustub::table_oid_t BENCH_TABLE_OID = 0;
+static const uint32_t BENCH_SLOTS_PER_PAGE = 64;
+
+auto ClockMs() -> uint64_t {
+  struct timeval tm;
+  gettimeofday(&tm, nullptr);
+  return static_cast<uint64_t>(tm.tv_sec * 1000) + static_cast<uint64_t>(tm.tv_usec / 1000);
+}
+
+struct LockBenchConfig {
+  size_t threads_{8};
+  size_t rows_{100000};
+  size_t rows_per_txn_{8};
+  size_t hot_rows_{16};
+  double hot_ratio_{0.5};
+  double read_ratio_{0.5};
+  bool ordered_{true};
+  bustub::LockManager::DeadlockPolicy deadlock_policy_{bustub::LockManager::DeadlockPolicy::DETECTION};
+  uint64_t duration_ms_{5000};
+};
+
+struct LockBenchTotalMetrics {
+  uint64_t committed_txn_cnt_{0};
+  uint64_t aborted_txn_cnt_{0};
+  uint64_t lock_cnt_{0};
+  std::vector<uint64_t> latencies_us_;
+  uint64_t start_time_{0};
+  std::mutex mutex_;
+
+  void Begin() { start_time_ = ClockMs(); }
+
+  void Report(uint64_t committed, uint64_t aborted, uint64_t locks, const std::vector<uint64_t> &latencies_us) {
+    std::unique_lock<std::mutex> l(mutex_);
+    committed_txn_cnt_ += committed;
+    aborted_txn_cnt_ += aborted;
+    lock_cnt_ += locks;
+    latencies_us_.insert(latencies_us_.end(), latencies_us.begin(), latencies_us.end());
+  }
+
+  auto Percentile(double p) -> uint64_t {
+    if (latencies_us_.empty()) {
+      return 0;
+    }
+    auto idx = static_cast<size_t>(p * static_cast<double>(latencies_us_.size() - 1));
+    std::nth_element(latencies_us_.begin(), latencies_us_.begin() + idx, latencies_us_.end());
+    return latencies_us_[idx];
+  }
+
+  void Print() {
+    auto elapsed = ClockMs() - start_time_;
+    auto total = committed_txn_cnt_ + aborted_txn_cnt_;
+    fmt::print("<<< BEGIN\n");
+    fmt::print("committed_txn: {}\n", committed_txn_cnt_);
+    fmt::print("aborted_txn: {}\n", aborted_txn_cnt_);
+    fmt::print("abort_rate: {:.4f}\n", total == 0 ? 0.0 : aborted_txn_cnt_ / static_cast<double>(total));
+    fmt::print("txn_per_sec: {:.1f}\n", committed_txn_cnt_ / static_cast<double>(elapsed) * 1000);
+    fmt::print("lock_per_sec: {:.1f}\n", lock_cnt_ / static_cast<double>(elapsed) * 1000);
+    fmt::print("txn_latency_p50_us: {}\n", Percentile(0.50));
+    fmt::print("txn_latency_p99_us: {}\n", Percentile(0.99));
+    fmt::print("txn_latency_p999_us: {}\n", Percentile(0.999));
+    fmt::print(">>> END\n");
+  }
+};
+
+// NOLINTNEXTLINE
+auto main(int argc, char **argv) -> int {
+  argparse::ArgumentParser program("bustub-lock-manager-bench");
+  program.add_argument("--duration").help("run the benchmark for n milliseconds");
+  program.add_argument("--threads").help("number of worker threads");
+  program.add_argument("--rows").help("number of rows in the table");
+  program.add_argument("--rows-per-txn").help("number of rows locked by each transaction");
+  program.add_argument("--hot-rows").help("number of hot rows");
+  program.add_argument("--hot-ratio").help("fraction of row accesses that go to the hot rows");
+  program.add_argument("--read-ratio").help("fraction of row accesses that take S instead of X locks");
+  program.add_argument("--ordered").help("lock rows in RID order (no deadlocks) instead of access order");
+  program.add_argument("--deadlock-policy").help("deadlock handling: detection, wait-die or wound-wait");
+
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::runtime_error &err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  LockBenchConfig config;
+  if (program.present("--duration")) {
+    config.duration_ms_ = std::stoul(program.get("--duration"));
+  }
+  if (program.present("--threads")) {
+    config.threads_ = std::stoul(program.get("--threads"));
+  }
+  if (program.present("--rows")) {
+    config.rows_ = std::stoul(program.get("--rows"));
+  }
+  if (program.present("--rows-per-txn")) {
+    config.rows_per_txn_ = std::stoul(program.get("--rows-per-txn"));
+  }
+  if (program.present("--hot-rows")) {
+    config.hot_rows_ = std::max<size_t>(1, std::stoul(program.get("--hot-rows")));
+  }
+  if (program.present("--hot-ratio")) {
+    config.hot_ratio_ = std::stod(program.get("--hot-ratio"));
+  }
+  if (program.present("--read-ratio")) {
+    config.read_ratio_ = std::stod(program.get("--read-ratio"));
+  }
+  if (program.present("--ordered")) {
+    config.ordered_ = program.get("--ordered") != "false" && program.get("--ordered") != "no";
+  }
+  std::string policy_name = "detection";
+  if (program.present("--deadlock-policy")) {
+    policy_name = program.get("--deadlock-policy");
+    if (policy_name == "wait-die") {
+      config.deadlock_policy_ = bustub::LockManager::DeadlockPolicy::WAIT_DIE;
+    } else if (policy_name == "wound-wait") {
+      config.deadlock_policy_ = bustub::LockManager::DeadlockPolicy::WOUND_WAIT;
+    } else if (policy_name != "detection") {
+      std::cerr << "unknown deadlock policy: " << policy_name << std::endl;
+      return 1;
+    }
+  }
+
+  fmt::print(stderr,
+             "lock-manager-bench: threads={} rows={} rows_per_txn={} hot_rows={} hot_ratio={} read_ratio={} ordered={} "
+             "deadlock_policy={}\n",
+             config.threads_, config.rows_, config.rows_per_txn_, config.hot_rows_, config.hot_ratio_,
+             config.read_ratio_, config.ordered_, policy_name);
+
+  bustub::LockManager lock_manager(config.deadlock_policy_);
+  bustub::TransactionManager txn_manager(&lock_manager);
+
+  LockBenchTotalMetrics total_metrics;
+  std::vector<std::thread> threads;
+  total_metrics.Begin();
+
+  for (size_t thread_id = 0; thread_id < config.threads_; thread_id++) {
+    threads.emplace_back([&config, &lock_manager, &txn_manager, &total_metrics, thread_id] {
+      std::default_random_engine gen(thread_id * 7919 + 1);
+      std::uniform_real_distribution<double> coin(0, 1);
+      std::uniform_int_distribution<size_t> hot_dist(0, config.hot_rows_ - 1);
+      std::uniform_int_distribution<size_t> cold_dist(0, config.rows_ - 1);
+
+      uint64_t committed = 0;
+      uint64_t aborted = 0;
+      uint64_t locks = 0;
+      std::vector<uint64_t> latencies_us;
+      auto start = ClockMs();
+
+      std::vector<std::pair<size_t, bool>> accesses;
+      while (ClockMs() - start < config.duration_ms_) {
+        accesses.clear();
+        for (size_t i = 0; i < config.rows_per_txn_; i++) {
+          size_t row = coin(gen) < config.hot_ratio_ ? hot_dist(gen) : cold_dist(gen);
+          accesses.emplace_back(row, coin(gen) >= config.read_ratio_);
+        }
+        if (config.ordered_) {
+          // Sorting by row with X first means a row is never upgraded, so the workload is deadlock free.
+          std::sort(accesses.begin(), accesses.end(),
+                    [](const auto &a, const auto &b) { return a.first != b.first ? a.first < b.first : a.second; });
+        }
+
+        auto txn_start = std::chrono::steady_clock::now();
+        auto *txn = txn_manager.Begin();
+        bool success = true;
+        try {
+          success = lock_manager.LockTable(txn, bustub::LockManager::LockMode::INTENTION_EXCLUSIVE, BENCH_TABLE_OID);
+          for (size_t i = 0; success && i < accesses.size(); i++) {
+            auto [row, exclusive] = accesses[i];
+            bustub::RID rid(static_cast<bustub::page_id_t>(row / BENCH_SLOTS_PER_PAGE), row % BENCH_SLOTS_PER_PAGE);
+            if (txn->IsRowExclusiveLocked(BENCH_TABLE_OID, rid) ||
+                (!exclusive && txn->IsRowSharedLocked(BENCH_TABLE_OID, rid))) {
+              continue;
+            }
+            auto mode = exclusive ? bustub::LockManager::LockMode::EXCLUSIVE : bustub::LockManager::LockMode::SHARED;
+            success = lock_manager.LockRow(txn, mode, BENCH_TABLE_OID, rid);
+            locks++;
+          }
+        } catch (bustub::TransactionAbortException &e) {
+          success = false;
+        }
+        // Under wound-wait an older transaction may have aborted this one after its last lock was granted.
+        if (success && txn->GetState() != bustub::TransactionState::ABORTED) {
+          txn_manager.Commit(txn);
+          committed++;
+        } else {
+          txn_manager.Abort(txn);
+          aborted++;
+        }
+        delete txn;
+        latencies_us.push_back(std::chrono::duration_cast<std::chrono::microseconds>(
+                                   std::chrono::steady_clock::now() - txn_start)
+                                   .count());
+      }
+      total_metrics.Report(committed, aborted, locks, latencies_us);
+    });
+  }
+
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  total_metrics.Print();
+  return 0;
+}
@@ -120,6 +120,7 @@ auto main(int argc, char **argv) -> int {
   program.add_argument("--duration").help("run terrier bench for n milliseconds");
   program.add_argument("--force-create-index").help("create index in terrier bench");
   program.add_argument("--force-enable-update").help("use update statement in terrier bench");
+  program.add_argument("--concurrency-control").help("concurrency control of the workers: 2pl or occ");
 
   try {
     program.parse_args(argc, argv);
@@ -172,6 +173,18 @@ auto main(int argc, char **argv) -> int {
     std::cerr << "x: use insert + delete" << std::endl;
   }
 
+  auto concurrency_control = bustub::ConcurrencyControl::TWO_PHASE_LOCKING;
+  if (program.present("--concurrency-control")) {
+    auto name = program.get("--concurrency-control");
+    if (name == "occ") {
+      concurrency_control = bustub::ConcurrencyControl::OPTIMISTIC;
+    } else if (name != "2pl") {
+      throw bustub::Exception(fmt::format("unexpected arg: {}", name));
+    }
+  }
+  std::cerr << "x: use " << (concurrency_control == bustub::ConcurrencyControl::OPTIMISTIC ? "occ" : "2pl")
+            << " concurrency control" << std::endl;
+
   uint64_t duration_ms = 30000;
 
   if (program.present("--duration")) {
@@ -213,7 +226,8 @@ auto main(int argc, char **argv) -> int {
   total_metrics.Begin();
 
   for (size_t thread_id = 0; thread_id < BUSTUB_TERRIER_THREAD; thread_id++) {
-    threads.emplace_back(std::thread([thread_id, &bustub, enable_update, duration_ms, &total_metrics] {
+    threads.emplace_back(std::thread([thread_id, &bustub, enable_update, concurrency_control, duration_ms,
+                                      &total_metrics] {
       const size_t nft_range_size = BUSTUB_NFT_NUM / BUSTUB_TERRIER_THREAD;
       const size_t nft_range_begin = thread_id * nft_range_size;
       const size_t nft_range_end = (thread_id + 1) * nft_range_size;
@@ -233,7 +247,7 @@ auto main(int argc, char **argv) -> int {
         bool txn_success = true;
 
         if (enable_update) {
-          auto txn = bustub->txn_manager_->Begin(nullptr, bustub::IsolationLevel::REPEATABLE_READ);
+          auto txn = bustub->txn_manager_->Begin(nullptr, bustub::IsolationLevel::REPEATABLE_READ, concurrency_control);
           std::string query = fmt::format("UPDATE nft SET terrier = {} WHERE id = {}", terrier_id, nft_id);
           if (!bustub->ExecuteSqlTxn(query, writer, txn)) {
             txn_success = false;
@@ -244,16 +258,18 @@ auto main(int argc, char **argv) -> int {
             exit(1);
           }
 
-          if (txn_success) {
-            bustub->txn_manager_->Commit(txn);
+          if (!txn_success) {
+            bustub->txn_manager_->Abort(txn);
+            metrics.TxnAborted();
+          } else if (bustub->txn_manager_->Commit(txn)) {
             metrics.TxnCommitted();
           } else {
-            bustub->txn_manager_->Abort(txn);
+            // An optimistic transaction failed its validation, Commit() aborted it.
             metrics.TxnAborted();
           }
           delete txn;
         } else {
-          auto txn = bustub->txn_manager_->Begin(nullptr, bustub::IsolationLevel::REPEATABLE_READ);
+          auto txn = bustub->txn_manager_->Begin(nullptr, bustub::IsolationLevel::REPEATABLE_READ, concurrency_control);
 
           std::string query = fmt::format("DELETE FROM nft WHERE id = {}", nft_id);
           if (!bustub->ExecuteSqlTxn(query, writer, txn)) {
@@ -269,11 +285,13 @@ auto main(int argc, char **argv) -> int {
             bustub->txn_manager_->Abort(txn);
             metrics.TxnAborted();
             delete txn;
+          } else if (!bustub->txn_manager_->Commit(txn)) {
+            metrics.TxnAborted();
+            delete txn;
           } else {
-            bustub->txn_manager_->Commit(txn);
             delete txn;
 
-            txn = bustub->txn_manager_->Begin(nullptr, bustub::IsolationLevel::REPEATABLE_READ);
+            txn = bustub->txn_manager_->Begin(nullptr, bustub::IsolationLevel::REPEATABLE_READ, concurrency_control);
 
             query = fmt::format("INSERT INTO nft VALUES ({}, {})", nft_id, terrier_id);
             if (!bustub->ExecuteSqlTxn(query, writer, txn)) {
@@ -288,9 +306,10 @@ auto main(int argc, char **argv) -> int {
             if (!txn_success) {
               bustub->txn_manager_->Abort(txn);
               metrics.TxnAborted();
-            } else {
-              bustub->txn_manager_->Commit(txn);
+            } else if (bustub->txn_manager_->Commit(txn)) {
               metrics.TxnCommitted();
+            } else {
+              metrics.TxnAborted();
             }
             delete txn;
           }
@@ -304,7 +323,7 @@ auto main(int argc, char **argv) -> int {
   }
 
   for (size_t thread_id = 0; thread_id < BUSTUB_TERRIER_THREAD; thread_id++) {
-    threads.emplace_back(std::thread([thread_id, &bustub, duration_ms, &total_metrics] {
+    threads.emplace_back(std::thread([thread_id, &bustub, concurrency_control, duration_ms, &total_metrics] {
       std::random_device r;
       std::default_random_engine gen(r());
       std::uniform_int_distribution<int> terrier_uniform_dist(0, BUSTUB_TERRIER_CNT - 1);
@@ -317,7 +336,7 @@ auto main(int argc, char **argv) -> int {
         auto writer = bustub::SimpleStreamWriter(ss, true);
         auto terrier_id = terrier_uniform_dist(gen);
 
-        auto txn = bustub->txn_manager_->Begin(nullptr, bustub::IsolationLevel::REPEATABLE_READ);
+        auto txn = bustub->txn_manager_->Begin(nullptr, bustub::IsolationLevel::REPEATABLE_READ, concurrency_control);
         bool txn_success = true;
 
         std::string query = fmt::format("SELECT count(*) FROM nft WHERE terrier = {}", terrier_id);
@@ -325,11 +344,12 @@ auto main(int argc, char **argv) -> int {
           txn_success = false;
         }
 
-        if (txn_success) {
-          bustub->txn_manager_->Commit(txn);
+        if (!txn_success) {
+          bustub->txn_manager_->Abort(txn);
+          metrics.TxnAborted();
+        } else if (bustub->txn_manager_->Commit(txn)) {
           metrics.TxnCommitted();
         } else {
-          bustub->txn_manager_->Abort(txn);
           metrics.TxnAborted();
         }
         delete txn;
@@ -0,0 +1,300 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "argparse/argparse.hpp"
+#include "buffer/buffer_pool_manager_instance.h"
+#include "catalog/catalog.h"
+#include "concurrency/lock_manager.h"
+#include "concurrency/transaction.h"
+#include "concurrency/transaction_manager.h"
+#include "fmt/core.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/table/table_heap.h"
+#include "type/value_factory.h"
+
+#include <sys/time.h>
+
+/**
+ * Begin/commit throughput benchmark that drives TransactionManager directly, without the SQL layer.
+ *
+ * The default commit workload takes no locks: every worker runs empty transactions back to back. With --writes-per-txn above zero each transaction carries that
+ * many table write records, so its commit takes a commit timestamp and stamps versions like a real writer does.
+ * By default the benchmark sweeps 1, 2, 4, ..., 64 threads and prints one result block per thread count.
+ *
+ * --workload update runs point updates through the table heap instead: every transaction rewrites a column of
+ * --writes-per-txn random rows out of --rows, visiting them in RID order. --concurrency-control picks how the updates
+ * are isolated: 2pl X locks each row before reading it, occ buffers the updates and validates them at commit.
+ */
+
+static const char *BENCH_DB_FILE = "txn_manager_bench.db";
+static const size_t BENCH_POOL_SIZE = 256;
+
+auto ClockMs() -> uint64_t {
+  struct timeval tm;
+  gettimeofday(&tm, nullptr);
+  return static_cast<uint64_t>(tm.tv_sec * 1000) + static_cast<uint64_t>(tm.tv_usec / 1000);
+}
+
+struct TxnBenchConfig {
+  size_t min_threads_{1};
+  size_t max_threads_{64};
+  size_t writes_per_txn_{1};
+  bustub::IsolationLevel isolation_level_{bustub::IsolationLevel::REPEATABLE_READ};
+  uint64_t duration_ms_{2000};
+  bool update_workload_{false};
+  size_t rows_{1000};
+  bustub::ConcurrencyControl concurrency_control_{bustub::ConcurrencyControl::TWO_PHASE_LOCKING};
+};
+
+auto RunOnce(const TxnBenchConfig &config, size_t thread_cnt, bustub::TableHeap *table) -> void {
+  bustub::LockManager lock_manager;
+  bustub::TransactionManager txn_manager(&lock_manager);
+  std::vector<uint64_t> committed(thread_cnt, 0);
+  std::vector<std::thread> threads;
+
+  auto start = ClockMs();
+  for (size_t thread_id = 0; thread_id < thread_cnt; thread_id++) {
+    threads.emplace_back([&config, &txn_manager, &committed, table, thread_id, start] {
+      uint64_t cnt = 0;
+      while (ClockMs() - start < config.duration_ms_) {
+        auto *txn = txn_manager.Begin(nullptr, config.isolation_level_);
+        for (size_t i = 0; i < config.writes_per_txn_; i++) {
+          // The RIDs have no version chain, committing them only costs the commit timestamp bookkeeping.
+          bustub::RID rid(static_cast<bustub::page_id_t>(thread_id), i);
+          txn->AppendTableWriteRecord(bustub::TableWriteRecord(rid, bustub::WType::UPDATE, table));
+        }
+        txn_manager.Commit(txn);
+        delete txn;
+        cnt++;
+      }
+      committed[thread_id] = cnt;
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  auto elapsed = ClockMs() - start;
+
+  uint64_t total = 0;
+  for (auto cnt : committed) {
+    total += cnt;
+  }
+  fmt::print("<<< BEGIN\n");
+  fmt::print("threads: {}\n", thread_cnt);
+  fmt::print("committed_txn: {}\n", total);
+  fmt::print("txn_per_sec: {:.1f}\n", total / static_cast<double>(elapsed) * 1000);
+  fmt::print("last_commit_ts: {}\n", txn_manager.GetLastCommitTs());
+  fmt::print(">>> END\n");
+}
+
+/** Add one to the second column of every row, locking them first under 2PL. @return false if txn has to abort */
+auto UpdateRows(bustub::Transaction *txn, bustub::LockManager *lock_manager, bustub::Catalog *catalog,
+                bustub::TableInfo *table_info, const std::vector<bustub::RID> &rids) -> bool {
+  auto oid = table_info->oid_;
+  auto *table = table_info->table_.get();
+  auto *schema = &table_info->schema_;
+  try {
+    if (!txn->IsOptimistic() &&
+        !lock_manager->LockTable(txn, bustub::LockManager::LockMode::INTENTION_EXCLUSIVE, oid)) {
+      return false;
+    }
+    for (const auto &rid : rids) {
+      if (!txn->IsOptimistic() && !lock_manager->LockRow(txn, bustub::LockManager::LockMode::EXCLUSIVE, oid, rid)) {
+        return false;
+      }
+      bustub::Tuple old_tuple;
+      if (!table->GetTuple(rid, &old_tuple, txn)) {
+        return false;
+      }
+      auto value = old_tuple.GetValue(schema, 1).GetAs<int32_t>();
+      bustub::Tuple new_tuple({old_tuple.GetValue(schema, 0), bustub::ValueFactory::GetIntegerValue(value + 1)},
+                              schema);
+      if (txn->IsOptimistic()) {
+        bustub::OptimisticWriteRecord record(rid, bustub::WType::UPDATE, new_tuple, oid, table, catalog);
+        record.old_tuple_ = old_tuple;
+        txn->GetOptimisticWriteSet()->push_back(record);
+      } else if (!table->UpdateTuple(new_tuple, rid, txn)) {
+        return false;
+      }
+    }
+  } catch (bustub::TransactionAbortException &e) {
+    return false;
+  }
+  return true;
+}
+
+auto RunUpdates(const TxnBenchConfig &config, size_t thread_cnt, bustub::Catalog *catalog,
+                bustub::TableInfo *table_info, const std::vector<bustub::RID> &rids) -> void {
+  bustub::LockManager lock_manager;
+  bustub::TransactionManager txn_manager(&lock_manager);
+  std::vector<uint64_t> committed(thread_cnt, 0);
+  std::vector<uint64_t> aborted(thread_cnt, 0);
+  std::vector<std::thread> threads;
+
+  auto start = ClockMs();
+  for (size_t thread_id = 0; thread_id < thread_cnt; thread_id++) {
+    threads.emplace_back([&, thread_id] {
+      std::mt19937_64 rng(thread_id);
+      std::uniform_int_distribution<size_t> dist(0, rids.size() - 1);
+      std::vector<bustub::RID> picked;
+      uint64_t committed_cnt = 0;
+      uint64_t aborted_cnt = 0;
+      while (ClockMs() - start < config.duration_ms_) {
+        picked.clear();
+        for (size_t i = 0; i < config.writes_per_txn_; i++) {
+          picked.push_back(rids[dist(rng)]);
+        }
+        // Locking in RID order keeps 2PL free of deadlocks.
+        std::sort(picked.begin(), picked.end(), [](const auto &a, const auto &b) { return a.Get() < b.Get(); });
+        picked.erase(std::unique(picked.begin(), picked.end()), picked.end());
+        auto *txn = txn_manager.Begin(nullptr, config.isolation_level_, config.concurrency_control_);
+        bool ok = UpdateRows(txn, &lock_manager, catalog, table_info, picked);
+        if (ok) {
+          ok = txn_manager.Commit(txn);
+        } else {
+          txn_manager.Abort(txn);
+        }
+        delete txn;
+        if (ok) {
+          committed_cnt++;
+        } else {
+          aborted_cnt++;
+        }
+      }
+      committed[thread_id] = committed_cnt;
+      aborted[thread_id] = aborted_cnt;
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  auto elapsed = ClockMs() - start;
+
+  uint64_t total_committed = 0;
+  uint64_t total_aborted = 0;
+  for (size_t thread_id = 0; thread_id < thread_cnt; thread_id++) {
+    total_committed += committed[thread_id];
+    total_aborted += aborted[thread_id];
+  }
+  fmt::print("<<< BEGIN\n");
+  fmt::print("threads: {}\n", thread_cnt);
+  fmt::print("committed_txn: {}\n", total_committed);
+  fmt::print("aborted_txn: {}\n", total_aborted);
+  fmt::print("txn_per_sec: {:.1f}\n", total_committed / static_cast<double>(elapsed) * 1000);
+  fmt::print("aborted_per_sec: {:.1f}\n", total_aborted / static_cast<double>(elapsed) * 1000);
+  fmt::print(">>> END\n");
+}
+
+// NOLINTNEXTLINE
+auto main(int argc, char **argv) -> int {
+  argparse::ArgumentParser program("bustub-txn-manager-bench");
+  program.add_argument("--duration").help("run each thread count for n milliseconds");
+  program.add_argument("--threads").help("run a single thread count instead of sweeping 1 to 64");
+  program.add_argument("--writes-per-txn").help("number of write records committed by each transaction");
+  program.add_argument("--isolation").help("isolation level of the transactions: rr or si");
+  program.add_argument("--workload").help("commit (empty transactions) or update (point updates of table rows)");
+  program.add_argument("--rows").help("number of rows the update workload picks from");
+  program.add_argument("--concurrency-control").help("concurrency control of the update workload: 2pl or occ");
+
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::runtime_error &err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  TxnBenchConfig config;
+  if (program.present("--duration")) {
+    config.duration_ms_ = std::stoul(program.get("--duration"));
+  }
+  if (program.present("--threads")) {
+    config.min_threads_ = config.max_threads_ = std::max<size_t>(1, std::stoul(program.get("--threads")));
+  }
+  if (program.present("--writes-per-txn")) {
+    config.writes_per_txn_ = std::stoul(program.get("--writes-per-txn"));
+  }
+  std::string isolation_name = "rr";
+  if (program.present("--isolation")) {
+    isolation_name = program.get("--isolation");
+    if (isolation_name == "si") {
+      config.isolation_level_ = bustub::IsolationLevel::SNAPSHOT_ISOLATION;
+    } else if (isolation_name != "rr") {
+      std::cerr << "unknown isolation level: " << isolation_name << std::endl;
+      return 1;
+    }
+  }
+
+  std::string workload_name = "commit";
+  if (program.present("--workload")) {
+    workload_name = program.get("--workload");
+    config.update_workload_ = workload_name == "update";
+    if (!config.update_workload_ && workload_name != "commit") {
+      std::cerr << "unknown workload: " << workload_name << std::endl;
+      return 1;
+    }
+  }
+  if (program.present("--rows")) {
+    config.rows_ = std::max<size_t>(1, std::stoul(program.get("--rows")));
+  }
+  std::string cc_name = "2pl";
+  if (program.present("--concurrency-control")) {
+    cc_name = program.get("--concurrency-control");
+    if (cc_name == "occ") {
+      config.concurrency_control_ = bustub::ConcurrencyControl::OPTIMISTIC;
+    } else if (cc_name != "2pl") {
+      std::cerr << "unknown concurrency control: " << cc_name << std::endl;
+      return 1;
+    }
+  }
+
+  fmt::print(stderr, "txn-manager-bench: workload={} threads={}..{} writes_per_txn={} isolation={}", workload_name,
+             config.min_threads_, config.max_threads_, config.writes_per_txn_, isolation_name);
+  if (config.update_workload_) {
+    fmt::print(stderr, " rows={} concurrency_control={}", config.rows_, cc_name);
+  }
+  fmt::print(stderr, "\n");
+
+  auto disk_manager = std::make_unique<bustub::DiskManager>(BENCH_DB_FILE);
+  auto bpm = std::make_unique<bustub::BufferPoolManagerInstance>(BENCH_POOL_SIZE, disk_manager.get());
+  if (config.update_workload_) {
+    bustub::Catalog catalog(bpm.get(), nullptr, nullptr);
+    bustub::Schema schema({bustub::Column("k", bustub::TypeId::INTEGER), bustub::Column("v", bustub::TypeId::INTEGER)});
+    std::vector<bustub::RID> rids(config.rows_);
+    bustub::TableInfo *table_info;
+    {
+      bustub::LockManager lock_manager;
+      bustub::TransactionManager txn_manager(&lock_manager);
+      auto *txn = txn_manager.Begin();
+      table_info = catalog.CreateTable(txn, "bench", schema);
+      for (size_t i = 0; i < config.rows_; i++) {
+        bustub::Tuple tuple({bustub::ValueFactory::GetIntegerValue(static_cast<int32_t>(i)),
+                             bustub::ValueFactory::GetIntegerValue(0)},
+                            &schema);
+        table_info->table_->InsertTuple(tuple, &rids[i], txn);
+      }
+      txn_manager.Commit(txn);
+      delete txn;
+    }
+    for (size_t thread_cnt = config.min_threads_; thread_cnt <= config.max_threads_; thread_cnt *= 2) {
+      RunUpdates(config, thread_cnt, &catalog, table_info, rids);
+    }
+  } else {
+    auto table = std::make_unique<bustub::TableHeap>(bpm.get(), nullptr, nullptr, nullptr);
+    for (size_t thread_cnt = config.min_threads_; thread_cnt <= config.max_threads_; thread_cnt *= 2) {
+      RunOnce(config, thread_cnt, table.get());
+    }
+  }
+  bpm.reset();
+  disk_manager->ShutDown();
+  std::remove(BENCH_DB_FILE);
+  std::remove("txn_manager_bench.log");
+  return 0;
+}